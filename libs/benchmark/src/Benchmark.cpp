@@ -0,0 +1,38 @@
+#include "Benchmark.h"
+#include "core/ConsoleOutput.h"
+#include <algorithm>
+
+void BenchmarkRunner::Run(const char* name, size_t opsPerBatch,
+                          const std::function<void()>& batchFunc) {
+    if (!m_filter.empty() && std::string(name).find(m_filter) == std::string::npos)
+        return;
+
+    using Clock = std::chrono::steady_clock;
+
+    // Warm up caches and branch predictors
+    batchFunc();
+
+    std::vector<double> nsPerOp;
+    nsPerOp.reserve(m_numBatches);
+    for (int i = 0; i < m_numBatches; ++i) {
+        const auto start = Clock::now();
+        batchFunc();
+        const auto end = Clock::now();
+        const double ns = std::chrono::duration<double, std::nano>(end - start).count();
+        nsPerOp.push_back(ns / opsPerBatch);
+    }
+
+    std::sort(nsPerOp.begin(), nsPerOp.end());
+
+    Result result;
+    result.name = name;
+    result.opsPerBatch = opsPerBatch;
+    result.medianNsPerOp = nsPerOp[nsPerOp.size() / 2];
+    result.minNsPerOp = nsPerOp.front();
+
+    Printf("%-40s %12zu %14.3f %14.3f\n", result.name.c_str(), result.opsPerBatch,
+           result.medianNsPerOp, result.minNsPerOp);
+    FlushStream(ConsoleStream::Output);
+
+    m_results.push_back(std::move(result));
+}
@@ -0,0 +1,59 @@
+#pragma once
+
+#include "core/Base.h"
+#include <chrono>
+#include <functional>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+// Minimal microbenchmark harness. Each benchmark is a function that performs a fixed number of
+// operations per call (a batch); the harness times a number of batches and reports the median and
+// minimum cost per operation. Batch sizes are fixed so that results can be diffed between builds.
+class BenchmarkRunner {
+public:
+    struct Result {
+        std::string name;
+        size_t opsPerBatch{};
+        double medianNsPerOp{};
+        double minNsPerOp{};
+    };
+
+    void SetFilter(std::string filter) { m_filter = std::move(filter); }
+    void SetNumBatches(int numBatches) { m_numBatches = numBatches; }
+
+    // Runs batchFunc (which must perform opsPerBatch operations) if name matches the filter
+    void Run(const char* name, size_t opsPerBatch, const std::function<void()>& batchFunc);
+
+    const std::vector<Result>& Results() const { return m_results; }
+
+private:
+    std::string m_filter;
+    int m_numBatches = 15;
+    std::vector<Result> m_results;
+};
+
+// Prevents the compiler from optimizing away computations whose results are otherwise unused
+template <typename T>
+void DoNotOptimize(T value) {
+    static_assert(std::is_scalar_v<T>);
+    static volatile T sink;
+    sink = value;
+    (void)sink;
+}
+
+// Benchmark suites
+namespace Benchmarks {
+    void RunCpuBenchmarks(BenchmarkRunner& runner);
+    void RunMemoryBusBenchmarks(BenchmarkRunner& runner);
+    void RunViaBenchmarks(BenchmarkRunner& runner);
+    void RunCoreBenchmarks(BenchmarkRunner& runner);
+    void RunRenderBenchmarks(BenchmarkRunner& runner);
+} // namespace Benchmarks
+
+// Regression checks of behaviour the benchmarked code must keep, run with -check. Each prints a
+// line per case and returns whether all passed.
+namespace Checks {
+    bool CheckScreenLineMerging();
+    bool CheckLineVertices();
+} // namespace Checks
@@ -0,0 +1,58 @@
+#include "Benchmark.h"
+#include "core/CircularBuffer.h"
+
+namespace {
+    const size_t NumOps = 1'000'000;
+
+    // Audio driver usage: producer pushes blocks of samples, consumer pops them
+    void RunPushPopBlocksBenchmark(BenchmarkRunner& runner) {
+        CircularBuffer<int16_t> buffer{4096};
+        const size_t BlockSize = 512;
+        std::vector<int16_t> block(BlockSize, 1);
+
+        runner.Run("circularbuffer/push_pop_blocks", NumOps, [&] {
+            size_t numPopped = 0;
+            for (size_t i = 0; i < NumOps; i += BlockSize) {
+                buffer.PushBack(block.data(), BlockSize);
+                numPopped += buffer.PopFront(block.data(), BlockSize);
+            }
+            DoNotOptimize(numPopped);
+        });
+    }
+
+    // Instruction trace usage: push single elements into a full buffer, dropping the oldest
+    void RunPushBackMoveFrontBenchmark(BenchmarkRunner& runner) {
+        CircularBuffer<uint64_t> buffer{64 * 1024};
+        for (uint64_t i = 0; i < buffer.TotalSize(); ++i)
+            buffer.PushBack(i);
+
+        runner.Run("circularbuffer/push_back_move_front", NumOps, [&] {
+            for (uint64_t i = 0; i < NumOps; ++i) {
+                buffer.PushBackMoveFront(i);
+            }
+        });
+    }
+
+    void RunPeekBackBenchmark(BenchmarkRunner& runner) {
+        CircularBuffer<uint64_t> buffer{64 * 1024};
+        for (uint64_t i = 0; i < buffer.TotalSize(); ++i)
+            buffer.PushBack(i);
+
+        const size_t NumPeeked = 16;
+        std::vector<uint64_t> dest(NumPeeked);
+
+        runner.Run("circularbuffer/peek_back_16", NumOps / NumPeeked, [&] {
+            size_t numPeeked = 0;
+            for (size_t i = 0; i < NumOps / NumPeeked; ++i) {
+                numPeeked += buffer.PeekBack(dest.data(), NumPeeked);
+            }
+            DoNotOptimize(numPeeked);
+        });
+    }
+} // namespace
+
+void Benchmarks::RunCoreBenchmarks(BenchmarkRunner& runner) {
+    RunPushPopBlocksBenchmark(runner);
+    RunPushBackMoveFrontBenchmark(runner);
+    RunPeekBackBenchmark(runner);
+}
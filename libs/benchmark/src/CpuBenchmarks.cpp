@@ -0,0 +1,133 @@
+#include "Benchmark.h"
+#include "emulator/Cpu.h"
+#include "emulator/MemoryBus.h"
+#include <array>
+#include <initializer_list>
+
+namespace {
+    // 64K of flat RAM so that the cpu benchmarks measure instruction dispatch rather than device
+    // lookup on the memory bus.
+    class FlatMemoryDevice : public IMemoryBusDevice {
+    public:
+        void Init(MemoryBus& memoryBus) {
+            memoryBus.ConnectDevice(*this, {0x0000, 0xFFFF}, EnableSync::False);
+        }
+
+        void Load(uint16_t address, const std::vector<uint8_t>& bytes) {
+            std::copy(bytes.begin(), bytes.end(), m_data.begin() + address);
+        }
+
+    private:
+        uint8_t Read(uint16_t address) const override { return m_data[address]; }
+        void Write(uint16_t address, uint8_t value) override { m_data[address] = value; }
+
+        std::array<uint8_t, 64 * 1024> m_data{};
+    };
+
+    // Assembles a 6809 program at a fixed base address
+    class ProgramBuilder {
+    public:
+        ProgramBuilder(uint16_t baseAddress)
+            : m_baseAddress(baseAddress) {}
+
+        uint16_t Here() const { return static_cast<uint16_t>(m_baseAddress + m_bytes.size()); }
+
+        void Emit(std::initializer_list<uint8_t> bytes) {
+            m_bytes.insert(m_bytes.end(), bytes.begin(), bytes.end());
+        }
+
+        // Emits an 8-bit relative branch (BRA, BNE, BSR, etc.) to target
+        void EmitBranch(uint8_t opCode, uint16_t target) {
+            const int offset = target - (Here() + 2);
+            ASSERT(offset >= -128 && offset <= 127);
+            Emit({opCode, static_cast<uint8_t>(offset)});
+        }
+
+        const std::vector<uint8_t>& Bytes() const { return m_bytes; }
+
+    private:
+        uint16_t m_baseAddress;
+        std::vector<uint8_t> m_bytes;
+    };
+
+    const uint16_t ProgramAddress = 0x1000;
+
+    // Simple register/ALU operations with immediate operands
+    std::vector<uint8_t> MakeAluProgram() {
+        ProgramBuilder p{ProgramAddress};
+        const auto loop = p.Here();
+        p.Emit({0x86, 0x10}); // LDA #$10
+        p.Emit({0x8B, 0x05}); // ADDA #$05
+        p.Emit({0x84, 0x7F}); // ANDA #$7F
+        p.Emit({0x81, 0x20}); // CMPA #$20
+        p.Emit({0xC6, 0x03}); // LDB #$03
+        p.Emit({0xCB, 0x01}); // ADDB #$01
+        p.Emit({0x3D});       // MUL
+        p.Emit({0x5A});       // DECB
+        p.EmitBranch(0x20, loop); // BRA loop
+        return p.Bytes();
+    }
+
+    // Loads and stores using extended and indexed addressing, and stack pushes/pulls
+    std::vector<uint8_t> MakeMemoryProgram() {
+        ProgramBuilder p{ProgramAddress};
+        p.Emit({0x8E, 0x20, 0x00});       // LDX #$2000
+        p.Emit({0x10, 0xCE, 0x30, 0x00}); // LDS #$3000
+        const auto loop = p.Here();
+        p.Emit({0xB6, 0x21, 0x00}); // LDA $2100
+        p.Emit({0xB7, 0x21, 0x01}); // STA $2101
+        p.Emit({0xEC, 0x84});       // LDD ,X
+        p.Emit({0xED, 0x84});       // STD ,X
+        p.Emit({0x30, 0x01});       // LEAX 1,X
+        p.Emit({0x34, 0x06});       // PSHS A,B
+        p.Emit({0x35, 0x06});       // PULS A,B
+        p.EmitBranch(0x20, loop);   // BRA loop
+        return p.Bytes();
+    }
+
+    // Conditional branches and subroutine calls
+    std::vector<uint8_t> MakeBranchProgram() {
+        ProgramBuilder p{ProgramAddress};
+        p.Emit({0x10, 0xCE, 0x30, 0x00}); // LDS #$3000
+        p.Emit({0x20, 0x01});             // BRA loop
+        const auto sub = p.Here();
+        p.Emit({0x39}); // sub: RTS
+        const auto loop = p.Here();
+        p.Emit({0xC6, 0x04}); // loop: LDB #$04
+        const auto inner = p.Here();
+        p.EmitBranch(0x8D, sub);   // inner: BSR sub
+        p.Emit({0x5A});            // DECB
+        p.EmitBranch(0x26, inner); // BNE inner
+        p.EmitBranch(0x20, loop);  // BRA loop
+        return p.Bytes();
+    }
+
+    void RunCpuProgram(BenchmarkRunner& runner, const char* name,
+                       const std::vector<uint8_t>& program) {
+        MemoryBus memoryBus;
+        FlatMemoryDevice memory;
+        Cpu cpu;
+
+        memory.Init(memoryBus);
+        cpu.Init(memoryBus);
+
+        memory.Load(ProgramAddress, program);
+        memory.Load(0xFFFE, {ProgramAddress >> 8, ProgramAddress & 0xFF}); // Reset vector
+        cpu.Reset();
+
+        const size_t NumInstructions = 100'000;
+        runner.Run(name, NumInstructions, [&] {
+            cycles_t cycles = 0;
+            for (size_t i = 0; i < NumInstructions; ++i) {
+                cycles += cpu.ExecuteInstruction(false, false);
+            }
+            DoNotOptimize(cycles);
+        });
+    }
+} // namespace
+
+void Benchmarks::RunCpuBenchmarks(BenchmarkRunner& runner) {
+    RunCpuProgram(runner, "cpu/alu_immediate", MakeAluProgram());
+    RunCpuProgram(runner, "cpu/load_store_indexed", MakeMemoryProgram());
+    RunCpuProgram(runner, "cpu/branch_subroutine", MakeBranchProgram());
+}
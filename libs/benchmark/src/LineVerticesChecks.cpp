@@ -0,0 +1,107 @@
+#include "Benchmark.h"
+#include "core/ConsoleOutput.h"
+#include "engine/LineVertices.h"
+#include <cstring>
+#include <iterator>
+#include <vector>
+
+namespace {
+    using LineVertices::LineInstance;
+    using LineVertices::VertexArray;
+    using LineVertices::VertexData;
+
+    bool Report(const char* name, bool passed) {
+        Printf("%-40s %s\n", name, passed ? "passed" : "FAILED");
+        return passed;
+    }
+
+    // Strips of every length from 1 to 9 lines, so that SIMD paths see runs of 4, partial runs and
+    // lines batched across strips, with dots and lines shorter than a pixel mixed in
+    LineStrips MakeMixedLines() {
+        LineStrips lines;
+        Vector2 pos{-100.f, -100.f};
+        for (int numLines = 1; numLines <= 9; ++numLines) {
+            const float brightness = numLines / 10.f;
+            for (int i = 0; i < numLines; ++i) {
+                Vector2 next = pos;
+                if (i % 3 == 1)
+                    next = pos + Vector2{0.3f, -0.2f}; // Shorter than a pixel
+                else if (i % 3 == 2)
+                    next = pos + Vector2{7.5f, 3.25f * numLines};
+                if (i == 0)
+                    lines.AddLine(Line{pos, next, brightness}); // A dot when i % 3 == 0
+                else
+                    lines.AddPoint(next);
+                pos = next;
+            }
+            pos = pos + Vector2{-5.f, 11.f};
+        }
+        return lines;
+    }
+
+    bool SameInstance(const LineInstance& a, const Line& b) {
+        return a.p0.x == b.p0.x && a.p0.y == b.p0.y && a.p1.x == b.p1.x && a.p1.y == b.p1.y &&
+               a.brightness == b.brightness;
+    }
+
+    bool SameVertices(const VertexArray& a, const VertexArray& b) {
+        return a.Size() == b.Size() &&
+               std::memcmp(a.Data(), b.Data(), a.Size() * sizeof(VertexData)) == 0;
+    }
+
+    bool CheckPackLineInstances() {
+        // A strip of 2 lines and a dot, with known instances
+        LineStrips lines;
+        lines.AddLine(Line{{1.f, 2.f}, {3.f, 4.f}, 0.5f});
+        lines.AddPoint({5.f, 6.f});
+        lines.AddLine(Line{{-7.f, 8.f}, {-7.f, 8.f}, 1.f});
+
+        std::vector<LineInstance> instances(lines.NumLines());
+        LineVertices::PackLineInstances(lines, instances.data());
+        const Line expected[] = {{{1.f, 2.f}, {3.f, 4.f}, 0.5f},
+                                 {{3.f, 4.f}, {5.f, 6.f}, 0.5f},
+                                 {{-7.f, 8.f}, {-7.f, 8.f}, 1.f}};
+        bool passed = instances.size() == std::size(expected);
+        for (size_t i = 0; passed && i < instances.size(); ++i)
+            passed = SameInstance(instances[i], expected[i]);
+        Report("line_vertices/pack_instances_strip_and_dot", passed);
+
+        // Every line of mixed strips, in draw order
+        const auto mixedLines = MakeMixedLines();
+        instances.resize(mixedLines.NumLines());
+        LineVertices::PackLineInstances(mixedLines, instances.data());
+        size_t index = 0;
+        bool mixedPassed = true;
+        mixedLines.ForEachLine([&](const Line& line) {
+            mixedPassed = mixedPassed && SameInstance(instances[index++], line);
+        });
+        mixedPassed = mixedPassed && index == instances.size();
+        Report("line_vertices/pack_instances_mixed_strips", mixedPassed);
+
+        return passed && mixedPassed;
+    }
+
+    bool CheckQuadsMatchScalar() {
+        const auto lines = MakeMixedLines();
+        const float scaleX = 2.5f;
+        const float scaleY = 1.75f;
+
+        VertexArray scalar0, scalar1, simd0, simd1;
+        LineVertices::CreateQuadVertexArrayScalar(lines, 1.f, scaleX, scaleY, scalar0);
+        LineVertices::CreateQuadVertexArrayScalar(lines, 6.f, scaleX, scaleY, scalar1);
+
+        LineVertices::CreateQuadVertexArray(lines, 1.f, scaleX, scaleY, simd0);
+        bool passed = Report("line_vertices/quads_match_scalar", SameVertices(simd0, scalar0));
+
+        LineVertices::CreateQuadVertexArrays(lines, 1.f, 6.f, scaleX, scaleY, simd0, simd1);
+        passed &= Report("line_vertices/two_width_quads_match_scalar",
+                         SameVertices(simd0, scalar0) && SameVertices(simd1, scalar1));
+        return passed;
+    }
+} // namespace
+
+bool Checks::CheckLineVertices() {
+    bool passed = CheckPackLineInstances();
+    passed &= CheckQuadsMatchScalar();
+    return passed;
+}
@@ -0,0 +1,96 @@
+#include "Benchmark.h"
+#include "emulator/BiosRom.h"
+#include "emulator/EngineTypes.h"
+#include "emulator/IllegalMemoryDevice.h"
+#include "emulator/MemoryBus.h"
+#include "emulator/MemoryMap.h"
+#include "emulator/Ram.h"
+#include "emulator/UnmappedMemoryDevice.h"
+#include "emulator/Via.h"
+#include <array>
+
+namespace {
+    // Stands in for Cartridge, which can only be loaded from a file
+    class CartridgeRomDevice : public IMemoryBusDevice {
+    public:
+        void Init(MemoryBus& memoryBus) {
+            memoryBus.ConnectDevice(*this, MemoryMap::Cartridge.range, EnableSync::False);
+        }
+
+    private:
+        uint8_t Read(uint16_t address) const override { return m_data[address]; }
+        void Write(uint16_t, uint8_t) override {}
+
+        std::array<uint8_t, MemoryMap::Cartridge.physicalSize> m_data{};
+    };
+
+    // Same set of devices, connected in the same ranges, as Emulator
+    struct MemoryBusSetup {
+        MemoryBusSetup() {
+            cartridge.Init(memoryBus);
+            unmapped.Init(memoryBus);
+            ram.Init(memoryBus);
+            via.Init(memoryBus);
+            illegal.Init(memoryBus);
+            biosRom.Init(memoryBus);
+
+            via.Reset();
+            via.SetSyncContext(input, renderContext, audioContext);
+        }
+
+        MemoryBus memoryBus;
+        CartridgeRomDevice cartridge;
+        UnmappedMemoryDevice unmapped;
+        Ram ram;
+        Via via;
+        IllegalMemoryDevice illegal;
+        BiosRom biosRom;
+
+        Input input;
+        RenderContext renderContext;
+        AudioContext audioContext{1500000.f / 44100.f};
+    };
+
+    const size_t NumAccesses = 1'000'000;
+
+    void RunReadBenchmark(BenchmarkRunner& runner, const char* name, MemoryBus& memoryBus,
+                          uint16_t firstAddress, uint16_t numAddresses) {
+        runner.Run(name, NumAccesses, [&] {
+            uint32_t sum = 0;
+            for (size_t i = 0; i < NumAccesses; ++i) {
+                sum += memoryBus.Read(static_cast<uint16_t>(firstAddress + (i % numAddresses)));
+            }
+            DoNotOptimize(sum);
+        });
+    }
+
+    void RunWriteBenchmark(BenchmarkRunner& runner, const char* name, MemoryBus& memoryBus,
+                           uint16_t firstAddress, uint16_t numAddresses) {
+        runner.Run(name, NumAccesses, [&] {
+            for (size_t i = 0; i < NumAccesses; ++i) {
+                memoryBus.Write(static_cast<uint16_t>(firstAddress + (i % numAddresses)),
+                                static_cast<uint8_t>(i));
+            }
+        });
+    }
+} // namespace
+
+void Benchmarks::RunMemoryBusBenchmarks(BenchmarkRunner& runner) {
+    MemoryBusSetup setup;
+    auto& memoryBus = setup.memoryBus;
+
+    RunReadBenchmark(runner, "memorybus/read_cartridge", memoryBus, 0x0000, 0x8000);
+    RunReadBenchmark(runner, "memorybus/read_ram", memoryBus, 0xC800, 0x0400);
+    // Only read port B, port A and DDRs; other registers have side effects on timers/interrupts
+    RunReadBenchmark(runner, "memorybus/read_via", memoryBus, 0xD000, 4);
+    RunReadBenchmark(runner, "memorybus/read_bios", memoryBus, 0xE000, 0x2000);
+
+    RunWriteBenchmark(runner, "memorybus/write_ram", memoryBus, 0xC800, 0x0400);
+    // Port A only (DDR A is 0, so no integrator updates)
+    RunWriteBenchmark(runner, "memorybus/write_via", memoryBus, 0xD001, 1);
+
+    // Debugger registers callbacks for every access
+    memoryBus.RegisterCallbacks([](uint16_t, uint8_t) {}, [](uint16_t, uint8_t) {});
+    RunReadBenchmark(runner, "memorybus/read_ram_with_callbacks", memoryBus, 0xC800, 0x0400);
+    RunWriteBenchmark(runner, "memorybus/write_ram_with_callbacks", memoryBus, 0xC800, 0x0400);
+}
@@ -0,0 +1,109 @@
+#include "Benchmark.h"
+#include "emulator/EngineTypes.h"
+#include "engine/DisplayListDiff.h"
+#include "engine/LineVertices.h"
+#include "engine/SoftwareRender.h"
+
+namespace {
+    // A deterministic frame's worth of lines: short connected segments in strips of 8, with some
+    // dots
+    LineStrips MakeFrameLines(size_t numLines) {
+        LineStrips lines;
+        Vector2 pos{};
+        for (size_t i = 0; i < numLines; ++i) {
+            const bool isDot = i % 10 == 0;
+            Vector2 delta{static_cast<float>((i * 37) % 41) - 20.f,
+                          static_cast<float>((i * 91) % 31) - 15.f};
+            if (isDot)
+                delta = {};
+            Vector2 next = pos + delta;
+            // Keep within the 256x256 screen
+            if (std::abs(next.x) > 128.f || std::abs(next.y) > 128.f)
+                next = {};
+            if (i % 8 == 0)
+                lines.AddLine(Line{pos, next, 0.75f});
+            else
+                lines.AddPoint(next);
+            pos = next;
+        }
+        return lines;
+    }
+} // namespace
+
+void Benchmarks::RunRenderBenchmarks(BenchmarkRunner& runner) {
+    using LineVertices::VertexArray;
+
+    const size_t NumLines = 2000;
+    const auto lines = MakeFrameLines(NumLines);
+
+    // Vertex arrays are reused across batches, as they are across frames by GLRender
+    VertexArray quadVA, glowQuadVA, lineVA, pointVA;
+
+    runner.Run("render/create_quad_vertex_array", NumLines, [&] {
+        LineVertices::CreateQuadVertexArray(lines, 0.4f, 1.f, 0.8f, quadVA);
+        DoNotOptimize(quadVA.Data());
+    });
+
+    runner.Run("render/create_line_and_point_arrays", NumLines, [&] {
+        LineVertices::CreateLineAndPointVertexArrays(lines, 1.f, 0.8f, lineVA, pointVA);
+        DoNotOptimize(lineVA.Data());
+        DoNotOptimize(pointVA.Data());
+    });
+
+    // Busy frames, with both the normal and glow line widths as when blur is enabled
+    const size_t NumBusyLines = 10000;
+    const auto busyLines = MakeFrameLines(NumBusyLines);
+
+    runner.Run("render/vertex_prep_10k_two_passes", NumBusyLines, [&] {
+        LineVertices::CreateQuadVertexArray(busyLines, 0.4f, 1.f, 0.8f, quadVA);
+        LineVertices::CreateQuadVertexArray(busyLines, 1.2f, 1.f, 0.8f, glowQuadVA);
+        DoNotOptimize(quadVA.Data());
+        DoNotOptimize(glowQuadVA.Data());
+    });
+
+    runner.Run("render/vertex_prep_10k_one_pass", NumBusyLines, [&] {
+        LineVertices::CreateQuadVertexArrays(busyLines, 0.4f, 1.2f, 1.f, 0.8f, quadVA,
+                                             glowQuadVA);
+        DoNotOptimize(quadVA.Data());
+        DoNotOptimize(glowQuadVA.Data());
+    });
+
+    // What GLRender does instead, leaving quad expansion to the vertex shader
+    std::vector<LineVertices::LineInstance> lineInstances(NumBusyLines);
+    runner.Run("render/pack_line_instances_10k", NumBusyLines, [&] {
+        LineVertices::PackLineInstances(busyLines, lineInstances.data());
+        DoNotOptimize(lineInstances.data());
+    });
+
+    // Frames that repeat exactly, and frames that alternate between two positions, so that every
+    // line is matched as unchanged or as moved
+    DisplayListDiff displayListDiff;
+    runner.Run("render/display_list_diff_unchanged", NumLines, [&] {
+        displayListDiff.Update(lines);
+        DoNotOptimize(displayListDiff.Deltas().data());
+    });
+
+    LineStrips shiftedLines;
+    lines.ForEachLine([&shiftedLines](const Line& line) {
+        const Vector2 offset{3.f, -2.f};
+        shiftedLines.AddLine(Line{line.p0 + offset, line.p1 + offset, line.brightness});
+    });
+    bool shifted = false;
+    runner.Run("render/display_list_diff_moved", NumLines, [&] {
+        displayListDiff.Update((shifted = !shifted) ? shiftedLines : lines);
+        DoNotOptimize(displayListDiff.Deltas().data());
+    });
+
+    // Full software rendered frames (GLRender-sized screen for a 600 pixel high window), on a
+    // single thread so that results don't depend on the machine's core count
+    SoftwareRender softwareRender;
+    const int ScreenHeight = 600;
+    softwareRender.Initialize(SoftwareRender::ScreenWidthForHeight(ScreenHeight), ScreenHeight, 1);
+    RenderContext renderContext;
+    renderContext.lines = lines;
+
+    runner.Run("render/software_render_frame", 1, [&] {
+        softwareRender.RenderScene(1.0 / 60, renderContext);
+        DoNotOptimize(softwareRender.Pixels());
+    });
+}
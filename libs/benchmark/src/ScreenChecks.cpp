@@ -0,0 +1,93 @@
+#include "Benchmark.h"
+#include "core/ConsoleOutput.h"
+#include "emulator/EngineTypes.h"
+#include "emulator/Screen.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <utility>
+#include <vector>
+
+namespace {
+    // Default Screen tweakable, plus some slack for float rounding
+    constexpr float MaxMergeError = 0.05f + 1e-3f;
+
+    float DistanceToSegment(const Vector2& p, const Vector2& a, const Vector2& b) {
+        const Vector2 ab = b - a;
+        const Vector2 ap = p - a;
+        const float lengthSq = ab.x * ab.x + ab.y * ab.y;
+        const float t =
+            lengthSq > 0.f ? std::clamp((ap.x * ab.x + ap.y * ab.y) / lengthSq, 0.f, 1.f) : 0.f;
+        const Vector2 d = ap - ab * t;
+        return std::sqrt(d.x * d.x + d.y * d.y);
+    }
+
+    // Drives a screen along a path made of (velocity x, velocity y, cycles) legs, and checks that
+    // every position the beam went through is within the merge tolerance of the lines emitted
+    bool CheckPath(const char* name, const std::vector<std::pair<Vector2, int>>& legs) {
+        Screen screen;
+        RenderContext renderContext;
+        screen.Init();
+        screen.SetBrightness(0x5F);
+        screen.SetBlankEnabled(false);
+        screen.SetIntegratorsEnabled(true);
+
+        // A second screen emits a line per cycle, which are cleared as they come, to get each
+        // position without merging
+        Screen referenceScreen = screen;
+        RenderContext referenceContext;
+        std::vector<Vector2> positions;
+
+        for (auto& [velocity, cycles] : legs) {
+            for (Screen* s : {&screen, &referenceScreen}) {
+                s->SetIntegratorX(static_cast<int8_t>(velocity.x));
+                s->SetIntegratorY(static_cast<int8_t>(velocity.y));
+            }
+            for (int i = 0; i < cycles; ++i) {
+                screen.Update(1, renderContext);
+                referenceScreen.Update(1, referenceContext);
+                if (!referenceContext.lines.Empty())
+                    positions.push_back(referenceContext.lines.LastPoint());
+                referenceContext.lines.Clear();
+            }
+        }
+
+        std::vector<Line> lines;
+        renderContext.lines.AppendLines(lines);
+        float maxError = 0.f;
+        for (auto& p : positions) {
+            float error = std::numeric_limits<float>::infinity();
+            for (auto& line : lines)
+                error = std::min(error, DistanceToSegment(p, line.p0, line.p1));
+            maxError = std::max(maxError, error);
+        }
+
+        const bool passed = maxError <= MaxMergeError;
+        Printf("%-40s %s (%zu lines, max error %.4f)\n", name, passed ? "passed" : "FAILED",
+               lines.size(), maxError);
+        return passed;
+    }
+} // namespace
+
+bool Checks::CheckScreenLineMerging() {
+    bool passed = true;
+
+    // At the slower speeds, the beam moves less than the merge tolerance per cycle, so each merge
+    // on its own is within the tolerance, and only bounding the error of the points merged before
+    // keeps the corners
+    for (int speed : {1, 5, 20}) {
+        const int cycles = 500 / speed;
+        passed &= CheckPath(FormattedString<>("screen/merge_l_velocity_%d", speed),
+                            {{{static_cast<float>(speed), 0.f}, cycles},
+                             {{0.f, static_cast<float>(speed)}, cycles}});
+
+        std::vector<std::pair<Vector2, int>> zigzag;
+        for (int i = 0; i < 8; ++i) {
+            const int y = i % 2 ? -speed : speed;
+            zigzag.push_back({{static_cast<float>(speed), static_cast<float>(y)}, cycles / 4});
+        }
+        passed &= CheckPath(FormattedString<>("screen/merge_zigzag_velocity_%d", speed), zigzag);
+    }
+
+    return passed;
+}
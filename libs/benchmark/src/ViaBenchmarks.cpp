@@ -0,0 +1,178 @@
+#include "Benchmark.h"
+#include "emulator/EngineTypes.h"
+#include "emulator/MemoryBus.h"
+#include "emulator/MemoryMap.h"
+#include "emulator/Psg.h"
+#include "emulator/Screen.h"
+#include "emulator/Via.h"
+
+namespace {
+    const float CpuCyclesPerAudioSample = 1500000.f / 44100.f;
+
+    // Drives the VIA registers the way the BIOS line drawing routines do
+    class ViaDriver {
+    public:
+        ViaDriver(Via& via)
+            : m_via(via) {}
+
+        void Write(uint8_t reg, uint8_t value) {
+            m_via.Write(MemoryMap::Via.range.first + reg, value);
+        }
+
+        void Sync(cycles_t cycles) { m_via.Sync(cycles); }
+
+        void InitForDrawing() {
+            Write(0x3, 0xFF); // DDR A: all output (DAC)
+            Write(0x2, 0x9F); // DDR B
+            Write(0xB, 0x98); // Aux control: shift out under O2, PB7 drives /RAMP
+            Write(0xC, 0xCE); // Periph control: /ZERO high, /BLANK low
+        }
+
+        // Draws a line of (dx, dy) over the input number of cycles, then syncs those cycles
+        void DrawLine(int8_t dx, int8_t dy, uint8_t brightness, uint8_t cycles) {
+            Write(0x1, brightness);
+            Write(0x0, 0x84); // Mux sel 2 (brightness)
+            Write(0x0, 0x81); // Mux disabled
+            Write(0x1, static_cast<uint8_t>(dy));
+            Write(0x0, 0x80); // Mux sel 0 (Y integrator)
+            Write(0x0, 0x81); // Mux disabled
+            Write(0x1, static_cast<uint8_t>(dx));
+            Write(0xA, 0xFF);   // Shift register: solid line pattern
+            Write(0x4, cycles); // Timer 1 low
+            Write(0x5, 0x00);   // Timer 1 high: starts ramp
+            Sync(cycles);
+        }
+
+    private:
+        IMemoryBusDevice& m_via;
+    };
+
+    // Writes a PSG register by sequencing BDIR/BC1 as the VIA does
+    void WritePsgRegister(Psg& psg, uint8_t reg, uint8_t value) {
+        auto clock = [&](bool bdir, bool bc1) {
+            psg.SetBDIR(bdir);
+            psg.SetBC1(bc1);
+            psg.Update(1);
+        };
+        psg.WriteDA(reg);
+        clock(true, true); // Latch address
+        clock(false, false);
+        psg.WriteDA(value);
+        clock(true, false); // Write
+        clock(false, false);
+    }
+
+    void RunDrawLinesBenchmark(BenchmarkRunner& runner) {
+        Via via;
+        MemoryBus memoryBus;
+        Input input;
+        RenderContext renderContext;
+        AudioContext audioContext{CpuCyclesPerAudioSample};
+
+        via.Init(memoryBus);
+        via.Reset();
+        via.SetSyncContext(input, renderContext, audioContext);
+
+        ViaDriver driver{via};
+        driver.InitForDrawing();
+
+        const size_t NumLines = 1000;
+        const uint8_t CyclesPerLine = 32;
+
+        runner.Run("via/dosync_draw_lines", NumLines * CyclesPerLine, [&] {
+            for (size_t i = 0; i < NumLines; ++i) {
+                const auto dx = static_cast<int8_t>((i * 37) % 256 - 128);
+                const auto dy = static_cast<int8_t>((i * 91) % 256 - 128);
+                driver.DrawLine(dx, dy, 0x5F, CyclesPerLine);
+            }
+            renderContext.lines.Clear();
+            audioContext.samples.clear();
+        });
+    }
+
+    void RunIdleBenchmark(BenchmarkRunner& runner) {
+        Via via;
+        MemoryBus memoryBus;
+        Input input;
+        RenderContext renderContext;
+        AudioContext audioContext{CpuCyclesPerAudioSample};
+
+        via.Init(memoryBus);
+        via.Reset();
+        via.SetSyncContext(input, renderContext, audioContext);
+
+        ViaDriver driver{via};
+        const size_t NumCycles = 100'000;
+
+        // Sync in small increments, as happens after each cpu instruction
+        runner.Run("via/dosync_idle", NumCycles, [&] {
+            for (size_t i = 0; i < NumCycles; i += 4) {
+                driver.Sync(4);
+            }
+            audioContext.samples.clear();
+        });
+    }
+
+    void RunPsgBenchmark(BenchmarkRunner& runner) {
+        Psg psg;
+        psg.Init();
+
+        WritePsgRegister(psg, 0, 0x40); // Tone A period
+        WritePsgRegister(psg, 2, 0x80); // Tone B period
+        WritePsgRegister(psg, 4, 0xC0); // Tone C period
+        WritePsgRegister(psg, 6, 0x10); // Noise period
+        WritePsgRegister(psg, 7, 0x30); // Mixer: tones on, noise on A only
+        WritePsgRegister(psg, 8, 0x0F); // Amplitude A
+        WritePsgRegister(psg, 9, 0x0F); // Amplitude B
+        WritePsgRegister(psg, 10, 0x10); // Amplitude C: envelope
+        WritePsgRegister(psg, 11, 0x00); // Envelope period
+        WritePsgRegister(psg, 12, 0x10);
+        WritePsgRegister(psg, 13, 0x0E); // Envelope shape: continuous triangle
+
+        const size_t NumCycles = 100'000;
+
+        // Via updates the psg and takes a sample every cycle
+        runner.Run("psg/update_and_sample", NumCycles, [&] {
+            float sum = 0.f;
+            for (size_t i = 0; i < NumCycles; ++i) {
+                psg.Update(1);
+                sum += psg.Sample();
+            }
+            DoNotOptimize(sum);
+        });
+    }
+
+    void RunScreenBenchmark(BenchmarkRunner& runner) {
+        Screen screen;
+        RenderContext renderContext;
+
+        screen.Init();
+        screen.SetBrightness(0x5F);
+        screen.SetBlankEnabled(false);
+        screen.SetIntegratorsEnabled(true);
+
+        const size_t NumCycles = 100'000;
+        const size_t CyclesPerDirection = 32;
+
+        runner.Run("screen/update_drawing", NumCycles, [&] {
+            for (size_t i = 0; i < NumCycles; ++i) {
+                if (i % CyclesPerDirection == 0) {
+                    const size_t segment = i / CyclesPerDirection;
+                    screen.SetIntegratorX(static_cast<int8_t>((segment * 37) % 256 - 128));
+                    screen.SetIntegratorY(static_cast<int8_t>((segment * 91) % 256 - 128));
+                    if (segment % 64 == 0)
+                        screen.ZeroBeam();
+                }
+                screen.Update(1, renderContext);
+            }
+            renderContext.lines.Clear();
+        });
+    }
+} // namespace
+
+void Benchmarks::RunViaBenchmarks(BenchmarkRunner& runner) {
+    RunDrawLinesBenchmark(runner);
+    RunIdleBenchmark(runner);
+    RunPsgBenchmark(runner);
+    RunScreenBenchmark(runner);
+}
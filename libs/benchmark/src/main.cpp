@@ -0,0 +1,61 @@
+#include "Benchmark.h"
+#include "core/ConsoleOutput.h"
+#include "core/ErrorHandler.h"
+#include <optional>
+#include <string>
+
+// Runs all microbenchmarks and prints a table of results, one line per benchmark. With -check,
+// runs the regression checks instead, and fails if any of them do.
+// Usage: benchmark [-filter=substring] [-batches=N] [-check]
+int main(int argc, char** argv) {
+    auto parseInt = [](const std::string& value, const char* name) -> std::optional<int> {
+        try {
+            int i = std::stoi(value);
+            if (i >= 1)
+                return i;
+        } catch (...) {
+        }
+        Errorf("Invalid value for %s: %s\n", name, value.c_str());
+        return {};
+    };
+
+    BenchmarkRunner runner;
+    bool check = false;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg.rfind("-filter=", 0) == 0) {
+            runner.SetFilter(arg.substr(8));
+        } else if (arg.rfind("-batches=", 0) == 0) {
+            auto numBatches = parseInt(arg.substr(9), "-batches");
+            if (!numBatches)
+                return -1;
+            runner.SetNumBatches(*numBatches);
+        } else if (arg == "-check") {
+            check = true;
+        } else {
+            Errorf("Unknown argument: %s\n", arg.c_str());
+            Errorf("Usage: %s [-filter=substring] [-batches=N] [-check]\n", argv[0]);
+            return -1;
+        }
+    }
+
+    // Benchmarks purposely exercise some undefined behaviour (e.g. reads from unmapped memory)
+    ErrorHandler::SetPolicy(ErrorHandler::Policy::Ignore);
+
+    if (check) {
+        bool passed = Checks::CheckScreenLineMerging();
+        passed &= Checks::CheckLineVertices();
+        return passed ? 0 : 1;
+    }
+
+    Printf("%-40s %12s %14s %14s\n", "benchmark", "ops/batch", "median ns/op", "min ns/op");
+
+    Benchmarks::RunCpuBenchmarks(runner);
+    Benchmarks::RunMemoryBusBenchmarks(runner);
+    Benchmarks::RunViaBenchmarks(runner);
+    Benchmarks::RunCoreBenchmarks(runner);
+    Benchmarks::RunRenderBenchmarks(runner);
+
+    return 0;
+}
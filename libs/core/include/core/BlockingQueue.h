@@ -0,0 +1,71 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <mutex>
+#include <optional>
+
+// Bounded queue for handing work to background threads. Push blocks while the queue is full, so
+// producers can't get arbitrarily far ahead of consumers; Pop blocks until an item is available or
+// the queue is closed. Any number of threads may push and pop.
+template <typename T>
+class BlockingQueue {
+public:
+    explicit BlockingQueue(size_t capacity)
+        : m_capacity(capacity) {}
+
+    // Returns false (dropping value) if the queue was closed
+    bool Push(T value) {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_notFull.wait(lock, [this] { return m_closed || m_items.size() < m_capacity; });
+        if (m_closed)
+            return false;
+        m_items.push_back(std::move(value));
+        lock.unlock();
+        m_notEmpty.notify_one();
+        return true;
+    }
+
+    // Never blocks: returns false (dropping value) if the queue is full or closed
+    bool TryPush(T value) {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        if (m_closed || m_items.size() >= m_capacity)
+            return false;
+        m_items.push_back(std::move(value));
+        lock.unlock();
+        m_notEmpty.notify_one();
+        return true;
+    }
+
+    // Returns an empty optional once the queue is closed and all items have been popped
+    std::optional<T> Pop() {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_notEmpty.wait(lock, [this] { return m_closed || !m_items.empty(); });
+        if (m_items.empty())
+            return {};
+        T value = std::move(m_items.front());
+        m_items.pop_front();
+        lock.unlock();
+        m_notFull.notify_one();
+        return value;
+    }
+
+    // Wakes up all waiting threads. Items already queued can still be popped.
+    void Close() {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_closed = true;
+        }
+        m_notFull.notify_all();
+        m_notEmpty.notify_all();
+    }
+
+private:
+    const size_t m_capacity;
+    std::mutex m_mutex;
+    std::condition_variable m_notFull;
+    std::condition_variable m_notEmpty;
+    std::deque<T> m_items;
+    bool m_closed = false;
+};
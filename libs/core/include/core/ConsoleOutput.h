@@ -3,14 +3,16 @@
 #include <cassert>
 #include <cstdio>
 
+// Streams are per-thread so that emulator instances running on different threads can each output
+// to their own log (see ScopedOverridePrintStream and ScopedOverrideErrorStream).
 namespace internal {
-    inline FILE* g_printStream = stdout;
-    inline FILE* g_errorStream = stderr;
+    inline thread_local FILE* g_printStream = stdout;
+    inline thread_local FILE* g_errorStream = stderr;
 } // namespace internal
 
 enum class ConsoleStream { Output, Error };
 
-constexpr FILE* GetStream(ConsoleStream type) {
+inline FILE* GetStream(ConsoleStream type) {
     switch (type) {
     case ConsoleStream::Output:
         return internal::g_printStream;
@@ -45,7 +47,7 @@ inline void FlushStream(ConsoleStream type) {
     fflush(GetStream(type));
 }
 
-// Use to override current print stream
+// Use to override current print stream for the current thread
 class ScopedOverridePrintStream {
 public:
     ScopedOverridePrintStream() = default;
@@ -64,3 +66,23 @@ public:
 private:
     FILE* m_oldStream = nullptr;
 };
+
+// Use to override current error stream for the current thread
+class ScopedOverrideErrorStream {
+public:
+    ScopedOverrideErrorStream() = default;
+    ScopedOverrideErrorStream(FILE* stream) { SetErrorStream(stream); }
+    ~ScopedOverrideErrorStream() {
+        if (m_oldStream)
+            internal::g_errorStream = m_oldStream;
+    }
+
+    void SetErrorStream(FILE* stream) {
+        assert(m_oldStream == nullptr);
+        m_oldStream = internal::g_errorStream;
+        internal::g_errorStream = stream;
+    }
+
+private:
+    FILE* m_oldStream = nullptr;
+};
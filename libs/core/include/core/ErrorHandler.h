@@ -13,6 +13,8 @@ namespace ErrorHandler {
 
     constexpr Policy DefaultPolicy = Policy::LogOnce;
 
+    // Error handling state (policy and logged messages) is per-thread, so these only affect errors
+    // raised on the calling thread.
     void SetPolicy(Policy policy);
     void Reset();
 
@@ -12,10 +12,12 @@
 
 namespace Gui {
     namespace Window {
-        enum Type { Debug, Size };
+        enum Type { Debug, Profiler, Size };
     }
 
-    inline std::array<bool, Window::Size> EnabledWindows = {};
+    // Per-thread so that only the thread that owns the ImGui context (where windows get enabled)
+    // makes ImGui calls. Emulator instances running on other threads skip them.
+    inline thread_local std::array<bool, Window::Size> EnabledWindows = {};
 
     namespace Internal {
         template <typename Func>
@@ -0,0 +1,20 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+namespace Hash {
+    // 64-bit FNV-1a: simple and well distributed, for identifying content and naming cache files
+    // (not for anything security sensitive). Pass a previous result as hash to continue hashing.
+    constexpr uint64_t Fnv1aBasis = 14695981039346656037ull;
+
+    inline uint64_t Fnv1a(const void* data, size_t size, uint64_t hash = Fnv1aBasis) {
+        auto bytes = static_cast<const uint8_t*>(data);
+        for (size_t i = 0; i < size; ++i)
+            hash = (hash ^ bytes[i]) * 1099511628211ull;
+        return hash;
+    }
+
+    inline uint64_t Fnv1a(std::string_view s) { return Fnv1a(s.data(), s.size()); }
+} // namespace Hash
@@ -0,0 +1,237 @@
+#pragma once
+
+#include "core/FileSystem.h"
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <intrin.h>
+#define HOST_PROFILER_RDTSC
+#elif defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define HOST_PROFILER_RDTSC
+#endif
+
+// Breakdown of where each host frame's time goes, by subsystem (emulated CPU, VIA, PSG, rendering,
+// etc.), for finding what to optimize on the host side. Only built with the HOST_PROFILER CMake
+// option, which defines HOST_PROFILER_ENABLED; otherwise the macros below compile to nothing.
+//
+// HOST_PROFILE_SCOPE(Section) times the rest of the enclosing block. Time is exclusive: while a
+// scope is nested in another on the same thread, only the inner one is charged, so the sections of
+// a frame add up to the time spent in them. Time outside any scope isn't charged. Each thread
+// charges its own counters, and HOST_PROFILE_END_FRAME() on the main thread adds up the time
+// charged since the last frame on all threads into a ring of recent frames. When emulating on
+// another thread, sections from both threads overlap, so they can add up to more than the frame.
+//
+// A trace of a number of frames can also be captured and written as a Chrome trace-event JSON file,
+// which chrome://tracing and Perfetto show as a timeline per thread, to find frame pacing hitches.
+// It has a span for each traced section (see IsTraced), and instant events for host frames and
+// guest events, like IRQs, marked with HOST_TRACE_INSTANT(name[, address]). Events go into a
+// buffer per thread, allocated when the thread registers and written only by that thread, and are
+// only serialized once the capture is over.
+#ifdef HOST_PROFILER_ENABLED
+#define HOST_PROFILE_CONCAT_IMPL(a, b) a##b
+#define HOST_PROFILE_CONCAT(a, b) HOST_PROFILE_CONCAT_IMPL(a, b)
+#define HOST_PROFILE_SCOPE(section)                                                                \
+    HostProfiler::Scope HOST_PROFILE_CONCAT(hostProfileScope, __LINE__)(                           \
+        HostProfiler::Section::section)
+#define HOST_PROFILE_END_FRAME() HostProfiler::EndFrame()
+#define HOST_TRACE_INSTANT(...) HostProfiler::TraceInstant(__VA_ARGS__)
+#define HOST_PROFILE_THREAD_NAME(name) HostProfiler::SetThreadName(name)
+#else
+#define HOST_PROFILE_SCOPE(section)
+#define HOST_PROFILE_END_FRAME()
+#define HOST_TRACE_INSTANT(...) ((void)0)
+#define HOST_PROFILE_THREAD_NAME(name)
+#endif
+
+namespace HostProfiler {
+#ifdef HOST_PROFILER_ENABLED
+    constexpr bool CompiledIn = true;
+#else
+    constexpr bool CompiledIn = false;
+#endif
+
+    enum class Section {
+        Cpu,           // Instruction execution, excluding the devices synced from it
+        Via,           // Via::DoSync, excluding Psg and Screen
+        Psg,           // Sound chip and audio sample generation
+        Screen,        // VIA timers, shift register and beam, updated together every cycle
+        Emulate,       // Client frame updates, excluding the sections above and Debugger
+        Debugger,      // Debugger::FrameUpdate bookkeeping around instructions
+        Render,        // GLRender::RenderScene
+        Gui,           // ImGui menus, windows and rendering
+        Swap,          // Swapping buffers, which may wait for vsync
+        Audio,         // Submitting samples to the audio driver
+        AudioCallback, // Audio driver's callback filling the device's buffer, on its own thread
+        Count
+    };
+    constexpr size_t NumSections = static_cast<size_t>(Section::Count);
+
+    const char* SectionName(Section section);
+
+    // Whether a section's scopes are spans in traces. Sections entered for every instruction
+    // aren't, as there would be too many.
+    constexpr bool IsTraced(Section section) { return section >= Section::Emulate; }
+
+    struct Frame {
+        double frameMs{}; // Wall time since the previous frame
+        std::array<double, NumSections> sectionMs{};
+    };
+
+    // Number of most recent frames kept
+    constexpr size_t MaxFrames = 300;
+
+    // Main thread: adds the time charged since the last call as a new frame
+    void EndFrame();
+
+    // Main thread: forgets all frames, e.g. to skip warm-up frames. The next frame starts now if
+    // none was started yet.
+    void Reset();
+
+    // Main thread: most recent frames, oldest first
+    std::vector<Frame> GetFrames();
+
+    // Main thread: writes per-section totals, means and maximums over all frames since the last
+    // Reset, and the most recent frames
+    bool WriteJson(const fs::path& file);
+
+    // Main thread: starts capturing a trace of the next numFrames frames, which is written to
+    // file once they've ended (see EndFrame), or on StopCapture
+    void StartCapture(int numFrames, const fs::path& file);
+
+    // Main thread: ends the capture early and writes the trace
+    bool StopCapture();
+
+    bool IsCapturing();
+
+    // Names the calling thread in traces. name must outlive the profiler, e.g. a string literal.
+    void SetThreadName(const char* name);
+
+    // Main thread: draws the profiler window contents, with a button to capture a trace to
+    // traceFile (ImGui builds only)
+    void DrawImGui(const fs::path& traceFile);
+
+    namespace Internal {
+        struct TraceEvent {
+            enum class Type : uint8_t { Span, Instant, FrameInstant };
+            uint64_t startTicks{};
+            uint64_t endTicks{};
+            const char* name{}; // Must outlive the capture, e.g. a string literal
+            uint16_t address{};
+            bool hasAddress{};
+            Type type{};
+        };
+
+        struct ThreadData {
+            // Ticks charged to each section, only written by the owning thread
+            std::array<std::atomic<uint64_t>, NumSections> ticks{};
+
+            // Trace events of the capture with this generation, only written by the owning thread.
+            // The buffer is allocated when the thread registers, before any capture.
+            std::atomic<uint32_t> traceGeneration{};
+            std::atomic<size_t> numTraceEvents{};
+            std::atomic<size_t> numDroppedTraceEvents{};
+            std::vector<TraceEvent> traceEvents;
+
+            std::atomic<const char*> name{};
+        };
+
+        // Data for the calling thread, kept after it exits
+        ThreadData* RegisterThread();
+
+        struct ThreadState {
+            ThreadData* data = nullptr;
+            Section section = Section::Count; // Section being charged, Count for none
+            uint64_t lastTicks = 0;
+        };
+        inline thread_local ThreadState CurrThreadState;
+
+        inline ThreadData& CurrThreadData() {
+            auto& state = CurrThreadState;
+            if (!state.data)
+                state.data = RegisterThread();
+            return *state.data;
+        }
+
+        // Generation of the capture in progress, 0 if none
+        inline std::atomic<uint32_t> CaptureGeneration{};
+
+        void AddTraceEvent(const TraceEvent& event);
+
+        inline uint64_t Ticks() {
+#ifdef HOST_PROFILER_RDTSC
+            return __rdtsc();
+#else
+            return static_cast<uint64_t>(
+                std::chrono::steady_clock::now().time_since_epoch().count());
+#endif
+        }
+
+        // Charges ticks since the last call to the current section
+        inline void Charge(ThreadState& state, uint64_t now) {
+            if (state.section != Section::Count) {
+                auto& ticks = state.data->ticks[static_cast<size_t>(state.section)];
+                ticks.store(ticks.load(std::memory_order_relaxed) + (now - state.lastTicks),
+                            std::memory_order_relaxed);
+            }
+            state.lastTicks = now;
+        }
+    } // namespace Internal
+
+    // Adds an instant event on the calling thread to the trace being captured, if any
+    inline void TraceInstant(const char* name) {
+        if (Internal::CaptureGeneration.load(std::memory_order_relaxed) != 0) {
+            const uint64_t now = Internal::Ticks();
+            Internal::AddTraceEvent(
+                {now, now, name, 0, false, Internal::TraceEvent::Type::Instant});
+        }
+    }
+
+    inline void TraceInstant(const char* name, uint16_t address) {
+        if (Internal::CaptureGeneration.load(std::memory_order_relaxed) != 0) {
+            const uint64_t now = Internal::Ticks();
+            Internal::AddTraceEvent(
+                {now, now, name, address, true, Internal::TraceEvent::Type::Instant});
+        }
+    }
+
+    class Scope {
+    public:
+        explicit Scope(Section section)
+            : m_section(section) {
+            auto& state = Internal::CurrThreadState;
+            if (!state.data)
+                state.data = Internal::RegisterThread();
+            m_startTicks = Internal::Ticks();
+            Internal::Charge(state, m_startTicks);
+            m_prevSection = state.section;
+            state.section = section;
+        }
+
+        ~Scope() {
+            auto& state = Internal::CurrThreadState;
+            const uint64_t now = Internal::Ticks();
+            Internal::Charge(state, now);
+            state.section = m_prevSection;
+
+            if (IsTraced(m_section) &&
+                Internal::CaptureGeneration.load(std::memory_order_relaxed) != 0) {
+                Internal::AddTraceEvent({m_startTicks, now, SectionName(m_section), 0, false,
+                                         Internal::TraceEvent::Type::Span});
+            }
+        }
+
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+
+    private:
+        Section m_section;
+        Section m_prevSection;
+        uint64_t m_startTicks;
+    };
+} // namespace HostProfiler
@@ -1,14 +1,34 @@
 #pragma once
 
+#include <cstdint>
+#include <cstdlib>
 #include <memory>
 #include <optional>
 
 namespace ImageUtil {
+    // Pixels allocated with malloc, as stb_image allocates decoded images, so that they can be
+    // owned without copying
+    struct FreeDeleter {
+        void operator()(uint8_t* p) const { std::free(p); }
+    };
+    using PixelBuffer = std::unique_ptr<uint8_t[], FreeDeleter>;
+
+    inline PixelBuffer allocatePixels(size_t size) {
+        return PixelBuffer{static_cast<uint8_t*>(std::malloc(size))};
+    }
+
     struct PngImageData {
         int width, height;
         bool hasAlpha;
-        std::unique_ptr<uint8_t[]> data;
+        PixelBuffer data;
     };
-    std::optional<PngImageData> loadPngImage(const char* name);
+
+    // Loads an image with its bottom row first. If numChannels is set (3 or 4), pixels are
+    // converted to that many channels while decoding.
+    std::optional<PngImageData> loadPngImage(const char* name, int numChannels = 0);
+
+    // Writes 8-bit pixels with numChannels (1 to 4) per pixel, top row first
+    bool writePngImage(const char* name, int width, int height, int numChannels,
+                       const uint8_t* data);
 
 } // namespace ImageUtil
@@ -0,0 +1,113 @@
+#pragma once
+
+#include "core/Line.h"
+#include "core/Vector2.h"
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+// Lines stored as strips of connected lines that share end points, which is how the beam draws
+// them: a strip is a run of points drawn with one brightness, where each line starts where the
+// previous one ended. A strip of N points holds N - 1 lines; a strip whose 2 points are equal is a
+// dot. Strips are stored back to back, so a strip's points end where the next strip's begin.
+//
+// Storage is structure-of-arrays (point x and y, strip first point and brightness) so that
+// consumers can transform several points at a time with SIMD: the lines of a strip from point i
+// on have start points at x[i-1..] and end points at x[i..]. Clear keeps the arrays' capacity, so
+// a buffer reused across frames stops allocating once it has grown to fit the largest frame.
+class LineStrips {
+public:
+    // Largest contents since construction, for sizing and reporting memory use
+    struct HighWaterMark {
+        size_t numPoints{};
+        size_t numStrips{};
+        size_t Bytes() const { return numPoints * 2 * sizeof(float) + numStrips * 8; }
+    };
+
+    void Clear() {
+        UpdateHighWaterMark();
+        m_x.clear();
+        m_y.clear();
+        m_stripFirstPoint.clear();
+        m_stripBrightness.clear();
+    }
+
+    bool Empty() const { return m_stripFirstPoint.empty(); }
+    size_t NumLines() const { return m_x.size() - m_stripFirstPoint.size(); }
+    size_t NumPoints() const { return m_x.size(); }
+    size_t NumStrips() const { return m_stripFirstPoint.size(); }
+
+    // Arrays of NumPoints()
+    const float* PointsX() const { return m_x.data(); }
+    const float* PointsY() const { return m_y.data(); }
+    Vector2 Point(size_t index) const { return {m_x[index], m_y[index]}; }
+
+    // Arrays of NumStrips()
+    const uint32_t* StripFirstPoints() const { return m_stripFirstPoint.data(); }
+    const float* StripBrightnesses() const { return m_stripBrightness.data(); }
+
+    // One past the index of the last point of strip stripIndex, which has at least 2 points
+    uint32_t StripEnd(size_t stripIndex) const {
+        return stripIndex + 1 < m_stripFirstPoint.size()
+                   ? m_stripFirstPoint[stripIndex + 1]
+                   : static_cast<uint32_t>(m_x.size());
+    }
+
+    HighWaterMark GetHighWaterMark() const {
+        return {std::max(m_highWaterMark.numPoints, m_x.size()),
+                std::max(m_highWaterMark.numStrips, m_stripFirstPoint.size())};
+    }
+
+    // Starts a new strip with a single line
+    void AddLine(const Line& line) {
+        m_stripFirstPoint.push_back(static_cast<uint32_t>(m_x.size()));
+        m_stripBrightness.push_back(line.brightness);
+        PushPoint(line.p0);
+        PushPoint(line.p1);
+    }
+
+    // Adds a line from the end of the last strip to p. Must not be empty.
+    void AddPoint(const Vector2& p) { PushPoint(p); }
+
+    // Moves the end of the last strip to p, changing its last line. Must not be empty.
+    void SetLastPoint(const Vector2& p) {
+        m_x.back() = p.x;
+        m_y.back() = p.y;
+    }
+
+    Vector2 LastPoint() const { return {m_x.back(), m_y.back()}; }
+    // Start of the last strip's last line
+    Vector2 SecondLastPoint() const { return Point(m_x.size() - 2); }
+    float LastStripBrightness() const { return m_stripBrightness.back(); }
+
+    // Calls func(const Line&) for each line, in draw order
+    template <typename Func>
+    void ForEachLine(Func&& func) const {
+        for (size_t s = 0; s < m_stripFirstPoint.size(); ++s) {
+            const float brightness = m_stripBrightness[s];
+            const uint32_t end = StripEnd(s);
+            for (uint32_t i = m_stripFirstPoint[s] + 1; i < end; ++i)
+                func(Line{{m_x[i - 1], m_y[i - 1]}, {m_x[i], m_y[i]}, brightness});
+        }
+    }
+
+    // Appends each line, for code that needs random access to them
+    void AppendLines(std::vector<Line>& lines) const {
+        lines.reserve(lines.size() + NumLines());
+        ForEachLine([&lines](const Line& line) { lines.push_back(line); });
+    }
+
+private:
+    void PushPoint(const Vector2& p) {
+        m_x.push_back(p.x);
+        m_y.push_back(p.y);
+    }
+
+    void UpdateHighWaterMark() { m_highWaterMark = GetHighWaterMark(); }
+
+    std::vector<float> m_x;
+    std::vector<float> m_y;
+    std::vector<uint32_t> m_stripFirstPoint;
+    std::vector<float> m_stripBrightness;
+    HighWaterMark m_highWaterMark;
+};
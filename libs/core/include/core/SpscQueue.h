@@ -0,0 +1,52 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <utility>
+
+// Lock-free, bounded, single-producer single-consumer queue. Exactly one thread may call TryPush,
+// and exactly one (other) thread may call TryPop. Capacity must be a power of 2.
+template <typename T, size_t Capacity>
+class SpscQueue {
+    static_assert(Capacity > 0 && (Capacity & (Capacity - 1)) == 0,
+                  "Capacity must be a power of 2");
+
+public:
+    // Returns false if the queue is full, in which case value is left untouched
+    bool TryPush(T&& value) {
+        const size_t tail = m_tail.load(std::memory_order_relaxed);
+        if (tail - m_head.load(std::memory_order_acquire) == Capacity)
+            return false;
+        m_values[tail & (Capacity - 1)] = std::move(value);
+        m_tail.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Returns false if the queue is empty
+    bool TryPop(T& value) {
+        const size_t head = m_head.load(std::memory_order_relaxed);
+        if (head == m_tail.load(std::memory_order_acquire))
+            return false;
+        value = std::move(m_values[head & (Capacity - 1)]);
+        m_head.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    bool Empty() const {
+        return m_head.load(std::memory_order_acquire) == m_tail.load(std::memory_order_acquire);
+    }
+
+private:
+    // Keep producer and consumer indices on separate cache lines to avoid false sharing. Padding is
+    // used rather than alignas so that the queue may live in storage that isn't cache line aligned
+    // (e.g. Pimpl).
+    static constexpr size_t CacheLineSize = 64;
+
+    std::array<T, Capacity> m_values{};
+    char m_pad0[CacheLineSize]{};
+    std::atomic<size_t> m_head{0}; // Next index to pop, written by consumer
+    char m_pad1[CacheLineSize]{};
+    std::atomic<size_t> m_tail{0}; // Next index to push, written by producer
+    char m_pad2[CacheLineSize]{};
+};
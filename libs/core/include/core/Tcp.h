@@ -3,14 +3,25 @@
 #include "core/Base.h"
 #include "core/Pimpl.h"
 
+// Minimal blocking TCP sockets: Send blocks until all data is sent, and returns less than len if
+// the connection failed; Receive blocks until some data arrives, and returns <= 0 once the
+// connection is closed. Implemented with SDL_net in SDL builds, and with the platform's sockets
+// otherwise, where sends to a server's client also fail if it stops reading for a few seconds.
+
+// Accepts one client at a time on a port
 class TcpServer {
 public:
     TcpServer();
     ~TcpServer();
 
-    void Open(uint16_t port);
+    // Starts listening on port. Returns false if it couldn't be opened (e.g. already in use).
+    bool Open(uint16_t port);
     void Close();
+    // Accepts a pending client connection if there is one, replacing the current client. Doesn't
+    // block.
     bool TryAccept();
+    // Closes the connection to the current client, but keeps listening
+    void Disconnect();
 
     int Send(const void* data, int len);
     int Receive(void* data, int maxlen);
@@ -36,8 +47,12 @@ public:
     TcpClient();
     ~TcpClient();
 
-    void Open(const char* ipAddress, uint16_t port);
+    // Connects to a server at ipAddress (or host name). Returns false if the connection failed.
+    bool Open(const char* ipAddress, uint16_t port);
     void Close();
+    // Waits up to timeoutMs for data to receive. Returns true if Receive won't block (which
+    // includes the connection having closed).
+    bool WaitForData(int timeoutMs);
 
     int Send(const void* data, int len);
     int Receive(void* data, int maxlen);
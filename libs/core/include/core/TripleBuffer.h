@@ -0,0 +1,57 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+// Lock-free triple buffer for handing off whole values (e.g. a frame's worth of data) from one
+// producer thread to one consumer thread. The producer fills Back() and calls Publish(); the
+// consumer calls Acquire() and reads Front(). Neither side ever waits on the other: the producer
+// always has a buffer to write into, and the consumer always reads the most recently published
+// value, skipping any it didn't get to.
+template <typename T>
+class TripleBuffer {
+public:
+    // Producer side
+    T& Back() { return m_buffers[m_backIndex]; }
+
+    // Makes Back() available to the consumer, and returns a new Back() to write into. Note that
+    // the new Back() holds stale data from an earlier publish that the caller may want to clear.
+    T& Publish() {
+        const auto published = static_cast<uint8_t>(m_backIndex | DirtyBit);
+        const uint8_t prev = m_middle.exchange(published, std::memory_order_acq_rel);
+        m_backIndex = prev & IndexMask;
+        return Back();
+    }
+
+    // Consumer side
+    const T& Front() const { return m_buffers[m_frontIndex]; }
+    T& Front() { return m_buffers[m_frontIndex]; }
+
+    // If a new value was published since the last call, makes it the Front() and returns true.
+    // Otherwise, Front() is left unchanged and returns false.
+    bool Acquire() {
+        if ((m_middle.load(std::memory_order_relaxed) & DirtyBit) == 0)
+            return false;
+        const uint8_t prev = m_middle.exchange(m_frontIndex, std::memory_order_acq_rel);
+        m_frontIndex = prev & IndexMask;
+        return true;
+    }
+
+private:
+    static constexpr uint8_t IndexMask = 0x3;
+    static constexpr uint8_t DirtyBit = 0x4;
+
+    // Padding keeps the producer and consumer's indices on separate cache lines
+    static constexpr size_t CacheLineSize = 64;
+
+    std::array<T, 3> m_buffers{};
+    uint8_t m_backIndex = 0; // Owned by producer
+    char m_pad0[CacheLineSize]{};
+    uint8_t m_frontIndex = 1; // Owned by consumer
+    char m_pad1[CacheLineSize]{};
+    // Index of the buffer in between producer and consumer, plus DirtyBit if it holds a value
+    // published since the consumer's last Acquire().
+    std::atomic<uint8_t> m_middle{2};
+};
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Fixed set of threads for data-parallel work. ParallelFor hands out work items to the workers and
+// the calling thread, and returns once all of them are done. Threads are kept alive between calls,
+// so it's cheap enough to use a few times per frame.
+class WorkerPool {
+public:
+    // numThreads includes the calling thread; 0 means one per hardware thread
+    explicit WorkerPool(size_t numThreads = 0);
+    ~WorkerPool();
+
+    WorkerPool(const WorkerPool&) = delete;
+    WorkerPool& operator=(const WorkerPool&) = delete;
+
+    // Number of threads that run work items, including the calling thread
+    size_t NumThreads() const { return m_threads.size() + 1; }
+
+    // Calls func(i) for i in [0, count), in any order and on any thread. Must not be called
+    // concurrently or from within func.
+    void ParallelFor(size_t count, const std::function<void(size_t index)>& func);
+
+private:
+    void WorkerMain();
+    void RunItems();
+
+    std::vector<std::thread> m_threads;
+    std::mutex m_mutex;
+    std::condition_variable m_workReady;
+    std::condition_variable m_workDone;
+    const std::function<void(size_t)>* m_func{};
+    size_t m_count{};
+    std::atomic<size_t> m_nextIndex{};
+    size_t m_numBusyWorkers{};
+    uint64_t m_generation{}; // Incremented for every ParallelFor, so workers can tell it's new work
+    bool m_stop = false;
+};
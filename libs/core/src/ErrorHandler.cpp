@@ -2,8 +2,9 @@
 #include <unordered_set>
 
 namespace {
-    ErrorHandler::Policy g_policy = ErrorHandler::DefaultPolicy;
-    std::unordered_set<std::string> g_errorMessages;
+    // Per-thread so that emulator instances running on different threads don't share error state
+    thread_local ErrorHandler::Policy g_policy = ErrorHandler::DefaultPolicy;
+    thread_local std::unordered_set<std::string> g_errorMessages;
 } // namespace
 
 namespace ErrorHandler {
@@ -0,0 +1,453 @@
+#include "core/HostProfiler.h"
+#include "core/Base.h"
+#include "core/ConsoleOutput.h"
+#include "core/Gui.h"
+#include <algorithm>
+#include <cinttypes>
+#include <memory>
+#include <mutex>
+
+namespace {
+    using Clock = std::chrono::steady_clock;
+
+    std::mutex g_threadsMutex;
+    std::vector<std::unique_ptr<HostProfiler::Internal::ThreadData>> g_threads;
+
+    // Per thread, allocated when the thread registers. 8 MB with 32 byte events.
+    constexpr size_t MaxTraceEvents = 1 << 18;
+
+    struct State {
+        bool started = false;
+        // For converting ticks to milliseconds, measured from the first frame
+        uint64_t startTicks{};
+        Clock::time_point startTime{};
+        // Ticks charged to each section on all threads, and time, at the end of the last frame
+        std::array<uint64_t, HostProfiler::NumSections> lastSectionTicks{};
+        Clock::time_point lastFrameTime{};
+
+        // Ring of most recent frames
+        std::vector<HostProfiler::Frame> frames;
+        size_t nextFrame{};
+
+        // Since the last Reset
+        size_t numFrames{};
+        HostProfiler::Frame totals;
+        HostProfiler::Frame maximums;
+    };
+    State g_state;
+
+    struct CaptureState {
+        uint32_t lastGeneration{};
+        int numFramesLeft{};
+        fs::path file;
+        // For converting ticks to microseconds, measured from the start of the capture
+        uint64_t startTicks{};
+        Clock::time_point startTime{};
+    };
+    CaptureState g_capture;
+
+    std::array<uint64_t, HostProfiler::NumSections> SumThreadTicks() {
+        std::array<uint64_t, HostProfiler::NumSections> result{};
+        std::lock_guard<std::mutex> lock(g_threadsMutex);
+        for (auto& counters : g_threads) {
+            for (size_t i = 0; i < result.size(); ++i)
+                result[i] += counters->ticks[i].load(std::memory_order_relaxed);
+        }
+        return result;
+    }
+
+    // Marks the start of the first frame
+    void Start() {
+        g_state.started = true;
+        g_state.startTicks = HostProfiler::Internal::Ticks();
+        g_state.startTime = Clock::now();
+        g_state.lastSectionTicks = SumThreadTicks();
+        g_state.lastFrameTime = g_state.startTime;
+        g_state.frames.resize(HostProfiler::MaxFrames);
+    }
+
+    double MsSince(Clock::time_point time, Clock::time_point now) {
+        return std::chrono::duration<double, std::milli>(now - time).count();
+    }
+} // namespace
+
+const char* HostProfiler::SectionName(Section section) {
+    switch (section) {
+    case Section::Cpu:
+        return "CPU";
+    case Section::Via:
+        return "VIA";
+    case Section::Psg:
+        return "PSG";
+    case Section::Screen:
+        return "Screen";
+    case Section::Emulate:
+        return "Emulate";
+    case Section::Debugger:
+        return "Debugger";
+    case Section::Render:
+        return "Render";
+    case Section::Gui:
+        return "GUI";
+    case Section::Swap:
+        return "Swap";
+    case Section::Audio:
+        return "Audio";
+    case Section::AudioCallback:
+        return "Audio callback";
+    case Section::Count:
+        break;
+    }
+    return "?";
+}
+
+HostProfiler::Internal::ThreadData* HostProfiler::Internal::RegisterThread() {
+    // Allocate the trace buffer up front, so that captures never allocate on the traced threads
+    auto data = std::make_unique<ThreadData>();
+    data->traceEvents.resize(MaxTraceEvents);
+
+    std::lock_guard<std::mutex> lock(g_threadsMutex);
+    g_threads.push_back(std::move(data));
+    return g_threads.back().get();
+}
+
+void HostProfiler::Internal::AddTraceEvent(const TraceEvent& event) {
+    auto& data = CurrThreadData();
+    const uint32_t generation = CaptureGeneration.load(std::memory_order_acquire);
+    if (generation == 0)
+        return;
+
+    // First event of this capture on this thread: start over. Only this thread writes the events,
+    // and the main thread only reads them once the capture is over, so no lock is needed.
+    if (data.traceGeneration.load(std::memory_order_relaxed) != generation) {
+        data.numTraceEvents.store(0, std::memory_order_relaxed);
+        data.numDroppedTraceEvents.store(0, std::memory_order_relaxed);
+        data.traceGeneration.store(generation, std::memory_order_release);
+    }
+
+    const size_t numEvents = data.numTraceEvents.load(std::memory_order_relaxed);
+    if (numEvents == data.traceEvents.size()) {
+        data.numDroppedTraceEvents.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    data.traceEvents[numEvents] = event;
+    data.numTraceEvents.store(numEvents + 1, std::memory_order_release);
+}
+
+void HostProfiler::EndFrame() {
+    if (g_capture.numFramesLeft > 0) {
+        const uint64_t now = Internal::Ticks();
+        Internal::AddTraceEvent(
+            {now, now, "Frame", 0, false, Internal::TraceEvent::Type::FrameInstant});
+        if (--g_capture.numFramesLeft == 0)
+            StopCapture();
+    }
+
+    // Unless Reset was called first, the first call only marks the start of the first frame
+    if (!g_state.started) {
+        Start();
+        return;
+    }
+
+    const auto now = Clock::now();
+    const uint64_t nowTicks = Internal::Ticks();
+    const auto sectionTicks = SumThreadTicks();
+
+    const double msSinceStart = MsSince(g_state.startTime, now);
+    const double ticksPerMs = msSinceStart > 0 ? (nowTicks - g_state.startTicks) / msSinceStart : 0;
+
+    Frame frame;
+    frame.frameMs = MsSince(g_state.lastFrameTime, now);
+    for (size_t i = 0; i < NumSections; ++i) {
+        const uint64_t ticks = sectionTicks[i] - g_state.lastSectionTicks[i];
+        frame.sectionMs[i] = ticksPerMs > 0 ? ticks / ticksPerMs : 0.0;
+    }
+    g_state.lastSectionTicks = sectionTicks;
+    g_state.lastFrameTime = now;
+
+    g_state.frames[g_state.nextFrame] = frame;
+    g_state.nextFrame = (g_state.nextFrame + 1) % MaxFrames;
+
+    ++g_state.numFrames;
+    g_state.totals.frameMs += frame.frameMs;
+    g_state.maximums.frameMs = std::max(g_state.maximums.frameMs, frame.frameMs);
+    for (size_t i = 0; i < NumSections; ++i) {
+        g_state.totals.sectionMs[i] += frame.sectionMs[i];
+        g_state.maximums.sectionMs[i] = std::max(g_state.maximums.sectionMs[i], frame.sectionMs[i]);
+    }
+}
+
+void HostProfiler::Reset() {
+    if (!g_state.started)
+        Start();
+    std::fill(g_state.frames.begin(), g_state.frames.end(), Frame{});
+    g_state.nextFrame = 0;
+    g_state.numFrames = 0;
+    g_state.totals = {};
+    g_state.maximums = {};
+}
+
+std::vector<HostProfiler::Frame> HostProfiler::GetFrames() {
+    const size_t numFrames = std::min(g_state.numFrames, g_state.frames.size());
+    std::vector<Frame> result;
+    result.reserve(numFrames);
+    for (size_t i = 0; i < numFrames; ++i) {
+        const size_t index = (g_state.nextFrame + MaxFrames - numFrames + i) % MaxFrames;
+        result.push_back(g_state.frames[index]);
+    }
+    return result;
+}
+
+bool HostProfiler::WriteJson(const fs::path& jsonFile) {
+    FILE* file = fopen(jsonFile.string().c_str(), "w");
+    if (!file) {
+        Errorf("Failed to open host profile json file for writing: %s\n",
+               jsonFile.string().c_str());
+        return false;
+    }
+
+    const size_t n = std::max<size_t>(g_state.numFrames, 1);
+    fprintf(file, "{\n");
+    fprintf(file, "  \"frames\": %zu,\n", g_state.numFrames);
+    fprintf(file, "  \"frameMs\": { \"mean\": %.6f, \"max\": %.6f },\n", g_state.totals.frameMs / n,
+            g_state.maximums.frameMs);
+    fprintf(file, "  \"sectionMs\": {\n");
+    for (size_t i = 0; i < NumSections; ++i) {
+        fprintf(file, "    \"%s\": { \"total\": %.6f, \"mean\": %.6f, \"max\": %.6f }%s\n",
+                SectionName(static_cast<Section>(i)), g_state.totals.sectionMs[i],
+                g_state.totals.sectionMs[i] / n, g_state.maximums.sectionMs[i],
+                i + 1 < NumSections ? "," : "");
+    }
+    fprintf(file, "  },\n");
+
+    const auto frames = GetFrames();
+    fprintf(file, "  \"recentFrames\": [\n");
+    for (size_t f = 0; f < frames.size(); ++f) {
+        fprintf(file, "    { \"frameMs\": %.6f", frames[f].frameMs);
+        for (size_t i = 0; i < NumSections; ++i)
+            fprintf(file, ", \"%s\": %.6f", SectionName(static_cast<Section>(i)),
+                    frames[f].sectionMs[i]);
+        fprintf(file, " }%s\n", f + 1 < frames.size() ? "," : "");
+    }
+    fprintf(file, "  ]\n");
+    fprintf(file, "}\n");
+    fclose(file);
+    return true;
+}
+
+void HostProfiler::StartCapture(int numFrames, const fs::path& file) {
+    ASSERT(numFrames > 0);
+    if (IsCapturing())
+        StopCapture();
+
+    g_capture.numFramesLeft = numFrames;
+    g_capture.file = file;
+    g_capture.startTicks = Internal::Ticks();
+    g_capture.startTime = Clock::now();
+
+    // Skip 0, which means not capturing
+    if (++g_capture.lastGeneration == 0)
+        ++g_capture.lastGeneration;
+    Internal::CaptureGeneration.store(g_capture.lastGeneration, std::memory_order_release);
+}
+
+bool HostProfiler::IsCapturing() {
+    return Internal::CaptureGeneration.load(std::memory_order_relaxed) != 0;
+}
+
+void HostProfiler::SetThreadName(const char* name) {
+    Internal::CurrThreadData().name.store(name, std::memory_order_relaxed);
+}
+
+bool HostProfiler::StopCapture() {
+    const uint32_t generation = Internal::CaptureGeneration.load(std::memory_order_relaxed);
+    if (generation == 0)
+        return false;
+    Internal::CaptureGeneration.store(0, std::memory_order_release);
+    g_capture.numFramesLeft = 0;
+
+    const uint64_t stopTicks = Internal::Ticks();
+    const double elapsedUs =
+        std::chrono::duration<double, std::micro>(Clock::now() - g_capture.startTime).count();
+    const double ticksPerUs = elapsedUs > 0 ? (stopTicks - g_capture.startTicks) / elapsedUs : 1.0;
+
+    // Microseconds since the start of the capture. Spans may have started before it.
+    auto ToUs = [&](uint64_t ticks) {
+        return ticks > g_capture.startTicks ? (ticks - g_capture.startTicks) / ticksPerUs : 0.0;
+    };
+
+    FILE* file = fopen(g_capture.file.string().c_str(), "w");
+    if (!file) {
+        Errorf("Failed to open host trace file for writing: %s\n",
+               g_capture.file.string().c_str());
+        return false;
+    }
+
+    // Chrome trace-event format, with a track per thread
+    size_t numEvents = 0;
+    size_t numDropped = 0;
+    bool first = true;
+    auto Separator = [&] {
+        const char* separator = first ? "" : ",\n";
+        first = false;
+        return separator;
+    };
+    fprintf(file, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+    {
+        std::lock_guard<std::mutex> lock(g_threadsMutex);
+        for (size_t t = 0; t < g_threads.size(); ++t) {
+            auto& data = *g_threads[t];
+            const size_t tid = t + 1;
+            const char* name = data.name.load(std::memory_order_relaxed);
+            fprintf(file,
+                    "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%zu,"
+                    "\"args\":{\"name\":\"%s\"}}",
+                    Separator(), tid,
+                    name ? name : FormattedString<>("Thread %zu", tid).Value());
+
+            if (data.traceGeneration.load(std::memory_order_acquire) != generation)
+                continue;
+            const size_t count = data.numTraceEvents.load(std::memory_order_acquire);
+            numEvents += count;
+            numDropped += data.numDroppedTraceEvents.load(std::memory_order_relaxed);
+
+            for (size_t i = 0; i < count; ++i) {
+                const auto& event = data.traceEvents[i];
+                const double ts = ToUs(event.startTicks);
+                switch (event.type) {
+                case Internal::TraceEvent::Type::Span:
+                    fprintf(file,
+                            "%s{\"name\":\"%s\",\"cat\":\"host\",\"ph\":\"X\",\"pid\":1,"
+                            "\"tid\":%zu,\"ts\":%.3f,\"dur\":%.3f}",
+                            Separator(), event.name, tid, ts, ToUs(event.endTicks) - ts);
+                    break;
+                case Internal::TraceEvent::Type::Instant:
+                    fprintf(file,
+                            "%s{\"name\":\"%s\",\"cat\":\"guest\",\"ph\":\"i\",\"s\":\"t\","
+                            "\"pid\":1,\"tid\":%zu,\"ts\":%.3f",
+                            Separator(), event.name, tid, ts);
+                    if (event.hasAddress)
+                        fprintf(file, ",\"args\":{\"address\":\"$%04x\"}", event.address);
+                    fprintf(file, "}");
+                    break;
+                case Internal::TraceEvent::Type::FrameInstant:
+                    fprintf(file,
+                            "%s{\"name\":\"%s\",\"cat\":\"frame\",\"ph\":\"i\",\"s\":\"g\","
+                            "\"pid\":1,\"tid\":%zu,\"ts\":%.3f}",
+                            Separator(), event.name, tid, ts);
+                    break;
+                }
+            }
+        }
+    }
+    fprintf(file, "\n]}\n");
+    fclose(file);
+
+    Printf("Host trace written to: %s (%zu events)\n", g_capture.file.string().c_str(), numEvents);
+    if (numDropped > 0)
+        Printf("Warning: %zu trace events dropped, buffers were full\n", numDropped);
+    return true;
+}
+
+void HostProfiler::DrawImGui(const fs::path& traceFile) {
+#ifdef DEBUG_UI_ENABLED
+    static const std::array<ImVec4, NumSections> colors = {
+        ImVec4(0.90f, 0.30f, 0.30f, 1.f), // Cpu
+        ImVec4(0.95f, 0.60f, 0.20f, 1.f), // Via
+        ImVec4(0.95f, 0.90f, 0.30f, 1.f), // Psg
+        ImVec4(0.40f, 0.85f, 0.35f, 1.f), // Screen
+        ImVec4(0.85f, 0.85f, 0.85f, 1.f), // Emulate
+        ImVec4(0.30f, 0.80f, 0.85f, 1.f), // Debugger
+        ImVec4(0.35f, 0.50f, 0.95f, 1.f), // Render
+        ImVec4(0.65f, 0.40f, 0.90f, 1.f), // Gui
+        ImVec4(0.60f, 0.60f, 0.60f, 1.f), // Swap
+        ImVec4(0.90f, 0.45f, 0.75f, 1.f), // Audio
+        ImVec4(0.70f, 0.30f, 0.55f, 1.f), // AudioCallback
+    };
+
+    static int traceFrames = 120;
+    if (IsCapturing()) {
+        ImGui::Text("Capturing trace: %d frames left", g_capture.numFramesLeft);
+        ImGui::SameLine();
+        if (ImGui::Button("Stop"))
+            StopCapture();
+    } else {
+        if (ImGui::Button("Capture trace"))
+            StartCapture(traceFrames, traceFile);
+        ImGui::SameLine();
+        ImGui::PushItemWidth(100.f);
+        ImGui::InputInt("frames", &traceFrames);
+        ImGui::PopItemWidth();
+        traceFrames = std::max(traceFrames, 1);
+    }
+    ImGui::Separator();
+
+    const auto frames = GetFrames();
+    if (frames.empty()) {
+        ImGui::Text("No frames yet");
+        return;
+    }
+
+    static float scaleMs = 20.f;
+    ImGui::SliderFloat("Scale (ms)", &scaleMs, 1.f, 100.f);
+
+    // Mean and max of each section over the frames shown
+    std::array<double, NumSections> meanMs{};
+    std::array<double, NumSections> maxMs{};
+    double meanFrameMs = 0;
+    for (auto& frame : frames) {
+        meanFrameMs += frame.frameMs / frames.size();
+        for (size_t i = 0; i < NumSections; ++i) {
+            meanMs[i] += frame.sectionMs[i] / frames.size();
+            maxMs[i] = std::max(maxMs[i], frame.sectionMs[i]);
+        }
+    }
+    ImGui::Text("Frame: %.3f ms mean over %zu frames", meanFrameMs, frames.size());
+    for (size_t i = 0; i < NumSections; ++i) {
+        ImGui::TextColored(colors[i], "%-8s", SectionName(static_cast<Section>(i)));
+        ImGui::SameLine();
+        ImGui::Text("mean %7.3f ms  max %7.3f ms", meanMs[i], maxMs[i]);
+    }
+
+    // Stacked graph of each frame's sections, with the frame time as a line
+    ImGui::Separator();
+    ImDrawList* drawList = ImGui::GetWindowDrawList();
+    const ImVec2 origin = ImGui::GetCursorScreenPos();
+    const ImVec2 size(ImGui::GetContentRegionAvail().x, 150.f);
+    ImGui::InvisibleButton("##stacked", size);
+    drawList->AddRectFilled(origin, ImVec2(origin.x + size.x, origin.y + size.y),
+                            ImGui::GetColorU32(ImGuiCol_FrameBg));
+    const float barWidth = size.x / MaxFrames;
+    auto MsToHeight = [&](double ms) {
+        return std::min(static_cast<float>(ms / scaleMs), 1.f) * size.y;
+    };
+    for (size_t f = 0; f < frames.size(); ++f) {
+        const float x = origin.x + (MaxFrames - frames.size() + f) * barWidth;
+        float y = origin.y + size.y;
+        for (size_t i = 0; i < NumSections; ++i) {
+            const float height = std::min(MsToHeight(frames[f].sectionMs[i]), y - origin.y);
+            drawList->AddRectFilled(ImVec2(x, y - height), ImVec2(x + barWidth, y),
+                                    ImGui::GetColorU32(colors[i]));
+            y -= height;
+        }
+        const float frameY = origin.y + size.y - MsToHeight(frames[f].frameMs);
+        drawList->AddLine(ImVec2(x, frameY), ImVec2(x + barWidth, frameY), IM_COL32_WHITE);
+    }
+
+    // Timeline of each section over the frames shown
+    ImGui::Separator();
+    std::vector<float> values(frames.size());
+    for (size_t i = 0; i < NumSections; ++i) {
+        for (size_t f = 0; f < frames.size(); ++f)
+            values[f] = static_cast<float>(frames[f].sectionMs[i]);
+        const char* name = SectionName(static_cast<Section>(i));
+        ImGui::PushStyleColor(ImGuiCol_PlotLines, colors[i]);
+        ImGui::PlotLines(name, values.data(), static_cast<int>(values.size()), 0,
+                         FormattedString<>("%s %.3f ms", name, values.back()), 0.f, scaleMs,
+                         ImVec2(0.f, 40.f));
+        ImGui::PopStyleColor();
+    }
+#else
+    (void)traceFile;
+#endif
+}
@@ -1,29 +1,36 @@
 #include "core/ImageUtil.h"
 #include "core/Base.h"
 #include <cstdlib>
-#include <cstring>
 
 MSC_PUSH_WARNING_DISABLE(4100  // unreferenced formal parameter
                          4505) // unreferenced local function has been removed
 #define STB_IMAGE_IMPLEMENTATION
 #define STBI_ONLY_PNG
+// Explicitly the defaults, as PngImageData frees decoded images with FreeDeleter
+#define STBI_MALLOC(size) std::malloc(size)
+#define STBI_REALLOC(p, newSize) std::realloc(p, newSize)
+#define STBI_FREE(p) std::free(p)
 #include <stb_image.h>
+#define STB_IMAGE_WRITE_IMPLEMENTATION
+#include <stb_image_write.h>
 MSC_POP_WARNING_DISABLE()
 
 namespace ImageUtil {
 
-    std::optional<PngImageData> loadPngImage(const char* name) {
+    std::optional<PngImageData> loadPngImage(const char* name, int numChannels) {
         stbi_set_flip_vertically_on_load(1);
-        int width{}, height{}, numChannels{};
-        auto buffer = stbi_load(name, &width, &height, &numChannels, 0);
+        int width{}, height{}, fileChannels{};
+        PixelBuffer data{stbi_load(name, &width, &height, &fileChannels, numChannels)};
+        if (!data)
+            return {};
 
-        size_t size = width * height * numChannels;
-        auto data = std::make_unique<unsigned char[]>(size);
-        memcpy(data.get(), buffer, size);
-
-        stbi_image_free(buffer);
+        const int channels = numChannels != 0 ? numChannels : fileChannels;
+        return PngImageData{width, height, channels == 4, std::move(data)};
+    }
 
-        return PngImageData{width, height, numChannels == 4, std::move(data)};
+    bool writePngImage(const char* name, int width, int height, int numChannels,
+                       const uint8_t* data) {
+        return stbi_write_png(name, width, height, numChannels, data, width * numChannels) != 0;
     }
 
 } // namespace ImageUtil
@@ -1,34 +1,247 @@
 #include "core/Tcp.h"
+#include <string>
 
 #if defined(ENGINE_NULL)
 
-class TcpServerImpl {};
-TcpServer::TcpServer() = default;
-TcpServer::~TcpServer() = default;
-void TcpServer::Open(uint16_t /*port*/) {}
-void TcpServer::Close() {}
-bool TcpServer::TryAccept() {
-    return false;
-}
-int TcpServer::Send(const void* /*data*/, int /*len*/) {
-    return 0;
-}
-int TcpServer::Receive(void* /*data*/, int /*maxlen*/) {
-    return 0;
-    ;
-}
+// SDL_net is only available to the SDL engine, so use the platform's sockets directly
 
-class TcpClientImpl {};
-TcpClient::TcpClient() = default;
-TcpClient::~TcpClient() = default;
-void TcpClient::Open(const char* /*ipAddress*/, uint16_t /*port*/) {}
-void TcpClient::Close() {}
-int TcpClient::Send(const void* /*data*/, int /*len*/) {
-    return 0;
-}
-int TcpClient::Receive(void* /*data*/, int /*maxlen*/) {
-    return 0;
-}
+#if defined(PLATFORM_WINDOWS)
+
+#include <winsock2.h>
+#include <ws2tcpip.h>
+
+namespace {
+    using Socket = SOCKET;
+    const Socket InvalidSocket = INVALID_SOCKET;
+    const int SendFlags = 0;
+
+    bool InitSockets() {
+        static const bool initialized = [] {
+            WSADATA data;
+            return ::WSAStartup(MAKEWORD(2, 2), &data) == 0;
+        }();
+        return initialized;
+    }
+
+    void CloseSocket(Socket socket) { ::closesocket(socket); }
+
+    bool SetNonBlocking(Socket socket, bool enable) {
+        u_long mode = enable ? 1 : 0;
+        return ::ioctlsocket(socket, FIONBIO, &mode) == 0;
+    }
+
+    void SetSendTimeout(Socket socket, int milliseconds) {
+        DWORD timeout = milliseconds;
+        ::setsockopt(socket, SOL_SOCKET, SO_SNDTIMEO, reinterpret_cast<const char*>(&timeout),
+                     sizeof(timeout));
+    }
+} // namespace
+
+#else
+
+#include <fcntl.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/select.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+namespace {
+    using Socket = int;
+    const Socket InvalidSocket = -1;
+    // Report a closed connection as a failed send rather than raising SIGPIPE
+    const int SendFlags = MSG_NOSIGNAL;
+
+    bool InitSockets() { return true; }
+
+    void CloseSocket(Socket socket) { ::close(socket); }
+
+    bool SetNonBlocking(Socket socket, bool enable) {
+        const int flags = ::fcntl(socket, F_GETFL, 0);
+        if (flags == -1)
+            return false;
+        return ::fcntl(socket, F_SETFL, enable ? (flags | O_NONBLOCK) : (flags & ~O_NONBLOCK)) !=
+               -1;
+    }
+
+    void SetSendTimeout(Socket socket, int milliseconds) {
+        timeval timeout{};
+        timeout.tv_sec = milliseconds / 1000;
+        timeout.tv_usec = (milliseconds % 1000) * 1000;
+        ::setsockopt(socket, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+    }
+} // namespace
+
+#endif
+
+namespace {
+    // A client that stops reading fails sends after this long, rather than blocking the server's
+    // sending thread forever
+    const int ClientSendTimeoutMs = 3000;
+
+    // Streams of small messages would otherwise be delayed by Nagle's algorithm
+    void SetNoDelay(Socket socket) {
+        int enable = 1;
+        ::setsockopt(socket, IPPROTO_TCP, TCP_NODELAY, reinterpret_cast<const char*>(&enable),
+                     sizeof(enable));
+    }
+
+    int SendAll(Socket socket, const void* data, int len) {
+        auto bytes = static_cast<const char*>(data);
+        int sent = 0;
+        while (sent < len) {
+            const auto result = ::send(socket, bytes + sent, len - sent, SendFlags);
+            if (result <= 0)
+                break;
+            sent += static_cast<int>(result);
+        }
+        return sent;
+    }
+
+    int ReceiveSome(Socket socket, void* data, int maxlen) {
+        return static_cast<int>(::recv(socket, static_cast<char*>(data), maxlen, 0));
+    }
+} // namespace
+
+class TcpServerImpl {
+public:
+    ~TcpServerImpl() { Close(); }
+
+    bool Open(uint16_t port) {
+        Close();
+        if (!InitSockets())
+            return false;
+
+        m_server = ::socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+        if (m_server == InvalidSocket)
+            return false;
+
+        // Allow reopening the port right after a previous run closed it
+        int reuse = 1;
+        ::setsockopt(m_server, SOL_SOCKET, SO_REUSEADDR, reinterpret_cast<const char*>(&reuse),
+                     sizeof(reuse));
+
+        sockaddr_in address{};
+        address.sin_family = AF_INET;
+        address.sin_addr.s_addr = htonl(INADDR_ANY);
+        address.sin_port = htons(port);
+        if (::bind(m_server, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) != 0 ||
+            ::listen(m_server, 1) != 0 || !SetNonBlocking(m_server, true)) {
+            Close();
+            return false;
+        }
+        return true;
+    }
+
+    void Close() {
+        Disconnect();
+        if (m_server != InvalidSocket) {
+            CloseSocket(m_server);
+            m_server = InvalidSocket;
+        }
+    }
+
+    bool TryAccept() {
+        if (m_server == InvalidSocket)
+            return false;
+        const Socket client = ::accept(m_server, nullptr, nullptr);
+        if (client == InvalidSocket)
+            return false;
+        // Accepted sockets may inherit the listening socket's non-blocking mode
+        SetNonBlocking(client, false);
+        SetNoDelay(client);
+        SetSendTimeout(client, ClientSendTimeoutMs);
+        Disconnect();
+        m_client = client;
+        return true;
+    }
+
+    void Disconnect() {
+        if (m_client != InvalidSocket) {
+            CloseSocket(m_client);
+            m_client = InvalidSocket;
+        }
+    }
+
+    int Send(const void* data, int len) {
+        return m_client == InvalidSocket ? -1 : SendAll(m_client, data, len);
+    }
+
+    int Receive(void* data, int maxlen) {
+        return m_client == InvalidSocket ? -1 : ReceiveSome(m_client, data, maxlen);
+    }
+
+private:
+    Socket m_server = InvalidSocket;
+    Socket m_client = InvalidSocket;
+};
+
+class TcpClientImpl {
+public:
+    ~TcpClientImpl() { Close(); }
+
+    bool Open(const char* ipAddress, uint16_t port) {
+        Close();
+        if (!InitSockets())
+            return false;
+
+        addrinfo hints{};
+        hints.ai_family = AF_INET;
+        hints.ai_socktype = SOCK_STREAM;
+        addrinfo* addresses{};
+        const auto service = std::to_string(port);
+        if (::getaddrinfo(ipAddress, service.c_str(), &hints, &addresses) != 0)
+            return false;
+
+        for (auto address = addresses; address; address = address->ai_next) {
+            m_socket = ::socket(address->ai_family, address->ai_socktype, address->ai_protocol);
+            if (m_socket == InvalidSocket)
+                continue;
+            if (::connect(m_socket, address->ai_addr, static_cast<int>(address->ai_addrlen)) == 0)
+                break;
+            Close();
+        }
+        ::freeaddrinfo(addresses);
+
+        if (m_socket == InvalidSocket)
+            return false;
+        SetNoDelay(m_socket);
+        return true;
+    }
+
+    void Close() {
+        if (m_socket != InvalidSocket) {
+            CloseSocket(m_socket);
+            m_socket = InvalidSocket;
+        }
+    }
+
+    bool WaitForData(int timeoutMs) {
+        if (m_socket == InvalidSocket)
+            return true;
+        fd_set readSet;
+        FD_ZERO(&readSet);
+        FD_SET(m_socket, &readSet);
+        timeval timeout{};
+        timeout.tv_sec = timeoutMs / 1000;
+        timeout.tv_usec = (timeoutMs % 1000) * 1000;
+        // First argument is ignored on Windows
+        return ::select(static_cast<int>(m_socket) + 1, &readSet, nullptr, nullptr, &timeout) != 0;
+    }
+
+    int Send(const void* data, int len) {
+        return m_socket == InvalidSocket ? -1 : SendAll(m_socket, data, len);
+    }
+
+    int Receive(void* data, int maxlen) {
+        return m_socket == InvalidSocket ? -1 : ReceiveSome(m_socket, data, maxlen);
+    }
+
+private:
+    Socket m_socket = InvalidSocket;
+};
 
 #elif defined(ENGINE_SDL)
 
@@ -38,13 +251,12 @@ class TcpServerImpl {
 public:
     ~TcpServerImpl() { Close(); }
 
-    void Open(uint16_t port) {
+    bool Open(uint16_t port) {
         m_port = port;
         if (SDLNet_ResolveHost(&m_ip, nullptr, port) == -1)
-            FAIL();
+            return false;
         m_server = SDLNet_TCP_Open(&m_ip);
-        if (!m_server)
-            FAIL();
+        return m_server != nullptr;
     }
 
     void Close() {
@@ -52,22 +264,34 @@ public:
             SDLNet_TCP_Close(m_server);
             m_server = {};
         }
-        if (m_client) {
-            SDLNet_TCP_Close(m_client);
-            m_client = {};
-        }
+        Disconnect();
         m_ip = {};
         m_port = {};
     }
 
     bool TryAccept() {
-        m_client = SDLNet_TCP_Accept(m_server);
-        return m_client != nullptr;
+        TCPsocket client = SDLNet_TCP_Accept(m_server);
+        if (!client)
+            return false;
+        Disconnect();
+        m_client = client;
+        return true;
     }
 
-    int Send(const void* data, int len) { return SDLNet_TCP_Send(m_client, data, len); }
+    void Disconnect() {
+        if (m_client) {
+            SDLNet_TCP_Close(m_client);
+            m_client = {};
+        }
+    }
 
-    int Receive(void* data, int maxlen) { return SDLNet_TCP_Recv(m_client, data, maxlen); }
+    int Send(const void* data, int len) {
+        return m_client ? SDLNet_TCP_Send(m_client, data, len) : -1;
+    }
+
+    int Receive(void* data, int maxlen) {
+        return m_client ? SDLNet_TCP_Recv(m_client, data, maxlen) : -1;
+    }
 
 private:
     TCPsocket m_server{};
@@ -76,42 +300,26 @@ private:
     uint16_t m_port{};
 };
 
-TcpServer::TcpServer() = default;
-TcpServer::~TcpServer() = default;
-
-void TcpServer::Open(uint16_t port) {
-    m_impl->Open(port);
-}
-
-void TcpServer::Close() {
-    m_impl->Close();
-}
-
-bool TcpServer::TryAccept() {
-    return m_impl->TryAccept();
-}
-
-int TcpServer::Send(const void* data, int len) {
-    return m_impl->Send(data, len);
-}
-
-int TcpServer::Receive(void* data, int maxlen) {
-    return m_impl->Receive(data, maxlen);
-}
-
 class TcpClientImpl {
 public:
     ~TcpClientImpl() { Close(); }
 
-    void Open(const char* ipAddress, uint16_t port) {
+    bool Open(const char* ipAddress, uint16_t port) {
         if (SDLNet_ResolveHost(&m_ip, ipAddress, port) == -1)
-            FAIL();
+            return false;
         m_socket = SDLNet_TCP_Open(&m_ip);
         if (!m_socket)
-            FAIL();
+            return false;
+        m_socketSet = SDLNet_AllocSocketSet(1);
+        SDLNet_TCP_AddSocket(m_socketSet, m_socket);
+        return true;
     }
 
     void Close() {
+        if (m_socketSet) {
+            SDLNet_FreeSocketSet(m_socketSet);
+            m_socketSet = {};
+        }
         if (m_socket) {
             SDLNet_TCP_Close(m_socket);
             m_socket = {};
@@ -119,26 +327,70 @@ public:
         m_ip = {};
     }
 
+    bool WaitForData(int timeoutMs) {
+        if (!m_socketSet)
+            return true;
+        return SDLNet_CheckSockets(m_socketSet, static_cast<Uint32>(timeoutMs)) != 0;
+    }
+
     int Send(const void* data, int len) { return SDLNet_TCP_Send(m_socket, data, len); }
 
     int Receive(void* data, int maxlen) { return SDLNet_TCP_Recv(m_socket, data, maxlen); }
 
 private:
     TCPsocket m_socket{};
+    SDLNet_SocketSet m_socketSet{};
     IPaddress m_ip{};
 };
 
+#else
+
+#error Implement me for current platform
+
+#endif
+
+TcpServer::TcpServer() = default;
+TcpServer::~TcpServer() = default;
+
+bool TcpServer::Open(uint16_t port) {
+    return m_impl->Open(port);
+}
+
+void TcpServer::Close() {
+    m_impl->Close();
+}
+
+bool TcpServer::TryAccept() {
+    return m_impl->TryAccept();
+}
+
+void TcpServer::Disconnect() {
+    m_impl->Disconnect();
+}
+
+int TcpServer::Send(const void* data, int len) {
+    return m_impl->Send(data, len);
+}
+
+int TcpServer::Receive(void* data, int maxlen) {
+    return m_impl->Receive(data, maxlen);
+}
+
 TcpClient::TcpClient() = default;
 TcpClient::~TcpClient() = default;
 
-void TcpClient::Open(const char* ipAddress, uint16_t port) {
-    m_impl->Open(ipAddress, port);
+bool TcpClient::Open(const char* ipAddress, uint16_t port) {
+    return m_impl->Open(ipAddress, port);
 }
 
 void TcpClient::Close() {
     m_impl->Close();
 }
 
+bool TcpClient::WaitForData(int timeoutMs) {
+    return m_impl->WaitForData(timeoutMs);
+}
+
 int TcpClient::Send(const void* data, int len) {
     return m_impl->Send(data, len);
 }
@@ -146,9 +398,3 @@ int TcpClient::Send(const void* data, int len) {
 int TcpClient::Receive(void* data, int maxlen) {
     return m_impl->Receive(data, maxlen);
 }
-
-#else
-
-#error Implement me for current platform
-
-#endif
@@ -0,0 +1,72 @@
+#include "core/WorkerPool.h"
+#include <algorithm>
+
+WorkerPool::WorkerPool(size_t numThreads) {
+    if (numThreads == 0)
+        numThreads = std::max(1u, std::thread::hardware_concurrency());
+
+    for (size_t i = 1; i < numThreads; ++i) {
+        m_threads.emplace_back([this] { WorkerMain(); });
+    }
+}
+
+WorkerPool::~WorkerPool() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stop = true;
+    }
+    m_workReady.notify_all();
+    for (auto& thread : m_threads)
+        thread.join();
+}
+
+void WorkerPool::ParallelFor(size_t count, const std::function<void(size_t)>& func) {
+    if (m_threads.empty() || count <= 1) {
+        for (size_t i = 0; i < count; ++i)
+            func(i);
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_func = &func;
+        m_count = count;
+        m_nextIndex = 0;
+        m_numBusyWorkers = m_threads.size();
+        ++m_generation;
+    }
+    m_workReady.notify_all();
+
+    RunItems();
+
+    // Wait for workers to finish their last item, and to stop reading m_func
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_workDone.wait(lock, [this] { return m_numBusyWorkers == 0; });
+    m_func = nullptr;
+}
+
+void WorkerPool::WorkerMain() {
+    uint64_t lastGeneration = 0;
+    for (;;) {
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_workReady.wait(lock,
+                             [&] { return m_stop || m_generation != lastGeneration; });
+            if (m_stop)
+                return;
+            lastGeneration = m_generation;
+        }
+
+        RunItems();
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (--m_numBusyWorkers == 0)
+            m_workDone.notify_one();
+    }
+}
+
+void WorkerPool::RunItems() {
+    for (size_t i = m_nextIndex++; i < m_count; i = m_nextIndex++) {
+        (*m_func)(i);
+    }
+}
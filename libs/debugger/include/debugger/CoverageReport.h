@@ -0,0 +1,26 @@
+#pragma once
+
+#include "core/FileSystem.h"
+#include "debugger/Debugger.h"
+#include "emulator/CodeCoverage.h"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Reports of which code of a rom was executed, from its CodeCoverage. For a rom named name, writes:
+//
+// - <dir>/<name>.opstarts.bin: a bit per rom byte, set if an instruction started there
+// - <dir>/<name>.executed.bin: a bit per rom byte, set if it's part of an executed instruction
+// - <dir>/<name>.coverage.txt: a summary, including code executed outside the rom, the executed
+//   ranges of the rom labeled with symbols, and a disassembly of the whole rom marking each
+//   instruction that was executed
+//
+// Bitmaps are in rom order, lowest bit of each byte first. Unexecuted bytes are disassembled from
+// the end of the previous instruction, so they may be data shown as code.
+namespace CoverageReport {
+    // numRuns is the number of runs merged into coverage, for the summary
+    bool Write(const fs::path& dir, const std::string& name, const CodeCoverage& coverage,
+               const std::vector<uint8_t>& romData, const Debugger::SymbolTable& symbolTable,
+               size_t numRuns);
+} // namespace CoverageReport
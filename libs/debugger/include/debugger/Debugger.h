@@ -4,9 +4,12 @@
 #include "core/CircularBuffer.h"
 #include "debugger/Breakpoints.h"
 #include "debugger/CallStack.h"
+#include "debugger/Profiler.h"
 #include "debugger/SyncProtocol.h"
 #include "debugger/Trace.h"
 #include "emulator/EngineTypes.h"
+#include "emulator/HeatMap.h"
+#include <memory>
 #include <map>
 #include <optional>
 #include <queue>
@@ -29,6 +32,14 @@ public:
 
     using SymbolTable = std::multimap<uint16_t, std::string>;
 
+    // Loads symbols from an AS09 .lst, .asm/.a09 or ASxxxx .map file, as the loadsymbols command
+    // does
+    static bool LoadSymbolsFile(const fs::path& file, SymbolTable& symbolTable);
+
+    // Disassembles instruction as located at address, as in traces, without the values it accessed
+    static std::string Disassemble(const Trace::Instruction& instruction, uint16_t address,
+                                   const SymbolTable& symbolTable);
+
 private:
     void BreakIntoDebugger(bool switchFocus = true);
     void ResumeFromDebugger(bool switchFocus = true);
@@ -42,6 +53,9 @@ private:
     cycles_t ExecuteInstruction(const Input& input, RenderContext& renderContext,
                                 AudioContext& audioContext);
     void SyncInstructionHash(int numInstructionsExecutedThisFrame);
+    void StartHeatMap(std::optional<int> numFrames);
+    void StopHeatMap();
+    void PrintHeatMap(HeatMap::Kind kind, size_t numEntries);
 
     std::shared_ptr<IEngineService> m_engineService;
     fs::path m_devDir;
@@ -56,6 +70,10 @@ private:
     Breakpoints m_breakpoints;
     ConditionalBreakpoints m_conditionalBreakpoints;
     CallStack m_callStack;
+    Profiler m_profiler;
+    std::unique_ptr<HeatMap> m_heatMap; // Allocated on first use
+    bool m_heatMapEnabled = false;
+    std::optional<int> m_heatMapFramesLeft; // If set, stops counting once 0
     std::optional<int64_t> m_numInstructionsToExecute = {};
     SymbolTable m_symbolTable; // Address to symbol name
     cycles_t m_cpuCyclesTotal = 0;
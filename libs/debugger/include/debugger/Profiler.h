@@ -0,0 +1,73 @@
+#pragma once
+
+#include "core/Base.h"
+#include "core/FileSystem.h"
+#include "debugger/CallStack.h"
+#include <cstdint>
+#include <map>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Profiles guest code by attributing the cycles of every instruction executed to the call path it
+// executed in, as tracked by the debugger's CallStack. Nothing is sampled, so the cycles of each
+// function add up exactly to the cycles emulated while profiling.
+//
+// Functions are identified by their first instruction's address, and named after the symbol at
+// that address, the BIOS routine, or the address itself.
+class Profiler {
+public:
+    using SymbolTable = std::multimap<uint16_t, std::string>;
+
+    // Cycles in a 50 Hz frame, the budget a game's main loop has to fit in
+    static constexpr cycles_t CyclesPerFrame = 30'000;
+
+    // Starts collecting, adding to any results so far, from the call path in callStack
+    void Start(const CallStack& callStack);
+    void Stop() { m_enabled = false; }
+    void Reset();
+    bool Enabled() const { return m_enabled; }
+
+    // Call after each instruction, with the cycles it took, before updating the call stack
+    void AddCycles(cycles_t cycles) {
+        if (m_enabled) {
+            m_nodes[m_currNode].selfCycles += cycles;
+            m_totalCycles += cycles;
+        }
+    }
+
+    // Call after frames were pushed or popped, so that following cycles go to the new call path
+    void OnCallStackChanged(const CallStack& callStack);
+
+    // Call after a frame was pushed for a call, to also count the call to the new function
+    void OnCall(const CallStack& callStack);
+
+    // Functions sorted by self cycles, with their self and inclusive cycles per frame
+    void PrintFlat(const SymbolTable& symbolTable, size_t maxEntries) const;
+
+    // Call tree sorted by inclusive cycles, leaving out paths with less than minPercent of cycles
+    void PrintTree(const SymbolTable& symbolTable, double minPercent) const;
+
+    // Writes one "caller;...;callee cycles" line per call path, the folded stack format that
+    // flame graph tools take
+    bool WriteFolded(const fs::path& file, const SymbolTable& symbolTable) const;
+
+private:
+    // Node in the call tree. Node 0 is the root, for cycles outside of any frame.
+    struct Node {
+        uint16_t address{};
+        uint32_t parent{};
+        uint32_t depth{};
+        cycles_t selfCycles{};
+        uint64_t numCalls{};
+    };
+
+    uint32_t FindOrAddChild(uint32_t parent, uint16_t address);
+    std::vector<cycles_t> InclusiveCycles() const;
+
+    bool m_enabled = false;
+    std::vector<Node> m_nodes{Node{}};
+    std::unordered_map<uint64_t, uint32_t> m_children; // Node by parent and address
+    uint32_t m_currNode = 0;
+    cycles_t m_totalCycles = 0;
+};
@@ -25,7 +25,8 @@ public:
     void InitServer() {
         m_server = std::make_unique<TcpServer>();
         Errorf("Server: about to accept connection...\n");
-        m_server->Open(9123);
+        if (!m_server->Open(9123))
+            FAIL_MSG("Server: failed to open port 9123");
         while (!m_server->TryAccept()) {
             Errorf("Server: no connection, retrying...\n");
             using namespace std::chrono_literals;
@@ -44,7 +45,8 @@ public:
     void InitClient() {
         m_client = std::make_unique<TcpClient>();
         Errorf("Client: about to connect...\n");
-        m_client->Open("127.0.0.1", 9123);
+        if (!m_client->Open("127.0.0.1", 9123))
+            FAIL_MSG("Client: failed to connect to port 9123");
         Errorf("Client: Connected!\n");
     }
 
@@ -1,3 +1,5 @@
+#pragma once
+
 #include "core/Encode.h"
 #include "emulator/Cpu.h"
 #include "emulator/CpuOpCodes.h"
@@ -35,14 +37,10 @@ namespace Trace {
         }
     };
 
-    inline Instruction ReadInstruction(uint16_t opAddr, const MemoryBus& memoryBus) {
+    // Decodes the instruction at the start of opBytes, which must be a valid op code
+    inline Instruction DecodeInstruction(const std::array<uint8_t, 5>& opBytes) {
         Instruction instruction{};
-
-        // Always read max opBytes size even if not all the bytes are for this instruction. We can't
-        // really know up front how many bytes an op will take because indexed instructions
-        // sometimes read an extra operand byte (determined dynamically).
-        for (auto& byte : instruction.opBytes)
-            byte = memoryBus.ReadRaw(opAddr++);
+        instruction.opBytes = opBytes;
 
         int cpuOpPage = 0;
         size_t opCodeIndex = 0;
@@ -60,6 +58,39 @@ namespace Trace {
         return instruction;
     }
 
+    inline Instruction ReadInstruction(uint16_t opAddr, const MemoryBus& memoryBus) {
+        // Always read max opBytes size even if not all the bytes are for this instruction. We can't
+        // really know up front how many bytes an op will take because indexed instructions
+        // sometimes read an extra operand byte (determined dynamically).
+        std::array<uint8_t, 5> opBytes;
+        for (auto& byte : opBytes)
+            byte = memoryBus.ReadRaw(opAddr++);
+        return DecodeInstruction(opBytes);
+    }
+
+    // Size of the instruction including the extra operand bytes of indexed instructions, which
+    // cpuOp->size doesn't count
+    inline size_t InstructionSize(const Instruction& instruction) {
+        size_t size = instruction.cpuOp->size;
+        if (instruction.cpuOp->addrMode == AddressingMode::Indexed) {
+            const uint8_t postbyte = instruction.GetOperand(0);
+            if (postbyte & 0x80) {
+                switch (postbyte & 0x0F) {
+                case 0b1000: // 8 bit offset
+                case 0b1100:
+                    size += 1;
+                    break;
+                case 0b1001: // 16 bit offset or address
+                case 0b1101:
+                case 0b1111:
+                    size += 2;
+                    break;
+                }
+            }
+        }
+        return size;
+    }
+
     inline void PreOpWriteTraceInfo(InstructionTraceInfo& traceInfo,
                                     const CpuRegisters& cpuRegisters,
                                     /*const*/ MemoryBus& memoryBus) {
@@ -0,0 +1,222 @@
+#include "debugger/CoverageReport.h"
+#include "core/Base.h"
+#include "debugger/Trace.h"
+#include "emulator/CpuOpCodes.h"
+#include "emulator/MemoryMap.h"
+#include <algorithm>
+#include <array>
+#include <fstream>
+#include <optional>
+
+namespace {
+    bool IsValidOpCode(const std::array<uint8_t, 5>& opBytes) {
+        auto InTable = [](const CpuOp table[], size_t numOps, uint8_t opCode) {
+            return std::any_of(table, table + numOps,
+                               [opCode](const CpuOp& cpuOp) { return cpuOp.opCode == opCode; });
+        };
+        if (IsOpCodePage1(opBytes[0]))
+            return InTable(CpuOpsPage1, NumCpuOpsPage1, opBytes[1]);
+        if (IsOpCodePage2(opBytes[0]))
+            return InTable(CpuOpsPage2, NumCpuOpsPage2, opBytes[1]);
+        return CpuOpsPage0[opBytes[0]].addrMode != AddressingMode::Illegal;
+    }
+
+    // Instruction at offset, if it's valid and ends within data
+    std::optional<Trace::Instruction> DecodeAt(const std::vector<uint8_t>& data, size_t offset) {
+        std::array<uint8_t, 5> opBytes{};
+        for (size_t i = 0; i < opBytes.size() && offset + i < data.size(); ++i)
+            opBytes[i] = data[offset + i];
+        if (!IsValidOpCode(opBytes))
+            return {};
+        auto instruction = Trace::DecodeInstruction(opBytes);
+        if (offset + Trace::InstructionSize(instruction) > data.size())
+            return {};
+        return instruction;
+    }
+
+    // E.g. "Start" or "Start+$1f", for the closest symbol at or before address
+    std::string NearestSymbol(uint16_t address, const Debugger::SymbolTable& symbolTable) {
+        auto iter = symbolTable.upper_bound(address);
+        if (iter == symbolTable.begin())
+            return {};
+        --iter;
+        const auto [symbolAddress, name] = *iter;
+        if (symbolAddress == address)
+            return name;
+        return FormattedString<>("%s+$%x", name.c_str(), address - symbolAddress).Value();
+    }
+
+    bool WriteBitmap(const fs::path& file, const std::vector<bool>& bits) {
+        std::vector<uint8_t> data((bits.size() + 7) / 8);
+        for (size_t i = 0; i < bits.size(); ++i) {
+            if (bits[i])
+                data[i / 8] |= static_cast<uint8_t>(1 << (i % 8));
+        }
+        std::ofstream fout(file, std::ios::binary);
+        fout.write(reinterpret_cast<const char*>(data.data()),
+                   static_cast<std::streamsize>(data.size()));
+        return static_cast<bool>(fout);
+    }
+
+    // Runs of set bits as [first, last] pairs
+    template <typename IsSet>
+    std::vector<std::pair<size_t, size_t>> FindRanges(size_t size, IsSet isSet) {
+        std::vector<std::pair<size_t, size_t>> ranges;
+        for (size_t i = 0; i < size; ++i) {
+            if (!isSet(i))
+                continue;
+            if (!ranges.empty() && ranges.back().second + 1 == i)
+                ranges.back().second = i;
+            else
+                ranges.push_back({i, i});
+        }
+        return ranges;
+    }
+} // namespace
+
+namespace CoverageReport {
+    bool Write(const fs::path& dir, const std::string& name, const CodeCoverage& coverage,
+               const std::vector<uint8_t>& romData, const Debugger::SymbolTable& symbolTable,
+               size_t numRuns) {
+        const size_t romSize = coverage.GetRomSize();
+        const size_t windowSize = coverage.GetWindowSize();
+        ASSERT(romData.size() == romSize);
+        const bool bankSwitched = romSize > windowSize;
+
+        // Address in cartridge space, within its bank
+        auto AddressOf = [windowSize](size_t offset) {
+            return static_cast<uint16_t>(offset % windowSize);
+        };
+
+        std::vector<bool> opStarts(romSize);
+        std::vector<bool> executed(romSize);
+        size_t numInstructions = 0;
+        for (size_t offset = 0; offset < romSize; ++offset) {
+            if (!coverage.IsRomOpcodeStart(offset))
+                continue;
+            opStarts[offset] = true;
+            ++numInstructions;
+            if (auto instruction = DecodeAt(romData, offset)) {
+                const size_t size = Trace::InstructionSize(*instruction);
+                std::fill_n(executed.begin() + offset, size, true);
+            }
+        }
+        const size_t numExecuted = std::count(executed.begin(), executed.end(), true);
+
+        if (!WriteBitmap(dir / (name + ".opstarts.bin"), opStarts) ||
+            !WriteBitmap(dir / (name + ".executed.bin"), executed))
+            return false;
+
+        std::ofstream fout(dir / (name + ".coverage.txt"));
+        if (!fout)
+            return false;
+
+        fout << FormattedString<>("Coverage of %s (content hash %016llx), merged from %zu run(s)\n",
+                                  name.c_str(),
+                                  static_cast<unsigned long long>(coverage.GetContentHash()),
+                                  numRuns)
+                    .Value();
+        fout << FormattedString<>("Rom: %zu bytes, %zu executed (%.1f%%), %zu instructions\n",
+                                  romSize, numExecuted,
+                                  romSize > 0 ? 100.0 * numExecuted / romSize : 0.0,
+                                  numInstructions)
+                    .Value();
+
+        if (bankSwitched) {
+            for (size_t bankOffset = 0; bankOffset < romSize; bankOffset += windowSize) {
+                const size_t bankEnd = std::min(bankOffset + windowSize, romSize);
+                const size_t bankExecuted = std::count(executed.begin() + bankOffset,
+                                                       executed.begin() + bankEnd, true);
+                fout << FormattedString<>("  Bank %zu: %zu bytes executed (%.1f%%)\n",
+                                          bankOffset / windowSize, bankExecuted,
+                                          100.0 * bankExecuted / (bankEnd - bankOffset))
+                            .Value();
+            }
+        }
+
+        // Code outside the rom. Decoded instructions can only be cached by address for code that
+        // can't change, so code in RAM is listed.
+        const auto ramRanges =
+            FindRanges(MemoryMap::Ram.range.second - MemoryMap::Ram.range.first + 1, [&](size_t i) {
+                return coverage.IsSystemOpcodeStart(
+                    static_cast<uint16_t>(MemoryMap::Ram.range.first + i));
+            });
+        size_t numRamInstructions = 0;
+        size_t numBiosInstructions = 0;
+        for (uint32_t address = CodeCoverage::SystemStart; address <= 0xFFFF; ++address) {
+            if (!coverage.IsSystemOpcodeStart(static_cast<uint16_t>(address)))
+                continue;
+            if (address >= MemoryMap::Bios.range.first)
+                ++numBiosInstructions;
+            else if (MemoryMap::Ram.range.first <= address &&
+                     address <= MemoryMap::Ram.range.second)
+                ++numRamInstructions;
+        }
+        fout << FormattedString<>("Outside the rom: %zu instructions in RAM, %zu in the BIOS\n",
+                                  numRamInstructions, numBiosInstructions)
+                    .Value();
+        for (auto& [first, last] : ramRanges) {
+            fout << FormattedString<>("  RAM instructions at $%04zx-$%04zx\n",
+                                      MemoryMap::Ram.range.first + first,
+                                      MemoryMap::Ram.range.first + last)
+                        .Value();
+        }
+
+        fout << "\nExecuted ranges:\n";
+        for (auto& [first, last] : FindRanges(romSize, [&](size_t i) { return executed[i]; })) {
+            const uint16_t address = AddressOf(first);
+            if (bankSwitched)
+                fout << FormattedString<>("  %zu:", first / windowSize).Value();
+            fout << FormattedString<>("  $%04x-$%04x %6zu bytes  %s\n", address,
+                                      AddressOf(last), last - first + 1,
+                                      NearestSymbol(address, symbolTable).c_str())
+                        .Value();
+        }
+
+        // Executed instructions start at their opcode, and the rest is disassembled linearly,
+        // stopping short of executed instructions
+        fout << "\nDisassembly (* executed):\n";
+        auto NextOpStart = [&](size_t from, size_t to) {
+            auto iter = std::find(opStarts.begin() + from, opStarts.begin() + to, true);
+            return static_cast<size_t>(iter - opStarts.begin());
+        };
+        for (size_t offset = 0; offset < romSize;) {
+            const uint16_t address = AddressOf(offset);
+            if (bankSwitched && address == 0)
+                fout << FormattedString<>("\nBank %zu:\n", offset / windowSize).Value();
+            auto symbols = symbolTable.equal_range(address);
+            for (auto iter = symbols.first; iter != symbols.second; ++iter)
+                fout << iter->second << ":\n";
+
+            auto instruction = DecodeAt(romData, offset);
+            size_t size = instruction ? Trace::InstructionSize(*instruction) : 1;
+            const bool isExecuted = opStarts[offset];
+            const size_t nextOpStart = NextOpStart(offset + 1, offset + size);
+
+            // Not executed and running into an executed instruction: show as data
+            if (!isExecuted && nextOpStart < offset + size)
+                instruction.reset();
+
+            std::string hex;
+            if (instruction) {
+                for (size_t i = 0; i < size; ++i)
+                    hex += FormattedString<>("%02x ", romData[offset + i]).Value();
+                fout << FormattedString<>(
+                            "%c $%04x  %-16s%s\n", isExecuted ? '*' : ' ', address, hex.c_str(),
+                            Debugger::Disassemble(*instruction, address, symbolTable).c_str())
+                            .Value();
+            } else {
+                fout << FormattedString<>("%c $%04x  %02x              fcb $%02x\n",
+                                          isExecuted ? '*' : ' ', address, romData[offset],
+                                          romData[offset])
+                            .Value();
+                size = 1;
+            }
+
+            // An executed instruction may start inside this one, e.g. when code skips a prefix
+            offset = NextOpStart(offset + 1, offset + size);
+        }
+
+        return static_cast<bool>(fout);
+    }
+} // namespace CoverageReport
@@ -1,6 +1,7 @@
 #include "debugger/Debugger.h"
 #include "core/ConsoleOutput.h"
 #include "core/ErrorHandler.h"
+#include "core/HostProfiler.h"
 #include "core/Platform.h"
 #include "core/RegexUtil.h"
 #include "core/Stream.h"
@@ -14,6 +15,7 @@
 #include "emulator/Via.h"
 #include <array>
 #include <cstdio>
+#include <cstdlib>
 #include <fstream>
 #include <iomanip>
 #include <iostream>
@@ -22,6 +24,12 @@
 #include <string>
 #include <vector>
 
+#ifdef HOST_PROFILER_ENABLED
+#include "emulator/BiosHle.h"
+#include "emulator/MemoryMap.h"
+#include <cstring>
+#endif
+
 namespace {
     struct ScopedConsoleCtrlHandler {
         template <typename Handler>
@@ -448,16 +456,16 @@ namespace {
                     auto offset = static_cast<int8_t>(instruction.GetOperand(0));
                     disasmInstruction =
                         FormattedString<>("%s $%02x", cpuOp->name, U16(offset) & 0x00FF);
-                    comment =
-                        FormattedString<>("(%d), PC + offset = $%04x", offset, nextPC + offset);
+                    comment = FormattedString<>("(%d), PC + offset = $%04x", offset,
+                                                U16(nextPC + offset));
                 } else {
                     // Could be a long branch from page 0 (3 bytes) or page 1 (4 bytes)
                     ASSERT(cpuOp->size >= 3);
                     auto offset = static_cast<int16_t>(
                         CombineToU16(instruction.GetOperand(0), instruction.GetOperand(1)));
                     disasmInstruction = FormattedString<>("%s $%04x", cpuOp->name, offset);
-                    comment =
-                        FormattedString<>("(%d), PC + offset = $%04x", offset, nextPC + offset);
+                    comment = FormattedString<>("(%d), PC + offset = $%04x", offset,
+                                                U16(nextPC + offset));
                 }
             } break;
 
@@ -573,6 +581,16 @@ namespace {
                "t[race] ...                          display trace output\n"
                "  -n <num_lines>                       display num_lines worth\n"
                "  -f <file_name>                       output trace to file_name\n"
+               "hot ...                              execution and memory access heat maps\n"
+               "  start [<num_frames>]                 clear and count, for num_frames if set\n"
+               "  stop                                 stop counting\n"
+               "  {pc|reads|writes} [<num_entries>]    display hottest addresses\n"
+               "  dump <file_name>                     output counts to file_name.<kind>.bin\n"
+               "profile ...                          profile cycles per function\n"
+               "  start|stop|reset                     start/stop collecting, or discard results\n"
+               "  flat [<num_entries>]                 display functions by self cycles\n"
+               "  tree [<min_percent>]                 display call tree by inclusive cycles\n"
+               "  folded <file_name>                   output folded stacks for flame graphs\n"
                "q[uit]                               quit\n"
                "h[elp]                               display this help text\n"
                "\n");
@@ -678,6 +696,14 @@ namespace {
     // is the PC before it was executed, and preOpPC != cpu.Registers().PC.
     std::optional<uint16_t> GetCallOpReturnAddress(uint16_t preOpPC, const Cpu& cpu,
                                                    const MemoryBus& memoryBus) {
+        // Raw reads, so that they don't show up in heat maps
+        auto ReadRaw16 = [&memoryBus](uint16_t address) {
+            // Big endian
+            const uint8_t high = memoryBus.ReadRaw(address);
+            const uint8_t low = memoryBus.ReadRaw(static_cast<uint16_t>(address + 1));
+            return static_cast<uint16_t>(high << 8 | low);
+        };
+
         uint8_t opCode = memoryBus.ReadRaw(preOpPC);
 
         // If it's a call, read the return address off the stack
@@ -688,11 +714,11 @@ namespace {
         case 0xAD: // JSR (page 0)
         case 0xBD: // JSR (page 0)
             // Branch and Jump push only the return address on the stack
-            return memoryBus.Read16(cpu.Registers().S);
+            return ReadRaw16(cpu.Registers().S);
 
         case 0x3F: // SWI (page 0)
             // SWI pushes all registers first, starting with PC
-            return memoryBus.Read16(cpu.Registers().S + 10);
+            return ReadRaw16(cpu.Registers().S + 10);
 
         case 0x10: // Page 1
         case 0x11: // Page 2
@@ -700,7 +726,7 @@ namespace {
             opCode = memoryBus.ReadRaw(preOpPC + 1);
             switch (opCode) {
             case 0x3F: // SWI2 (page 1) or SWI3 (page 2)
-                return memoryBus.Read16(cpu.Registers().S + 10);
+                return ReadRaw16(cpu.Registers().S + 10);
             }
 
         default:
@@ -721,6 +747,23 @@ namespace {
 
 } // namespace
 
+bool Debugger::LoadSymbolsFile(const fs::path& file, SymbolTable& symbolTable) {
+    return LoadUserSymbolsFile(file.string().c_str(), symbolTable);
+}
+
+std::string Debugger::Disassemble(const Trace::Instruction& instruction, uint16_t address,
+                                  const SymbolTable& symbolTable) {
+    Trace::InstructionTraceInfo traceInfo{};
+    traceInfo.instruction = instruction;
+    traceInfo.preOpCpuRegisters.PC = address;
+    auto op = DisassembleOp(traceInfo, symbolTable);
+
+    // Other comments depend on registers, which aren't known here
+    if (instruction.cpuOp->addrMode == AddressingMode::Relative)
+        return op.disasmInstruction + " ; " + op.comment;
+    return op.disasmInstruction;
+}
+
 void Debugger::Init(std::shared_ptr<IEngineService>& engineService, int argc, char** argv,
                     fs::path devDir, Emulator& emulator) {
     m_engineService = engineService;
@@ -731,6 +774,8 @@ void Debugger::Init(std::shared_ptr<IEngineService>& engineService, int argc, ch
             m_syncProtocol.InitServer();
         } else if (arg == "-client") {
             m_syncProtocol.InitClient();
+        } else if (arg == "-profile") {
+            m_profiler.Start(m_callStack);
         }
     }
 
@@ -806,6 +851,7 @@ void Debugger::Reset() {
     m_instructionTraceBuffer.Clear();
     m_currTraceInfo = nullptr;
     m_callStack.Clear();
+    m_profiler.OnCallStackChanged(m_callStack);
 
     // Force ram to zero when running sync protocol for determinism
     if (!m_syncProtocol.IsStandalone()) {
@@ -869,6 +915,7 @@ void Debugger::PostOpUpdateCallstack(const CpuRegisters& preOpRegisters) {
     // Push initial frame on the first instruction
     if (m_callStack.Empty()) {
         m_callStack.Push(StackFrame{0, preOpPC, static_cast<uint16_t>(0), preOpRegisters.S});
+        m_profiler.OnCallStackChanged(m_callStack);
         return;
     }
 
@@ -877,11 +924,19 @@ void Debugger::PostOpUpdateCallstack(const CpuRegisters& preOpRegisters) {
     // Push calls
     if (auto returnAddress = GetCallOpReturnAddress(preOpPC, *m_cpu, *m_memoryBus)) {
         m_callStack.Push(StackFrame{preOpPC, currOpPC, *returnAddress, preOpRegisters.S});
+        m_profiler.OnCall(m_callStack);
+#ifdef HOST_PROFILER_ENABLED
+        if (currOpPC >= MemoryMap::Bios.range.first && HostProfiler::IsCapturing()) {
+            const char* name = BiosHle::RoutineName(currOpPC);
+            HostProfiler::TraceInstant(std::strcmp(name, "?") != 0 ? name : "BIOS call", currOpPC);
+        }
+#endif
     }
     // Pop returns
     else if (m_callStack.IsLastReturnAddress(currOpPC)) {
         // Normal return case
         m_callStack.Pop();
+        m_profiler.OnCallStackChanged(m_callStack);
 
     }
     // Pop abnormal returns
@@ -898,12 +953,14 @@ void Debugger::PostOpUpdateCallstack(const CpuRegisters& preOpRegisters) {
             Printf("Detected abnormal stack frame exit at PC=$%04x: %s\n", preOpPC,
                    m_callStack.Top()->ToString().c_str());
             m_callStack.Pop();
+            m_profiler.OnCallStackChanged(m_callStack);
         }
     }
 }
 
 bool Debugger::FrameUpdate(double frameTime, const EmuEvents& emuEvents, const Input& inputArg,
                            RenderContext& renderContext, AudioContext& audioContext) {
+    HOST_PROFILE_SCOPE(Debugger);
 
     auto input = inputArg; // Copy input arg so we can modify it for sync protocol
     if (m_syncProtocol.IsServer()) {
@@ -1182,6 +1239,75 @@ bool Debugger::FrameUpdate(double frameTime, const EmuEvents& emuEvents, const I
                 validCommand = false;
             }
 
+        } else if (tokens[0] == "hot") {
+            auto ParseKind = [](const std::string& name) -> std::optional<HeatMap::Kind> {
+                for (auto kind : {HeatMap::Kind::Execute, HeatMap::Kind::Read,
+                                  HeatMap::Kind::Write}) {
+                    if (name == HeatMap::KindName(kind))
+                        return kind;
+                }
+                return {};
+            };
+
+            if (tokens.size() > 1 && tokens[1] == "start") {
+                std::optional<int> numFrames;
+                if (tokens.size() > 2)
+                    numFrames = StringToIntegral<int>(tokens[2]);
+                StartHeatMap(numFrames);
+            } else if (tokens.size() > 1 && tokens[1] == "stop") {
+                StopHeatMap();
+            } else if (tokens.size() > 1 && !m_heatMap) {
+                Printf("No heat map, use \"hot start\" first\n");
+            } else if (auto kind = tokens.size() > 1 ? ParseKind(tokens[1]) : std::nullopt) {
+                const size_t numEntries =
+                    tokens.size() > 2 ? StringToIntegral<size_t>(tokens[2]) : 10;
+                PrintHeatMap(*kind, numEntries);
+            } else if (tokens.size() > 2 && tokens[1] == "dump") {
+                for (auto kind : {HeatMap::Kind::Execute, HeatMap::Kind::Read,
+                                  HeatMap::Kind::Write}) {
+                    fs::path outFilePath =
+                        m_devDir / (tokens[2] + "." + HeatMap::KindName(kind) + ".bin");
+                    if (m_heatMap->Save(kind, outFilePath))
+                        Printf("Wrote heat map to \"%s\"\n",
+                               fs::absolute(outFilePath).string().c_str());
+                    else
+                        Printf("Failed to create heat map file\n");
+                }
+            } else {
+                validCommand = false;
+            }
+
+        } else if (tokens[0] == "profile") {
+            if (tokens.size() > 1 && tokens[1] == "start") {
+                m_profiler.Start(m_callStack);
+                Printf("Profiling started\n");
+            } else if (tokens.size() > 1 && tokens[1] == "stop") {
+                m_profiler.Stop();
+                Printf("Profiling stopped\n");
+            } else if (tokens.size() > 1 && tokens[1] == "reset") {
+                m_profiler.Reset();
+                m_profiler.OnCallStackChanged(m_callStack);
+                Printf("Profile reset\n");
+            } else if (tokens.size() > 1 && tokens[1] == "flat") {
+                const size_t numEntries =
+                    tokens.size() > 2 ? StringToIntegral<size_t>(tokens[2]) : 20;
+                m_profiler.PrintFlat(m_symbolTable, numEntries);
+            } else if (tokens.size() > 1 && tokens[1] == "tree") {
+                const double minPercent = tokens.size() > 2 ? std::atof(tokens[2].c_str()) : 1.0;
+                m_profiler.PrintTree(m_symbolTable, minPercent);
+            } else if (tokens.size() > 2 && tokens[1] == "folded") {
+                fs::path outFilePath = m_devDir / tokens[2];
+                if (!outFilePath.has_extension())
+                    outFilePath.replace_extension(".folded");
+                if (m_profiler.WriteFolded(outFilePath, m_symbolTable))
+                    Printf("Wrote folded stacks to \"%s\"\n",
+                           fs::absolute(outFilePath).string().c_str());
+                else
+                    Printf("Failed to create folded stacks file\n");
+            } else {
+                validCommand = false;
+            }
+
         } else if (tokens[0] == "toggle") {
             if (tokens.size() > 1) {
                 if (tokens[1] == "color") {
@@ -1282,6 +1408,10 @@ bool Debugger::FrameUpdate(double frameTime, const EmuEvents& emuEvents, const I
     } else { // Not broken into debugger (running)
 
         ExecuteFrameInstructions(frameTime, input, renderContext, audioContext);
+
+        if (m_heatMapEnabled && m_heatMapFramesLeft && --*m_heatMapFramesLeft <= 0) {
+            StopHeatMap();
+        }
     }
 
     SyncInstructionHash(m_numInstructionsExecutedThisFrame);
@@ -1380,6 +1510,9 @@ cycles_t Debugger::ExecuteInstruction(const Input& input, RenderContext& renderC
         // In case exception is thrown below, we still want to add the current instruction trace
         // info, so wrap the call in a ScopedExit
         auto onExit = MakeScopedExit([&] {
+            // Attribute the cycles to the frame the instruction executed in, i.e. a call's cycles
+            // go to the caller
+            m_profiler.AddCycles(cpuCycles);
             PostOpUpdateCallstack(preOpRegisters);
 
             if (m_traceEnabled) {
@@ -1420,6 +1553,39 @@ cycles_t Debugger::ExecuteInstruction(const Input& input, RenderContext& renderC
     return static_cast<cycles_t>(0);
 };
 
+void Debugger::StartHeatMap(std::optional<int> numFrames) {
+    if (!m_heatMap)
+        m_heatMap = std::make_unique<HeatMap>();
+    m_heatMap->Clear();
+    m_heatMapEnabled = true;
+    m_heatMapFramesLeft = numFrames;
+    m_emulator->SetHeatMap(m_heatMap.get());
+
+    if (numFrames)
+        Printf("Counting heat map for %d frames\n", *numFrames);
+    else
+        Printf("Counting heat map\n");
+}
+
+void Debugger::StopHeatMap() {
+    if (!m_heatMapEnabled)
+        return;
+    m_heatMapEnabled = false;
+    m_heatMapFramesLeft = {};
+    m_emulator->SetHeatMap(nullptr);
+    Printf("Stopped counting heat map\n");
+}
+
+void Debugger::PrintHeatMap(HeatMap::Kind kind, size_t numEntries) {
+    const uint64_t total = m_heatMap->Total(kind);
+    Printf("Hottest %s (%llu total):\n", HeatMap::KindName(kind),
+           static_cast<unsigned long long>(total));
+    for (auto& entry : m_heatMap->Hottest(kind, numEntries)) {
+        Printf("%10u %6.2f%%  %s\n", entry.count, 100.0 * entry.count / total,
+               FormatAddress(entry.address, m_symbolTable).c_str());
+    }
+}
+
 void Debugger::SyncInstructionHash(int numInstructionsExecutedThisFrame) {
     if (m_syncProtocol.IsStandalone())
         return;
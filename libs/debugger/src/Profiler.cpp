@@ -0,0 +1,192 @@
+#include "debugger/Profiler.h"
+#include "core/ConsoleOutput.h"
+#include "emulator/BiosHle.h"
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+
+namespace {
+    std::string FunctionName(uint16_t address, const Profiler::SymbolTable& symbolTable) {
+        auto iter = symbolTable.find(address);
+        if (iter != symbolTable.end())
+            return iter->second;
+        const char* routineName = BiosHle::RoutineName(address);
+        if (std::strcmp(routineName, "?") != 0)
+            return routineName;
+        return FormattedString<>("$%04x", address).Value();
+    }
+
+    double Percent(cycles_t cycles, cycles_t total) {
+        return total > 0 ? 100.0 * cycles / total : 0.0;
+    }
+} // namespace
+
+void Profiler::Start(const CallStack& callStack) {
+    m_enabled = true;
+    OnCallStackChanged(callStack);
+}
+
+void Profiler::Reset() {
+    m_nodes.assign(1, Node{});
+    m_children.clear();
+    m_currNode = 0;
+    m_totalCycles = 0;
+}
+
+void Profiler::OnCallStackChanged(const CallStack& callStack) {
+    if (!m_enabled)
+        return;
+
+    // Call paths are shallow, so walk down from the root rather than mirroring each push and pop
+    uint32_t node = 0;
+    for (auto& frame : callStack.Frames())
+        node = FindOrAddChild(node, frame.frameAddress);
+    m_currNode = node;
+}
+
+void Profiler::OnCall(const CallStack& callStack) {
+    if (!m_enabled)
+        return;
+
+    OnCallStackChanged(callStack);
+    ++m_nodes[m_currNode].numCalls;
+}
+
+uint32_t Profiler::FindOrAddChild(uint32_t parent, uint16_t address) {
+    const uint64_t key = (static_cast<uint64_t>(parent) << 16) | address;
+    auto [iter, inserted] = m_children.try_emplace(key, static_cast<uint32_t>(m_nodes.size()));
+    if (inserted) {
+        Node node;
+        node.address = address;
+        node.parent = parent;
+        node.depth = m_nodes[parent].depth + 1;
+        m_nodes.push_back(node);
+    }
+    return iter->second;
+}
+
+std::vector<cycles_t> Profiler::InclusiveCycles() const {
+    // Children are always added after their parents
+    std::vector<cycles_t> result(m_nodes.size());
+    for (size_t i = m_nodes.size(); i-- > 0;) {
+        result[i] += m_nodes[i].selfCycles;
+        if (i > 0)
+            result[m_nodes[i].parent] += result[i];
+    }
+    return result;
+}
+
+void Profiler::PrintFlat(const SymbolTable& symbolTable, size_t maxEntries) const {
+    struct Function {
+        uint16_t address{};
+        cycles_t selfCycles{};
+        cycles_t inclusiveCycles{};
+        uint64_t numCalls{};
+    };
+
+    const auto inclusiveCycles = InclusiveCycles();
+    std::map<uint16_t, Function> functions;
+    for (uint32_t i = 1; i < m_nodes.size(); ++i) {
+        const auto& node = m_nodes[i];
+        auto& function = functions[node.address];
+        function.address = node.address;
+        function.selfCycles += node.selfCycles;
+        function.numCalls += node.numCalls;
+
+        // Count recursive calls' cycles once, in the outermost call
+        bool recursive = false;
+        for (uint32_t p = node.parent; p != 0 && !recursive; p = m_nodes[p].parent)
+            recursive = m_nodes[p].address == node.address;
+        if (!recursive)
+            function.inclusiveCycles += inclusiveCycles[i];
+    }
+
+    std::vector<Function> sorted;
+    for (auto& [address, function] : functions)
+        sorted.push_back(function);
+    std::sort(sorted.begin(), sorted.end(), [](const Function& a, const Function& b) {
+        return a.selfCycles > b.selfCycles;
+    });
+    if (sorted.size() > maxEntries)
+        sorted.resize(maxEntries);
+
+    const double numFrames = static_cast<double>(m_totalCycles) / CyclesPerFrame;
+    Printf("Profile: %llu cycles (%.1f frames of %llu cycles)\n",
+           static_cast<unsigned long long>(m_totalCycles), numFrames,
+           static_cast<unsigned long long>(CyclesPerFrame));
+    Printf("  Self%%  Self/frame   Incl%%  Incl/frame      Calls  Function\n");
+    for (auto& function : sorted) {
+        Printf("%6.2f%% %11.1f %6.2f%% %11.1f %10llu  %s\n",
+               Percent(function.selfCycles, m_totalCycles),
+               numFrames > 0 ? function.selfCycles / numFrames : 0.0,
+               Percent(function.inclusiveCycles, m_totalCycles),
+               numFrames > 0 ? function.inclusiveCycles / numFrames : 0.0,
+               static_cast<unsigned long long>(function.numCalls),
+               FunctionName(function.address, symbolTable).c_str());
+    }
+}
+
+void Profiler::PrintTree(const SymbolTable& symbolTable, double minPercent) const {
+    const auto inclusiveCycles = InclusiveCycles();
+
+    std::vector<std::vector<uint32_t>> children(m_nodes.size());
+    for (uint32_t i = 1; i < m_nodes.size(); ++i)
+        children[m_nodes[i].parent].push_back(i);
+    for (auto& nodes : children) {
+        std::sort(nodes.begin(), nodes.end(), [&](uint32_t a, uint32_t b) {
+            return inclusiveCycles[a] > inclusiveCycles[b];
+        });
+    }
+
+    const double numFrames = static_cast<double>(m_totalCycles) / CyclesPerFrame;
+    Printf("Profile: %llu cycles (%.1f frames of %llu cycles)\n",
+           static_cast<unsigned long long>(m_totalCycles), numFrames,
+           static_cast<unsigned long long>(CyclesPerFrame));
+    Printf("  Incl%%  Incl/frame   Self%%      Calls  Function\n");
+
+    // Depth-first, so that each node is printed under its caller
+    std::vector<uint32_t> pending(children[0].rbegin(), children[0].rend());
+    while (!pending.empty()) {
+        const uint32_t i = pending.back();
+        pending.pop_back();
+        const auto& node = m_nodes[i];
+        if (Percent(inclusiveCycles[i], m_totalCycles) < minPercent)
+            continue;
+
+        Printf("%6.2f%% %11.1f %6.2f%% %10llu  %*s%s\n", Percent(inclusiveCycles[i], m_totalCycles),
+               numFrames > 0 ? inclusiveCycles[i] / numFrames : 0.0,
+               Percent(node.selfCycles, m_totalCycles),
+               static_cast<unsigned long long>(node.numCalls),
+               static_cast<int>(node.depth - 1) * 2, "",
+               FunctionName(node.address, symbolTable).c_str());
+        pending.insert(pending.end(), children[i].rbegin(), children[i].rend());
+    }
+}
+
+bool Profiler::WriteFolded(const fs::path& file, const SymbolTable& symbolTable) const {
+    std::ofstream fout(file);
+    if (!fout)
+        return false;
+
+    // Separators can't appear in names
+    auto FoldedName = [&symbolTable](uint16_t address) {
+        auto name = FunctionName(address, symbolTable);
+        std::replace_if(
+            name.begin(), name.end(), [](char c) { return c == ';' || c == ' '; }, '_');
+        return name;
+    };
+
+    std::vector<std::string> paths(m_nodes.size());
+    paths[0] = "[none]";
+    for (uint32_t i = 1; i < m_nodes.size(); ++i) {
+        const auto& node = m_nodes[i];
+        paths[i] = node.parent == 0 ? FoldedName(node.address)
+                                    : paths[node.parent] + ";" + FoldedName(node.address);
+    }
+
+    for (uint32_t i = 0; i < m_nodes.size(); ++i) {
+        if (m_nodes[i].selfCycles > 0)
+            fout << paths[i] << " " << m_nodes[i].selfCycles << "\n";
+    }
+    return static_cast<bool>(fout);
+}
@@ -0,0 +1,49 @@
+#pragma once
+
+#include "core/Base.h"
+#include <bitset>
+#include <cstdint>
+
+class CpuRegisters;
+class MemoryBus;
+
+// High-level emulation (HLE) of the BIOS routines that most frame time is spent in: drawing vector
+// lists, moving the beam and printing strings. These routines drive the VIA one register write at
+// a time, so rather than interpreting their instructions, they're translated to native code that
+// makes the same memory accesses after the same number of cycles. The VIA then produces the same
+// lines and audio, and registers and RAM end up the same as with full emulation.
+//
+// A routine runs when the PC is at one of its entry points, e.g. after a JSR, until it returns to
+// code that isn't translated, or until maxCycles have elapsed. Either way, it stops at an
+// instruction that full emulation would also have stopped at, and the CPU carries on from there.
+class BiosHle {
+public:
+    enum class Mode { Off, On, Validate };
+
+    struct Stats {
+        uint64_t numCalls{};
+        uint64_t numCycles{};
+        uint64_t numMismatches{}; // Validate mode only
+    };
+
+    // Returns false if the BIOS mapped in memoryBus doesn't match the translated code
+    bool Init(MemoryBus& memoryBus);
+
+    bool IsEntryPoint(uint16_t address) const {
+        return address >= 0xF000 && m_entryPoints[address - 0xF000];
+    }
+
+    // Runs the routine at registers.PC, which must be an entry point, and returns the number of
+    // cycles elapsed
+    cycles_t Execute(CpuRegisters& registers, cycles_t maxCycles);
+
+    // Name of the routine at an entry point, as in the BIOS listing
+    static const char* RoutineName(uint16_t address);
+
+    Stats& GetStats() { return m_stats; }
+
+private:
+    MemoryBus* m_memoryBus{};
+    std::bitset<0x1000> m_entryPoints; // For $F000-$FFFF
+    Stats m_stats;
+};
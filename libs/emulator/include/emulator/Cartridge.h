@@ -1,18 +1,43 @@
 #pragma once
 
 #include "MemoryBus.h"
+#include "emulator/RomFile.h"
 #include <vector>
 
+// Cartridge rom, which may be bank-switched (see RomFile). Reads go straight to the rom through
+// the memory bus's page table, so switching banks only repoints the pages of the banked window,
+// no matter how large the rom is.
 class Cartridge : public IMemoryBusDevice {
 public:
     void Init(MemoryBus& memoryBus);
     void Reset() {}
     bool LoadRom(const char* file);
 
+    // Maps bank (modulo the number of banks) into the banked window. Roms that aren't
+    // bank-switched have a single bank.
+    void SelectBank(size_t bank);
+
+    // Of the loaded rom
+    const RomFile::Header& GetHeader() const { return m_header; }
+    uint64_t GetContentHash() const { return m_contentHash; }
+    const std::vector<uint8_t>& GetData() const { return m_data; }
+    size_t GetNumBanks() const { return m_numBanks; }
+    size_t GetBank() const { return m_bank; }
+    // Bytes of cartridge space that show the selected bank, from its start
+    size_t GetWindowSize() const { return m_windowSize; }
+
 private:
     uint8_t Read(uint16_t address) const override;
     void Write(uint16_t address, uint8_t value) override;
 
+    void MapBank();
+
 private:
+    MemoryBus* m_memoryBus{};
     std::vector<uint8_t> m_data;
+    RomFile::Header m_header;
+    uint64_t m_contentHash{};
+    size_t m_windowSize{}; // Bytes of cartridge space that show the selected bank
+    size_t m_numBanks = 1;
+    size_t m_bank{};
 };
@@ -0,0 +1,62 @@
+#pragma once
+
+#include "emulator/Cartridge.h"
+#include "emulator/MemoryMap.h"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Which instructions of a rom were executed, as a bitmap with a bit set for each byte an
+// instruction started at. Bytes in cartridge space are tracked by their offset in the rom, so that
+// each bank of a bank-switched rom is covered separately, and the rest of memory (RAM and BIOS) by
+// address.
+//
+// While set on the Emulator, the Cpu sets one bit per instruction. Which bytes were executed,
+// including operands, is worked out afterwards from the instructions (see CoverageReport.h).
+// BIOS routines run natively by BiosHle aren't covered.
+class CodeCoverage {
+public:
+    // Sized for the rom loaded in cartridge, which must stay loaded while covering
+    void Init(const Cartridge& cartridge);
+
+    void AddInstruction(uint16_t address) {
+        if (address >= SystemStart) {
+            Set(m_systemStarts, address - SystemStart);
+        } else if (address < m_windowSize) {
+            const size_t offset = m_cartridge->GetBank() * m_windowSize + address;
+            if (offset < m_romSize)
+                Set(m_romStarts, offset);
+        }
+    }
+
+    // Adds other's instructions, which must be of the same rom
+    void Merge(const CodeCoverage& other);
+
+    size_t GetRomSize() const { return m_romSize; }
+    size_t GetWindowSize() const { return m_windowSize; }
+    uint64_t GetContentHash() const { return m_contentHash; }
+
+    bool IsRomOpcodeStart(size_t offset) const { return Test(m_romStarts, offset); }
+
+    // For addresses from SystemStart, i.e. RAM and BIOS
+    bool IsSystemOpcodeStart(uint16_t address) const {
+        return address >= SystemStart && Test(m_systemStarts, address - SystemStart);
+    }
+
+    static constexpr uint16_t SystemStart = MemoryMap::Cartridge.range.second + 1;
+
+private:
+    static void Set(std::vector<uint64_t>& bits, size_t index) {
+        bits[index / 64] |= uint64_t{1} << (index % 64);
+    }
+    static bool Test(const std::vector<uint64_t>& bits, size_t index) {
+        return (bits[index / 64] >> (index % 64)) & 1;
+    }
+
+    const Cartridge* m_cartridge{};
+    size_t m_romSize{};
+    size_t m_windowSize{};
+    uint64_t m_contentHash{};
+    std::vector<uint64_t> m_romStarts;
+    std::vector<uint64_t> m_systemStarts;
+};
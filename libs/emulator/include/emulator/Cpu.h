@@ -3,6 +3,8 @@
 #include "core/Base.h"
 #include "core/Pimpl.h"
 
+class CodeCoverage;
+class HeatMap;
 class MemoryBus;
 
 // Implementation of Motorola 68A09 1.5 MHz 8-Bit Microprocessor
@@ -58,6 +60,12 @@ public:
     };
     uint8_t DP;       // direct page register (msb of zero-page address)
     ConditionCode CC; // condition code register (aka status register)
+
+    friend bool operator==(const CpuRegisters& a, const CpuRegisters& b) {
+        return a.X == b.X && a.Y == b.Y && a.U == b.U && a.S == b.S && a.PC == b.PC && a.D == b.D &&
+               a.DP == b.DP && a.CC.Value == b.CC.Value;
+    }
+    friend bool operator!=(const CpuRegisters& a, const CpuRegisters& b) { return !(a == b); }
 };
 
 class Cpu {
@@ -72,7 +80,15 @@ public:
     cycles_t ExecuteInstruction(bool irqEnabled, bool firqEnabled);
 
     const CpuRegisters& Registers() const;
+    // For code that executes instructions itself, like BiosHle
+    void SetRegisters(const CpuRegisters& registers);
+
+    // Counts executions while set, or stops counting if nullptr
+    void SetHeatMap(HeatMap* heatMap);
+
+    // Covers instructions while set, or stops covering if nullptr
+    void SetCodeCoverage(CodeCoverage* codeCoverage);
 
 private:
-    pimpl::Pimpl<class CpuImpl, 48> m_impl;
+    pimpl::Pimpl<class CpuImpl, 56> m_impl;
 };
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "core/Base.h"
+#include <algorithm>
 
 // A simple value container on which we can assign values, but that value will only be returned
 // after an input number of cycles.
@@ -19,10 +20,10 @@ public:
     }
 
     void Update(cycles_t cycles) {
-        (void)cycles;
-        assert(cycles == 1);
-        if (m_cyclesLeft > 0 && --m_cyclesLeft == 0) {
-            m_value = m_nextValue;
+        if (m_cyclesLeft > 0) {
+            m_cyclesLeft -= std::min(cycles, m_cyclesLeft);
+            if (m_cyclesLeft == 0)
+                m_value = m_nextValue;
         }
     }
 
@@ -1,10 +1,14 @@
 #pragma once
 
 #include "core/Base.h"
+#include "emulator/BiosHle.h"
 #include "emulator/BiosRom.h"
 #include "emulator/Cartridge.h"
+#include "emulator/CodeCoverage.h"
 #include "emulator/Cpu.h"
 #include "emulator/DevMemoryDevice.h"
+#include "emulator/HeatMap.h"
+#include "emulator/IdleLoopSkipper.h"
 #include "emulator/IllegalMemoryDevice.h"
 #include "emulator/Ram.h"
 #include "emulator/UnmappedMemoryDevice.h"
@@ -13,20 +17,54 @@
 class Emulator {
 public:
     void Init(const char* biosRomFile);
+    // Fills RAM with random values, as on hardware
     void Reset();
+    // Fills RAM with values generated from ramSeed, for reproducible runs
+    void Reset(unsigned int ramSeed);
     bool LoadBios(const char* file);
     bool LoadRom(const char* file);
 
+    // Runs BIOS routines natively when the CPU calls them, see BiosHle. Returns false if the BIOS
+    // isn't one BiosHle supports, in which case everything is still emulated.
+    bool SetBiosHleMode(BiosHle::Mode mode);
+    BiosHle& GetBiosHle() { return m_biosHle; }
+
+    // Skips the iterations of loops that only poll the VIA, see IdleLoopSkipper, and lets the VIA
+    // advance its timers and screen in bulk while the screen is idle
+    void SetIdleLoopSkipping(bool enabled) {
+        m_idleLoopSkipping = enabled;
+        m_via.SetIdleUpdates(enabled);
+    }
+    IdleLoopSkipper& GetIdleLoopSkipper() { return m_idleLoopSkipper; }
+
+    // Counts executions, reads and writes per address into heatMap while set, see HeatMap
+    void SetHeatMap(HeatMap* heatMap) {
+        m_cpu.SetHeatMap(heatMap);
+        m_memoryBus.SetHeatMap(heatMap);
+    }
+
+    // Records which instructions execute into codeCoverage while set, see CodeCoverage. It must
+    // have been initialized for the loaded rom.
+    void SetCodeCoverage(CodeCoverage* codeCoverage) { m_cpu.SetCodeCoverage(codeCoverage); }
+
+    // If maxCycles isn't 0, this may run for up to maxCycles instead of executing one instruction:
+    // a BIOS routine called by the CPU if BIOS HLE is on, or an idle loop if idle loop skipping is
+    // on
     cycles_t ExecuteInstruction(const Input& input, RenderContext& renderContext,
-                                AudioContext& audioContext);
+                                AudioContext& audioContext, cycles_t maxCycles = 0);
 
     void FrameUpdate(double frameTime);
 
     MemoryBus& GetMemoryBus() { return m_memoryBus; }
     Cpu& GetCpu() { return m_cpu; }
     Ram& GetRam() { return m_ram; }
+    Cartridge& GetCartridge() { return m_cartridge; }
 
 private:
+    cycles_t ExecuteBiosHle(cycles_t maxCycles);
+    cycles_t ValidateBiosHle(const Input& input, RenderContext& renderContext,
+                             AudioContext& audioContext, cycles_t maxCycles);
+
     MemoryBus m_memoryBus;
     Cpu m_cpu;
     Via m_via;
@@ -37,4 +75,10 @@ private:
     DevMemoryDevice m_dev;
 
     Cartridge m_cartridge;
+
+    BiosHle m_biosHle;
+    BiosHle::Mode m_biosHleMode = BiosHle::Mode::Off;
+
+    IdleLoopSkipper m_idleLoopSkipper;
+    bool m_idleLoopSkipping = false;
 };
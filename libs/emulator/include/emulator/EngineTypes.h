@@ -3,7 +3,7 @@
 #include "core/Base.h"
 #include "core/BitOps.h"
 #include "core/FileSystem.h"
-#include "core/Line.h"
+#include "core/LineStrips.h"
 #include <array>
 #include <functional>
 #include <variant>
@@ -45,7 +45,8 @@ private:
 };
 
 struct RenderContext {
-    std::vector<Line> lines; // Lines to draw this frame
+    LineStrips lines;       // Lines to draw this frame
+    bool skipFrame = false; // Set by engine when this frame won't be presented (fast-forward)
 };
 
 struct AudioContext {
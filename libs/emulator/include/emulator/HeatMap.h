@@ -0,0 +1,47 @@
+#pragma once
+
+#include "core/FileSystem.h"
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Counts of how many times each address was executed, read and written, to find hot loops and data
+// in guest code. The Cpu counts an execution at the start of each instruction, and the MemoryBus
+// counts reads and writes, including those made by code that runs natively like BiosHle.
+// Instruction fetches aren't counted as reads.
+//
+// Counting is on while a HeatMap is set on the Emulator, and only costs an increment in a flat
+// array per access.
+class HeatMap {
+public:
+    enum class Kind { Execute, Read, Write, Count };
+    using Counts = std::array<uint32_t, 0x10000>;
+
+    struct Entry {
+        uint16_t address{};
+        uint32_t count{};
+    };
+
+    HeatMap();
+
+    static const char* KindName(Kind kind);
+
+    void Clear();
+
+    void AddExecute(uint16_t address) { ++m_counts[static_cast<size_t>(Kind::Execute)][address]; }
+    void AddRead(uint16_t address) { ++m_counts[static_cast<size_t>(Kind::Read)][address]; }
+    void AddWrite(uint16_t address) { ++m_counts[static_cast<size_t>(Kind::Write)][address]; }
+
+    const Counts& GetCounts(Kind kind) const { return m_counts[static_cast<size_t>(kind)]; }
+    uint64_t Total(Kind kind) const;
+
+    // Addresses with the highest counts, highest first, leaving out those never accessed
+    std::vector<Entry> Hottest(Kind kind, size_t maxEntries) const;
+
+    // Writes the counts for each address in order, as 64K little-endian uint32_t
+    bool Save(Kind kind, const fs::path& file) const;
+
+private:
+    std::vector<Counts> m_counts; // By Kind, on the heap as they take 768K
+};
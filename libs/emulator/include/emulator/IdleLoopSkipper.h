@@ -0,0 +1,57 @@
+#pragma once
+
+#include "core/Base.h"
+#include "emulator/Cpu.h"
+#include <cstdint>
+
+class MemoryBus;
+class Via;
+
+// Detects loops that spin polling the VIA until an interrupt flag is set, like the BIOS's
+// Wait_Recal waiting for Timer 2 to expire, so that their iterations can be skipped instead of
+// emulated.
+//
+// A loop qualifies if it's a short run of instructions that only read the VIA's interrupt flag and
+// enable registers, RAM or rom, and only change registers, ending in a branch back to its start.
+// Nothing but the VIA changes while it runs, so once an iteration ends with the registers and
+// interrupt flags it started with, every following iteration does the same until the interrupt
+// flags change. Skipping those iterations only leaves their cycles for the VIA to run.
+class IdleLoopSkipper {
+public:
+    struct Stats {
+        uint64_t numSkips{};
+        uint64_t numCyclesSkipped{};
+    };
+
+    void Init(MemoryBus& memoryBus) { m_memoryBus = &memoryBus; }
+
+    // Call before each instruction. Returns the cycles of whole iterations that can be skipped, up
+    // to maxCycles and before the VIA's interrupt flags change, or 0 to execute the instruction.
+    // Skipping leaves the registers as they are.
+    cycles_t CyclesToSkip(const CpuRegisters& registers, const Via& via, cycles_t maxCycles);
+
+    // Call with the cycles of each instruction executed
+    void AddCycles(cycles_t cycles) { m_cyclesSinceLoopStart += cycles; }
+
+    Stats& GetStats() { return m_stats; }
+
+private:
+    struct Loop {
+        uint16_t start{};
+        uint16_t branch{}; // Address of the branch back to start
+        uint8_t dp{};      // For direct addressing
+        bool idle = false;
+    };
+
+    Loop Analyze(uint16_t start, uint8_t dp) const;
+    void StartIteration(const CpuRegisters& registers, uint8_t interruptFlags);
+
+    MemoryBus* m_memoryBus{};
+    Loop m_loop;
+    bool m_inLoop = false; // PC has stayed within m_loop since it was last at its start
+    uint16_t m_lastPC{};
+    CpuRegisters m_startRegisters{};
+    uint8_t m_startInterruptFlags{};
+    cycles_t m_cyclesSinceLoopStart{};
+    Stats m_stats;
+};
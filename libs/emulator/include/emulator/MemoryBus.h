@@ -2,7 +2,9 @@
 
 #include "core/Base.h"
 #include "core/ErrorHandler.h"
+#include "emulator/HeatMap.h"
 #include <algorithm>
+#include <array>
 #include <functional>
 #include <vector>
 
@@ -27,6 +29,20 @@ public:
                   });
     }
 
+    // Reads in range go straight to data instead of to the device connected there, which saves
+    // finding and calling the device for memory that's only ever read, like roms. Passing nullptr
+    // sends reads back to the device. Writes always go to the device, which must not need syncing.
+    // The range must start and end on page boundaries, and remapping it only updates one pointer
+    // per page.
+    void MapReadOnlyMemory(MemoryRange range, const uint8_t* data) {
+        ASSERT((range.first & PageMask) == 0 && (range.second & PageMask) == PageMask);
+        for (size_t page = range.first >> PageShift; page <= (range.second >> PageShift); ++page) {
+            m_readPages[page] = data;
+            if (data)
+                data += PageSize;
+        }
+    }
+
     //@TODO: Move this callback stuff out of here, perhaps in some DebuggerMemoryBus class.
     using OnReadCallback = std::function<void(uint16_t, uint8_t)>;
     using OnWriteCallback = std::function<void(uint16_t, uint8_t)>;
@@ -35,11 +51,25 @@ public:
         m_onWriteCallback = onWriteCallback;
     }
 
+    // Counts reads and writes while set, or stops counting if nullptr
+    void SetHeatMap(HeatMap* heatMap) { m_heatMap = heatMap; }
+
     uint8_t Read(uint16_t address) const {
-        auto& deviceInfo = FindDeviceInfo(address);
-        SyncDevice(deviceInfo);
+        if (m_heatMap)
+            m_heatMap->AddRead(address);
+        return Fetch(address);
+    }
 
-        uint8_t value = deviceInfo.device->Read(address);
+    // Reads an instruction byte: same as Read, but not counted as a read in the heat map
+    uint8_t Fetch(uint16_t address) const {
+        uint8_t value;
+        if (const uint8_t* page = m_readPages[address >> PageShift]) {
+            value = page[address & PageMask];
+        } else {
+            auto& deviceInfo = FindDeviceInfo(address);
+            SyncDevice(deviceInfo);
+            value = deviceInfo.device->Read(address);
+        }
 
         if (m_onReadCallback)
             m_onReadCallback(address, value);
@@ -48,6 +78,8 @@ public:
     }
 
     void Write(uint16_t address, uint8_t value) {
+        if (m_heatMap)
+            m_heatMap->AddWrite(address);
         if (m_onWriteCallback)
             m_onWriteCallback(address, value);
 
@@ -58,6 +90,8 @@ public:
     }
 
     uint8_t ReadRaw(uint16_t address) const {
+        if (const uint8_t* page = m_readPages[address >> PageShift])
+            return page[address & PageMask];
         auto& deviceInfo = FindDeviceInfo(address);
         return deviceInfo.device->Read(address);
     }
@@ -83,6 +117,11 @@ public:
         }
     }
 
+    // 2K, the granularity of the memory map
+    static constexpr size_t PageShift = 11;
+    static constexpr size_t PageSize = 1 << PageShift;
+    static constexpr size_t PageMask = PageSize - 1;
+
 private:
     struct DeviceInfo {
         IMemoryBusDevice* device = nullptr;
@@ -122,6 +161,10 @@ private:
     // Sorted by first address in range
     std::vector<DeviceInfo> m_devices;
 
+    // Start of each page mapped with MapReadOnlyMemory, or nullptr
+    std::array<const uint8_t*, 0x10000 / PageSize> m_readPages{};
+
     OnReadCallback m_onReadCallback;
     OnWriteCallback m_onWriteCallback;
+    HeatMap* m_heatMap = nullptr;
 };
@@ -9,6 +9,8 @@ class Psg {
 public:
     Psg();
     ~Psg();
+    Psg(const Psg&);
+    Psg& operator=(const Psg&);
 
     void Init();
 
@@ -28,5 +30,5 @@ public:
     void FrameUpdate(double frameTime);
 
 private:
-    pimpl::Pimpl<class PsgImpl, 256> m_impl;
+    pimpl::Pimpl<class PsgImpl, 272> m_impl;
 };
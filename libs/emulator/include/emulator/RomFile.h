@@ -0,0 +1,37 @@
+#pragma once
+
+#include "core/FileSystem.h"
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace RomFile {
+    // Header at the start of a cartridge rom: a copyright string that should start with "g GCE",
+    // the address of the title music, then the title as lines of height, width, relative y and x,
+    // and text, ending with a 0 byte.
+    struct Header {
+        bool valid = false;        // Title ends within a reasonable number of lines
+        bool hasCopyright = false; // Copyright string starts with "g GCE"
+        uint16_t musicAddress{};
+        std::string title; // Title lines separated by spaces
+    };
+
+    // Roms larger than the 48K of cartridge space are bank-switched: the first 32K of cartridge
+    // space shows one 32K bank of the image at a time, selected by the VIA's PB6 line. PB6 is
+    // pulled high while it's an input, as it is after reset, so these roms boot from bank 1.
+    constexpr size_t BankSize = 32 * 1024;
+    constexpr size_t BootBank = 1;
+
+    bool IsBankSwitched(size_t romSize);
+
+    // Reads the whole file in one go. Returns nothing if it can't be read.
+    std::optional<std::vector<uint8_t>> Read(const fs::path& file);
+
+    // Parses the header from the start of a rom image, or of its boot bank if it's bank-switched,
+    // never reading past its end
+    Header ParseHeader(const std::vector<uint8_t>& data);
+
+    // Hash of the rom image's contents, which identifies it regardless of its file name
+    uint64_t ContentHash(const std::vector<uint8_t>& data);
+} // namespace RomFile
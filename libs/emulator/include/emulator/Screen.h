@@ -10,7 +10,14 @@ struct RenderContext;
 class Screen {
 public:
     void Init();
+    void Reset();
     void Update(cycles_t cycles, RenderContext& renderContext);
+
+    // Whether the beam is off and staying where it is, and anything it draws there was already
+    // drawn, so that updating only counts down the integrator delays. Updating an idle screen with
+    // UpdateIdle is the same as calling Update once per cycle.
+    bool IsIdle(const RenderContext& renderContext) const;
+    void UpdateIdle(cycles_t cycles);
     void FrameUpdate(double frameTime);
 
     void ZeroBeam();
@@ -22,12 +29,25 @@ public:
     void SetBrightness(uint8_t value) { m_brightness = value; }
 
 private:
+    //@TODO: make these conditionally const for "shipping" build
+    struct Tweakables {
+        bool ImGuiEnabled = false;
+        int32_t RampUpDelay = 5;
+        int32_t RampDownDelay = 10;
+        int32_t VelocityXDelay = 6;
+        // LineDrawScale is required because introducing ramp and velX delays means we now create
+        // lines that go outside the 256x256 grid. So we scale down the line drawing values a little
+        // to make it fit within the grid again.
+        float LineDrawScale = 0.85f;
+        // A new line is merged into the one before it if every point merged away since the
+        // strip's last kept point stays within this distance of the merged line, so that nearly
+        // straight runs are output as one line.
+        float LineMergeTolerance = 0.05f;
+    } m_tweakables;
+
     bool m_integratorsEnabled{};
     Vector2 m_pos;
 
-    bool m_lastDrawingEnabled{};
-    Vector2 m_lastDir;
-
     DelayedValueStore<float> m_velocityX;
     DelayedValueStore<float> m_velocityY;
     float m_xyOffset = 0.f;
@@ -35,4 +55,6 @@ private:
     bool m_blank = false;
     enum class RampPhase { RampOff, RampUp, RampOn, RampDown } m_rampPhase = RampPhase::RampOff;
     int32_t m_rampDelay = 0;
+    // Bound on how far the points merged away into the last strip's last line are from it
+    float m_mergeError = 0.f;
 };
@@ -18,6 +18,9 @@ public:
         return true;
     }
     void Update(cycles_t cycles);
+    // While shifting, CB2 and the interrupt flag change. Otherwise Update does nothing.
+    bool IsShifting() const { return m_shiftCyclesLeft > 0; }
+    cycles_t CyclesUntilDone() const { return m_shiftCyclesLeft; }
 
     void SetInterruptFlag(bool enabled) { m_interruptFlag = enabled; }
     bool InterruptFlag() const { return m_interruptFlag; }
@@ -1,6 +1,8 @@
 #pragma once
 
 #include "core/Base.h"
+#include "core/HostProfiler.h"
+#include <algorithm>
 
 enum class TimerMode { FreeRunning, OneShot, PulseCounting };
 
@@ -51,6 +53,9 @@ public:
         }
     }
 
+    // Cycles of Update until the counter expires next
+    cycles_t CyclesUntilExpired() const { return std::max<cycles_t>(m_counter, 1); }
+
     void SetInterruptFlag(bool enabled) { m_interruptFlag = enabled; }
     bool InterruptFlag() const { return m_interruptFlag; }
 
@@ -97,10 +102,16 @@ public:
         bool expired = cycles >= m_counter;
         m_counter -= checked_static_cast<uint16_t>(cycles);
         if (expired) {
+            // Games wait for Timer2 to pace their frames
+            if (!m_interruptFlag)
+                HOST_TRACE_INSTANT("Timer2 expired");
             m_interruptFlag = true;
         }
     }
 
+    // Cycles of Update until the counter expires next
+    cycles_t CyclesUntilExpired() const { return std::max<cycles_t>(m_counter, 1); }
+
     void SetInterruptFlag(bool enabled) { m_interruptFlag = enabled; }
     bool InterruptFlag() const { return m_interruptFlag; }
 
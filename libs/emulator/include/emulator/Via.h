@@ -8,6 +8,7 @@
 #include "core/Line.h"
 #include "core/MathUtil.h"
 #include "emulator/Timers.h"
+#include <functional>
 
 class Input;
 struct RenderContext;
@@ -27,18 +28,37 @@ public:
         m_syncContext = {&input, &renderContext, &audioContext};
     }
 
+    // Called with the level of PB6 whenever it changes, and on Reset. PB6 isn't used by the
+    // Vectrex itself, but goes to the cartridge port, where bank-switched roms use it to select a
+    // bank.
+    using PB6Callback = std::function<void(bool high)>;
+    void SetPB6Callback(PB6Callback callback) { m_pb6Callback = std::move(callback); }
+
     void FrameUpdate(double frameTime);
 
+    // While enabled, cycles where the screen is idle and the timers only count down are run in
+    // bulk rather than one at a time, with the same results
+    void SetIdleUpdates(bool enabled) { m_idleUpdates = enabled; }
+
     bool IrqEnabled() const;
     bool FirqEnabled() const;
 
+    // Value of the interrupt flag register, as read by the CPU
+    uint8_t GetInterruptFlagValue() const;
+    // Cycles until the interrupt flags or FIRQ line may change without the CPU accessing the VIA.
+    // Until then, code that only polls the interrupt flags keeps reading the same value.
+    cycles_t CyclesUntilInterruptFlagsChange() const;
+
 private:
     uint8_t Read(uint16_t address) const override;
     void Write(uint16_t address, uint8_t value) override;
     void Sync(cycles_t cycles) override;
     void DoSync(cycles_t cycles, const Input& input, RenderContext& renderContext,
                 AudioContext& audioContext);
-    uint8_t GetInterruptFlagValue() const;
+    cycles_t IdleCycles(cycles_t maxCycles, const RenderContext& renderContext) const;
+    void UpdatePB6();
+
+    bool m_idleUpdates = false;
 
     struct SyncContext {
         const Input* input{};
@@ -67,4 +87,6 @@ private:
     float m_elapsedAudioCycles{};
     MathUtil::AverageValue m_directAudioSamples;
     MathUtil::AverageValue m_psgAudioSamples;
+    bool m_pb6High{};
+    PB6Callback m_pb6Callback;
 };
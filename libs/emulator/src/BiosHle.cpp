@@ -0,0 +1,1490 @@
+#include "emulator/BiosHle.h"
+#include "core/Hash.h"
+#include "emulator/Cpu.h"
+#include "emulator/CpuHelpers.h"
+#include "emulator/MemoryBus.h"
+#include <algorithm>
+#include <array>
+#include <iterator>
+
+namespace {
+    // BIOS code that's translated below, inclusive. Only these bytes need to match.
+    const std::array<MemoryRange, 6> TranslatedRanges = {{
+        {0xF2F2, 0xF349}, // Moveto_*
+        {0xF34F, 0xF390}, // Reset0Ref, Print_List*
+        {0xF3AD, 0xF494}, // Mov_Draw_VL*, Draw_VL*, Draw_Pat_VL*
+        {0xF495, 0xF510}, // Print_Str
+        {0xF56D, 0xF57D}, // Delay_*
+        {0xF584, 0xF592}, // Abs_*
+    }};
+
+    // Hash::Fnv1a of TranslatedRanges in order, the same for all known BIOS revisions
+    const uint64_t TranslatedRangesHash = 0xdd2a325b30adc1c8ull;
+
+    struct EntryPoint {
+        uint16_t address;
+        const char* name;
+    };
+
+    // Sorted by address
+    const EntryPoint EntryPoints[] = {
+        {0xF2F2, "Moveto_x_7F"},    {0xF2FC, "Moveto_d_7F"},    {0xF308, "Moveto_ix_FF"},
+        {0xF30C, "Moveto_ix_7F"},   {0xF30E, "Moveto_ix_b"},    {0xF310, "Moveto_ix"},
+        {0xF312, "Moveto_d"},       {0xF34F, "Check0Ref"},      {0xF354, "Reset0Ref"},
+        {0xF35B, "Reset_Pen"},      {0xF36B, "Reset0Int"},      {0xF373, "Print_Str_hwyx"},
+        {0xF378, "Print_Str_yx"},   {0xF37A, "Print_Str_d"},    {0xF385, "Print_List_hw"},
+        {0xF38A, "Print_List"},     {0xF38C, "Print_List_chk"}, {0xF3AD, "Mov_Draw_VLc_a"},
+        {0xF3B1, "Mov_Draw_VL_b"},  {0xF3B5, "Mov_Draw_VLcs"},  {0xF3B7, "Mov_Draw_VL_ab"},
+        {0xF3B9, "Mov_Draw_VL_a"},  {0xF3BC, "Mov_Draw_VL"},    {0xF3BE, "Mov_Draw_VL_d"},
+        {0xF3CE, "Draw_VLc"},       {0xF3D2, "Draw_VL_b"},      {0xF3D6, "Draw_VLcs"},
+        {0xF3D8, "Draw_VL_ab"},     {0xF3DA, "Draw_VL_a"},      {0xF3DD, "Draw_VL"},
+        {0xF3DF, "Draw_Line_d"},    {0xF404, "Draw_VLp_FF"},    {0xF408, "Draw_VLp_7F"},
+        {0xF40C, "Draw_VLp_scale"}, {0xF40E, "Draw_VLp_b"},     {0xF410, "Draw_VLp"},
+        {0xF434, "Draw_Pat_VL_a"},  {0xF437, "Draw_Pat_VL"},    {0xF439, "Draw_Pat_VL_d"},
+        {0xF46E, "Draw_VL_mode"},   {0xF495, "Print_Str"},      {0xF56D, "Delay_3"},
+        {0xF571, "Delay_2"},        {0xF575, "Delay_1"},        {0xF579, "Delay_0"},
+        {0xF57A, "Delay_b"},        {0xF57D, "Delay_RTS"},      {0xF584, "Abs_a_b"},
+        {0xF58B, "Abs_b"},
+    };
+
+    // Executes the translated BIOS code. Each case is one instruction, and does what CpuImpl does
+    // for it: the same memory accesses in the same order, after adding the instruction's cycles
+    // so that synced devices see them at the same time, and the same condition codes.
+    class NativeBios {
+    public:
+        NativeBios(MemoryBus& memoryBus, CpuRegisters& registers)
+            : m_memoryBus(memoryBus)
+            , r(registers) {}
+
+        cycles_t Run(cycles_t maxCycles) {
+            uint16_t pc = r.PC;
+            while (m_cycles < maxCycles) {
+                switch (pc) {
+                case 0xF2F2: // Moveto_x_7F: LDB #$7F
+                    Cycles(2);
+                    r.B = Ld8(0x7F);
+                    pc = 0xF2F4;
+                    break;
+                case 0xF2F4: // STB <$04
+                    Cycles(4);
+                    St8(Direct(0x04), r.B);
+                    pc = 0xF2F6;
+                    break;
+                case 0xF2F6: // LDA ,X
+                    Cycles(4);
+                    r.A = Ld8(Read8(r.X));
+                    pc = 0xF2F8;
+                    break;
+                case 0xF2F8: // LDB 2,X
+                    Cycles(5);
+                    r.B = Ld8(Read8(r.X + 2));
+                    pc = 0xF2FA;
+                    break;
+                case 0xF2FA: // BRA $F312
+                    Cycles(3);
+                    pc = 0xF312;
+                    break;
+                case 0xF2FC: // Moveto_d_7F: STA <$01
+                    Cycles(4);
+                    St8(Direct(0x01), r.A);
+                    pc = 0xF2FE;
+                    break;
+                case 0xF2FE: // PSHS A,B
+                    Cycles(7);
+                    Push8(r.S, r.B);
+                    Push8(r.S, r.A);
+                    pc = 0xF300;
+                    break;
+                case 0xF300: // LDA #$7F
+                    Cycles(2);
+                    r.A = Ld8(0x7F);
+                    pc = 0xF302;
+                    break;
+                case 0xF302: // STA <$04
+                    Cycles(4);
+                    St8(Direct(0x04), r.A);
+                    pc = 0xF304;
+                    break;
+                case 0xF304: // CLR <$00
+                    Cycles(6);
+                    Clr(Direct(0x00));
+                    pc = 0xF306;
+                    break;
+                case 0xF306: // BRA $F318
+                    Cycles(3);
+                    pc = 0xF318;
+                    break;
+                case 0xF308: // Moveto_ix_FF: LDB #$FF
+                    Cycles(2);
+                    r.B = Ld8(0xFF);
+                    pc = 0xF30A;
+                    break;
+                case 0xF30A: // BRA $F30E
+                    Cycles(3);
+                    pc = 0xF30E;
+                    break;
+                case 0xF30C: // Moveto_ix_7F: LDB #$7F
+                    Cycles(2);
+                    r.B = Ld8(0x7F);
+                    pc = 0xF30E;
+                    break;
+                case 0xF30E: // Moveto_ix_b: STB <$04
+                    Cycles(4);
+                    St8(Direct(0x04), r.B);
+                    pc = 0xF310;
+                    break;
+                case 0xF310: // Moveto_ix: LDD ,X++
+                    Cycles(8);
+                    r.D = Ld16(Read16(PostInc2(r.X)));
+                    pc = 0xF312;
+                    break;
+                case 0xF312: // Moveto_d: STA <$01
+                    Cycles(4);
+                    St8(Direct(0x01), r.A);
+                    pc = 0xF314;
+                    break;
+                case 0xF314: // CLR <$00
+                    Cycles(6);
+                    Clr(Direct(0x00));
+                    pc = 0xF316;
+                    break;
+                case 0xF316: // PSHS A,B
+                    Cycles(7);
+                    Push8(r.S, r.B);
+                    Push8(r.S, r.A);
+                    pc = 0xF318;
+                    break;
+                case 0xF318: // LDA #$CE
+                    Cycles(2);
+                    r.A = Ld8(0xCE);
+                    pc = 0xF31A;
+                    break;
+                case 0xF31A: // STA <$0C
+                    Cycles(4);
+                    St8(Direct(0x0C), r.A);
+                    pc = 0xF31C;
+                    break;
+                case 0xF31C: // CLR <$0A
+                    Cycles(6);
+                    Clr(Direct(0x0A));
+                    pc = 0xF31E;
+                    break;
+                case 0xF31E: // INC <$00
+                    Cycles(6);
+                    Inc(Direct(0x00));
+                    pc = 0xF320;
+                    break;
+                case 0xF320: // STB <$01
+                    Cycles(4);
+                    St8(Direct(0x01), r.B);
+                    pc = 0xF322;
+                    break;
+                case 0xF322: // CLR <$05
+                    Cycles(6);
+                    Clr(Direct(0x05));
+                    pc = 0xF324;
+                    break;
+                case 0xF324: // PULS A,B
+                    Cycles(7);
+                    r.A = Pop8(r.S);
+                    r.B = Pop8(r.S);
+                    pc = 0xF326;
+                    break;
+                case 0xF326: // JSR $F584
+                    Cycles(8);
+                    Push16(r.S, 0xF329);
+                    pc = 0xF584;
+                    break;
+                case 0xF329: // STB -1,S
+                    Cycles(5);
+                    St8(r.S - 1, r.B);
+                    pc = 0xF32B;
+                    break;
+                case 0xF32B: // ORA -1,S
+                    Cycles(5);
+                    r.A = Or8(r.A, Read8(r.S - 1));
+                    pc = 0xF32D;
+                    break;
+                case 0xF32D: // LDB #$40
+                    Cycles(2);
+                    r.B = Ld8(0x40);
+                    pc = 0xF32F;
+                    break;
+                case 0xF32F: // CMPA #$40
+                    Cycles(2);
+                    Sub8(r.A, 0x40);
+                    pc = 0xF331;
+                    break;
+                case 0xF331: // BLS $F345
+                    Cycles(3);
+                    pc = (r.CC.Carry || r.CC.Zero) ? 0xF345 : 0xF333;
+                    break;
+                case 0xF333: // CMPA #$64
+                    Cycles(2);
+                    Sub8(r.A, 0x64);
+                    pc = 0xF335;
+                    break;
+                case 0xF335: // BLS $F33B
+                    Cycles(3);
+                    pc = (r.CC.Carry || r.CC.Zero) ? 0xF33B : 0xF337;
+                    break;
+                case 0xF337: // LDA #$08
+                    Cycles(2);
+                    r.A = Ld8(0x08);
+                    pc = 0xF339;
+                    break;
+                case 0xF339: // BRA $F33D
+                    Cycles(3);
+                    pc = 0xF33D;
+                    break;
+                case 0xF33B: // LDA #$04
+                    Cycles(2);
+                    r.A = Ld8(0x04);
+                    pc = 0xF33D;
+                    break;
+                case 0xF33D: // BITB <$0D
+                    Cycles(4);
+                    Tst8(r.B & Read8(Direct(0x0D)));
+                    pc = 0xF33F;
+                    break;
+                case 0xF33F: // BEQ $F33D
+                    Cycles(3);
+                    pc = (r.CC.Zero) ? 0xF33D : 0xF341;
+                    break;
+                case 0xF341: // DECA
+                    Cycles(2);
+                    r.A = Dec8(r.A);
+                    pc = 0xF342;
+                    break;
+                case 0xF342: // BNE $F341
+                    Cycles(3);
+                    pc = (!r.CC.Zero) ? 0xF341 : 0xF344;
+                    break;
+                case 0xF344: // RTS
+                    Cycles(5);
+                    pc = Pop16(r.S);
+                    break;
+                case 0xF345: // BITB <$0D
+                    Cycles(4);
+                    Tst8(r.B & Read8(Direct(0x0D)));
+                    pc = 0xF347;
+                    break;
+                case 0xF347: // BEQ $F345
+                    Cycles(3);
+                    pc = (r.CC.Zero) ? 0xF345 : 0xF349;
+                    break;
+                case 0xF349: // RTS
+                    Cycles(5);
+                    pc = Pop16(r.S);
+                    break;
+                case 0xF34F: // Check0Ref: LDA $C824
+                    Cycles(5);
+                    r.A = Ld8(Read8(0xC824));
+                    pc = 0xF352;
+                    break;
+                case 0xF352: // BEQ $F36A
+                    Cycles(3);
+                    pc = (r.CC.Zero) ? 0xF36A : 0xF354;
+                    break;
+                case 0xF354: // Reset0Ref: LDD #$00CC
+                    Cycles(3);
+                    r.D = Ld16(0x00CC);
+                    pc = 0xF357;
+                    break;
+                case 0xF357: // STB <$0C
+                    Cycles(4);
+                    St8(Direct(0x0C), r.B);
+                    pc = 0xF359;
+                    break;
+                case 0xF359: // STA <$0A
+                    Cycles(4);
+                    St8(Direct(0x0A), r.A);
+                    pc = 0xF35B;
+                    break;
+                case 0xF35B: // Reset_Pen: LDD #$0302
+                    Cycles(3);
+                    r.D = Ld16(0x0302);
+                    pc = 0xF35E;
+                    break;
+                case 0xF35E: // CLR <$01
+                    Cycles(6);
+                    Clr(Direct(0x01));
+                    pc = 0xF360;
+                    break;
+                case 0xF360: // STA <$00
+                    Cycles(4);
+                    St8(Direct(0x00), r.A);
+                    pc = 0xF362;
+                    break;
+                case 0xF362: // STB <$00
+                    Cycles(4);
+                    St8(Direct(0x00), r.B);
+                    pc = 0xF364;
+                    break;
+                case 0xF364: // STB <$00
+                    Cycles(4);
+                    St8(Direct(0x00), r.B);
+                    pc = 0xF366;
+                    break;
+                case 0xF366: // LDB #$01
+                    Cycles(2);
+                    r.B = Ld8(0x01);
+                    pc = 0xF368;
+                    break;
+                case 0xF368: // STB <$00
+                    Cycles(4);
+                    St8(Direct(0x00), r.B);
+                    pc = 0xF36A;
+                    break;
+                case 0xF36A: // RTS
+                    Cycles(5);
+                    pc = Pop16(r.S);
+                    break;
+                case 0xF36B: // Reset0Int: LDD #$00CC
+                    Cycles(3);
+                    r.D = Ld16(0x00CC);
+                    pc = 0xF36E;
+                    break;
+                case 0xF36E: // STB <$0C
+                    Cycles(4);
+                    St8(Direct(0x0C), r.B);
+                    pc = 0xF370;
+                    break;
+                case 0xF370: // STA <$0A
+                    Cycles(4);
+                    St8(Direct(0x0A), r.A);
+                    pc = 0xF372;
+                    break;
+                case 0xF372: // RTS
+                    Cycles(5);
+                    pc = Pop16(r.S);
+                    break;
+                case 0xF373: // Print_Str_hwyx: LDD ,U++
+                    Cycles(8);
+                    r.D = Ld16(Read16(PostInc2(r.U)));
+                    pc = 0xF375;
+                    break;
+                case 0xF375: // STD $C82A
+                    Cycles(6);
+                    St16(0xC82A, r.D);
+                    pc = 0xF378;
+                    break;
+                case 0xF378: // Print_Str_yx: LDD ,U++
+                    Cycles(8);
+                    r.D = Ld16(Read16(PostInc2(r.U)));
+                    pc = 0xF37A;
+                    break;
+                case 0xF37A: // Print_Str_d: JSR $F2FC
+                    Cycles(8);
+                    Push16(r.S, 0xF37D);
+                    pc = 0xF2FC;
+                    break;
+                case 0xF37D: // JSR $F575
+                    Cycles(8);
+                    Push16(r.S, 0xF380);
+                    pc = 0xF575;
+                    break;
+                case 0xF380: // JMP $F495
+                    Cycles(4);
+                    pc = 0xF495;
+                    break;
+                case 0xF383: // BSR $F373
+                    Cycles(7);
+                    Push16(r.S, 0xF385);
+                    pc = 0xF373;
+                    break;
+                case 0xF385: // Print_List_hw: LDA ,U
+                    Cycles(4);
+                    r.A = Ld8(Read8(r.U));
+                    pc = 0xF387;
+                    break;
+                case 0xF387: // BNE $F383
+                    Cycles(3);
+                    pc = (!r.CC.Zero) ? 0xF383 : 0xF389;
+                    break;
+                case 0xF389: // RTS
+                    Cycles(5);
+                    pc = Pop16(r.S);
+                    break;
+                case 0xF38A: // Print_List: BSR $F378
+                    Cycles(7);
+                    Push16(r.S, 0xF38C);
+                    pc = 0xF378;
+                    break;
+                case 0xF38C: // Print_List_chk: LDA ,U
+                    Cycles(4);
+                    r.A = Ld8(Read8(r.U));
+                    pc = 0xF38E;
+                    break;
+                case 0xF38E: // BNE $F38A
+                    Cycles(3);
+                    pc = (!r.CC.Zero) ? 0xF38A : 0xF390;
+                    break;
+                case 0xF3AD: // Mov_Draw_VLc_a: LDA ,X+
+                    Cycles(6);
+                    r.A = Ld8(Read8(r.X++));
+                    pc = 0xF3AF;
+                    break;
+                case 0xF3AF: // BRA $F3B9
+                    Cycles(3);
+                    pc = 0xF3B9;
+                    break;
+                case 0xF3B1: // Mov_Draw_VL_b: STB <$04
+                    Cycles(4);
+                    St8(Direct(0x04), r.B);
+                    pc = 0xF3B3;
+                    break;
+                case 0xF3B3: // BRA $F3BC
+                    Cycles(3);
+                    pc = 0xF3BC;
+                    break;
+                case 0xF3B5: // Mov_Draw_VLcs: LDD ,X++
+                    Cycles(8);
+                    r.D = Ld16(Read16(PostInc2(r.X)));
+                    pc = 0xF3B7;
+                    break;
+                case 0xF3B7: // Mov_Draw_VL_ab: STB <$04
+                    Cycles(4);
+                    St8(Direct(0x04), r.B);
+                    pc = 0xF3B9;
+                    break;
+                case 0xF3B9: // Mov_Draw_VL_a: STA $C823
+                    Cycles(5);
+                    St8(0xC823, r.A);
+                    pc = 0xF3BC;
+                    break;
+                case 0xF3BC: // Mov_Draw_VL: LDD ,X
+                    Cycles(5);
+                    r.D = Ld16(Read16(r.X));
+                    pc = 0xF3BE;
+                    break;
+                case 0xF3BE: // Mov_Draw_VL_d: STA <$01
+                    Cycles(4);
+                    St8(Direct(0x01), r.A);
+                    pc = 0xF3C0;
+                    break;
+                case 0xF3C0: // CLR <$00
+                    Cycles(6);
+                    Clr(Direct(0x00));
+                    pc = 0xF3C2;
+                    break;
+                case 0xF3C2: // LEAX 2,X
+                    Cycles(5);
+                    r.X = r.X + 2;
+                    r.CC.Zero = r.X == 0;
+                    pc = 0xF3C4;
+                    break;
+                case 0xF3C4: // NOP
+                    Cycles(2);
+                    pc = 0xF3C5;
+                    break;
+                case 0xF3C5: // INC <$00
+                    Cycles(6);
+                    Inc(Direct(0x00));
+                    pc = 0xF3C7;
+                    break;
+                case 0xF3C7: // STB <$01
+                    Cycles(4);
+                    St8(Direct(0x01), r.B);
+                    pc = 0xF3C9;
+                    break;
+                case 0xF3C9: // LDD #$0000
+                    Cycles(3);
+                    r.D = Ld16(0x0000);
+                    pc = 0xF3CC;
+                    break;
+                case 0xF3CC: // BRA $F3ED
+                    Cycles(3);
+                    pc = 0xF3ED;
+                    break;
+                case 0xF3CE: // Draw_VLc: LDA ,X+
+                    Cycles(6);
+                    r.A = Ld8(Read8(r.X++));
+                    pc = 0xF3D0;
+                    break;
+                case 0xF3D0: // BRA $F3DA
+                    Cycles(3);
+                    pc = 0xF3DA;
+                    break;
+                case 0xF3D2: // Draw_VL_b: STB <$04
+                    Cycles(4);
+                    St8(Direct(0x04), r.B);
+                    pc = 0xF3D4;
+                    break;
+                case 0xF3D4: // BRA $F3DD
+                    Cycles(3);
+                    pc = 0xF3DD;
+                    break;
+                case 0xF3D6: // Draw_VLcs: LDD ,X++
+                    Cycles(8);
+                    r.D = Ld16(Read16(PostInc2(r.X)));
+                    pc = 0xF3D8;
+                    break;
+                case 0xF3D8: // Draw_VL_ab: STB <$04
+                    Cycles(4);
+                    St8(Direct(0x04), r.B);
+                    pc = 0xF3DA;
+                    break;
+                case 0xF3DA: // Draw_VL_a: STA $C823
+                    Cycles(5);
+                    St8(0xC823, r.A);
+                    pc = 0xF3DD;
+                    break;
+                case 0xF3DD: // Draw_VL: LDD ,X
+                    Cycles(5);
+                    r.D = Ld16(Read16(r.X));
+                    pc = 0xF3DF;
+                    break;
+                case 0xF3DF: // Draw_Line_d: STA <$01
+                    Cycles(4);
+                    St8(Direct(0x01), r.A);
+                    pc = 0xF3E1;
+                    break;
+                case 0xF3E1: // CLR <$00
+                    Cycles(6);
+                    Clr(Direct(0x00));
+                    pc = 0xF3E3;
+                    break;
+                case 0xF3E3: // LEAX 2,X
+                    Cycles(5);
+                    r.X = r.X + 2;
+                    r.CC.Zero = r.X == 0;
+                    pc = 0xF3E5;
+                    break;
+                case 0xF3E5: // NOP
+                    Cycles(2);
+                    pc = 0xF3E6;
+                    break;
+                case 0xF3E6: // INC <$00
+                    Cycles(6);
+                    Inc(Direct(0x00));
+                    pc = 0xF3E8;
+                    break;
+                case 0xF3E8: // STB <$01
+                    Cycles(4);
+                    St8(Direct(0x01), r.B);
+                    pc = 0xF3EA;
+                    break;
+                case 0xF3EA: // LDD #$FF00
+                    Cycles(3);
+                    r.D = Ld16(0xFF00);
+                    pc = 0xF3ED;
+                    break;
+                case 0xF3ED: // STA <$0A
+                    Cycles(4);
+                    St8(Direct(0x0A), r.A);
+                    pc = 0xF3EF;
+                    break;
+                case 0xF3EF: // STB <$05
+                    Cycles(4);
+                    St8(Direct(0x05), r.B);
+                    pc = 0xF3F1;
+                    break;
+                case 0xF3F1: // LDD #$0040
+                    Cycles(3);
+                    r.D = Ld16(0x0040);
+                    pc = 0xF3F4;
+                    break;
+                case 0xF3F4: // BITB <$0D
+                    Cycles(4);
+                    Tst8(r.B & Read8(Direct(0x0D)));
+                    pc = 0xF3F6;
+                    break;
+                case 0xF3F6: // BEQ $F3F4
+                    Cycles(3);
+                    pc = (r.CC.Zero) ? 0xF3F4 : 0xF3F8;
+                    break;
+                case 0xF3F8: // NOP
+                    Cycles(2);
+                    pc = 0xF3F9;
+                    break;
+                case 0xF3F9: // STA <$0A
+                    Cycles(4);
+                    St8(Direct(0x0A), r.A);
+                    pc = 0xF3FB;
+                    break;
+                case 0xF3FB: // LDA $C823
+                    Cycles(5);
+                    r.A = Ld8(Read8(0xC823));
+                    pc = 0xF3FE;
+                    break;
+                case 0xF3FE: // DECA
+                    Cycles(2);
+                    r.A = Dec8(r.A);
+                    pc = 0xF3FF;
+                    break;
+                case 0xF3FF: // BPL $F3DA
+                    Cycles(3);
+                    pc = (!r.CC.Negative) ? 0xF3DA : 0xF401;
+                    break;
+                case 0xF401: // JMP $F34F
+                    Cycles(4);
+                    pc = 0xF34F;
+                    break;
+                case 0xF404: // Draw_VLp_FF: LDB #$FF
+                    Cycles(2);
+                    r.B = Ld8(0xFF);
+                    pc = 0xF406;
+                    break;
+                case 0xF406: // BRA $F40E
+                    Cycles(3);
+                    pc = 0xF40E;
+                    break;
+                case 0xF408: // Draw_VLp_7F: LDB #$7F
+                    Cycles(2);
+                    r.B = Ld8(0x7F);
+                    pc = 0xF40A;
+                    break;
+                case 0xF40A: // BRA $F40E
+                    Cycles(3);
+                    pc = 0xF40E;
+                    break;
+                case 0xF40C: // Draw_VLp_scale: LDB ,X+
+                    Cycles(6);
+                    r.B = Ld8(Read8(r.X++));
+                    pc = 0xF40E;
+                    break;
+                case 0xF40E: // Draw_VLp_b: STB <$04
+                    Cycles(4);
+                    St8(Direct(0x04), r.B);
+                    pc = 0xF410;
+                    break;
+                case 0xF410: // Draw_VLp: LDD 1,X
+                    Cycles(6);
+                    r.D = Ld16(Read16(r.X + 1));
+                    pc = 0xF412;
+                    break;
+                case 0xF412: // STA <$01
+                    Cycles(4);
+                    St8(Direct(0x01), r.A);
+                    pc = 0xF414;
+                    break;
+                case 0xF414: // CLR <$00
+                    Cycles(6);
+                    Clr(Direct(0x00));
+                    pc = 0xF416;
+                    break;
+                case 0xF416: // LDA ,X
+                    Cycles(4);
+                    r.A = Ld8(Read8(r.X));
+                    pc = 0xF418;
+                    break;
+                case 0xF418: // LEAX 3,X
+                    Cycles(5);
+                    r.X = r.X + 3;
+                    r.CC.Zero = r.X == 0;
+                    pc = 0xF41A;
+                    break;
+                case 0xF41A: // INC <$00
+                    Cycles(6);
+                    Inc(Direct(0x00));
+                    pc = 0xF41C;
+                    break;
+                case 0xF41C: // STB <$01
+                    Cycles(4);
+                    St8(Direct(0x01), r.B);
+                    pc = 0xF41E;
+                    break;
+                case 0xF41E: // STA <$0A
+                    Cycles(4);
+                    St8(Direct(0x0A), r.A);
+                    pc = 0xF420;
+                    break;
+                case 0xF420: // CLR <$05
+                    Cycles(6);
+                    Clr(Direct(0x05));
+                    pc = 0xF422;
+                    break;
+                case 0xF422: // LDD #$0040
+                    Cycles(3);
+                    r.D = Ld16(0x0040);
+                    pc = 0xF425;
+                    break;
+                case 0xF425: // BITB <$0D
+                    Cycles(4);
+                    Tst8(r.B & Read8(Direct(0x0D)));
+                    pc = 0xF427;
+                    break;
+                case 0xF427: // BEQ $F425
+                    Cycles(3);
+                    pc = (r.CC.Zero) ? 0xF425 : 0xF429;
+                    break;
+                case 0xF429: // NOP
+                    Cycles(2);
+                    pc = 0xF42A;
+                    break;
+                case 0xF42A: // STA <$0A
+                    Cycles(4);
+                    St8(Direct(0x0A), r.A);
+                    pc = 0xF42C;
+                    break;
+                case 0xF42C: // LDA ,X
+                    Cycles(4);
+                    r.A = Ld8(Read8(r.X));
+                    pc = 0xF42E;
+                    break;
+                case 0xF42E: // BLE $F410
+                    Cycles(3);
+                    pc = (r.CC.Zero || (r.CC.Negative != r.CC.Overflow)) ? 0xF410 : 0xF430;
+                    break;
+                case 0xF430: // JMP $F34F
+                    Cycles(4);
+                    pc = 0xF34F;
+                    break;
+                case 0xF433: // DECA
+                    Cycles(2);
+                    r.A = Dec8(r.A);
+                    pc = 0xF434;
+                    break;
+                case 0xF434: // Draw_Pat_VL_a: STA $C823
+                    Cycles(5);
+                    St8(0xC823, r.A);
+                    pc = 0xF437;
+                    break;
+                case 0xF437: // Draw_Pat_VL: LDD ,X
+                    Cycles(5);
+                    r.D = Ld16(Read16(r.X));
+                    pc = 0xF439;
+                    break;
+                case 0xF439: // Draw_Pat_VL_d: STA <$01
+                    Cycles(4);
+                    St8(Direct(0x01), r.A);
+                    pc = 0xF43B;
+                    break;
+                case 0xF43B: // CLR <$00
+                    Cycles(6);
+                    Clr(Direct(0x00));
+                    pc = 0xF43D;
+                    break;
+                case 0xF43D: // LEAX 2,X
+                    Cycles(5);
+                    r.X = r.X + 2;
+                    r.CC.Zero = r.X == 0;
+                    pc = 0xF43F;
+                    break;
+                case 0xF43F: // INC <$00
+                    Cycles(6);
+                    Inc(Direct(0x00));
+                    pc = 0xF441;
+                    break;
+                case 0xF441: // STB <$01
+                    Cycles(4);
+                    St8(Direct(0x01), r.B);
+                    pc = 0xF443;
+                    break;
+                case 0xF443: // LDA $C829
+                    Cycles(5);
+                    r.A = Ld8(Read8(0xC829));
+                    pc = 0xF446;
+                    break;
+                case 0xF446: // LDB #$40
+                    Cycles(2);
+                    r.B = Ld8(0x40);
+                    pc = 0xF448;
+                    break;
+                case 0xF448: // STA <$0A
+                    Cycles(4);
+                    St8(Direct(0x0A), r.A);
+                    pc = 0xF44A;
+                    break;
+                case 0xF44A: // CLR <$05
+                    Cycles(6);
+                    Clr(Direct(0x05));
+                    pc = 0xF44C;
+                    break;
+                case 0xF44C: // BITB $D00D
+                    Cycles(5);
+                    Tst8(r.B & Read8(0xD00D));
+                    pc = 0xF44F;
+                    break;
+                case 0xF44F: // BEQ $F45C
+                    Cycles(3);
+                    pc = (r.CC.Zero) ? 0xF45C : 0xF451;
+                    break;
+                case 0xF451: // CLR <$0A
+                    Cycles(6);
+                    Clr(Direct(0x0A));
+                    pc = 0xF453;
+                    break;
+                case 0xF453: // LDA $C823
+                    Cycles(5);
+                    r.A = Ld8(Read8(0xC823));
+                    pc = 0xF456;
+                    break;
+                case 0xF456: // BNE $F433
+                    Cycles(3);
+                    pc = (!r.CC.Zero) ? 0xF433 : 0xF458;
+                    break;
+                case 0xF458: // RTS
+                    Cycles(5);
+                    pc = Pop16(r.S);
+                    break;
+                case 0xF459: // LDA $C829
+                    Cycles(5);
+                    r.A = Ld8(Read8(0xC829));
+                    pc = 0xF45C;
+                    break;
+                case 0xF45C: // STA <$0A
+                    Cycles(4);
+                    St8(Direct(0x0A), r.A);
+                    pc = 0xF45E;
+                    break;
+                case 0xF45E: // NOP
+                    Cycles(2);
+                    pc = 0xF45F;
+                    break;
+                case 0xF45F: // BITB <$0D
+                    Cycles(4);
+                    Tst8(r.B & Read8(Direct(0x0D)));
+                    pc = 0xF461;
+                    break;
+                case 0xF461: // BEQ $F459
+                    Cycles(3);
+                    pc = (r.CC.Zero) ? 0xF459 : 0xF463;
+                    break;
+                case 0xF463: // LDA $C823
+                    Cycles(5);
+                    r.A = Ld8(Read8(0xC823));
+                    pc = 0xF466;
+                    break;
+                case 0xF466: // CLR <$0A
+                    Cycles(6);
+                    Clr(Direct(0x0A));
+                    pc = 0xF468;
+                    break;
+                case 0xF468: // TSTA
+                    Cycles(2);
+                    Tst8(r.A);
+                    pc = 0xF469;
+                    break;
+                case 0xF469: // BNE $F433
+                    Cycles(3);
+                    pc = (!r.CC.Zero) ? 0xF433 : 0xF46B;
+                    break;
+                case 0xF46B: // JMP $F34F
+                    Cycles(4);
+                    pc = 0xF34F;
+                    break;
+                case 0xF46E: // Draw_VL_mode: LDA $C824
+                    Cycles(5);
+                    r.A = Ld8(Read8(0xC824));
+                    pc = 0xF471;
+                    break;
+                case 0xF471: // PSHS A
+                    Cycles(6);
+                    Push8(r.S, r.A);
+                    pc = 0xF473;
+                    break;
+                case 0xF473: // CLR $C824
+                    Cycles(7);
+                    Clr(0xC824);
+                    pc = 0xF476;
+                    break;
+                case 0xF476: // LDA ,X+
+                    Cycles(6);
+                    r.A = Ld8(Read8(r.X++));
+                    pc = 0xF478;
+                    break;
+                case 0xF478: // BPL $F47E
+                    Cycles(3);
+                    pc = (!r.CC.Negative) ? 0xF47E : 0xF47A;
+                    break;
+                case 0xF47A: // BSR $F437
+                    Cycles(7);
+                    Push16(r.S, 0xF47C);
+                    pc = 0xF437;
+                    break;
+                case 0xF47C: // BRA $F476
+                    Cycles(3);
+                    pc = 0xF476;
+                    break;
+                case 0xF47E: // BNE $F485
+                    Cycles(3);
+                    pc = (!r.CC.Zero) ? 0xF485 : 0xF480;
+                    break;
+                case 0xF480: // JSR $F3BC
+                    Cycles(8);
+                    Push16(r.S, 0xF483);
+                    pc = 0xF3BC;
+                    break;
+                case 0xF483: // BRA $F476
+                    Cycles(3);
+                    pc = 0xF476;
+                    break;
+                case 0xF485: // DECA
+                    Cycles(2);
+                    r.A = Dec8(r.A);
+                    pc = 0xF486;
+                    break;
+                case 0xF486: // BEQ $F48D
+                    Cycles(3);
+                    pc = (r.CC.Zero) ? 0xF48D : 0xF488;
+                    break;
+                case 0xF488: // JSR $F3DD
+                    Cycles(8);
+                    Push16(r.S, 0xF48B);
+                    pc = 0xF3DD;
+                    break;
+                case 0xF48B: // BRA $F476
+                    Cycles(3);
+                    pc = 0xF476;
+                    break;
+                case 0xF48D: // PULS A
+                    Cycles(6);
+                    r.A = Pop8(r.S);
+                    pc = 0xF48F;
+                    break;
+                case 0xF48F: // STA $C824
+                    Cycles(5);
+                    St8(0xC824, r.A);
+                    pc = 0xF492;
+                    break;
+                case 0xF492: // JMP $F34F
+                    Cycles(4);
+                    pc = 0xF34F;
+                    break;
+                case 0xF495: // Print_Str: STU $C82C
+                    Cycles(6);
+                    St16(0xC82C, r.U);
+                    pc = 0xF498;
+                    break;
+                case 0xF498: // LDX #$F9D4
+                    Cycles(3);
+                    r.X = Ld16(0xF9D4);
+                    pc = 0xF49B;
+                    break;
+                case 0xF49B: // LDD #$1883
+                    Cycles(3);
+                    r.D = Ld16(0x1883);
+                    pc = 0xF49E;
+                    break;
+                case 0xF49E: // CLR <$01
+                    Cycles(6);
+                    Clr(Direct(0x01));
+                    pc = 0xF4A0;
+                    break;
+                case 0xF4A0: // STA <$0B
+                    Cycles(4);
+                    St8(Direct(0x0B), r.A);
+                    pc = 0xF4A2;
+                    break;
+                case 0xF4A2: // LDX #$F9D4
+                    Cycles(3);
+                    r.X = Ld16(0xF9D4);
+                    pc = 0xF4A5;
+                    break;
+                case 0xF4A5: // STB <$00
+                    Cycles(4);
+                    St8(Direct(0x00), r.B);
+                    pc = 0xF4A7;
+                    break;
+                case 0xF4A7: // DEC <$00
+                    Cycles(6);
+                    Dec(Direct(0x00));
+                    pc = 0xF4A9;
+                    break;
+                case 0xF4A9: // LDD #$8081
+                    Cycles(3);
+                    r.D = Ld16(0x8081);
+                    pc = 0xF4AC;
+                    break;
+                case 0xF4AC: // NOP
+                    Cycles(2);
+                    pc = 0xF4AD;
+                    break;
+                case 0xF4AD: // INC <$00
+                    Cycles(6);
+                    Inc(Direct(0x00));
+                    pc = 0xF4AF;
+                    break;
+                case 0xF4AF: // STB <$00
+                    Cycles(4);
+                    St8(Direct(0x00), r.B);
+                    pc = 0xF4B1;
+                    break;
+                case 0xF4B1: // STA <$00
+                    Cycles(4);
+                    St8(Direct(0x00), r.A);
+                    pc = 0xF4B3;
+                    break;
+                case 0xF4B3: // TST $C800
+                    Cycles(7);
+                    Tst8(Read8(0xC800));
+                    pc = 0xF4B6;
+                    break;
+                case 0xF4B6: // INC <$00
+                    Cycles(6);
+                    Inc(Direct(0x00));
+                    pc = 0xF4B8;
+                    break;
+                case 0xF4B8: // LDA $C82B
+                    Cycles(5);
+                    r.A = Ld8(Read8(0xC82B));
+                    pc = 0xF4BB;
+                    break;
+                case 0xF4BB: // STA <$01
+                    Cycles(4);
+                    St8(Direct(0x01), r.A);
+                    pc = 0xF4BD;
+                    break;
+                case 0xF4BD: // LDD #$0100
+                    Cycles(3);
+                    r.D = Ld16(0x0100);
+                    pc = 0xF4C0;
+                    break;
+                case 0xF4C0: // LDU $C82C
+                    Cycles(6);
+                    r.U = Ld16(Read16(0xC82C));
+                    pc = 0xF4C3;
+                    break;
+                case 0xF4C3: // STA <$00
+                    Cycles(4);
+                    St8(Direct(0x00), r.A);
+                    pc = 0xF4C5;
+                    break;
+                case 0xF4C5: // BRA $F4CB
+                    Cycles(3);
+                    pc = 0xF4CB;
+                    break;
+                case 0xF4C7: // LDA A,X
+                    Cycles(5);
+                    r.A = Ld8(Read8(r.X + S16(r.A)));
+                    pc = 0xF4C9;
+                    break;
+                case 0xF4C9: // STA <$0A
+                    Cycles(4);
+                    St8(Direct(0x0A), r.A);
+                    pc = 0xF4CB;
+                    break;
+                case 0xF4CB: // LDA ,U+
+                    Cycles(6);
+                    r.A = Ld8(Read8(r.U++));
+                    pc = 0xF4CD;
+                    break;
+                case 0xF4CD: // BPL $F4C7
+                    Cycles(3);
+                    pc = (!r.CC.Negative) ? 0xF4C7 : 0xF4CF;
+                    break;
+                case 0xF4CF: // LDA #$81
+                    Cycles(2);
+                    r.A = Ld8(0x81);
+                    pc = 0xF4D1;
+                    break;
+                case 0xF4D1: // STA <$00
+                    Cycles(4);
+                    St8(Direct(0x00), r.A);
+                    pc = 0xF4D3;
+                    break;
+                case 0xF4D3: // NEG <$01
+                    Cycles(6);
+                    Neg(Direct(0x01));
+                    pc = 0xF4D5;
+                    break;
+                case 0xF4D5: // LDA #$01
+                    Cycles(2);
+                    r.A = Ld8(0x01);
+                    pc = 0xF4D7;
+                    break;
+                case 0xF4D7: // STA <$00
+                    Cycles(4);
+                    St8(Direct(0x00), r.A);
+                    pc = 0xF4D9;
+                    break;
+                case 0xF4D9: // CMPX #$FBB4
+                    Cycles(4);
+                    Sub16(r.X, 0xFBB4);
+                    pc = 0xF4DC;
+                    break;
+                case 0xF4DC: // BEQ $F50A
+                    Cycles(3);
+                    pc = (r.CC.Zero) ? 0xF50A : 0xF4DE;
+                    break;
+                case 0xF4DE: // LEAX 80,X
+                    Cycles(5);
+                    r.X = r.X + 80;
+                    r.CC.Zero = r.X == 0;
+                    pc = 0xF4E1;
+                    break;
+                case 0xF4E1: // TFR U,D
+                    Cycles(6);
+                    r.D = r.U;
+                    pc = 0xF4E3;
+                    break;
+                case 0xF4E3: // SUBD $C82C
+                    Cycles(7);
+                    r.D = Sub16(r.D, Read16(0xC82C));
+                    pc = 0xF4E6;
+                    break;
+                case 0xF4E6: // SUBB #$02
+                    Cycles(2);
+                    r.B = Sub8(r.B, 0x02);
+                    pc = 0xF4E8;
+                    break;
+                case 0xF4E8: // LSLB/ASLB
+                    Cycles(2);
+                    r.B = Add8(r.B, r.B);
+                    pc = 0xF4E9;
+                    break;
+                case 0xF4E9: // BRN $F4EB
+                    Cycles(3);
+                    pc = 0xF4EB;
+                    break;
+                case 0xF4EB: // LDA #$81
+                    Cycles(2);
+                    r.A = Ld8(0x81);
+                    pc = 0xF4ED;
+                    break;
+                case 0xF4ED: // NOP
+                    Cycles(2);
+                    pc = 0xF4EE;
+                    break;
+                case 0xF4EE: // DECB
+                    Cycles(2);
+                    r.B = Dec8(r.B);
+                    pc = 0xF4EF;
+                    break;
+                case 0xF4EF: // BNE $F4EB
+                    Cycles(3);
+                    pc = (!r.CC.Zero) ? 0xF4EB : 0xF4F1;
+                    break;
+                case 0xF4F1: // STA <$00
+                    Cycles(4);
+                    St8(Direct(0x00), r.A);
+                    pc = 0xF4F3;
+                    break;
+                case 0xF4F3: // LDB $C82A
+                    Cycles(5);
+                    r.B = Ld8(Read8(0xC82A));
+                    pc = 0xF4F6;
+                    break;
+                case 0xF4F6: // STB <$01
+                    Cycles(4);
+                    St8(Direct(0x01), r.B);
+                    pc = 0xF4F8;
+                    break;
+                case 0xF4F8: // DEC <$00
+                    Cycles(6);
+                    Dec(Direct(0x00));
+                    pc = 0xF4FA;
+                    break;
+                case 0xF4FA: // LDD #$8101
+                    Cycles(3);
+                    r.D = Ld16(0x8101);
+                    pc = 0xF4FD;
+                    break;
+                case 0xF4FD: // NOP
+                    Cycles(2);
+                    pc = 0xF4FE;
+                    break;
+                case 0xF4FE: // STA <$00
+                    Cycles(4);
+                    St8(Direct(0x00), r.A);
+                    pc = 0xF500;
+                    break;
+                case 0xF500: // CLR <$01
+                    Cycles(6);
+                    Clr(Direct(0x01));
+                    pc = 0xF502;
+                    break;
+                case 0xF502: // STB <$00
+                    Cycles(4);
+                    St8(Direct(0x00), r.B);
+                    pc = 0xF504;
+                    break;
+                case 0xF504: // STA <$00
+                    Cycles(4);
+                    St8(Direct(0x00), r.A);
+                    pc = 0xF506;
+                    break;
+                case 0xF506: // LDB #$03
+                    Cycles(2);
+                    r.B = Ld8(0x03);
+                    pc = 0xF508;
+                    break;
+                case 0xF508: // BRA $F4A5
+                    Cycles(3);
+                    pc = 0xF4A5;
+                    break;
+                case 0xF50A: // LDA #$98
+                    Cycles(2);
+                    r.A = Ld8(0x98);
+                    pc = 0xF50C;
+                    break;
+                case 0xF50C: // STA <$0B
+                    Cycles(4);
+                    St8(Direct(0x0B), r.A);
+                    pc = 0xF50E;
+                    break;
+                case 0xF50E: // JMP $F354
+                    Cycles(4);
+                    pc = 0xF354;
+                    break;
+                case 0xF56D: // Delay_3: LDB #$03
+                    Cycles(2);
+                    r.B = Ld8(0x03);
+                    pc = 0xF56F;
+                    break;
+                case 0xF56F: // BRA $F57A
+                    Cycles(3);
+                    pc = 0xF57A;
+                    break;
+                case 0xF571: // Delay_2: LDB #$02
+                    Cycles(2);
+                    r.B = Ld8(0x02);
+                    pc = 0xF573;
+                    break;
+                case 0xF573: // BRA $F57A
+                    Cycles(3);
+                    pc = 0xF57A;
+                    break;
+                case 0xF575: // Delay_1: LDB #$01
+                    Cycles(2);
+                    r.B = Ld8(0x01);
+                    pc = 0xF577;
+                    break;
+                case 0xF577: // BRA $F57A
+                    Cycles(3);
+                    pc = 0xF57A;
+                    break;
+                case 0xF579: // Delay_0: CLRB
+                    Cycles(2);
+                    r.B = Clr8();
+                    pc = 0xF57A;
+                    break;
+                case 0xF57A: // Delay_b: DECB
+                    Cycles(2);
+                    r.B = Dec8(r.B);
+                    pc = 0xF57B;
+                    break;
+                case 0xF57B: // BPL $F57A
+                    Cycles(3);
+                    pc = (!r.CC.Negative) ? 0xF57A : 0xF57D;
+                    break;
+                case 0xF57D: // Delay_RTS: RTS
+                    Cycles(5);
+                    pc = Pop16(r.S);
+                    break;
+                case 0xF584: // Abs_a_b: TSTA
+                    Cycles(2);
+                    Tst8(r.A);
+                    pc = 0xF585;
+                    break;
+                case 0xF585: // BPL $F58B
+                    Cycles(3);
+                    pc = (!r.CC.Negative) ? 0xF58B : 0xF587;
+                    break;
+                case 0xF587: // NEGA
+                    Cycles(2);
+                    r.A = Neg8(r.A);
+                    pc = 0xF588;
+                    break;
+                case 0xF588: // BVC $F58B
+                    Cycles(3);
+                    pc = (!r.CC.Overflow) ? 0xF58B : 0xF58A;
+                    break;
+                case 0xF58A: // DECA
+                    Cycles(2);
+                    r.A = Dec8(r.A);
+                    pc = 0xF58B;
+                    break;
+                case 0xF58B: // Abs_b: TSTB
+                    Cycles(2);
+                    Tst8(r.B);
+                    pc = 0xF58C;
+                    break;
+                case 0xF58C: // BPL $F592
+                    Cycles(3);
+                    pc = (!r.CC.Negative) ? 0xF592 : 0xF58E;
+                    break;
+                case 0xF58E: // NEGB
+                    Cycles(2);
+                    r.B = Neg8(r.B);
+                    pc = 0xF58F;
+                    break;
+                case 0xF58F: // BVC $F592
+                    Cycles(3);
+                    pc = (!r.CC.Overflow) ? 0xF592 : 0xF591;
+                    break;
+                case 0xF591: // DECB
+                    Cycles(2);
+                    r.B = Dec8(r.B);
+                    pc = 0xF592;
+                    break;
+                case 0xF592: // RTS
+                    Cycles(5);
+                    pc = Pop16(r.S);
+                    break;
+                default:
+                    r.PC = pc;
+                    return m_cycles;
+                }
+            }
+            r.PC = pc;
+            return m_cycles;
+        }
+
+    private:
+        void Cycles(cycles_t cycles) {
+            m_cycles += cycles;
+            m_memoryBus.AddSyncCycles(cycles);
+        }
+
+        uint8_t Read8(uint16_t address) { return m_memoryBus.Read(address); }
+        uint16_t Read16(uint16_t address) { return m_memoryBus.Read16(address); }
+        void Write8(uint16_t address, uint8_t value) { m_memoryBus.Write(address, value); }
+
+        uint16_t Direct(uint8_t offset) const { return CombineToU16(r.DP, offset); }
+
+        static uint16_t PostInc2(uint16_t& reg) {
+            const uint16_t value = reg;
+            reg += 2;
+            return value;
+        }
+
+        static int16_t S16(uint8_t value) { return static_cast<int8_t>(value); }
+
+        void Push8(uint16_t& stackPointer, uint8_t value) { Write8(--stackPointer, value); }
+        uint8_t Pop8(uint16_t& stackPointer) { return Read8(stackPointer++); }
+
+        void Push16(uint16_t& stackPointer, uint16_t value) {
+            Write8(--stackPointer, U8(value & 0xFF)); // Low
+            Write8(--stackPointer, U8(value >> 8));   // High
+        }
+
+        uint16_t Pop16(uint16_t& stackPointer) {
+            auto high = Read8(stackPointer++);
+            auto low = Read8(stackPointer++);
+            return CombineToU16(high, low);
+        }
+
+        // LD, TST, BIT, OR
+        template <typename T>
+        T SetNZ(T value) {
+            r.CC.Negative = (value >> (sizeof(T) * 8 - 1)) & 1;
+            r.CC.Zero = value == 0;
+            r.CC.Overflow = 0;
+            return value;
+        }
+
+        uint8_t Ld8(uint8_t value) { return SetNZ(value); }
+        uint16_t Ld16(uint16_t value) { return SetNZ(value); }
+        void Tst8(uint8_t value) { SetNZ(value); }
+        uint8_t Or8(uint8_t a, uint8_t b) { return SetNZ(U8(a | b)); }
+
+        void St8(uint16_t address, uint8_t value) { Write8(address, SetNZ(value)); }
+
+        void St16(uint16_t address, uint16_t value) {
+            SetNZ(value);
+            Write8(address, U8(value >> 8));
+            Write8(address + 1, U8(value & 0xFF));
+        }
+
+        uint8_t Add8(uint8_t a, uint8_t b, uint8_t carry = 0) {
+            const uint16_t r16 = U16(a) + U16(b) + U16(carry);
+            const uint8_t r8 = U8(r16);
+            r.CC.HalfCarry = (((a & 0x0F) + (b & 0x0F) + carry) & 0x10) != 0;
+            r.CC.Carry = (r16 & 0xFF00) != 0;
+            r.CC.Overflow = ((a ^ r16) & (b ^ r16) & BITS(7)) != 0;
+            r.CC.Zero = r8 == 0;
+            r.CC.Negative = (r8 & BITS(7)) != 0;
+            return r8;
+        }
+
+        uint16_t Add16(uint16_t a, uint16_t b, uint16_t carry = 0) {
+            const uint32_t r32 = U16(a) + U16(b) + U16(carry);
+            const uint16_t r16 = U16(r32);
+            r.CC.Carry = (r32 & 0xFFFF'0000) != 0;
+            r.CC.Overflow = ((a ^ r32) & (b ^ r32) & BITS(15)) != 0;
+            r.CC.Zero = r16 == 0;
+            r.CC.Negative = (r16 & BITS(15)) != 0;
+            return r16;
+        }
+
+        // SUB, CMP
+        uint8_t Sub8(uint8_t a, uint8_t b) {
+            const uint8_t result = Add8(a, ~b, 1);
+            r.CC.Carry = !r.CC.Carry;
+            return result;
+        }
+
+        uint16_t Sub16(uint16_t a, uint16_t b) {
+            const uint16_t result = Add16(a, ~b, 1);
+            r.CC.Carry = !r.CC.Carry;
+            return result;
+        }
+
+        uint8_t Neg8(uint8_t value) { return Sub8(0, value); }
+
+        uint8_t Clr8() {
+            r.CC.Negative = 0;
+            r.CC.Zero = 1;
+            r.CC.Overflow = 0;
+            r.CC.Carry = 0;
+            return 0;
+        }
+
+        uint8_t Inc8(uint8_t value) {
+            r.CC.Overflow = value == 0b0111'1111;
+            return SetZN(++value);
+        }
+
+        uint8_t Dec8(uint8_t value) {
+            r.CC.Overflow = value == 0b1000'0000;
+            return SetZN(--value);
+        }
+
+        // INC, DEC leave V alone
+        uint8_t SetZN(uint8_t value) {
+            r.CC.Zero = value == 0;
+            r.CC.Negative = (value & BITS(7)) != 0;
+            return value;
+        }
+
+        // Memory forms
+        void Clr(uint16_t address) { Write8(address, Clr8()); }
+        void Inc(uint16_t address) { Write8(address, Inc8(Read8(address))); }
+        void Dec(uint16_t address) { Write8(address, Dec8(Read8(address))); }
+        void Neg(uint16_t address) { Write8(address, Neg8(Read8(address))); }
+
+        MemoryBus& m_memoryBus;
+        CpuRegisters& r;
+        cycles_t m_cycles{};
+    };
+} // namespace
+
+bool BiosHle::Init(MemoryBus& memoryBus) {
+    m_memoryBus = &memoryBus;
+
+    uint64_t hash = Hash::Fnv1aBasis;
+    for (auto& range : TranslatedRanges) {
+        for (uint32_t address = range.first; address <= range.second; ++address) {
+            const uint8_t value = memoryBus.ReadRaw(static_cast<uint16_t>(address));
+            hash = Hash::Fnv1a(&value, 1, hash);
+        }
+    }
+
+    m_entryPoints.reset();
+    if (hash != TranslatedRangesHash)
+        return false;
+
+    for (auto& entryPoint : EntryPoints)
+        m_entryPoints.set(entryPoint.address - 0xF000);
+    return true;
+}
+
+cycles_t BiosHle::Execute(CpuRegisters& registers, cycles_t maxCycles) {
+    ASSERT(IsEntryPoint(registers.PC));
+    const cycles_t cycles = NativeBios(*m_memoryBus, registers).Run(maxCycles);
+    ++m_stats.numCalls;
+    m_stats.numCycles += cycles;
+    return cycles;
+}
+
+const char* BiosHle::RoutineName(uint16_t address) {
+    auto iter = std::lower_bound(
+        std::begin(EntryPoints), std::end(EntryPoints), address,
+        [](const EntryPoint& entryPoint, uint16_t value) { return entryPoint.address < value; });
+    if (iter == std::end(EntryPoints) || iter->address != address)
+        return "?";
+    return iter->name;
+}
@@ -5,6 +5,7 @@
 
 void BiosRom::Init(MemoryBus& memoryBus) {
     memoryBus.ConnectDevice(*this, MemoryMap::Bios.range, EnableSync::False);
+    memoryBus.MapReadOnlyMemory(MemoryMap::Bios.range, m_data.data());
 }
 
 bool BiosRom::LoadBiosRom(const char* file) {
@@ -1,99 +1,85 @@
 #include "emulator/Cartridge.h"
 #include "core/ConsoleOutput.h"
 #include "core/ErrorHandler.h"
-#include "core/Stream.h"
 #include "emulator/MemoryMap.h"
-#include <cstring>
-#include <vector>
+#include <algorithm>
 
-namespace {
-    std::vector<uint8_t> ReadStreamUntil(FileStream& fs, uint8_t delim) {
-        std::vector<uint8_t> result;
-        uint8_t value;
-        while (fs.ReadValue(value) && value != delim)
-            result.push_back(value);
-        if (value != delim)
-            FAIL_MSG("Failed to find delim");
-        return result;
-    }
-
-    std::vector<uint8_t> ReadStreamUntilEnd(FileStream& fs) {
-        std::vector<uint8_t> result;
-        uint8_t value;
-        while (fs.ReadValue(value))
-            result.push_back(value);
-        return result;
-    }
-
-    bool IsValidRom(const char* file) {
-        bool valid = false;
-
-        try {
-            FileStream fs(file, "rb");
+void Cartridge::Init(MemoryBus& memoryBus) {
+    m_memoryBus = &memoryBus;
+    memoryBus.ConnectDevice(*this, MemoryMap::Cartridge.range, EnableSync::False);
+    m_data.resize(MemoryMap::Cartridge.physicalSize, 0);
+    m_windowSize = MemoryMap::Cartridge.physicalSize;
+    MapBank();
+}
 
-            std::string requiredCopyright = "g GCE";
-            auto copyright = ReadStreamUntil(fs, 0x80);
-            if (copyright.size() < requiredCopyright.size() ||
-                memcmp(copyright.data(), requiredCopyright.data(), requiredCopyright.size()) != 0) {
-                Errorf("Warning: missing \"g GCE\" copyright string at start of rom\n");
-            }
+bool Cartridge::LoadRom(const char* file) {
+    auto data = RomFile::Read(file);
+    if (!data)
+        return false;
 
-            // Location of music from ROM
-            //@TODO: Byte-swap on little endian
-            uint16_t musicLocation;
-            fs.ReadValue(musicLocation);
+    auto header = RomFile::ParseHeader(*data);
+    if (!header.hasCopyright)
+        Errorf("Warning: missing \"g GCE\" copyright string at start of rom\n");
+    if (!header.valid)
+        return false;
 
-            // Title of game is a multiline string of position, string, 0x80 as newline marker.
-            const int MAX_LINES = 10; // Some reasonable max to look for
-            std::string title;
-            for (int line = 0; line < MAX_LINES; ++line) {
-                uint8_t height, width, relY, relX;
-                fs.ReadValue(height);
-                // If first byte is 0, we're done
-                if (height == 0) {
-                    valid = true;
-                    break;
-                }
-                fs.ReadValue(width);
-                fs.ReadValue(relY);
-                fs.ReadValue(relX);
+    m_data = std::move(*data);
+    m_header = std::move(header);
+    m_contentHash = RomFile::ContentHash(m_data);
 
-                auto titleBytes = ReadStreamUntil(fs, 0x80);
-                title += {titleBytes.begin(), titleBytes.end()};
-                title += " ";
-            }
+    if (RomFile::IsBankSwitched(m_data.size())) {
+        m_windowSize = RomFile::BankSize;
+        m_numBanks = (m_data.size() + RomFile::BankSize - 1) / RomFile::BankSize;
+        Printf("Bank-switched rom: %zu banks\n", m_numBanks);
+    } else {
+        m_windowSize = MemoryMap::Cartridge.physicalSize;
+        m_numBanks = 1;
+    }
+    m_bank %= m_numBanks;
 
-        } catch (...) {
-        }
+    // Unmap everything first, as a banked window leaves the rest of cartridge space unmapped
+    m_memoryBus->MapReadOnlyMemory(MemoryMap::Cartridge.range, nullptr);
+    MapBank();
+    return true;
+}
 
-        return valid;
+void Cartridge::SelectBank(size_t bank) {
+    bank %= m_numBanks;
+    if (bank != m_bank) {
+        m_bank = bank;
+        MapBank();
     }
-} // namespace
-
-void Cartridge::Init(MemoryBus& memoryBus) {
-    memoryBus.ConnectDevice(*this, MemoryMap::Cartridge.range, EnableSync::False);
-    m_data.resize(MemoryMap::Cartridge.physicalSize, 0);
 }
 
-bool Cartridge::LoadRom(const char* file) {
-    if (IsValidRom(file)) {
-        FileStream fs(file, "rb");
-        m_data = ReadStreamUntilEnd(fs);
-        return true;
+void Cartridge::MapBank() {
+    // Only whole pages are mapped. Reads of a partial last page go to Read below, which handles
+    // reads past the end of the rom.
+    const size_t bankOffset = m_bank * m_windowSize;
+    const size_t bankSize = std::min(m_windowSize, m_data.size() - bankOffset);
+    const size_t mappedSize = bankSize & ~MemoryBus::PageMask;
+    const auto first = MemoryMap::Cartridge.range.first;
+    if (mappedSize > 0) {
+        m_memoryBus->MapReadOnlyMemory({first, static_cast<uint16_t>(first + mappedSize - 1)},
+                                       &m_data[bankOffset]);
+    }
+    if (mappedSize < m_windowSize) {
+        m_memoryBus->MapReadOnlyMemory({static_cast<uint16_t>(first + mappedSize),
+                                        static_cast<uint16_t>(first + m_windowSize - 1)},
+                                       nullptr);
     }
-    return false;
 }
 
 uint8_t Cartridge::Read(uint16_t address) const {
-    auto mappedAddress = MemoryMap::Cartridge.MapAddress(address);
-    if (mappedAddress >= m_data.size()) {
+    const size_t mappedAddress = MemoryMap::Cartridge.MapAddress(address);
+    const size_t offset = m_bank * m_windowSize + mappedAddress;
+    if (mappedAddress >= m_windowSize || offset >= m_data.size()) {
         ErrorHandler::Undefined("Invalid Cartridge read at $%04x\n", address);
         // Some roms erroneously access cartridge space when trying to draw vector lists (e.g. Mine
         // Storm, Polar Rescue), so by returning $01 here, we help to hide/fix these bugs. Real
         // hardware unlikely returns 0 anyway, so this may be more correct anyway?
         return 1;
     }
-    return m_data[mappedAddress];
+    return m_data[offset];
 }
 
 void Cartridge::Write(uint16_t /*address*/, uint8_t /*value*/) {
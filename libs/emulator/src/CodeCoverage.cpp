@@ -0,0 +1,19 @@
+#include "emulator/CodeCoverage.h"
+#include "core/ErrorHandler.h"
+
+void CodeCoverage::Init(const Cartridge& cartridge) {
+    m_cartridge = &cartridge;
+    m_romSize = cartridge.GetData().size();
+    m_windowSize = cartridge.GetWindowSize();
+    m_contentHash = cartridge.GetContentHash();
+    m_romStarts.assign((m_romSize + 63) / 64, 0);
+    m_systemStarts.assign((0x10000 - SystemStart) / 64, 0);
+}
+
+void CodeCoverage::Merge(const CodeCoverage& other) {
+    ASSERT(other.m_contentHash == m_contentHash && other.m_romSize == m_romSize);
+    for (size_t i = 0; i < m_romStarts.size(); ++i)
+        m_romStarts[i] |= other.m_romStarts[i];
+    for (size_t i = 0; i < m_systemStarts.size(); ++i)
+        m_systemStarts[i] |= other.m_systemStarts[i];
+}
@@ -1,6 +1,8 @@
 #include "emulator/Cpu.h"
 #include "core/BitOps.h"
 #include "core/ErrorHandler.h"
+#include "core/HostProfiler.h"
+#include "emulator/CodeCoverage.h"
 #include "emulator/CpuHelpers.h"
 #include "emulator/CpuOpCodes.h"
 #include "emulator/MemoryBus.h"
@@ -66,6 +68,8 @@ namespace {
 class CpuImpl : public CpuRegisters {
 public:
     MemoryBus* m_memoryBus{};
+    HeatMap* m_heatMap{};
+    CodeCoverage* m_codeCoverage{};
     cycles_t m_cycles{};
     bool m_waitingForInterrupts{}; // Set by CWAI
 
@@ -102,11 +106,12 @@ public:
         return CombineToU16(high, low);
     }
 
-    uint8_t ReadPC8() { return Read8(PC++); }
+    // Instruction bytes
+    uint8_t ReadPC8() { return m_memoryBus->Fetch(PC++); }
     uint16_t ReadPC16() {
-        uint16_t value = Read16(PC);
-        PC += 2;
-        return value;
+        auto high = m_memoryBus->Fetch(PC++);
+        auto low = m_memoryBus->Fetch(PC++);
+        return CombineToU16(high, low);
     }
 
     void Push8(uint16_t& stackPointer, uint8_t value) { m_memoryBus->Write(--stackPointer, value); }
@@ -913,6 +918,7 @@ public:
                 m_waitingForInterrupts = false;
                 CC.InterruptMask = 1;
                 PC = Read16(InterruptVector::Irq);
+                HOST_TRACE_INSTANT("IRQ");
                 return;
 
             } else if (firqEnabled && (CC.FastInterruptMask == 0)) {
@@ -933,6 +939,7 @@ public:
             PushCCState(true);
             CC.InterruptMask = 1;
             PC = Read16(InterruptVector::Irq);
+            HOST_TRACE_INSTANT("IRQ");
             AddCycles(19);
             return;
         }
@@ -942,6 +949,11 @@ public:
             return;
         }
 
+        if (m_heatMap)
+            m_heatMap->AddExecute(PC);
+        if (m_codeCoverage)
+            m_codeCoverage->AddInstruction(PC);
+
         // Read op code byte and page
         int cpuOpPage = 0;
         uint8_t opCodeByte = ReadPC8();
@@ -1910,3 +1922,15 @@ cycles_t Cpu::ExecuteInstruction(bool irqEnabled, bool firqEnabled) {
 const CpuRegisters& Cpu::Registers() const {
     return *m_impl;
 }
+
+void Cpu::SetHeatMap(HeatMap* heatMap) {
+    m_impl->m_heatMap = heatMap;
+}
+
+void Cpu::SetCodeCoverage(CodeCoverage* codeCoverage) {
+    m_impl->m_codeCoverage = codeCoverage;
+}
+
+void Cpu::SetRegisters(const CpuRegisters& registers) {
+    static_cast<CpuRegisters&>(*m_impl) = registers;
+}
@@ -1,4 +1,31 @@
 #include "emulator/Emulator.h"
+#include "core/ConsoleOutput.h"
+#include "core/HostProfiler.h"
+#include "emulator/EngineTypes.h"
+#include "emulator/MemoryMap.h"
+#include <algorithm>
+#include <array>
+
+namespace {
+    bool SameLines(const LineStrips& a, const LineStrips& b) {
+        return a.NumPoints() == b.NumPoints() && a.NumStrips() == b.NumStrips() &&
+               std::equal(a.PointsX(), a.PointsX() + a.NumPoints(), b.PointsX()) &&
+               std::equal(a.PointsY(), a.PointsY() + a.NumPoints(), b.PointsY()) &&
+               std::equal(a.StripFirstPoints(), a.StripFirstPoints() + a.NumStrips(),
+                          b.StripFirstPoints()) &&
+               std::equal(a.StripBrightnesses(), a.StripBrightnesses() + a.NumStrips(),
+                          b.StripBrightnesses());
+    }
+
+    using RamContents = std::array<uint8_t, MemoryMap::Ram.logicalSize>;
+
+    RamContents ReadRam(const MemoryBus& memoryBus) {
+        RamContents result;
+        for (size_t i = 0; i < result.size(); ++i)
+            result[i] = memoryBus.ReadRaw(static_cast<uint16_t>(MemoryMap::Ram.range.first + i));
+        return result;
+    }
+} // namespace
 
 void Emulator::Init(const char* biosRomFile) {
     // TODO: config option
@@ -15,21 +42,35 @@ void Emulator::Init(const char* biosRomFile) {
         m_unmapped.Init(m_memoryBus);
     }
     m_cartridge.Init(m_memoryBus);
+    m_idleLoopSkipper.Init(m_memoryBus);
+    m_via.SetPB6Callback([this](bool high) { m_cartridge.SelectBank(high ? 1 : 0); });
 
     LoadBios(biosRomFile);
 }
 
 void Emulator::Reset() {
+    Reset(std::random_device{}());
+}
+
+void Emulator::Reset(unsigned int ramSeed) {
     // Some games rely on initial random state of memory (e.g. Mine Storm)
-    const unsigned int seed = std::random_device{}();
-    m_ram.Randomize(seed);
+    m_ram.Randomize(ramSeed);
 
     m_cpu.Reset();
     m_via.Reset();
 }
 
 bool Emulator::LoadBios(const char* file) {
-    return m_biosRom.LoadBiosRom(file);
+    if (!m_biosRom.LoadBiosRom(file))
+        return false;
+    if (m_biosHleMode != BiosHle::Mode::Off && !m_biosHle.Init(m_memoryBus))
+        Errorf("BIOS HLE not supported for this BIOS, emulating it\n");
+    return true;
+}
+
+bool Emulator::SetBiosHleMode(BiosHle::Mode mode) {
+    m_biosHleMode = mode;
+    return mode == BiosHle::Mode::Off || m_biosHle.Init(m_memoryBus);
 }
 
 bool Emulator::LoadRom(const char* file) {
@@ -37,17 +78,100 @@ bool Emulator::LoadRom(const char* file) {
 }
 
 cycles_t Emulator::ExecuteInstruction(const Input& input, RenderContext& renderContext,
-                                      AudioContext& audioContext) {
+                                      AudioContext& audioContext, cycles_t maxCycles) {
+    HOST_PROFILE_SCOPE(Cpu);
     m_via.SetSyncContext(input, renderContext, audioContext);
 
+    if (maxCycles > 0 && m_idleLoopSkipping) {
+        if (const cycles_t cycles =
+                m_idleLoopSkipper.CyclesToSkip(m_cpu.Registers(), m_via, maxCycles)) {
+            m_memoryBus.AddSyncCycles(cycles);
+            m_memoryBus.Sync();
+            return cycles;
+        }
+    }
+
+    // BiosHle doesn't handle interrupts, so only take over while they're masked, as they are when
+    // the BIOS draws
+    if (maxCycles > 0 && m_biosHleMode != BiosHle::Mode::Off) {
+        const auto& registers = m_cpu.Registers();
+        if (registers.CC.InterruptMask && registers.CC.FastInterruptMask &&
+            m_biosHle.IsEntryPoint(registers.PC)) {
+            // Validating emulates the routine with nested ExecuteInstruction calls, which already
+            // count their cycles
+            if (m_biosHleMode == BiosHle::Mode::Validate)
+                return ValidateBiosHle(input, renderContext, audioContext, maxCycles);
+            const cycles_t cycles = ExecuteBiosHle(maxCycles);
+            m_idleLoopSkipper.AddCycles(cycles);
+            return cycles;
+        }
+    }
+
     cycles_t cpuCycles = m_cpu.ExecuteInstruction(m_via.IrqEnabled(), m_via.FirqEnabled());
 
     // Sync all devices to consume any leftover CPU cycles
     m_memoryBus.Sync();
 
+    m_idleLoopSkipper.AddCycles(cpuCycles);
     return cpuCycles;
 }
 
+cycles_t Emulator::ExecuteBiosHle(cycles_t maxCycles) {
+    CpuRegisters registers = m_cpu.Registers();
+    const cycles_t cycles = m_biosHle.Execute(registers, maxCycles);
+    m_cpu.SetRegisters(registers);
+    m_memoryBus.Sync();
+    return cycles;
+}
+
+cycles_t Emulator::ValidateBiosHle(const Input& input, RenderContext& renderContext,
+                                   AudioContext& audioContext, cycles_t maxCycles) {
+    // Save everything a routine can change, run it natively, then go back and emulate the same
+    // cycles instead, and compare. The emulated results are kept.
+    const CpuRegisters startRegisters = m_cpu.Registers();
+    const Via startVia = m_via;
+    const Ram startRam = m_ram;
+    const size_t startBank = m_cartridge.GetBank();
+    const LineStrips startLines = renderContext.lines;
+    const std::vector<float> startSamples = audioContext.samples;
+
+    const cycles_t hleCycles = ExecuteBiosHle(maxCycles);
+    const CpuRegisters hleRegisters = m_cpu.Registers();
+    const RamContents hleRam = ReadRam(m_memoryBus);
+    const LineStrips hleLines = renderContext.lines;
+    const std::vector<float> hleSamples = audioContext.samples;
+
+    m_cpu.SetRegisters(startRegisters);
+    m_via = startVia;
+    m_ram = startRam;
+    m_cartridge.SelectBank(startBank);
+    renderContext.lines = startLines;
+    audioContext.samples = startSamples;
+
+    cycles_t cycles = 0;
+    while (cycles < hleCycles)
+        cycles += ExecuteInstruction(input, renderContext, audioContext);
+
+    const char* mismatch = nullptr;
+    if (cycles != hleCycles)
+        mismatch = "cycles";
+    else if (m_cpu.Registers() != hleRegisters)
+        mismatch = "registers";
+    else if (ReadRam(m_memoryBus) != hleRam)
+        mismatch = "RAM";
+    else if (!SameLines(renderContext.lines, hleLines))
+        mismatch = "lines";
+    else if (audioContext.samples != hleSamples)
+        mismatch = "audio";
+
+    if (mismatch) {
+        ++m_biosHle.GetStats().numMismatches;
+        Errorf("BIOS HLE mismatch in %s ($%04x): %s differ\n",
+               BiosHle::RoutineName(startRegisters.PC), startRegisters.PC, mismatch);
+    }
+    return cycles;
+}
+
 void Emulator::FrameUpdate(double frameTime) {
     m_via.FrameUpdate(frameTime);
 }
@@ -0,0 +1,71 @@
+#include "emulator/HeatMap.h"
+#include <algorithm>
+#include <fstream>
+#include <numeric>
+
+HeatMap::HeatMap()
+    : m_counts(static_cast<size_t>(Kind::Count)) {
+    Clear();
+}
+
+const char* HeatMap::KindName(Kind kind) {
+    switch (kind) {
+    case Kind::Execute:
+        return "pc";
+    case Kind::Read:
+        return "reads";
+    case Kind::Write:
+        return "writes";
+    case Kind::Count:
+        break;
+    }
+    return "INVALID";
+}
+
+void HeatMap::Clear() {
+    for (auto& counts : m_counts)
+        counts.fill(0);
+}
+
+uint64_t HeatMap::Total(Kind kind) const {
+    const auto& counts = GetCounts(kind);
+    return std::accumulate(counts.begin(), counts.end(), uint64_t{0});
+}
+
+std::vector<HeatMap::Entry> HeatMap::Hottest(Kind kind, size_t maxEntries) const {
+    const auto& counts = GetCounts(kind);
+    std::vector<Entry> result;
+    for (size_t address = 0; address < counts.size(); ++address) {
+        if (counts[address] > 0)
+            result.push_back({static_cast<uint16_t>(address), counts[address]});
+    }
+
+    auto ByCount = [](const Entry& a, const Entry& b) {
+        return a.count > b.count || (a.count == b.count && a.address < b.address);
+    };
+    if (result.size() > maxEntries) {
+        std::partial_sort(result.begin(), result.begin() + maxEntries, result.end(), ByCount);
+        result.resize(maxEntries);
+    } else {
+        std::sort(result.begin(), result.end(), ByCount);
+    }
+    return result;
+}
+
+bool HeatMap::Save(Kind kind, const fs::path& file) const {
+    std::ofstream fout(file, std::ios::binary);
+    if (!fout)
+        return false;
+
+    const auto& counts = GetCounts(kind);
+    std::vector<uint8_t> data(counts.size() * 4);
+    for (size_t i = 0; i < counts.size(); ++i) {
+        data[i * 4 + 0] = static_cast<uint8_t>(counts[i]);
+        data[i * 4 + 1] = static_cast<uint8_t>(counts[i] >> 8);
+        data[i * 4 + 2] = static_cast<uint8_t>(counts[i] >> 16);
+        data[i * 4 + 3] = static_cast<uint8_t>(counts[i] >> 24);
+    }
+    fout.write(reinterpret_cast<const char*>(data.data()),
+               static_cast<std::streamsize>(data.size()));
+    return static_cast<bool>(fout);
+}
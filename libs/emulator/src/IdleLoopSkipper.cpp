@@ -0,0 +1,144 @@
+#include "emulator/IdleLoopSkipper.h"
+#include "emulator/CpuHelpers.h"
+#include "emulator/CpuOpCodes.h"
+#include "emulator/MemoryBus.h"
+#include "emulator/MemoryMap.h"
+#include "emulator/Via.h"
+#include <algorithm>
+
+namespace {
+    // Longest loop considered, in bytes from its start to the branch back
+    const int MaxLoopSize = 16;
+
+    // Instructions that change nothing but registers, and read memory at most
+    bool IsAllowedOpCode(uint8_t opCode) {
+        switch (opCode) {
+        case 0x12: // NOP
+        case 0x4D: // TSTA
+        case 0x5D: // TSTB
+        case 0x0D: // TST
+        case 0x7D:
+        case 0x81: // CMPA
+        case 0x91:
+        case 0xB1:
+        case 0xC1: // CMPB
+        case 0xD1:
+        case 0xF1:
+        case 0x84: // ANDA
+        case 0x94:
+        case 0xB4:
+        case 0xC4: // ANDB
+        case 0xD4:
+        case 0xF4:
+        case 0x85: // BITA
+        case 0x95:
+        case 0xB5:
+        case 0xC5: // BITB
+        case 0xD5:
+        case 0xF5:
+        case 0x86: // LDA
+        case 0x96:
+        case 0xB6:
+        case 0xC6: // LDB
+        case 0xD6:
+        case 0xF6:
+            return true;
+        }
+        return false;
+    }
+
+    // Reads that have no side effects, of memory that only the CPU changes, or of the VIA's
+    // interrupt flag and enable registers
+    bool IsAllowedRead(uint16_t address) {
+        if (MemoryMap::Via.range.first <= address && address <= MemoryMap::Via.range.second) {
+            const auto index = MemoryMap::Via.MapAddress(address);
+            return index == 0xD || index == 0xE;
+        }
+        for (auto& mapping : {MemoryMap::Cartridge, MemoryMap::Ram, MemoryMap::Bios}) {
+            if (mapping.range.first <= address && address <= mapping.range.second)
+                return true;
+        }
+        return false;
+    }
+} // namespace
+
+cycles_t IdleLoopSkipper::CyclesToSkip(const CpuRegisters& registers, const Via& via,
+                                       cycles_t maxCycles) {
+    const uint16_t pc = registers.PC;
+    const uint16_t lastPC = m_lastPC;
+    m_lastPC = pc;
+
+    if (m_inLoop && (pc < m_loop.start || pc > m_loop.branch))
+        m_inLoop = false;
+
+    if (m_inLoop && pc == m_loop.start) {
+        // Back at the start after an iteration. If it changed nothing, neither will the next ones.
+        const uint8_t interruptFlags = via.GetInterruptFlagValue();
+        if (registers == m_startRegisters && interruptFlags == m_startInterruptFlags) {
+            const cycles_t iterationCycles = m_cyclesSinceLoopStart;
+            const cycles_t maxSkipCycles =
+                std::min(maxCycles, via.CyclesUntilInterruptFlagsChange());
+            const cycles_t cycles = maxSkipCycles / iterationCycles * iterationCycles;
+            if (cycles > 0) {
+                ++m_stats.numSkips;
+                m_stats.numCyclesSkipped += cycles;
+                return cycles;
+            }
+        }
+        StartIteration(registers, interruptFlags);
+        return 0;
+    }
+
+    // Jumping back a short way may be the end of a loop's first iteration. Loops that aren't idle
+    // keep their analysis while they run.
+    if (pc < lastPC && lastPC - pc <= MaxLoopSize) {
+        if (pc != m_loop.start || registers.DP != m_loop.dp || m_loop.idle)
+            m_loop = Analyze(pc, registers.DP);
+        if (m_loop.idle) {
+            m_inLoop = true;
+            StartIteration(registers, via.GetInterruptFlagValue());
+        }
+    }
+    return 0;
+}
+
+IdleLoopSkipper::Loop IdleLoopSkipper::Analyze(uint16_t start, uint8_t dp) const {
+    Loop loop{start, 0, dp, false};
+
+    uint16_t pc = start;
+    while (pc >= start && pc - start <= MaxLoopSize) {
+        const uint8_t opCode = m_memoryBus->ReadRaw(pc);
+
+        // Any short branch back to the start but BRN (which never branches)
+        if (opCode >= 0x20 && opCode <= 0x2F && opCode != 0x21) {
+            const auto offset = static_cast<int8_t>(m_memoryBus->ReadRaw(pc + 1));
+            if (static_cast<uint16_t>(pc + 2 + offset) == start) {
+                loop.branch = pc;
+                loop.idle = true;
+            }
+            return loop;
+        }
+
+        if (!IsAllowedOpCode(opCode))
+            return loop;
+
+        const CpuOp& cpuOp = LookupCpuOp(0, opCode);
+        if (cpuOp.addrMode == AddressingMode::Direct &&
+            !IsAllowedRead(CombineToU16(dp, m_memoryBus->ReadRaw(pc + 1)))) {
+            return loop;
+        }
+        if (cpuOp.addrMode == AddressingMode::Extended &&
+            !IsAllowedRead(CombineToU16(m_memoryBus->ReadRaw(pc + 1),
+                                        m_memoryBus->ReadRaw(pc + 2)))) {
+            return loop;
+        }
+        pc += cpuOp.size;
+    }
+    return loop;
+}
+
+void IdleLoopSkipper::StartIteration(const CpuRegisters& registers, uint8_t interruptFlags) {
+    m_startRegisters = registers;
+    m_startInterruptFlags = interruptFlags;
+    m_cyclesSinceLoopStart = 0;
+}
@@ -84,6 +84,16 @@ namespace {
         size_t index = 0;
     };
 
+    // Histories of values plotted in the debug UI
+    struct PsgHistories {
+        static constexpr int NumHistoryValues = 5000;
+        std::array<PlotData<float, NumHistoryValues>, 3> channelHistories;
+        std::array<PlotData<float, NumHistoryValues>, 3> toneHistories;
+        std::array<PlotData<float, NumHistoryValues>, 3> noiseHistories;
+        std::array<PlotData<float, NumHistoryValues>, 3> volumeHistories;
+        PlotData<float, NumHistoryValues> envelopeHistory;
+    };
+
     // Timer used by Tone and Noise Generators
     class Timer {
     public:
@@ -320,6 +330,13 @@ namespace {
         AmplitudeControl(EnvelopeGenerator& envelopeGenerator)
             : m_envelopeGenerator(envelopeGenerator) {}
 
+        // Copies state, keeping this control's envelope generator
+        AmplitudeControl& operator=(const AmplitudeControl& rhs) {
+            m_mode = rhs.m_mode;
+            m_fixedVolume = rhs.m_fixedVolume;
+            return *this;
+        }
+
         void SetMode(AmplitudeMode mode) { m_mode = mode; }
         void SetFixedVolume(uint32_t volume) { m_fixedVolume = volume; }
 
@@ -366,6 +383,16 @@ namespace {
             , m_noiseGenerator(noiseGenerator)
             , m_amplitudeControl(envelopeGenerator) {}
 
+        // Copies state, keeping this channel's generators
+        PsgChannel& operator=(const PsgChannel& rhs) {
+            m_toneEnabled = rhs.m_toneEnabled;
+            m_noiseEnabled = rhs.m_noiseEnabled;
+            m_amplitudeControl = rhs.m_amplitudeControl;
+            OverrideToneEnabled = rhs.OverrideToneEnabled;
+            OverrideNoiseEnabled = rhs.OverrideNoiseEnabled;
+            return *this;
+        }
+
         bool ToneEnabled() const { return m_toneEnabled; }
         bool NoiseEnabled() const { return m_noiseEnabled; }
         void SetToneEnabled(bool enabled) { m_toneEnabled = enabled; }
@@ -427,6 +454,12 @@ namespace {
 class PsgImpl {
 public:
     PsgImpl();
+    // Copies are for saving and restoring state, so debug UI state isn't copied
+    PsgImpl(const PsgImpl& rhs)
+        : PsgImpl() {
+        *this = rhs;
+    }
+    PsgImpl& operator=(const PsgImpl& rhs);
     void Init();
 
     void SetBDIR(bool enable) { m_BDIR = enable; }
@@ -470,6 +503,9 @@ private:
     NoiseGenerator m_noiseGenerator{};
     EnvelopeGenerator m_envelopeGenerator{};
     std::array<PsgChannel, 3> m_channels;
+
+    bool m_imGuiEnabled = false;
+    std::unique_ptr<PsgHistories> m_histories; // Only allocated when shown in debug UI
 };
 
 PsgImpl::PsgImpl()
@@ -477,6 +513,21 @@ PsgImpl::PsgImpl()
                  PsgChannel{m_toneGenerators[1], m_noiseGenerator, m_envelopeGenerator},
                  PsgChannel{m_toneGenerators[2], m_noiseGenerator, m_envelopeGenerator}} {}
 
+PsgImpl& PsgImpl::operator=(const PsgImpl& rhs) {
+    m_mode = rhs.m_mode;
+    m_BDIR = rhs.m_BDIR;
+    m_BC1 = rhs.m_BC1;
+    m_DA = rhs.m_DA;
+    m_latchedAddress = rhs.m_latchedAddress;
+    m_registers = rhs.m_registers;
+    m_masterDivider = rhs.m_masterDivider;
+    m_toneGenerators = rhs.m_toneGenerators;
+    m_noiseGenerator = rhs.m_noiseGenerator;
+    m_envelopeGenerator = rhs.m_envelopeGenerator;
+    m_channels = rhs.m_channels;
+    return *this;
+}
+
 void PsgImpl::Init() {
     Reset();
 }
@@ -507,9 +558,8 @@ void PsgImpl::Update(cycles_t cycles) {
 
 void PsgImpl::FrameUpdate(double frameTime) {
     // Debug output
-    static bool PsgImGui = false;
-    IMGUI_CALL(Debug, ImGui::Checkbox("<<< Psg >>>", &PsgImGui));
-    if (PsgImGui) {
+    IMGUI_CALL(Debug, ImGui::Checkbox("<<< Psg >>>", &m_imGuiEnabled));
+    if (m_imGuiEnabled) {
         auto IndexToChannelName = [](auto index) {
             switch (index) {
             case 0:
@@ -526,12 +576,13 @@ void PsgImpl::FrameUpdate(double frameTime) {
             return FormattedString<>("%s##%d", name, (int)index);
         };
 
-        const int NumHistoryValues = 5000;
-        static std::array<PlotData<float, NumHistoryValues>, 3> channelHistories;
-        static std::array<PlotData<float, NumHistoryValues>, 3> toneHistories;
-        static std::array<PlotData<float, NumHistoryValues>, 3> noiseHistories;
-        static std::array<PlotData<float, NumHistoryValues>, 3> volumeHistories;
-        static PlotData<float, NumHistoryValues> envelopeHistory;
+        if (!m_histories)
+            m_histories = std::make_unique<PsgHistories>();
+        auto& channelHistories = m_histories->channelHistories;
+        auto& toneHistories = m_histories->toneHistories;
+        auto& noiseHistories = m_histories->noiseHistories;
+        auto& volumeHistories = m_histories->volumeHistories;
+        auto& envelopeHistory = m_histories->envelopeHistory;
 
         for (size_t i = 0; i < m_channels.size(); ++i) {
             auto& channel = m_channels[i];
@@ -736,6 +787,8 @@ void PsgImpl::Write(uint16_t address, uint8_t value) {
 
 Psg::Psg() = default;
 Psg::~Psg() = default;
+Psg::Psg(const Psg&) = default;
+Psg& Psg::operator=(const Psg&) = default;
 
 void Psg::Init() {
     m_impl->Init();
@@ -0,0 +1,89 @@
+#include "emulator/RomFile.h"
+#include "core/Hash.h"
+#include "core/Stream.h"
+#include "emulator/MemoryMap.h"
+#include <algorithm>
+#include <cstring>
+
+namespace RomFile {
+    bool IsBankSwitched(size_t romSize) {
+        return romSize > MemoryMap::Cartridge.physicalSize;
+    }
+
+    std::optional<std::vector<uint8_t>> Read(const fs::path& file) {
+        std::error_code ec;
+        const auto size = fs::file_size(file, ec);
+        if (ec)
+            return {};
+
+        FileStream fs;
+        if (!fs.Open(file, "rb"))
+            return {};
+        std::vector<uint8_t> data(static_cast<size_t>(size));
+        if (!data.empty() && !fs.Read(data.data(), data.size()))
+            return {};
+        return data;
+    }
+
+    Header ParseHeader(const std::vector<uint8_t>& data) {
+        Header header;
+
+        // The header is read from [pos, size) of data
+        size_t pos = 0;
+        size_t size = data.size();
+        if (IsBankSwitched(data.size())) {
+            pos = BootBank * BankSize;
+            size = std::min(size, pos + BankSize);
+        }
+
+        // Returns the bytes up to the next 0x80 and skips past it, or nothing if there isn't one
+        auto ReadString = [&]() -> std::optional<std::string> {
+            auto begin = data.begin() + pos;
+            auto end = std::find(begin, data.begin() + size, uint8_t{0x80});
+            if (end == data.begin() + size)
+                return {};
+            pos = (end - data.begin()) + 1;
+            return std::string{begin, end};
+        };
+
+        auto copyright = ReadString();
+        if (!copyright)
+            return header;
+        header.hasCopyright = copyright->compare(0, 5, "g GCE") == 0;
+
+        // Location of music from ROM, big endian like the 6809
+        if (pos + 2 > size)
+            return header;
+        header.musicAddress = static_cast<uint16_t>((data[pos] << 8) | data[pos + 1]);
+        pos += 2;
+
+        // Title of game is a multiline string of position, string, 0x80 as newline marker
+        const int MaxLines = 10; // Some reasonable max to look for
+        for (int line = 0; line < MaxLines; ++line) {
+            if (pos >= size)
+                return header;
+            // If first byte is 0, we're done
+            if (data[pos] == 0) {
+                header.valid = true;
+                break;
+            }
+            // Skip height, width, relative y and x
+            pos += 4;
+            if (pos > size)
+                return header;
+
+            auto text = ReadString();
+            if (!text)
+                return header;
+            if (!header.title.empty())
+                header.title += " ";
+            header.title += *text;
+        }
+
+        return header;
+    }
+
+    uint64_t ContentHash(const std::vector<uint8_t>& data) {
+        return Hash::Fnv1a(data.data(), data.size());
+    }
+} // namespace RomFile
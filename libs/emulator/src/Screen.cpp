@@ -1,20 +1,37 @@
 #include "emulator/Screen.h"
 #include "core/Gui.h"
 #include "emulator/EngineTypes.h"
+#include <cmath>
+#include <limits>
 
 namespace {
-    //@TODO: make these conditionally const for "shipping" build
-    int32_t RampUpDelay = 5;
-    int32_t RampDownDelay = 10;
-    int32_t VelocityXDelay = 6;
-    // LineDrawScale is required because introducing ramp and velX delays means we now create lines
-    // that go outside the 256x256 grid. So we scale down the line drawing values a little to make
-    // it fit within the grid again.
-    float LineDrawScale = 0.85f;
+    // How far the point the strip's last line and a line to p would share is from line ap, if the
+    // last line were extended to end at p instead. Infinite if the beam turns back.
+    float MergeError(const LineStrips& lines, const Vector2& p) {
+        const Vector2 a = lines.SecondLastPoint();
+        const Vector2 b = lines.LastPoint();
+        const Vector2 ab = b - a;
+        const Vector2 bp = p - b;
+        if (ab.x * bp.x + ab.y * bp.y < 0.f)
+            return std::numeric_limits<float>::infinity();
+        const Vector2 ap = p - a;
+        const float length = std::sqrt(ap.x * ap.x + ap.y * ap.y);
+        if (length == 0.f)
+            return 0.f;
+        return std::abs(ap.x * ab.y - ap.y * ab.x) / length;
+    }
 } // namespace
 
 void Screen::Init() {
-    m_velocityX.CyclesToUpdateValue = VelocityXDelay;
+    m_velocityX.CyclesToUpdateValue = m_tweakables.VelocityXDelay;
+}
+
+void Screen::Reset() {
+    // Keep tweakables across resets
+    const auto tweakables = m_tweakables;
+    *this = Screen{};
+    m_tweakables = tweakables;
+    Init();
 }
 
 void Screen::Update(cycles_t cycles, RenderContext& renderContext) {
@@ -27,7 +44,7 @@ void Screen::Update(cycles_t cycles, RenderContext& renderContext) {
     case RampPhase::RampDown:
         if (m_integratorsEnabled) {
             m_rampPhase = RampPhase::RampUp;
-            m_rampDelay = RampUpDelay;
+            m_rampDelay = m_tweakables.RampUpDelay;
         }
         break;
 
@@ -35,7 +52,7 @@ void Screen::Update(cycles_t cycles, RenderContext& renderContext) {
     case RampPhase::RampUp:
         if (!m_integratorsEnabled) {
             m_rampPhase = RampPhase::RampDown;
-            m_rampDelay = RampDownDelay;
+            m_rampDelay = m_tweakables.RampDownDelay;
         }
     }
 
@@ -60,7 +77,6 @@ void Screen::Update(cycles_t cycles, RenderContext& renderContext) {
     }
 
     const auto lastPos = m_pos;
-    const Vector2 currDir = Normalized({m_velocityX, m_velocityY});
 
     // Move beam while ramp is on or its way down
     switch (m_rampPhase) {
@@ -68,7 +84,8 @@ void Screen::Update(cycles_t cycles, RenderContext& renderContext) {
     case RampPhase::RampOn: {
         const auto offset = Vector2{m_xyOffset, m_xyOffset};
         Vector2 velocity{m_velocityX, m_velocityY};
-        Vector2 delta = (velocity + offset) / 128.f * static_cast<float>(cycles) * LineDrawScale;
+        Vector2 delta = (velocity + offset) / 128.f * static_cast<float>(cycles) *
+                        m_tweakables.LineDrawScale;
         m_pos += delta;
         break;
     }
@@ -80,33 +97,70 @@ void Screen::Update(cycles_t cycles, RenderContext& renderContext) {
 
     // We might draw even when integrators are disabled (e.g. drawing dots)
     bool drawingEnabled = !m_blank && (m_brightness > 0.f && m_brightness <= 128.f);
-    if (drawingEnabled) {
-        if (m_lastDrawingEnabled && (Magnitude(m_lastDir) > 0.f) && (m_lastDir == currDir) &&
-            !renderContext.lines.empty()) {
-            renderContext.lines.back().p1 = m_pos;
+    // Beam state is still tracked for skipped frames, but no lines are emitted
+    if (drawingEnabled && !renderContext.skipFrame) {
+        auto& lines = renderContext.lines;
+        const float brightness = m_brightness / 128.f;
+        // Continue the last strip if the beam is drawing from where it ended. The beam is often
+        // blanked between lines without moving, e.g. by the BIOS's Draw_VL routines, so those are
+        // still connected.
+        if (!lines.Empty() && lines.LastPoint() == lastPos &&
+            lines.LastStripBrightness() == brightness) {
+            if (m_pos == lastPos) {
+                // Beam hasn't moved, so there's nothing new to draw
+            } else if (const float error = MergeError(lines, m_pos);
+                       m_mergeError + error <= m_tweakables.LineMergeTolerance) {
+                // Points merged away before were within m_mergeError of the last line, and are
+                // within m_mergeError + error of the extended one, so the error can't build up
+                // past the tolerance over a slow turn
+                lines.SetLastPoint(m_pos);
+                m_mergeError += error;
+            } else {
+                lines.AddPoint(m_pos);
+                m_mergeError = 0.f;
+            }
         } else {
-            renderContext.lines.emplace_back(Line{lastPos, m_pos, m_brightness / 128.f});
+            lines.AddLine(Line{lastPos, m_pos, brightness});
+            m_mergeError = 0.f;
         }
     }
+}
+
+bool Screen::IsIdle(const RenderContext& renderContext) const {
+    if (m_integratorsEnabled || m_rampPhase != RampPhase::RampOff)
+        return false;
 
-    m_lastDrawingEnabled = drawingEnabled;
-    m_lastDir = currDir;
+    const bool drawingEnabled = !m_blank && (m_brightness > 0.f && m_brightness <= 128.f);
+    if (!drawingEnabled || renderContext.skipFrame)
+        return true;
+
+    const auto& lines = renderContext.lines;
+    return !lines.Empty() && lines.LastPoint() == m_pos &&
+           lines.LastStripBrightness() == m_brightness / 128.f;
+}
+
+void Screen::UpdateIdle(cycles_t cycles) {
+    m_velocityX.Update(cycles);
+    m_velocityY.Update(cycles);
 }
 
 void Screen::FrameUpdate(double /*frameTime*/) {
-    static bool ScreenImGui = false;
-    IMGUI_CALL(Debug, ImGui::Checkbox("<<< Screen >>>", &ScreenImGui));
-
-    IMGUI_CALL_IF(ScreenImGui, Debug, ImGui::SliderInt("RampUpDelay", &RampUpDelay, 0, 20));
-    IMGUI_CALL_IF(ScreenImGui, Debug, ImGui::SliderInt("RampDownDelay", &RampDownDelay, 0, 20));
-    IMGUI_CALL_IF(ScreenImGui, Debug, ImGui::SliderInt("VelocityXDelay", &VelocityXDelay, 0, 30));
-    IMGUI_CALL_IF(ScreenImGui, Debug,
-                  ImGui::SliderFloat("LineDrawScale", &LineDrawScale, 0.1f, 1.f));
-    m_velocityX.CyclesToUpdateValue = VelocityXDelay;
+    auto& t = m_tweakables;
+    IMGUI_CALL(Debug, ImGui::Checkbox("<<< Screen >>>", &t.ImGuiEnabled));
+
+    IMGUI_CALL_IF(t.ImGuiEnabled, Debug, ImGui::SliderInt("RampUpDelay", &t.RampUpDelay, 0, 20));
+    IMGUI_CALL_IF(t.ImGuiEnabled, Debug,
+                  ImGui::SliderInt("RampDownDelay", &t.RampDownDelay, 0, 20));
+    IMGUI_CALL_IF(t.ImGuiEnabled, Debug,
+                  ImGui::SliderInt("VelocityXDelay", &t.VelocityXDelay, 0, 30));
+    IMGUI_CALL_IF(t.ImGuiEnabled, Debug,
+                  ImGui::SliderFloat("LineDrawScale", &t.LineDrawScale, 0.1f, 1.f));
+    IMGUI_CALL_IF(t.ImGuiEnabled, Debug,
+                  ImGui::SliderFloat("LineMergeTolerance", &t.LineMergeTolerance, 0.f, 1.f));
+    m_velocityX.CyclesToUpdateValue = t.VelocityXDelay;
 }
 
 void Screen::ZeroBeam() {
     //@TODO: move beam towards 0,0 over time
     m_pos = {0.f, 0.f};
-    m_lastDrawingEnabled = false;
 }
@@ -1,8 +1,11 @@
 #include "emulator/Via.h"
 #include "core/BitOps.h"
 #include "core/ErrorHandler.h"
+#include "core/HostProfiler.h"
 #include "emulator/EngineTypes.h"
 #include "emulator/MemoryMap.h"
+#include <algorithm>
+#include <limits>
 
 namespace {
     enum class ShiftRegisterMode {
@@ -38,6 +41,7 @@ namespace {
         const uint8_t SoundBC1 = BITS(3);  // Bus Control 1
         const uint8_t SoundBDir = BITS(4); // Bus Direction
         const uint8_t Comparator = BITS(5);
+        const uint8_t BankSelect = BITS(6); // Cartridge port
         const uint8_t RampDisabled = BITS(7);
     } // namespace PortB
 
@@ -139,7 +143,7 @@ void Via::Reset() {
     m_periphCntl = 0;
     m_interruptEnable = 0;
 
-    m_screen = Screen{};
+    m_screen.Reset();
     m_psg.Reset();
     m_timer1 = Timer1{};
     m_timer2 = Timer2{};
@@ -152,10 +156,27 @@ void Via::Reset() {
     m_directAudioSamples.Reset();
 
     SetBits(m_portB, PortB::RampDisabled, true);
+
+    // PB6 is now an input, so pulled high; always report it
+    m_pb6High = false;
+    UpdatePB6();
+}
+
+void Via::UpdatePB6() {
+    // Pulled high while it's an input
+    const bool high =
+        !TestBits(m_dataDirB, PortB::BankSelect) || TestBits(m_portB, PortB::BankSelect);
+    if (high != m_pb6High) {
+        m_pb6High = high;
+        if (m_pb6Callback)
+            m_pb6Callback(high);
+    }
 }
 
 void Via::DoSync(cycles_t cycles, const Input& input, RenderContext& renderContext,
                  AudioContext& audioContext) {
+    HOST_PROFILE_SCOPE(Via);
+
     // Update cached input state
     m_joystickButtonState = input.ButtonStateMask();
 
@@ -177,33 +198,37 @@ void Via::DoSync(cycles_t cycles, const Input& input, RenderContext& renderConte
     m_firqEnabled = input.IsButtonDown(0, 3);
 
     // Audio update
-    for (cycles_t i = 0; i < cycles; ++i) {
-        m_psg.Update(1);
-        m_psgAudioSamples.Add(m_psg.Sample());
+    {
+        HOST_PROFILE_SCOPE(Psg);
+        for (cycles_t i = 0; i < cycles; ++i) {
+            m_psg.Update(1);
+            m_psgAudioSamples.Add(m_psg.Sample());
 
-        if (++m_elapsedAudioCycles >= audioContext.CpuCyclesPerAudioSample) {
-            m_elapsedAudioCycles -= audioContext.CpuCyclesPerAudioSample;
+            if (++m_elapsedAudioCycles >= audioContext.CpuCyclesPerAudioSample) {
+                m_elapsedAudioCycles -= audioContext.CpuCyclesPerAudioSample;
 
-            // Need a target sample...
+                // Need a target sample...
 
-            float psgSample = m_psgAudioSamples.AverageAndReset();
-            float directSample = m_directAudioSamples.AverageAndReset();
+                float psgSample = m_psgAudioSamples.AverageAndReset();
+                float directSample = m_directAudioSamples.AverageAndReset();
 
-            //@TODO: Is this right? Averaging means getting half the volume when only one source is
-            // playing, which is most of the time.
-            float targetSample = directSample != 0 ? directSample : psgSample;
-            // float targetSample = (psgSample + directSample) / 2.f;
+                //@TODO: Is this right? Averaging means getting half the volume when only one
+                // source is playing, which is most of the time.
+                float targetSample = directSample != 0 ? directSample : psgSample;
+                // float targetSample = (psgSample + directSample) / 2.f;
 
-            audioContext.samples.push_back(targetSample);
+                audioContext.samples.push_back(targetSample);
+            }
         }
     }
 
     //@TODO: Move this code into a Clock() function and call it cycles number of times
     // For cycle-accurate drawing, we update our timers, shift register, and beam movement 1 cycle
     // at a time
+    HOST_PROFILE_SCOPE(Screen);
     cycles_t cyclesLeft = cycles;
     cycles = 1;
-    while (cyclesLeft-- > 0) {
+    while (cyclesLeft > 0) {
         m_timer1.Update(cycles);
         m_timer2.Update(cycles);
         m_shiftRegister.Update(cycles);
@@ -228,9 +253,31 @@ void Via::DoSync(cycles_t cycles, const Input& input, RenderContext& renderConte
 
         // Update screen, which populates the lines in the renderContext
         m_screen.Update(cycles, renderContext);
+        --cyclesLeft;
+
+        // Skip ahead over cycles where the above would only count down timers and delays
+        if (const cycles_t idleCycles = IdleCycles(cyclesLeft, renderContext); idleCycles > 0) {
+            m_timer1.Update(idleCycles);
+            m_timer2.Update(idleCycles);
+            m_screen.UpdateIdle(idleCycles);
+            cyclesLeft -= idleCycles;
+        }
     }
 }
 
+cycles_t Via::IdleCycles(cycles_t maxCycles, const RenderContext& renderContext) const {
+    // Blank, ramp, zero and the integrators are set to the same values every cycle as long as the
+    // shift register isn't shifting and Timer1 doesn't drive /RAMP to a new level
+    if (!m_idleUpdates || maxCycles == 0 || m_shiftRegister.IsShifting() ||
+        !m_screen.IsIdle(renderContext))
+        return 0;
+    // Timers count down 16 bits at a time
+    maxCycles = std::min<cycles_t>(maxCycles, std::numeric_limits<uint16_t>::max());
+    if (m_timer1.PB7Flag())
+        return std::min(maxCycles, m_timer1.CyclesUntilExpired() - 1);
+    return maxCycles;
+}
+
 void Via::FrameUpdate(double frameTime) {
     m_screen.FrameUpdate(frameTime);
     m_psg.FrameUpdate(frameTime);
@@ -373,6 +420,7 @@ void Via::Write(uint16_t address, uint8_t value) {
         m_portB = value;
         UpdateIntegrators();
         UpdatePsg();
+        UpdatePB6();
         break;
 
     case Register::PortA:
@@ -388,6 +436,7 @@ void Via::Write(uint16_t address, uint8_t value) {
 
     case Register::DataDirB:
         m_dataDirB = value;
+        UpdatePB6();
         break;
 
     case Register::DataDirA:
@@ -512,6 +561,22 @@ bool Via::IrqEnabled() const {
     return TestBits(GetInterruptFlagValue(), InterruptFlag::IrqEnabled);
 }
 
+cycles_t Via::CyclesUntilInterruptFlagsChange() const {
+    // CA1 and FIRQ follow the input, which only changes between syncs
+    const Input& input = *m_syncContext.input;
+    if (input.IsButtonDown(1, 3) != m_ca1Enabled || input.IsButtonDown(0, 3) != m_firqEnabled)
+        return 0;
+
+    cycles_t result = std::numeric_limits<cycles_t>::max();
+    if (!m_timer1.InterruptFlag())
+        result = std::min(result, m_timer1.CyclesUntilExpired());
+    if (!m_timer2.InterruptFlag())
+        result = std::min(result, m_timer2.CyclesUntilExpired());
+    if (!m_shiftRegister.InterruptFlag() && m_shiftRegister.IsShifting())
+        result = std::min(result, m_shiftRegister.CyclesUntilDone());
+    return result;
+}
+
 bool Via::FirqEnabled() const {
     return m_firqEnabled;
 }
@@ -0,0 +1,109 @@
+#pragma once
+
+#include "core/Line.h"
+#include "core/LineStrips.h"
+#include "core/Vector2.h"
+#include <cstdint>
+#include <vector>
+
+// Matches each frame's lines against the previous frame's, so that renderers and streaming
+// consumers can skip geometry that hasn't changed. Most Vectrex games redraw nearly the same
+// vectors every frame, so a frame's delta is usually a small fraction of its lines.
+//
+// Lines are matched on end points and brightness quantized to a grid of cellSize units, so that
+// beam drift within a cell doesn't count as a change. Each line is tagged:
+// - Unchanged: a line of the previous frame has the same quantized end points (drawn either way)
+// - Moved: one has the same quantized shape somewhere else, e.g. a sprite that moved
+// - New: neither
+// A line of the previous frame matches at most one line; those left unmatched were removed.
+class DisplayListDiff {
+public:
+    // 1/1024 of the screen, which is less than a pixel at common window sizes
+    static constexpr float DefaultCellSize = 0.25f;
+
+    enum class LineState : uint8_t { Unchanged, Moved, New };
+
+    struct LineDelta {
+        LineState state = LineState::New;
+        uint32_t prevIndex{}; // Unchanged and Moved: index of matching line in the previous frame
+        Vector2 offset{};     // Moved: translation from the matching line to this one
+    };
+
+    // A line's end points in cells and brightness in 1/128ths. End points are ordered so that the
+    // same line drawn in either direction quantizes the same. An Unchanged line's quantized values
+    // are equal to its matching line's, and a Moved line's differ by a whole number of cells.
+    struct QuantizedLine {
+        int32_t x0{}, y0{}, x1{}, y1{};
+        int32_t brightness{};
+        bool reversed{}; // End points were swapped
+
+        uint64_t PositionHash() const;
+        uint64_t ShapeHash() const;
+        bool SamePosition(const QuantizedLine& other) const;
+        bool SameShape(const QuantizedLine& other) const;
+    };
+
+    struct Stats {
+        size_t numUnchanged{};
+        size_t numMoved{};
+        size_t numNew{};
+        size_t numRemoved{};
+    };
+
+    explicit DisplayListDiff(float cellSize = DefaultCellSize);
+
+    // Diffs lines against those passed to the previous call. The first call, or the first after
+    // Reset(), reports all lines as new.
+    void Update(const LineStrips& lines);
+    void Reset();
+
+    // Lines passed to the last Update, in LineStrips::ForEachLine order
+    const std::vector<Line>& Lines() const { return m_lines; }
+    // Each of Lines(), quantized
+    const std::vector<QuantizedLine>& QuantizedLines() const { return m_quantized; }
+    // Delta of each of Lines()
+    const std::vector<LineDelta>& Deltas() const { return m_deltas; }
+    // Indices of the previous frame's lines that no longer exist, in ascending order
+    const std::vector<uint32_t>& RemovedLines() const { return m_removedLines; }
+    const Stats& GetStats() const { return m_stats; }
+
+private:
+    // Chains the previous frame's lines by hash, in an open-addressed table of chain heads with the
+    // links stored per line. Rebuilding it doesn't allocate once it has grown to fit a frame.
+    class LineIndex {
+    public:
+        static constexpr uint32_t End = ~0u;
+
+        void Clear(size_t numLines);
+        // Lines added last are visited first
+        void Add(uint64_t hash, uint32_t lineIndex);
+        uint32_t First(uint64_t hash) const;
+        uint32_t Next(uint32_t lineIndex) const { return m_next[lineIndex]; }
+
+    private:
+        struct Slot {
+            uint64_t hash{};
+            uint32_t head = End;
+        };
+        size_t FindSlot(uint64_t hash) const;
+
+        std::vector<Slot> m_slots; // Power of 2 size
+        std::vector<uint32_t> m_next;
+    };
+
+    QuantizedLine Quantize(const Line& line) const;
+    void MatchUnchanged();
+    void MatchMoved();
+
+    const float m_invCellSize;
+    std::vector<Line> m_lines;
+    std::vector<QuantizedLine> m_quantized;
+    std::vector<Line> m_prevLines;
+    std::vector<QuantizedLine> m_prevQuantized;
+    std::vector<bool> m_prevMatched;
+    LineIndex m_positionIndex;
+    LineIndex m_shapeIndex;
+    std::vector<LineDelta> m_deltas;
+    std::vector<uint32_t> m_removedLines;
+    Stats m_stats;
+};
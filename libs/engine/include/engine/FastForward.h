@@ -0,0 +1,26 @@
+#pragma once
+
+#include "engine/EngineClient.h"
+#include <vector>
+
+// Fast-forward by frame skipping: for each presented frame, the client emulates several frames,
+// and only the last one produces lines. Audio from all of them is decimated down to one frame's
+// worth so that the audio buffer doesn't overflow.
+class FastForward {
+public:
+    static constexpr int Unthrottled = 0; // Speed that runs as many frames as time allows
+    static constexpr int MaxSpeed = 10;
+
+    // Calls client.FrameUpdate once for speed 1, speed times for higher speeds, or as many times as
+    // fit in timeBudget seconds when unthrottled. emuEvents are only passed to the first call.
+    // Returns false if the client asked to quit.
+    bool FrameUpdate(IEngineClient& client, double frameTime, int speed, double timeBudget,
+                     const EmuContext& emuContext, const Input& input,
+                     RenderContext& renderContext, AudioContext& audioContext);
+
+    // Reduces samples to 1/factor of their count by averaging each group of factor samples
+    static void DecimateSamples(std::vector<float>& samples, int factor);
+
+private:
+    double m_frameCost = 0; // Running average of seconds per emulated frame
+};
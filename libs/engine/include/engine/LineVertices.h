@@ -0,0 +1,76 @@
+#pragma once
+
+#include "core/Base.h"
+#include "core/Line.h"
+#include "core/LineStrips.h"
+#include "core/Vector2.h"
+#include <vector>
+
+// Converts the lines output by the emulator into vertex arrays that can be uploaded as-is to the
+// GPU. This is kept independent of any graphics API so that it can be benchmarked without one.
+namespace LineVertices {
+    struct VertexData {
+        Vector2 v{};
+        float brightness{};
+    };
+
+    // Vertex storage meant to be kept and reused across frames. It grows to fit the largest frame
+    // seen and is never shrunk, so generating vertices doesn't allocate in the steady state. Only
+    // the first Size() vertices are valid.
+    class VertexArray {
+    public:
+        const VertexData* Data() const { return m_vertices.data(); }
+        size_t Size() const { return m_size; }
+        bool Empty() const { return m_size == 0; }
+
+        // Discards the current contents and returns storage for up to maxSize vertices. Call
+        // SetSize() with the number of vertices actually written.
+        VertexData* Prepare(size_t maxSize) {
+            if (m_vertices.size() < maxSize)
+                m_vertices.resize(maxSize);
+            m_size = 0;
+            return m_vertices.data();
+        }
+
+        void SetSize(size_t size) {
+            ASSERT(size <= m_vertices.size());
+            m_size = size;
+        }
+
+    private:
+        std::vector<VertexData> m_vertices;
+        size_t m_size = 0;
+    };
+
+    // Outputs 2 triangles (6 vertices) per line, expanded to lineWidth. Lines whose end points are
+    // (nearly) the same are output as square dots of lineWidth size.
+    void CreateQuadVertexArray(const LineStrips& lines, float lineWidth, float scaleX,
+                               float scaleY, VertexArray& result);
+
+    // Same as calling CreateQuadVertexArray for each line width, but in a single pass over lines
+    void CreateQuadVertexArrays(const LineStrips& lines, float lineWidth0, float lineWidth1,
+                                float scaleX, float scaleY, VertexArray& result0,
+                                VertexArray& result1);
+
+    // CreateQuadVertexArray without SIMD (as built with LINE_VERTICES_NO_SIMD), which must output
+    // the same vertices, for checking the SIMD path against
+    void CreateQuadVertexArrayScalar(const LineStrips& lines, float lineWidth, float scaleX,
+                                     float scaleY, VertexArray& result);
+
+    // Per-line record for instanced rendering, where each instance is expanded into a quad by the
+    // vertex shader (DrawLineInstances.vert) the same way CreateQuadVertexArray does on the CPU.
+    // Positions are in vectrex space: scaling is also left to the shader.
+    struct LineInstance {
+        Vector2 p0{};
+        Vector2 p1{};
+        float brightness{};
+    };
+    static_assert(sizeof(LineInstance) == 20);
+
+    // Writes one LineInstance per line to out, which must have room for lines.NumLines() instances
+    void PackLineInstances(const LineStrips& lines, LineInstance* out);
+
+    // Outputs line-list vertices (2 per line) and point-list vertices (1 per dot)
+    void CreateLineAndPointVertexArrays(const LineStrips& lines, float scaleX, float scaleY,
+                                        VertexArray& lineResult, VertexArray& pointResult);
+} // namespace LineVertices
@@ -1,17 +1,40 @@
 #pragma once
 
 #include "core/FileSystem.h"
+#include <cstdint>
 #include <optional>
+#include <string>
 #include <vector>
 
 class Overlays {
 public:
-    void LoadOverlays(const fs::path& overlaysDir);
+    // Finds the overlay images in overlaysDir. If indexFile is set, the list is read from it
+    // instead while the overlay directories are unchanged since it was written (by modification
+    // time), and it is rewritten otherwise, so that startup doesn't walk the directory tree.
+    void LoadOverlays(const fs::path& overlaysDir, const fs::path& indexFile = {});
+
+    // Returns the overlay whose name best matches romFile's, if any is close enough
     std::optional<fs::path> FindOverlay(const char* romFile);
 
 private:
     struct OverlayFile {
         fs::path path;
+        std::string key; // Normalized name used for matching
+    };
+
+    struct OverlayDir {
+        fs::path path;
+        int64_t lastWriteTime{};
     };
+
+    bool LoadIndex(const fs::path& overlaysDir, const fs::path& indexFile);
+    void SaveIndex(const fs::path& overlaysDir, const fs::path& indexFile) const;
+    void AddOverlayFile(fs::path path);
+
     std::vector<OverlayFile> m_overlayFiles;
+    std::vector<OverlayDir> m_overlayDirs;
+
+    // Levenshtein distance rows, reused across matches
+    std::vector<int> m_prevRow;
+    std::vector<int> m_currRow;
 };
@@ -17,4 +17,7 @@ namespace Paths {
 
     inline const fs::path optionsFile = userDir / "options.txt";
     inline const fs::path imguiIniFile = userDir / "imgui.ini";
+    inline const fs::path overlayIndexFile = userDir / "overlays.idx";
+    inline const fs::path overlayCacheDir = userDir / "overlay_cache";
+    inline const fs::path romLibraryFile = userDir / "rom_library.txt";
 } // namespace Paths
@@ -0,0 +1,47 @@
+#pragma once
+
+#include "core/FileSystem.h"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Index of the roms under a directory, for listing a whole rom collection. Each rom is identified
+// by a hash of its contents, and described by its header's title and whether the header is valid.
+//
+// The index is cached in a manifest file. On Scan, roms whose size and modification time match the
+// manifest aren't read again, and the rest are read and hashed in parallel, so rescanning a large
+// collection that hasn't changed only costs listing it. Roms that fail to read are left out of the
+// index and the manifest, so that they're read again on the next Scan.
+class RomLibrary {
+public:
+    struct Entry {
+        fs::path path;
+        uint64_t size{};
+        int64_t lastWriteTime{};
+        uint64_t contentHash{};
+        std::string title;
+        bool validHeader = false;
+    };
+
+    struct ScanStats {
+        size_t numRead{};   // New or changed roms
+        size_t numCached{}; // Roms taken from the manifest
+        size_t numFailed{}; // Roms that couldn't be read, which aren't in Entries
+    };
+
+    // Finds the .vec and .bin files under romsDir. If manifestFile is set, it's used as described
+    // above, and rewritten if anything changed. If numThreads is 0, uses one thread per hardware
+    // thread.
+    ScanStats Scan(const fs::path& romsDir, const fs::path& manifestFile = {},
+                   size_t numThreads = 0);
+
+    // Sorted by path
+    const std::vector<Entry>& Entries() const { return m_entries; }
+
+    // Entries with the given contents, e.g. copies of a rom under different names
+    std::vector<const Entry*> FindByContentHash(uint64_t contentHash) const;
+
+private:
+    std::vector<Entry> m_entries;
+};
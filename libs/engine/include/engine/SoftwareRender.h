@@ -0,0 +1,64 @@
+#pragma once
+
+#include "core/Pimpl.h"
+#include <cstddef>
+#include <cstdint>
+
+struct RenderContext;
+
+// Renders RenderContext::lines on the CPU, for headless use where there's no GPU (screenshots,
+// video capture, visual regression tests). It reproduces GLRender's passes: thick anti-aliased
+// lines, phosphor decay, separable glow and the overlay composite.
+//
+// The CRT area is split into tiles that lines are binned into, and tiles are rasterized in
+// parallel on a WorkerPool. The output is an RGBA framebuffer of the screen, top row first.
+class SoftwareRender {
+public:
+    // Defaults match GLRender's
+    struct Config {
+        float crtScaleX = 1.f;
+        float crtScaleY = 0.8f;
+        float lineWidthNormal = 0.4f;
+        float lineWidthGlow = 1.f;
+        float glowRadius = 1.2f;
+        float darkenSpeedScale = 3.f;
+        float overlayAlpha = 1.f;
+        bool enableBlur = true;
+    };
+
+    // Screen width that matches the overlay aspect ratio for the given height, as GLRender uses
+    static int ScreenWidthForHeight(int screenHeight);
+
+    SoftwareRender();
+    ~SoftwareRender();
+
+    // numThreads includes the calling thread; 0 means one per hardware thread
+    void Initialize(int screenWidth, int screenHeight, size_t numThreads = 0);
+
+    Config& GetConfig();
+
+    // Loads the overlay image drawn over the screen; pass nullptr to remove it. Returns false on
+    // failure, in which case there is no overlay.
+    bool ResetOverlay(const char* file = nullptr);
+
+    // Renders a frame. frameTime drives phosphor decay; pass 0 when paused.
+    void RenderScene(double frameTime, const RenderContext& renderContext);
+
+    // Number of frames of frameTime after which anything drawn has faded out, so that older frames
+    // no longer visibly affect the output. Returns 0 if lines never fade.
+    int FramesToFade(double frameTime) const;
+
+    // Clears the phosphor, as if everything drawn so far had faded out. Callers that only need
+    // some frames can skip rendering the rest, then Clear and render the last FramesToFade
+    // frames before each one they need.
+    void Clear();
+
+    int Width() const;
+    int Height() const;
+
+    // RGBA8 pixels of the last rendered frame, Width() * Height() * 4 bytes, top row first
+    const uint8_t* Pixels() const;
+
+private:
+    pimpl::Pimpl<class SoftwareRenderImpl, 1024> m_impl;
+};
@@ -0,0 +1,75 @@
+#pragma once
+
+#include "core/LineStrips.h"
+#include "engine/DisplayListDiff.h"
+#include <cstdint>
+#include <vector>
+
+// Wire format for streaming an emulator's output to remote viewers: each frame's lines, quantized,
+// and its audio samples. Most frames are sent as deltas against the previous message's lines,
+// with a full keyframe periodically and whenever a viewer connects.
+//
+// Each message is a uint32 payload size followed by the payload, with values in native byte order
+// (little-endian on all supported platforms):
+//
+//   uint32 magic, uint8 type (Keyframe or Delta), uint32 frame index
+//   Keyframe: uint32 numLines, then numLines lines
+//   Delta:    uint32 numOps, then ops that build the lines from the previous message's:
+//     Copy: uint8 op, uint32 first, uint32 count              - previous lines [first, first+count)
+//     Move: uint8 op, uint32 first, uint32 count, int16 dx, dy - the same, translated by dx, dy
+//     Add:  uint8 op, uint32 count, then count lines
+//   uint32 numSamples, then numSamples int16 audio samples
+//
+// A line is int16 x0, y0, x1, y1 in cells of DisplayListDiff::DefaultCellSize and uint8
+// brightness in 1/128ths. Lines are quantized the way DisplayListDiff matches them, so applying
+// a delta reproduces the quantized lines exactly.
+namespace VectorStream {
+    const uint32_t Magic = 0x53585856; // "VXXS"
+    const uint16_t DefaultPort = 9124;
+    const float CellSize = DisplayListDiff::DefaultCellSize;
+
+    // Upper bound on a message's payload, so that a corrupt size can't exhaust memory
+    const uint32_t MaxPayloadSize = 16 * 1024 * 1024;
+
+    enum class MessageType : uint8_t { Keyframe, Delta };
+
+    class Encoder {
+    public:
+        // Encodes a frame into message, replacing its contents. Deltas are against the frame
+        // encoded by the previous call, so every encoded message must be sent.
+        void Encode(uint32_t frameIndex, const LineStrips& lines, const std::vector<float>& samples,
+                    bool keyframe, std::vector<uint8_t>& message);
+
+        // Size of the last message had it been a keyframe, for reporting compression
+        size_t LastKeyframeSize() const { return m_lastKeyframeSize; }
+
+    private:
+        DisplayListDiff m_diff;
+        std::vector<DisplayListDiff::QuantizedLine> m_prevLines;
+        size_t m_lastKeyframeSize{};
+    };
+
+    class Decoder {
+    public:
+        // Decodes a message's payload into lines and samples (replacing their contents). Returns
+        // false if the payload is invalid, or is a delta that doesn't follow a decoded message.
+        bool Decode(const uint8_t* payload, size_t size, LineStrips& lines,
+                    std::vector<float>& samples);
+
+        uint32_t FrameIndex() const { return m_frameIndex; }
+
+        // Forget the previous message, e.g. after reconnecting
+        void Reset();
+
+    private:
+        struct StreamLine {
+            int16_t x0, y0, x1, y1;
+            uint8_t brightness;
+        };
+
+        std::vector<StreamLine> m_lines;
+        std::vector<StreamLine> m_prevLines;
+        bool m_hasPrevLines = false;
+        uint32_t m_frameIndex{};
+    };
+} // namespace VectorStream
@@ -0,0 +1,63 @@
+#pragma once
+
+#include "core/BlockingQueue.h"
+#include "core/LineStrips.h"
+#include "core/Tcp.h"
+#include "engine/VectorStream.h"
+#include <atomic>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+struct RenderContext;
+struct AudioContext;
+
+// Streams the emulator's output to one remote viewer at a time over TCP, so that headless
+// instances can be watched live without rendering on the server (see VectorStream.h for the
+// format, and the SDL engine's -watch flag for the viewer).
+//
+// Frames are encoded and sent on a background thread. The emulation thread only copies each
+// frame's lines and samples into a bounded queue while a viewer is connected, and drops the frame
+// if the queue is full, so a slow viewer misses frames rather than stalling emulation. Deltas are
+// against the last frame actually sent, so dropped frames don't break the stream.
+class VectorStreamServer {
+public:
+    VectorStreamServer();
+    ~VectorStreamServer();
+
+    VectorStreamServer(const VectorStreamServer&) = delete;
+    VectorStreamServer& operator=(const VectorStreamServer&) = delete;
+
+    // Starts listening for a viewer on port
+    bool Start(uint16_t port);
+
+    // Emulation thread: queues the output of the next frame for the viewer, if there is one
+    void AddFrame(const RenderContext& renderContext, const AudioContext& audioContext);
+
+    // Disconnects the viewer and stops listening
+    void Stop();
+
+private:
+    struct Frame {
+        uint32_t index{};
+        LineStrips lines;
+        std::vector<float> samples;
+    };
+
+    void ThreadMain();
+
+    uint16_t m_port{};
+    bool m_started = false;
+    uint32_t m_numFramesAdded{};
+    TcpServer m_server;
+    BlockingQueue<Frame> m_frames;
+    std::thread m_thread;
+    std::atomic<bool> m_stopRequested{false};
+    std::atomic<bool> m_viewerConnected{false};
+
+    // Reported on Stop
+    std::atomic<size_t> m_numFramesDropped{0};
+    size_t m_numFramesSent{};
+    size_t m_numBytesSent{};
+    size_t m_numKeyframeBytes{}; // What sending every frame as a keyframe would have cost
+};
@@ -0,0 +1,198 @@
+#include "engine/DisplayListDiff.h"
+#include <algorithm>
+#include <cmath>
+#include <tuple>
+
+namespace {
+    // Brightness is quantized to the 128 levels the screen actually produces
+    const float BrightnessScale = 128.f;
+
+    // Bounds the search for the nearest moved line, as many lines can share a shape (e.g. the dots
+    // that make up text)
+    const int MaxMoveCandidates = 32;
+
+    int32_t Quantize(float value, float scale) {
+        return static_cast<int32_t>(std::lround(value * scale));
+    }
+
+    // FNV-1a over 32-bit values
+    template <size_t N>
+    uint64_t HashValues(const int32_t (&values)[N]) {
+        uint64_t hash = 0xcbf29ce484222325ull;
+        for (int32_t value : values) {
+            hash ^= static_cast<uint32_t>(value);
+            hash *= 0x100000001b3ull;
+        }
+        return hash;
+    }
+
+    int64_t SquaredDistance(int32_t x0, int32_t y0, int32_t x1, int32_t y1) {
+        const int64_t dx = x1 - x0;
+        const int64_t dy = y1 - y0;
+        return dx * dx + dy * dy;
+    }
+} // namespace
+
+void DisplayListDiff::LineIndex::Clear(size_t numLines) {
+    // At most half full, so probe sequences stay short
+    size_t numSlots = 16;
+    while (numSlots < numLines * 2)
+        numSlots *= 2;
+    m_slots.assign(numSlots, Slot{});
+    m_next.resize(numLines);
+}
+
+size_t DisplayListDiff::LineIndex::FindSlot(uint64_t hash) const {
+    // Fibonacci hashing spreads the FNV hash's low-entropy bits over the slot index
+    const size_t mask = m_slots.size() - 1;
+    size_t slot = static_cast<size_t>((hash * 0x9e3779b97f4a7c15ull) >> 32) & mask;
+    while (m_slots[slot].head != End && m_slots[slot].hash != hash)
+        slot = (slot + 1) & mask;
+    return slot;
+}
+
+void DisplayListDiff::LineIndex::Add(uint64_t hash, uint32_t lineIndex) {
+    auto& slot = m_slots[FindSlot(hash)];
+    slot.hash = hash;
+    m_next[lineIndex] = slot.head;
+    slot.head = lineIndex;
+}
+
+uint32_t DisplayListDiff::LineIndex::First(uint64_t hash) const {
+    return m_slots.empty() ? End : m_slots[FindSlot(hash)].head;
+}
+
+uint64_t DisplayListDiff::QuantizedLine::PositionHash() const {
+    const int32_t values[] = {x0, y0, x1, y1, brightness};
+    return HashValues(values);
+}
+
+uint64_t DisplayListDiff::QuantizedLine::ShapeHash() const {
+    const int32_t values[] = {x1 - x0, y1 - y0, brightness};
+    return HashValues(values);
+}
+
+bool DisplayListDiff::QuantizedLine::SamePosition(const QuantizedLine& other) const {
+    return x0 == other.x0 && y0 == other.y0 && x1 == other.x1 && y1 == other.y1 &&
+           brightness == other.brightness;
+}
+
+bool DisplayListDiff::QuantizedLine::SameShape(const QuantizedLine& other) const {
+    return x1 - x0 == other.x1 - other.x0 && y1 - y0 == other.y1 - other.y0 &&
+           brightness == other.brightness;
+}
+
+DisplayListDiff::DisplayListDiff(float cellSize)
+    : m_invCellSize(1.f / cellSize) {}
+
+void DisplayListDiff::Reset() {
+    m_lines.clear();
+    m_quantized.clear();
+    m_deltas.clear();
+    m_removedLines.clear();
+    m_stats = {};
+}
+
+DisplayListDiff::QuantizedLine DisplayListDiff::Quantize(const Line& line) const {
+    QuantizedLine q;
+    q.x0 = ::Quantize(line.p0.x, m_invCellSize);
+    q.y0 = ::Quantize(line.p0.y, m_invCellSize);
+    q.x1 = ::Quantize(line.p1.x, m_invCellSize);
+    q.y1 = ::Quantize(line.p1.y, m_invCellSize);
+    q.brightness = ::Quantize(line.brightness, BrightnessScale);
+    if (std::tie(q.x1, q.y1) < std::tie(q.x0, q.y0)) {
+        std::swap(q.x0, q.x1);
+        std::swap(q.y0, q.y1);
+        q.reversed = true;
+    }
+    return q;
+}
+
+void DisplayListDiff::Update(const LineStrips& lines) {
+    // This frame's lines become the previous frame's; swapping keeps both buffers' capacity
+    std::swap(m_lines, m_prevLines);
+    std::swap(m_quantized, m_prevQuantized);
+
+    m_lines.clear();
+    lines.AppendLines(m_lines);
+    m_quantized.resize(m_lines.size());
+    std::transform(m_lines.begin(), m_lines.end(), m_quantized.begin(),
+                   [this](const Line& line) { return Quantize(line); });
+
+    const size_t numPrevLines = m_prevLines.size();
+    m_positionIndex.Clear(numPrevLines);
+    m_shapeIndex.Clear(numPrevLines);
+    for (size_t i = numPrevLines; i-- > 0;) {
+        m_positionIndex.Add(m_prevQuantized[i].PositionHash(), static_cast<uint32_t>(i));
+        m_shapeIndex.Add(m_prevQuantized[i].ShapeHash(), static_cast<uint32_t>(i));
+    }
+    m_prevMatched.assign(numPrevLines, false);
+
+    m_deltas.assign(m_lines.size(), LineDelta{});
+    m_stats = {};
+    MatchUnchanged();
+    MatchMoved();
+
+    m_removedLines.clear();
+    for (size_t i = 0; i < numPrevLines; ++i) {
+        if (!m_prevMatched[i])
+            m_removedLines.push_back(static_cast<uint32_t>(i));
+    }
+
+    m_stats.numNew = m_lines.size() - m_stats.numUnchanged - m_stats.numMoved;
+    m_stats.numRemoved = m_removedLines.size();
+}
+
+void DisplayListDiff::MatchUnchanged() {
+    for (size_t i = 0; i < m_quantized.size(); ++i) {
+        const auto& q = m_quantized[i];
+        for (uint32_t j = m_positionIndex.First(q.PositionHash()); j != LineIndex::End;
+             j = m_positionIndex.Next(j)) {
+            if (!m_prevMatched[j] && q.SamePosition(m_prevQuantized[j])) {
+                m_prevMatched[j] = true;
+                m_deltas[i] = {LineState::Unchanged, j, {}};
+                ++m_stats.numUnchanged;
+                break;
+            }
+        }
+    }
+}
+
+void DisplayListDiff::MatchMoved() {
+    // Start point of the line, in the order its end points were quantized in
+    auto StartPoint = [](const Line& line, const QuantizedLine& q) {
+        return q.reversed ? line.p1 : line.p0;
+    };
+
+    for (size_t i = 0; i < m_quantized.size(); ++i) {
+        if (m_deltas[i].state != LineState::New)
+            continue;
+
+        const auto& q = m_quantized[i];
+        uint32_t nearest = LineIndex::End;
+        int64_t nearestDistance = 0;
+        int numCandidates = 0;
+        for (uint32_t j = m_shapeIndex.First(q.ShapeHash());
+             j != LineIndex::End && numCandidates < MaxMoveCandidates;
+             j = m_shapeIndex.Next(j)) {
+            ++numCandidates;
+            const auto& prev = m_prevQuantized[j];
+            if (m_prevMatched[j] || !q.SameShape(prev))
+                continue;
+
+            const int64_t distance = SquaredDistance(q.x0, q.y0, prev.x0, prev.y0);
+            if (nearest == LineIndex::End || distance < nearestDistance) {
+                nearest = j;
+                nearestDistance = distance;
+            }
+        }
+
+        if (nearest != LineIndex::End) {
+            m_prevMatched[nearest] = true;
+            const Vector2 offset = StartPoint(m_lines[i], q) -
+                                   StartPoint(m_prevLines[nearest], m_prevQuantized[nearest]);
+            m_deltas[i] = {LineState::Moved, nearest, offset};
+            ++m_stats.numMoved;
+        }
+    }
+}
@@ -0,0 +1,62 @@
+#include "engine/FastForward.h"
+#include "core/HostProfiler.h"
+#include <chrono>
+
+bool FastForward::FrameUpdate(IEngineClient& client, double frameTime, int speed,
+                              double timeBudget, const EmuContext& emuContext, const Input& input,
+                              RenderContext& renderContext, AudioContext& audioContext) {
+    using Clock = std::chrono::steady_clock;
+    auto SecondsSince = [](Clock::time_point start) {
+        return std::chrono::duration<double>(Clock::now() - start).count();
+    };
+    HOST_PROFILE_SCOPE(Emulate);
+
+    // Nothing to skip when paused
+    if (frameTime == 0 || speed == 1) {
+        renderContext.skipFrame = false;
+        return client.FrameUpdate(frameTime, emuContext, input, renderContext, audioContext);
+    }
+
+    EmuEvents noEmuEvents;
+    const EmuContext skippedEmuContext{std::ref(noEmuEvents), emuContext.options};
+    const size_t firstSample = audioContext.samples.size();
+    const auto startTime = Clock::now();
+
+    bool keepGoing = true;
+    int numFrames = 0;
+    for (bool lastFrame = false; keepGoing && !lastFrame; ++numFrames) {
+        // When unthrottled, present the frame that's expected to use up the rest of the budget
+        lastFrame = speed == Unthrottled ? SecondsSince(startTime) + m_frameCost >= timeBudget
+                                         : numFrames + 1 >= speed;
+        renderContext.skipFrame = !lastFrame;
+
+        const auto frameStartTime = Clock::now();
+        keepGoing = client.FrameUpdate(frameTime, numFrames == 0 ? emuContext : skippedEmuContext,
+                                       input, renderContext, audioContext);
+        m_frameCost = m_frameCost * 0.9 + SecondsSince(frameStartTime) * 0.1;
+    }
+    renderContext.skipFrame = false;
+
+    // Decimate only the samples produced here, in case some were already in the buffer
+    std::vector<float> samples(audioContext.samples.begin() + firstSample,
+                               audioContext.samples.end());
+    DecimateSamples(samples, numFrames);
+    audioContext.samples.resize(firstSample);
+    audioContext.samples.insert(audioContext.samples.end(), samples.begin(), samples.end());
+
+    return keepGoing;
+}
+
+void FastForward::DecimateSamples(std::vector<float>& samples, int factor) {
+    if (factor <= 1)
+        return;
+
+    const size_t numSamples = samples.size() / factor;
+    for (size_t i = 0; i < numSamples; ++i) {
+        float sum = 0.f;
+        for (int j = 0; j < factor; ++j)
+            sum += samples[i * factor + j];
+        samples[i] = sum / factor;
+    }
+    samples.resize(numSamples);
+}
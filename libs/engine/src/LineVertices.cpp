@@ -0,0 +1,331 @@
+#include "engine/LineVertices.h"
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+
+// SSE2 is part of x64, so it's always available there. Define LINE_VERTICES_NO_SIMD to compare
+// against the scalar path.
+#if !defined(LINE_VERTICES_NO_SIMD) &&                                                             \
+    (defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+#define LINE_VERTICES_SSE2 1
+#include <emmintrin.h>
+#else
+#define LINE_VERTICES_SSE2 0
+#endif
+
+namespace {
+    using LineVertices::VertexArray;
+    using LineVertices::VertexData;
+
+    const float MinPixelDist = 1.f;
+
+    // Lines whose end points are closer than this (before scaling) are drawn as dots
+    const float MaxPointLength = 0.1f;
+
+    // A line's quad before it's expanded to a given width. The corners are q0 + u, q0 + w, q1 - u and
+    // q1 - w, with u and w scaled by half the line width. For lines, u is the unit normal and w is
+    // -u; for dots, q0 == q1 and u and w are diagonals.
+    struct Quad {
+        Vector2 q0, q1, u, w;
+        float brightness;
+    };
+
+    Quad MakeQuad(const Line& line, float scaleX, float scaleY) {
+        // If end points are close, draw a dot instead of a line. We do this before applying any
+        // scale.
+        const bool isPoint = Magnitude(line.p0 - line.p1) <= MaxPointLength;
+
+        Vector2 p0{line.p0.x * scaleX, line.p0.y * scaleY};
+        Vector2 p1{line.p1.x * scaleX, line.p1.y * scaleY};
+
+        if (isPoint) {
+            return {p0, p0, {1.f, 1.f}, {1.f, -1.f}, line.brightness};
+        }
+
+        auto v01 = p1 - p0;
+        Vector2 n = Normalized(v01);
+
+        // Make sure line gets at least one pixel coverage to ensure it gets rendered. Note that we
+        // extend p1, the end point, which means we may get some slight errors with attached lines.
+        // If we were to store "line strips" instead, we could correct the point in the strip,
+        // ensuring that strips don't get detached.
+        if (std::abs(v01.x) < MinPixelDist) {
+            p1.x = p0.x + n.x * MinPixelDist;
+        }
+        if (std::abs(v01.y) < MinPixelDist) {
+            p1.y = p0.y + n.y * MinPixelDist;
+        }
+
+        return {p0, p1, {-n.y, n.x}, {n.y, -n.x}, line.brightness};
+    }
+
+    // Writes the 2 triangles for a quad expanded by hlw (half line width)
+    VertexData* WriteQuad(VertexData* out, const Quad& quad, float hlw) {
+        const VertexData a{quad.q0 + quad.u * hlw, quad.brightness};
+        const VertexData b{quad.q0 + quad.w * hlw, quad.brightness};
+        const VertexData c{quad.q1 - quad.u * hlw, quad.brightness};
+        const VertexData d{quad.q1 - quad.w * hlw, quad.brightness};
+        out[0] = a;
+        out[1] = b;
+        out[2] = c;
+        out[3] = c;
+        out[4] = d;
+        out[5] = a;
+        return out + 6;
+    }
+
+    // Make sure line width is at least one pixel wide to ensure it gets rendered
+    float HalfLineWidth(float lineWidth) { return std::max(lineWidth, MinPixelDist) / 2.0f; }
+
+#if LINE_VERTICES_SSE2
+    // Computes the quads of 4 lines at a time, in SoA form
+    struct Quad4 {
+        __m128 q0x, q0y, q1x, q1y, ux, uy, wx, wy;
+    };
+
+    __m128 Select(__m128 mask, __m128 ifTrue, __m128 ifFalse) {
+        return _mm_or_ps(_mm_and_ps(mask, ifTrue), _mm_andnot_ps(mask, ifFalse));
+    }
+
+    __m128 Abs(__m128 v) { return _mm_andnot_ps(_mm_set1_ps(-0.f), v); }
+
+    // Takes the end points of 4 lines, before scaling
+    Quad4 MakeQuad4(__m128 lp0x, __m128 lp0y, __m128 lp1x, __m128 lp1y, __m128 scaleX,
+                    __m128 scaleY) {
+        // Same operations as MakeQuad, so that results match the scalar path exactly
+        const __m128 ldx = _mm_sub_ps(lp0x, lp1x);
+        const __m128 ldy = _mm_sub_ps(lp0y, lp1y);
+        const __m128 lLength =
+            _mm_sqrt_ps(_mm_add_ps(_mm_mul_ps(ldx, ldx), _mm_mul_ps(ldy, ldy)));
+        const __m128 isPoint = _mm_cmple_ps(lLength, _mm_set1_ps(MaxPointLength));
+
+        const __m128 p0x = _mm_mul_ps(lp0x, scaleX);
+        const __m128 p0y = _mm_mul_ps(lp0y, scaleY);
+        __m128 p1x = _mm_mul_ps(lp1x, scaleX);
+        __m128 p1y = _mm_mul_ps(lp1y, scaleY);
+
+        const __m128 v01x = _mm_sub_ps(p1x, p0x);
+        const __m128 v01y = _mm_sub_ps(p1y, p0y);
+        const __m128 length =
+            _mm_sqrt_ps(_mm_add_ps(_mm_mul_ps(v01x, v01x), _mm_mul_ps(v01y, v01y)));
+        // Dot lanes may divide by 0 here, but their results are discarded below
+        const __m128 nx = _mm_div_ps(v01x, length);
+        const __m128 ny = _mm_div_ps(v01y, length);
+
+        const __m128 minPixelDist = _mm_set1_ps(MinPixelDist);
+        p1x = Select(_mm_cmplt_ps(Abs(v01x), minPixelDist),
+                     _mm_add_ps(p0x, _mm_mul_ps(nx, minPixelDist)), p1x);
+        p1y = Select(_mm_cmplt_ps(Abs(v01y), minPixelDist),
+                     _mm_add_ps(p0y, _mm_mul_ps(ny, minPixelDist)), p1y);
+
+        const __m128 zero = _mm_setzero_ps();
+        const __m128 one = _mm_set1_ps(1.f);
+        const __m128 minusOne = _mm_set1_ps(-1.f);
+
+        Quad4 q;
+        q.q0x = p0x;
+        q.q0y = p0y;
+        q.q1x = Select(isPoint, p0x, p1x);
+        q.q1y = Select(isPoint, p0y, p1y);
+        q.ux = Select(isPoint, one, _mm_sub_ps(zero, ny));
+        q.uy = Select(isPoint, one, nx);
+        q.wx = Select(isPoint, one, ny);
+        q.wy = Select(isPoint, minusOne, _mm_sub_ps(zero, nx));
+        return q;
+    }
+
+    // Writes the 2 triangles for each of 4 quads expanded by hlw (half line width)
+    VertexData* WriteQuad4(VertexData* out, const Quad4& q, const float* brightness, float hlw) {
+        const __m128 h = _mm_set1_ps(hlw);
+        alignas(16) float corners[8][4];
+        _mm_store_ps(corners[0], _mm_add_ps(q.q0x, _mm_mul_ps(q.ux, h))); // a
+        _mm_store_ps(corners[1], _mm_add_ps(q.q0y, _mm_mul_ps(q.uy, h)));
+        _mm_store_ps(corners[2], _mm_add_ps(q.q0x, _mm_mul_ps(q.wx, h))); // b
+        _mm_store_ps(corners[3], _mm_add_ps(q.q0y, _mm_mul_ps(q.wy, h)));
+        _mm_store_ps(corners[4], _mm_sub_ps(q.q1x, _mm_mul_ps(q.ux, h))); // c
+        _mm_store_ps(corners[5], _mm_sub_ps(q.q1y, _mm_mul_ps(q.uy, h)));
+        _mm_store_ps(corners[6], _mm_sub_ps(q.q1x, _mm_mul_ps(q.wx, h))); // d
+        _mm_store_ps(corners[7], _mm_sub_ps(q.q1y, _mm_mul_ps(q.wy, h)));
+
+        for (int i = 0; i < 4; ++i) {
+            const VertexData a{{corners[0][i], corners[1][i]}, brightness[i]};
+            const VertexData b{{corners[2][i], corners[3][i]}, brightness[i]};
+            const VertexData c{{corners[4][i], corners[5][i]}, brightness[i]};
+            const VertexData d{{corners[6][i], corners[7][i]}, brightness[i]};
+            out[0] = a;
+            out[1] = b;
+            out[2] = c;
+            out[3] = c;
+            out[4] = d;
+            out[5] = a;
+            out += 6;
+        }
+        return out;
+    }
+#endif
+
+    template <size_t NumWidths>
+    void WriteQuadsScalar(const LineStrips& lines, float scaleX, float scaleY,
+                          const std::array<float, NumWidths>& hlw,
+                          std::array<VertexData*, NumWidths>& out) {
+        lines.ForEachLine([&](const Line& line) {
+            const Quad quad = MakeQuad(line, scaleX, scaleY);
+            for (size_t w = 0; w < NumWidths; ++w)
+                out[w] = WriteQuad(out[w], quad, hlw[w]);
+        });
+    }
+
+#if LINE_VERTICES_SSE2
+    template <size_t NumWidths>
+    void WriteQuadsSse2(const LineStrips& lines, float scaleX, float scaleY,
+                        const std::array<float, NumWidths>& hlw,
+                        std::array<VertexData*, NumWidths>& out) {
+        const __m128 scaleX4 = _mm_set1_ps(scaleX);
+        const __m128 scaleY4 = _mm_set1_ps(scaleY);
+
+        auto WriteQuads4 = [&](const Quad4& quad4, const float* brightness) {
+            for (size_t w = 0; w < NumWidths; ++w)
+                out[w] = WriteQuad4(out[w], quad4, brightness, hlw[w]);
+        };
+
+        // Runs of 4 lines within a strip are loaded straight from the point arrays, as their start
+        // points are at i - 1 and end points at i. Lines from short strips and strip ends are
+        // gathered into a batch instead, which is filled up first to keep lines in draw order.
+        struct Batch {
+            alignas(16) float p0x[4], p0y[4], p1x[4], p1y[4], brightness[4];
+            size_t size = 0;
+        } batch;
+
+        const float* x = lines.PointsX();
+        const float* y = lines.PointsY();
+
+        auto AddToBatch = [&](uint32_t i, float brightness) {
+            batch.p0x[batch.size] = x[i - 1];
+            batch.p0y[batch.size] = y[i - 1];
+            batch.p1x[batch.size] = x[i];
+            batch.p1y[batch.size] = y[i];
+            batch.brightness[batch.size] = brightness;
+            if (++batch.size == 4) {
+                WriteQuads4(MakeQuad4(_mm_load_ps(batch.p0x), _mm_load_ps(batch.p0y),
+                                      _mm_load_ps(batch.p1x), _mm_load_ps(batch.p1y), scaleX4,
+                                      scaleY4),
+                            batch.brightness);
+                batch.size = 0;
+            }
+        };
+
+        for (size_t s = 0; s < lines.NumStrips(); ++s) {
+            const float brightness = lines.StripBrightnesses()[s];
+            const float brightness4[4] = {brightness, brightness, brightness, brightness};
+            const uint32_t end = lines.StripEnd(s);
+            uint32_t i = lines.StripFirstPoints()[s] + 1;
+
+            for (; i < end && batch.size != 0; ++i)
+                AddToBatch(i, brightness);
+
+            for (; i + 4 <= end; i += 4) {
+                WriteQuads4(MakeQuad4(_mm_loadu_ps(x + i - 1), _mm_loadu_ps(y + i - 1),
+                                      _mm_loadu_ps(x + i), _mm_loadu_ps(y + i), scaleX4, scaleY4),
+                            brightness4);
+            }
+
+            for (; i < end; ++i)
+                AddToBatch(i, brightness);
+        }
+
+        for (size_t i = 0; i < batch.size; ++i) {
+            const Line line{{batch.p0x[i], batch.p0y[i]},
+                            {batch.p1x[i], batch.p1y[i]},
+                            batch.brightness[i]};
+            const Quad quad = MakeQuad(line, scaleX, scaleY);
+            for (size_t w = 0; w < NumWidths; ++w)
+                out[w] = WriteQuad(out[w], quad, hlw[w]);
+        }
+    }
+#endif
+
+    // Writes quads for all lines for each of NumWidths line widths in a single pass
+    template <size_t NumWidths>
+    void CreateQuadVertexArrays(const LineStrips& lines,
+                                const std::array<float, NumWidths>& lineWidths, float scaleX,
+                                float scaleY, const std::array<VertexArray*, NumWidths>& results,
+                                bool useSimd = true) {
+        std::array<float, NumWidths> hlw;
+        std::array<VertexData*, NumWidths> out;
+        for (size_t w = 0; w < NumWidths; ++w) {
+            hlw[w] = HalfLineWidth(lineWidths[w]);
+            out[w] = results[w]->Prepare(lines.NumLines() * 6);
+        }
+
+#if LINE_VERTICES_SSE2
+        if (useSimd)
+            WriteQuadsSse2(lines, scaleX, scaleY, hlw, out);
+        else
+            WriteQuadsScalar(lines, scaleX, scaleY, hlw, out);
+#else
+        (void)useSimd;
+        WriteQuadsScalar(lines, scaleX, scaleY, hlw, out);
+#endif
+
+        for (size_t w = 0; w < NumWidths; ++w)
+            results[w]->SetSize(lines.NumLines() * 6);
+    }
+} // namespace
+
+namespace LineVertices {
+    void CreateQuadVertexArray(const LineStrips& lines, float lineWidth, float scaleX, float scaleY,
+                               VertexArray& result) {
+        ::CreateQuadVertexArrays<1>(lines, {lineWidth}, scaleX, scaleY, {&result});
+    }
+
+    void CreateQuadVertexArrays(const LineStrips& lines, float lineWidth0, float lineWidth1,
+                                float scaleX, float scaleY, VertexArray& result0,
+                                VertexArray& result1) {
+        ::CreateQuadVertexArrays<2>(lines, {lineWidth0, lineWidth1}, scaleX, scaleY,
+                                    {&result0, &result1});
+    }
+
+    void CreateQuadVertexArrayScalar(const LineStrips& lines, float lineWidth, float scaleX,
+                                     float scaleY, VertexArray& result) {
+        ::CreateQuadVertexArrays<1>(lines, {lineWidth}, scaleX, scaleY, {&result}, false);
+    }
+
+    void PackLineInstances(const LineStrips& lines, LineInstance* out) {
+        const float* x = lines.PointsX();
+        const float* y = lines.PointsY();
+        for (size_t s = 0; s < lines.NumStrips(); ++s) {
+            const float brightness = lines.StripBrightnesses()[s];
+            const uint32_t end = lines.StripEnd(s);
+            for (uint32_t i = lines.StripFirstPoints()[s] + 1; i < end; ++i)
+                *out++ = {{x[i - 1], y[i - 1]}, {x[i], y[i]}, brightness};
+        }
+    }
+
+    void CreateLineAndPointVertexArrays(const LineStrips& lines, float scaleX, float scaleY,
+                                        VertexArray& lineResult, VertexArray& pointResult) {
+        auto AlmostEqual = [](float a, float b, float epsilon = 0.01f) {
+            return std::abs(a - b) <= epsilon;
+        };
+
+        VertexData* lineOut = lineResult.Prepare(lines.NumLines() * 2);
+        VertexData* pointOut = pointResult.Prepare(lines.NumLines());
+        size_t numLineVertices = 0;
+        size_t numPointVertices = 0;
+
+        lines.ForEachLine([&](const Line& line) {
+            Vector2 p0{line.p0.x * scaleX, line.p0.y * scaleY};
+            Vector2 p1{line.p1.x * scaleX, line.p1.y * scaleY};
+
+            if (AlmostEqual(p0.x, p1.x) && AlmostEqual(p0.y, p1.y)) {
+                pointOut[numPointVertices++] = {p0, line.brightness};
+            } else {
+                lineOut[numLineVertices++] = {p0, line.brightness};
+                lineOut[numLineVertices++] = {p1, line.brightness};
+            }
+        });
+
+        lineResult.SetSize(numLineVertices);
+        pointResult.SetSize(numPointVertices);
+    }
+} // namespace LineVertices
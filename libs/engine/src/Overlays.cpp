@@ -2,114 +2,206 @@
 #include "core/Base.h"
 #include "core/ConsoleOutput.h"
 #include "core/StringUtil.h"
+#include <algorithm>
+#include <cmath>
+#include <fstream>
 #include <string_view>
-#include <unordered_map>
 
 namespace {
-
-    // To avoid performing the computation multiple times on the same pair of substrings, we cache
-    // the results and look them up before computing
-    using LDCache = std::unordered_map<std::string_view, std::unordered_map<std::string_view, int>>;
-
-    int LevenshteinDistance(std::string_view s, std::string_view t, LDCache& cache) {
-
-        // base case: empty strings
-        if (s.size() == 0)
-            return static_cast<int>(t.size());
-
-        if (t.size() == 0)
-            return static_cast<int>(s.size());
-
-        auto& cache1 = cache[s];
-        if (auto iter = cache1.find(t); iter != cache1.end()) {
-            return iter->second;
+    const char* IndexHeader = "vectrexy overlay index 1";
+
+    // Overlays must match a rom's name with a confidence above this
+    const float MinConfidence = 0.5f;
+
+    // Levenshtein distance between s and t, computed one row of the table at a time. Stops early
+    // and returns maxDistance + 1 once the distance is known to be greater than maxDistance: a
+    // row's minimum never decreases in later rows.
+    int LevenshteinDistance(std::string_view s, std::string_view t, int maxDistance,
+                            std::vector<int>& prevRow, std::vector<int>& currRow) {
+        prevRow.resize(t.size() + 1);
+        currRow.resize(t.size() + 1);
+        for (size_t j = 0; j <= t.size(); ++j)
+            prevRow[j] = static_cast<int>(j);
+
+        for (size_t i = 1; i <= s.size(); ++i) {
+            currRow[0] = static_cast<int>(i);
+            int rowMin = currRow[0];
+            for (size_t j = 1; j <= t.size(); ++j) {
+                const int cost = s[i - 1] == t[j - 1] ? 0 : 1;
+                // Minimum of delete char from s, delete char from t, and delete char from both
+                currRow[j] = std::min({prevRow[j] + 1, currRow[j - 1] + 1, prevRow[j - 1] + cost});
+                rowMin = std::min(rowMin, currRow[j]);
+            }
+            if (rowMin > maxDistance)
+                return maxDistance + 1;
+            std::swap(prevRow, currRow);
         }
-
-        // test if last characters of the strings match
-        int cost = s.back() == t.back() ? 0 : 1;
-
-        auto min3 = [](auto a, auto b, auto c) { return std::min(std::min(a, b), std::min(b, c)); };
-
-        // return minimum of delete char from s, delete char from t, and delete char from both
-        auto result =
-            min3(LevenshteinDistance(s.substr(0, s.size() - 1), t, cache) + 1,
-                 LevenshteinDistance(s, t.substr(0, t.size() - 1), cache) + 1,
-                 LevenshteinDistance(s.substr(0, s.size() - 1), t.substr(0, t.size() - 1), cache) +
-                     cost);
-
-        cache1[t] = result;
-        return result;
+        return prevRow[t.size()];
     }
 
-    int LevenshteinDistance(std::string_view s, std::string_view t) {
-        LDCache cache;
-        return LevenshteinDistance(s, t, cache);
-    }
-
-    // Returns a confidence ratio in [0.0, 1.0] from no match to perfect match
-    float OverlayFileFuzzyMatch(const fs::path& p1, const fs::path& p2) {
-        auto TrimFileName = [](std::string s) {
-            // Replace separators with space
-            s = StringUtil::Replace(s, "-", " ");
-            s = StringUtil::Replace(s, "_", " ");
+    std::string TrimFileName(std::string s) {
+        // Replace separators with space
+        s = StringUtil::Replace(s, "-", " ");
+        s = StringUtil::Replace(s, "_", " ");
 
-            std::string_view sub = s;
+        std::string_view sub = s;
 
-            // Remove " by GCE"
-            auto index = s.find(" by GCE");
-            if (index != std::string::npos) {
-                sub = sub.substr(0, index);
-            }
-            // Remove extra version details at end of name, e.g. "(PD)"
-            index = s.find(" (");
-            if (index != std::string::npos) {
-                sub = sub.substr(0, index);
-            }
+        // Remove " by GCE"
+        auto index = s.find(" by GCE");
+        if (index != std::string::npos) {
+            sub = sub.substr(0, index);
+        }
+        // Remove extra version details at end of name, e.g. "(PD)"
+        index = s.find(" (");
+        if (index != std::string::npos) {
+            sub = sub.substr(0, index);
+        }
 
-            // Remove extension, e.g. ".png"
-            index = s.rfind('.');
-            if (index != std::string::npos) {
-                sub = sub.substr(0, index);
-            }
+        // Remove extension, e.g. ".png"
+        index = s.rfind('.');
+        if (index != std::string::npos) {
+            sub = sub.substr(0, index);
+        }
 
-            return std::string{sub};
-        };
+        return std::string{sub};
+    }
 
+    // Name that rom and overlay files are matched by, e.g. "minestorm" for "Mine_Storm (PD).png"
+    std::string MatchKey(const fs::path& path) {
         using namespace StringUtil;
-        auto t1 = Remove(ToLower(TrimFileName(p1.filename().string())), " ");
-        auto t2 = Remove(ToLower(TrimFileName(p2.filename().string())), " ");
-        auto dist = LevenshteinDistance(t1, t2);
+        return Remove(ToLower(TrimFileName(path.filename().string())), " ");
+    }
 
-        auto distRatio = 1.0f - static_cast<float>(dist) / std::max(t1.size(), t2.size());
-        return distRatio;
+    int64_t LastWriteTime(const fs::path& path) {
+        std::error_code ec;
+        auto time = fs::last_write_time(path, ec);
+        return ec ? 0 : static_cast<int64_t>(time.time_since_epoch().count());
     }
 } // namespace
 
-void Overlays::LoadOverlays(const fs::path& overlaysDir) {
+void Overlays::LoadOverlays(const fs::path& overlaysDir, const fs::path& indexFile) {
     if (!fs::exists(overlaysDir))
         return;
 
-    for (auto& dir : fs::recursive_directory_iterator(overlaysDir)) {
-        if (dir.path().extension() == ".png") {
-            m_overlayFiles.push_back({fs::absolute(dir.path())});
+    if (!indexFile.empty() && LoadIndex(overlaysDir, indexFile))
+        return;
+
+    // Discard anything read from a stale index
+    m_overlayFiles.clear();
+    m_overlayDirs.clear();
+
+    // Directories are timestamped before their contents are listed, so that files added during
+    // the walk invalidate the index next time
+    m_overlayDirs.push_back({overlaysDir, LastWriteTime(overlaysDir)});
+    for (auto& entry : fs::recursive_directory_iterator(overlaysDir)) {
+        if (entry.is_directory()) {
+            m_overlayDirs.push_back({entry.path(), LastWriteTime(entry.path())});
+        } else if (entry.path().extension() == ".png") {
+            AddOverlayFile(fs::absolute(entry.path()));
         }
     }
+
+    if (!indexFile.empty())
+        SaveIndex(overlaysDir, indexFile);
 }
 
 std::optional<fs::path> Overlays::FindOverlay(const char* romFile) {
-    std::optional<fs::path> bestMatch{};
-    float bestConfidence = 0;
+    const auto romKey = MatchKey(romFile);
+
+    // Confidence is a ratio in [0.0, 1.0] from no match to perfect match
+    const OverlayFile* bestMatch = nullptr;
+    float bestConfidence = MinConfidence;
     for (auto& overlayFile : m_overlayFiles) {
-        float c = OverlayFileFuzzyMatch(romFile, overlayFile.path);
-        if (c > bestConfidence) {
-            bestConfidence = c;
-            bestMatch = overlayFile.path;
+        const auto& key = overlayFile.key;
+        const size_t maxLength = std::max(romKey.size(), key.size());
+        if (maxLength == 0)
+            continue;
+
+        // Confidence is 1 - distance / maxLength, so only distances up to this can beat the best
+        // match so far. The difference in lengths is a lower bound on the distance.
+        const int maxDistance =
+            static_cast<int>(std::ceil((1.0f - bestConfidence) * maxLength)) - 1;
+        const int lengthDiff =
+            std::abs(static_cast<int>(romKey.size()) - static_cast<int>(key.size()));
+        if (lengthDiff > maxDistance)
+            continue;
+
+        const int dist = LevenshteinDistance(romKey, key, maxDistance, m_prevRow, m_currRow);
+        const float confidence = 1.0f - static_cast<float>(dist) / maxLength;
+        if (dist <= maxDistance && confidence > bestConfidence) {
+            bestConfidence = confidence;
+            bestMatch = &overlayFile;
+            if (dist == 0)
+                break;
         }
     }
 
     // Errorf("Overlay bestConfidence: %f\n", bestConfidence);
-    if (bestConfidence > 0.5f) {
-        return bestMatch;
+    if (bestMatch) {
+        return bestMatch->path;
     }
     return {};
 }
+
+bool Overlays::LoadIndex(const fs::path& overlaysDir, const fs::path& indexFile) {
+    std::ifstream fin(indexFile);
+    if (!fin)
+        return false;
+
+    const auto absOverlaysDir = fs::absolute(overlaysDir);
+    std::string line;
+    if (!std::getline(fin, line) || line != IndexHeader)
+        return false;
+    if (!std::getline(fin, line) || line != "root " + absOverlaysDir.generic_string())
+        return false;
+
+    // Each line is a tag, then for directories their time stamp, then a path relative to
+    // overlaysDir
+    while (std::getline(fin, line)) {
+        auto tagEnd = line.find(' ');
+        if (tagEnd == std::string::npos)
+            return false;
+        const auto tag = line.substr(0, tagEnd);
+
+        if (tag == "dir") {
+            auto timeEnd = line.find(' ', tagEnd + 1);
+            if (timeEnd == std::string::npos)
+                return false;
+            const auto dir = overlaysDir / line.substr(timeEnd + 1);
+            const int64_t lastWriteTime = LastWriteTime(dir);
+            if (line.compare(tagEnd + 1, timeEnd - tagEnd - 1, std::to_string(lastWriteTime)) != 0)
+                return false;
+            m_overlayDirs.push_back({dir, lastWriteTime});
+        } else if (tag == "file") {
+            AddOverlayFile(absOverlaysDir / line.substr(tagEnd + 1));
+        } else {
+            return false;
+        }
+    }
+
+    return !m_overlayDirs.empty();
+}
+
+void Overlays::SaveIndex(const fs::path& overlaysDir, const fs::path& indexFile) const {
+    std::ofstream fout(indexFile);
+    if (!fout) {
+        Errorf("Failed to write overlay index: %s\n", indexFile.string().c_str());
+        return;
+    }
+
+    const auto absOverlaysDir = fs::absolute(overlaysDir);
+    fout << IndexHeader << "\n";
+    fout << "root " << absOverlaysDir.generic_string() << "\n";
+    for (auto& dir : m_overlayDirs) {
+        fout << "dir " << dir.lastWriteTime << " "
+             << dir.path.lexically_relative(overlaysDir).generic_string() << "\n";
+    }
+    for (auto& file : m_overlayFiles) {
+        fout << "file " << file.path.lexically_relative(absOverlaysDir).generic_string() << "\n";
+    }
+}
+
+void Overlays::AddOverlayFile(fs::path path) {
+    auto key = MatchKey(path);
+    m_overlayFiles.push_back({std::move(path), std::move(key)});
+}
@@ -0,0 +1,188 @@
+#include "engine/RomLibrary.h"
+#include "core/Base.h"
+#include "core/ConsoleOutput.h"
+#include "core/StringUtil.h"
+#include "core/WorkerPool.h"
+#include "emulator/RomFile.h"
+#include <algorithm>
+#include <fstream>
+#include <thread>
+#include <unordered_map>
+
+namespace {
+    const char* ManifestHeader = "vectrexy rom library 1";
+
+    enum class Field { ContentHash, Size, LastWriteTime, ValidHeader, Title, Path, Count };
+
+    int64_t LastWriteTime(const fs::path& path, std::error_code& ec) {
+        auto time = fs::last_write_time(path, ec);
+        return static_cast<int64_t>(time.time_since_epoch().count());
+    }
+
+    // Titles are stored between tabs, and shown on consoles
+    std::string SanitizeTitle(std::string title) {
+        for (auto& c : title) {
+            if (c < 0x20 || c > 0x7e)
+                c = '?';
+        }
+        return title;
+    }
+
+    // Entries from the manifest by path relative to romsDir
+    using Manifest = std::unordered_map<std::string, RomLibrary::Entry>;
+
+    Manifest LoadManifest(const fs::path& manifestFile, const fs::path& romsDir) {
+        std::ifstream fin(manifestFile);
+        if (!fin)
+            return {};
+
+        std::string line;
+        if (!std::getline(fin, line) || line != ManifestHeader)
+            return {};
+        if (!std::getline(fin, line) || line != "root " + romsDir.generic_string())
+            return {};
+
+        // Tab-separated fields as in Field, one rom per line
+        Manifest manifest;
+        while (std::getline(fin, line)) {
+            auto fields = StringUtil::Split(line, "\t", StringUtil::KeepEmptyEntries::True);
+            if (fields.size() != static_cast<size_t>(Field::Count))
+                return {};
+            auto GetField = [&fields](Field field) -> const std::string& {
+                return fields[static_cast<size_t>(field)];
+            };
+
+            RomLibrary::Entry entry;
+            try {
+                entry.contentHash = std::stoull(GetField(Field::ContentHash), nullptr, 16);
+                entry.size = std::stoull(GetField(Field::Size));
+                entry.lastWriteTime = std::stoll(GetField(Field::LastWriteTime));
+            } catch (...) {
+                return {};
+            }
+            entry.validHeader = GetField(Field::ValidHeader) == "1";
+            entry.title = GetField(Field::Title);
+            const auto& relativePath = GetField(Field::Path);
+            entry.path = romsDir / fs::path(relativePath).make_preferred();
+            manifest.emplace(relativePath, std::move(entry));
+        }
+        return manifest;
+    }
+
+    void SaveManifest(const fs::path& manifestFile, const fs::path& romsDir,
+                      const std::vector<RomLibrary::Entry>& entries) {
+        std::ofstream fout(manifestFile);
+        if (!fout) {
+            Errorf("Failed to write rom library manifest: %s\n", manifestFile.string().c_str());
+            return;
+        }
+
+        fout << ManifestHeader << "\n";
+        fout << "root " << romsDir.generic_string() << "\n";
+        for (auto& entry : entries) {
+            fout << FormattedString<>("%016llx\t%llu\t%lld\t%d\t",
+                                      static_cast<unsigned long long>(entry.contentHash),
+                                      static_cast<unsigned long long>(entry.size),
+                                      static_cast<long long>(entry.lastWriteTime),
+                                      entry.validHeader ? 1 : 0)
+                        .Value()
+                 << entry.title << "\t" << entry.path.lexically_relative(romsDir).generic_string()
+                 << "\n";
+        }
+    }
+} // namespace
+
+RomLibrary::ScanStats RomLibrary::Scan(const fs::path& dir, const fs::path& manifestFile,
+                                       size_t numThreads) {
+    const auto romsDir = fs::absolute(dir);
+    auto manifest = manifestFile.empty() ? Manifest{} : LoadManifest(manifestFile, romsDir);
+
+    m_entries.clear();
+    std::vector<size_t> entriesToRead;
+    ScanStats stats;
+
+    std::error_code ec;
+    for (auto iter = fs::recursive_directory_iterator(romsDir, ec);
+         iter != fs::recursive_directory_iterator(); iter.increment(ec)) {
+        if (ec) {
+            Errorf("Failed to list roms in %s: %s\n", romsDir.string().c_str(),
+                   ec.message().c_str());
+            break;
+        }
+        if (!iter->is_regular_file(ec))
+            continue;
+        const auto ext = StringUtil::ToLower(iter->path().extension().string());
+        if (ext != ".vec" && ext != ".bin")
+            continue;
+
+        Entry entry;
+        entry.path = iter->path();
+        entry.size = iter->file_size(ec);
+        if (ec)
+            continue;
+        entry.lastWriteTime = LastWriteTime(entry.path, ec);
+        if (ec)
+            continue;
+
+        auto cached = manifest.find(entry.path.lexically_relative(romsDir).generic_string());
+        if (cached != manifest.end() && cached->second.size == entry.size &&
+            cached->second.lastWriteTime == entry.lastWriteTime) {
+            m_entries.push_back(std::move(cached->second));
+            ++stats.numCached;
+        } else {
+            entriesToRead.push_back(m_entries.size());
+            m_entries.push_back(std::move(entry));
+        }
+    }
+
+    // Each rom is read in one go, and only its header is parsed
+    if (!entriesToRead.empty()) {
+        if (numThreads == 0)
+            numThreads = std::max(std::thread::hardware_concurrency(), 1u);
+        std::vector<char> readFailed(m_entries.size());
+        WorkerPool workerPool(std::min(numThreads, entriesToRead.size()));
+        workerPool.ParallelFor(entriesToRead.size(), [&](size_t i) {
+            auto& entry = m_entries[entriesToRead[i]];
+            if (auto data = RomFile::Read(entry.path)) {
+                const auto header = RomFile::ParseHeader(*data);
+                entry.contentHash = RomFile::ContentHash(*data);
+                entry.title = SanitizeTitle(header.title);
+                entry.validHeader = header.valid;
+            } else {
+                readFailed[entriesToRead[i]] = true;
+            }
+        });
+
+        // Drop failed roms rather than caching them with no hash, which would stick until the
+        // file changes
+        size_t numKept = 0;
+        for (size_t i = 0; i < m_entries.size(); ++i) {
+            if (readFailed[i]) {
+                Errorf("Failed to read rom: %s\n", m_entries[i].path.string().c_str());
+                ++stats.numFailed;
+            } else {
+                m_entries[numKept++] = std::move(m_entries[i]);
+            }
+        }
+        m_entries.resize(numKept);
+        stats.numRead = entriesToRead.size() - stats.numFailed;
+    }
+
+    std::sort(m_entries.begin(), m_entries.end(),
+              [](const Entry& a, const Entry& b) { return a.path < b.path; });
+
+    // Also rewrite if roms were removed, or failed to read after being cached
+    if (!manifestFile.empty() && (stats.numRead > 0 || stats.numCached != manifest.size()))
+        SaveManifest(manifestFile, romsDir, m_entries);
+
+    return stats;
+}
+
+std::vector<const RomLibrary::Entry*> RomLibrary::FindByContentHash(uint64_t contentHash) const {
+    std::vector<const Entry*> result;
+    for (auto& entry : m_entries) {
+        if (entry.contentHash == contentHash)
+            result.push_back(&entry);
+    }
+    return result;
+}
@@ -0,0 +1,582 @@
+#include "engine/SoftwareRender.h"
+#include "core/ConsoleOutput.h"
+#include "core/ImageUtil.h"
+#include "core/WorkerPool.h"
+#include "emulator/EngineTypes.h"
+#include "engine/LineVertices.h"
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <memory>
+#include <vector>
+
+// See LineVertices.cpp
+#if !defined(SOFTWARE_RENDER_NO_SIMD) &&                                                           \
+    (defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+#define SOFTWARE_RENDER_SSE2 1
+#include <emmintrin.h>
+#else
+#define SOFTWARE_RENDER_SSE2 0
+#endif
+
+namespace {
+    const int VectrexScreenWidth = 256;
+    const int VectrexScreenHeight = 256;
+    const float OverlayAR = 936.f / 1200.f;
+
+    const int TileSize = 64;
+    const int RowsPerJob = 16;
+
+    // Single channel image. The CRT is only ever drawn in shades of grey (DrawVectors.frag outputs
+    // vec3(brightness)), so one channel is enough. Rows are stored bottom first, like GL textures.
+    struct Image {
+        int width{};
+        int height{};
+        std::vector<float> pixels;
+
+        void Allocate(int w, int h) {
+            width = w;
+            height = h;
+            pixels.assign(static_cast<size_t>(w) * h, 0.f);
+        }
+
+        float* Row(int y) { return &pixels[static_cast<size_t>(y) * width]; }
+        const float* Row(int y) const { return &pixels[static_cast<size_t>(y) * width]; }
+    };
+
+    // Oriented rectangle covered by a line's quad, in pixels. Coverage of a pixel is the product
+    // of how far its center is inside each pair of edges, which anti-aliases the edges over a pixel.
+    struct LineRect {
+        Vector2 center;
+        Vector2 axis0, axis1; // Unit length
+        float halfExtent0{}, halfExtent1{};
+        float brightness{};
+        int minX{}, minY{}, maxX{}, maxY{}; // Inclusive pixel bounds
+    };
+
+    struct Tile {
+        int x0, y0, x1, y1; // Exclusive end
+    };
+
+    // Builds the rectangle of each quad output by LineVertices::CreateQuadVertexArray, so that we
+    // draw exactly the same shapes as GLRender does.
+    void MakeLineRects(const LineVertices::VertexArray& quads, int width, int height,
+                       std::vector<LineRect>& rects) {
+        rects.clear();
+        const LineVertices::VertexData* v = quads.Data();
+        const Vector2 origin{width / 2.f, height / 2.f};
+
+        for (size_t i = 0; i + 6 <= quads.Size(); i += 6) {
+            // Vertices are a, b, c, c, d, a; where a -> b -> c -> d goes around the quad
+            const Vector2 a = v[i].v + origin;
+            const Vector2 b = v[i + 1].v + origin;
+            const Vector2 c = v[i + 2].v + origin;
+            const Vector2 d = v[i + 4].v + origin;
+
+            LineRect rect;
+            rect.center = (a + c) * 0.5f;
+            const Vector2 e0 = b - a;
+            const Vector2 e1 = c - b;
+            const float length0 = Magnitude(e0);
+            const float length1 = Magnitude(e1);
+            rect.axis0 = length0 > 0 ? e0 / length0 : Vector2{1.f, 0.f};
+            rect.axis1 = length1 > 0 ? e1 / length1 : Vector2{-rect.axis0.y, rect.axis0.x};
+            rect.halfExtent0 = length0 / 2;
+            rect.halfExtent1 = length1 / 2;
+            rect.brightness = v[i].brightness;
+
+            // Pixels whose center is within half a pixel of the quad
+            const float minX = std::min({a.x, b.x, c.x, d.x});
+            const float maxX = std::max({a.x, b.x, c.x, d.x});
+            const float minY = std::min({a.y, b.y, c.y, d.y});
+            const float maxY = std::max({a.y, b.y, c.y, d.y});
+            rect.minX = std::max(static_cast<int>(std::floor(minX - 0.5f)), 0);
+            rect.minY = std::max(static_cast<int>(std::floor(minY - 0.5f)), 0);
+            rect.maxX = std::min(static_cast<int>(std::floor(maxX + 0.5f)), width - 1);
+            rect.maxY = std::min(static_cast<int>(std::floor(maxY + 0.5f)), height - 1);
+
+            if (rect.minX <= rect.maxX && rect.minY <= rect.maxY)
+                rects.push_back(rect);
+        }
+    }
+
+    // Narrows [x0, x1] to the pixels whose distance along an axis, which is linear in x, is within
+    // extent: |dx * (x + 0.5) + c| < extent
+    void ClipSpan(float dx, float c, float extent, float& x0, float& x1) {
+        const float Epsilon = 1e-6f;
+        if (std::abs(dx) < Epsilon) {
+            if (std::abs(c) >= extent)
+                x1 = x0 - 1;
+            return;
+        }
+        float a = (-extent - c) / dx - 0.5f;
+        float b = (extent - c) / dx - 0.5f;
+        if (a > b)
+            std::swap(a, b);
+        x0 = std::max(x0, std::floor(a));
+        x1 = std::min(x1, std::ceil(b));
+    }
+
+    // Blends the rect into the tile: dst = mix(dst, brightness, coverage). With full coverage,
+    // this overwrites the pixel as GLRender does (it draws lines without blending).
+    void RasterizeRect(const LineRect& rect, const Tile& tile, Image& image) {
+        const int minY = std::max(rect.minY, tile.y0);
+        const int maxY = std::min(rect.maxY, tile.y1 - 1);
+        const float extent0 = rect.halfExtent0 + 0.5f;
+        const float extent1 = rect.halfExtent1 + 0.5f;
+
+        for (int y = minY; y <= maxY; ++y) {
+            // Distance along each axis as a function of x: d = axis.x * (x + 0.5) + c
+            const float py = y + 0.5f - rect.center.y;
+            const float c0 = rect.axis0.y * py - rect.axis0.x * rect.center.x;
+            const float c1 = rect.axis1.y * py - rect.axis1.x * rect.center.x;
+
+            float spanX0 = static_cast<float>(std::max(rect.minX, tile.x0));
+            float spanX1 = static_cast<float>(std::min(rect.maxX, tile.x1 - 1));
+            ClipSpan(rect.axis0.x, c0, extent0, spanX0, spanX1);
+            ClipSpan(rect.axis1.x, c1, extent1, spanX0, spanX1);
+            if (spanX0 > spanX1)
+                continue;
+
+            float* row = image.Row(y);
+            int x = static_cast<int>(spanX0);
+            const int x1 = static_cast<int>(spanX1);
+
+#if SOFTWARE_RENDER_SSE2
+            const __m128 signMask = _mm_set1_ps(-0.f);
+            const __m128 zero = _mm_setzero_ps();
+            const __m128 one = _mm_set1_ps(1.f);
+            const __m128 ax0 = _mm_set1_ps(rect.axis0.x);
+            const __m128 ax1 = _mm_set1_ps(rect.axis1.x);
+            const __m128 vc0 = _mm_set1_ps(c0);
+            const __m128 vc1 = _mm_set1_ps(c1);
+            const __m128 vExtent0 = _mm_set1_ps(extent0);
+            const __m128 vExtent1 = _mm_set1_ps(extent1);
+            const __m128 brightness = _mm_set1_ps(rect.brightness);
+            for (; x + 3 <= x1; x += 4) {
+                const __m128 px = _mm_add_ps(_mm_set1_ps(static_cast<float>(x)),
+                                             _mm_setr_ps(0.5f, 1.5f, 2.5f, 3.5f));
+                const __m128 d0 = _mm_add_ps(_mm_mul_ps(ax0, px), vc0);
+                const __m128 d1 = _mm_add_ps(_mm_mul_ps(ax1, px), vc1);
+                const __m128 cov0 =
+                    _mm_min_ps(_mm_max_ps(_mm_sub_ps(vExtent0, _mm_andnot_ps(signMask, d0)), zero),
+                               one);
+                const __m128 cov1 =
+                    _mm_min_ps(_mm_max_ps(_mm_sub_ps(vExtent1, _mm_andnot_ps(signMask, d1)), zero),
+                               one);
+                const __m128 coverage = _mm_mul_ps(cov0, cov1);
+                const __m128 dst = _mm_loadu_ps(row + x);
+                _mm_storeu_ps(row + x,
+                              _mm_add_ps(dst, _mm_mul_ps(_mm_sub_ps(brightness, dst), coverage)));
+            }
+#endif
+            for (; x <= x1; ++x) {
+                const float px = x + 0.5f;
+                const float d0 = rect.axis0.x * px + c0;
+                const float d1 = rect.axis1.x * px + c1;
+                const float cov0 = std::min(std::max(extent0 - std::abs(d0), 0.f), 1.f);
+                const float cov1 = std::min(std::max(extent1 - std::abs(d1), 0.f), 1.f);
+                const float coverage = cov0 * cov1;
+                row[x] += (rect.brightness - row[x]) * coverage;
+            }
+        }
+    }
+
+    // 9-tap gaussian weights of Glow.frag
+    const std::array<float, 9> GlowWeights = {0.0162162162f, 0.0540540541f, 0.1216216216f,
+                                              0.1945945946f, 0.2270270270f, 0.1945945946f,
+                                              0.1216216216f, 0.0540540541f, 0.0162162162f};
+
+    // Texel offsets sampled by Glow.frag for a given step in texels. Textures use nearest
+    // filtering, so each tap reads the texel its sample position falls in.
+    std::array<int, 9> GlowTapOffsets(float step) {
+        std::array<int, 9> offsets{};
+        for (int k = -4; k <= 4; ++k)
+            offsets[k + 4] = static_cast<int>(std::floor(0.5f + k * step));
+        return offsets;
+    }
+} // namespace
+
+class SoftwareRenderImpl {
+public:
+    void Initialize(int screenWidth, int screenHeight, size_t numThreads) {
+        m_workerPool = std::make_unique<WorkerPool>(numThreads);
+        m_screenWidth = std::max(screenWidth, 1);
+        m_screenHeight = std::max(screenHeight, 1);
+        m_output.assign(static_cast<size_t>(m_screenWidth) * m_screenHeight * 4, 0);
+        ResizeCrt();
+        ResampleOverlay();
+    }
+
+    SoftwareRender::Config& GetConfig() { return m_config; }
+
+    bool ResetOverlay(const char* file) {
+        m_overlayImage.reset();
+        bool result = true;
+        if (file) {
+            if (auto image = ImageUtil::loadPngImage(file)) {
+                m_overlayImage = std::make_unique<ImageUtil::PngImageData>(std::move(*image));
+            } else {
+                Errorf("Failed to load overlay: %s\n", file);
+                result = false;
+            }
+        }
+        ResampleOverlay();
+        return result;
+    }
+
+    void RenderScene(double frameTime, const RenderContext& renderContext) {
+        // Resize on crt scale change
+        if (m_crtScaleX != m_config.crtScaleX || m_crtScaleY != m_config.crtScaleY)
+            ResizeCrt();
+
+        if (frameTime > 0)
+            m_vectorsImage0Index = (m_vectorsImage0Index + 1) % 2;
+
+        Image& currVectorsImage0 = m_vectorsImage[m_vectorsImage0Index];
+        Image& currVectorsImage1 = m_vectorsImage[(m_vectorsImage0Index + 1) % 2];
+        Image& currVectorsThickImage0 = m_vectorsThickImage[m_vectorsImage0Index];
+        Image& currVectorsThickImage1 = m_vectorsThickImage[(m_vectorsImage0Index + 1) % 2];
+
+        const int crtWidth = currVectorsImage0.width;
+        const int crtHeight = currVectorsImage0.height;
+
+        // Scale lines from vectrex-space to CRT space
+        const float lineScaleX = static_cast<float>(crtWidth) / VectrexScreenWidth;
+        const float lineScaleY = static_cast<float>(crtHeight) / VectrexScreenHeight;
+        const float lineWidthScale = lineScaleX;
+
+        const bool enableBlur = m_config.enableBlur;
+        if (enableBlur) {
+            LineVertices::CreateQuadVertexArrays(
+                renderContext.lines, m_config.lineWidthNormal * lineWidthScale,
+                m_config.lineWidthGlow * lineWidthScale, lineScaleX, lineScaleY, m_quadVA,
+                m_glowQuadVA);
+        } else {
+            LineVertices::CreateQuadVertexArray(renderContext.lines,
+                                                m_config.lineWidthNormal * lineWidthScale,
+                                                lineScaleX, lineScaleY, m_quadVA);
+        }
+
+        // Render normal (and thick) lines, and darken
+        MakeLineRects(m_quadVA, crtWidth, crtHeight, m_rects);
+        BinRects(m_rects, m_bins);
+        if (enableBlur) {
+            MakeLineRects(m_glowQuadVA, crtWidth, crtHeight, m_glowRects);
+            BinRects(m_glowRects, m_glowBins);
+        }
+
+        const size_t numTiles = m_tiles.size();
+        m_workerPool->ParallelFor(enableBlur ? numTiles * 2 : numTiles, [&](size_t index) {
+            const bool glow = index >= numTiles;
+            const size_t tileIndex = index % numTiles;
+            const auto& rects = glow ? m_glowRects : m_rects;
+            const auto& bin = glow ? m_glowBins[tileIndex] : m_bins[tileIndex];
+            Image& image = glow ? currVectorsThickImage0 : currVectorsImage0;
+            for (uint32_t rectIndex : bin)
+                RasterizeRect(rects[rectIndex], m_tiles[tileIndex], image);
+        });
+
+        Darken(currVectorsImage0, currVectorsImage1, static_cast<float>(frameTime));
+
+        if (enableBlur) {
+            // Darken thick lines and apply glow
+            Darken(currVectorsThickImage0, currVectorsThickImage1, static_cast<float>(frameTime));
+            Glow(currVectorsThickImage0, m_tempImage, m_glowImage);
+        }
+
+        // Combine glow and normal lines, scale CRT to screen, and apply overlay
+        Composite(currVectorsImage0, enableBlur ? &m_glowImage : nullptr);
+    }
+
+    int FramesToFade(double frameTime) const {
+        // Drawing a line blends towards its brightness (at most 1), and Darken scales everything
+        // down every frame, so the difference between any two histories of a pixel shrinks by at
+        // least the darken factor each frame. Wait until it's below half a step of 8-bit output
+        // (give or take pixels straddling Darken's cutoff).
+        const double darken = std::pow(0.01, frameTime * m_config.darkenSpeedScale);
+        if (!(darken < 1.0))
+            return 0;
+        const double frames = std::ceil(std::log(0.5 / 255.0) / std::log(darken));
+        return static_cast<int>(frames) + 1;
+    }
+
+    void Clear() {
+        for (auto& image : m_vectorsImage)
+            std::fill(image.pixels.begin(), image.pixels.end(), 0.f);
+        for (auto& image : m_vectorsThickImage)
+            std::fill(image.pixels.begin(), image.pixels.end(), 0.f);
+    }
+
+    int Width() const { return m_screenWidth; }
+    int Height() const { return m_screenHeight; }
+    const uint8_t* Pixels() const { return m_output.data(); }
+
+private:
+    template <typename Func>
+    void ParallelRows(int height, Func func) {
+        const size_t numJobs = (height + RowsPerJob - 1) / RowsPerJob;
+        m_workerPool->ParallelFor(numJobs, [&](size_t job) {
+            const int y0 = static_cast<int>(job) * RowsPerJob;
+            const int y1 = std::min(y0 + RowsPerJob, height);
+            for (int y = y0; y < y1; ++y)
+                func(y);
+        });
+    }
+
+    void ResizeCrt() {
+        m_crtScaleX = m_config.crtScaleX;
+        m_crtScaleY = m_config.crtScaleY;
+
+        // "CRT" represents the physical CRT screen where the line vectors are drawn. The size is
+        // smaller than the screen since the overlay is larger than the CRT on the Vectrex.
+        const int crtWidth = std::max(static_cast<int>(m_screenWidth * m_crtScaleX), 1);
+        const int crtHeight = std::max(static_cast<int>(m_screenHeight * m_crtScaleY), 1);
+
+        for (auto& image : m_vectorsImage)
+            image.Allocate(crtWidth, crtHeight);
+        for (auto& image : m_vectorsThickImage)
+            image.Allocate(crtWidth, crtHeight);
+        m_tempImage.Allocate(crtWidth, crtHeight);
+        m_glowImage.Allocate(crtWidth, crtHeight);
+
+        m_tiles.clear();
+        for (int y = 0; y < crtHeight; y += TileSize) {
+            for (int x = 0; x < crtWidth; x += TileSize) {
+                m_tiles.push_back(
+                    {x, y, std::min(x + TileSize, crtWidth), std::min(y + TileSize, crtHeight)});
+            }
+        }
+        m_numTilesX = (crtWidth + TileSize - 1) / TileSize;
+        m_bins.resize(m_tiles.size());
+        m_glowBins.resize(m_tiles.size());
+
+        // Map screen pixels to the CRT texels they sample. The CRT is drawn as a quad scaled by
+        // crtScale in the middle of the screen, with nearest filtering.
+        auto MapAxis = [](int screenSize, float scale, int crtSize, std::vector<int>& crtIndices) {
+            crtIndices.resize(screenSize);
+            const float start = screenSize * (1.f - scale) / 2.f;
+            const float size = screenSize * scale;
+            for (int i = 0; i < screenSize; ++i) {
+                const float uv = (i + 0.5f - start) / size;
+                crtIndices[i] = (uv >= 0.f && uv < 1.f)
+                                    ? std::min(static_cast<int>(uv * crtSize), crtSize - 1)
+                                    : -1;
+            }
+        };
+        MapAxis(m_screenWidth, m_crtScaleX, crtWidth, m_screenToCrtX);
+        MapAxis(m_screenHeight, m_crtScaleY, crtHeight, m_screenToCrtY);
+    }
+
+    void BinRects(const std::vector<LineRect>& rects, std::vector<std::vector<uint32_t>>& bins) {
+        for (auto& bin : bins)
+            bin.clear();
+
+        for (size_t i = 0; i < rects.size(); ++i) {
+            const auto& rect = rects[i];
+            for (int ty = rect.minY / TileSize; ty <= rect.maxY / TileSize; ++ty) {
+                for (int tx = rect.minX / TileSize; tx <= rect.maxX / TileSize; ++tx) {
+                    bins[ty * m_numTilesX + tx].push_back(static_cast<uint32_t>(i));
+                }
+            }
+        }
+    }
+
+    // See DarkenTexture.frag
+    void Darken(const Image& input, Image& output, float frameTime) {
+        const float rate = 0.99f;
+        const float ratio = 1.f - std::pow(1.f - rate, frameTime * m_config.darkenSpeedScale);
+
+        ParallelRows(input.height, [&](int y) {
+            const float* in = input.Row(y);
+            float* out = output.Row(y);
+            for (int x = 0; x < input.width; ++x) {
+                out[x] = in[x] > 0.1f ? in[x] * (1.f - ratio) : 0.f;
+            }
+        });
+    }
+
+    // See GlowPass and Glow.frag: a horizontal then a vertical blur. Note that the vertical step
+    // is also relative to the texture width, as GlowPass sets the shader's resolution to it.
+    void Glow(const Image& input, Image& temp, Image& output) {
+        const int width = input.width;
+        const int height = input.height;
+        const float texelsPerStep = m_config.glowRadius;
+        const auto offsetsX = GlowTapOffsets(texelsPerStep);
+        const auto offsetsY =
+            GlowTapOffsets(texelsPerStep * static_cast<float>(height) / static_cast<float>(width));
+
+        ParallelRows(height, [&](int y) {
+            const float* in = input.Row(y);
+            float* out = temp.Row(y);
+            for (int x = 0; x < width; ++x) {
+                float sum = 0.f;
+                for (size_t k = 0; k < GlowWeights.size(); ++k) {
+                    const int sx = std::clamp(x + offsetsX[k], 0, width - 1);
+                    sum += in[sx] * GlowWeights[k];
+                }
+                out[x] = sum;
+            }
+        });
+
+        ParallelRows(height, [&](int y) {
+            std::array<const float*, 9> rows;
+            for (size_t k = 0; k < rows.size(); ++k)
+                rows[k] = temp.Row(std::clamp(y + offsetsY[k], 0, height - 1));
+            float* out = output.Row(y);
+            for (int x = 0; x < width; ++x) {
+                float sum = 0.f;
+                for (size_t k = 0; k < GlowWeights.size(); ++k)
+                    sum += rows[k][x] * GlowWeights[k];
+                out[x] = sum;
+            }
+        });
+    }
+
+    // Resamples the overlay to the screen size with bilinear filtering, as GLRender samples it
+    void ResampleOverlay() {
+        m_overlay.clear();
+        if (!m_overlayImage || m_screenWidth == 0)
+            return;
+
+        const auto& image = *m_overlayImage;
+        const int channels = image.hasAlpha ? 4 : 3;
+        auto Texel = [&](int x, int y, int c) -> float {
+            x = std::clamp(x, 0, image.width - 1);
+            y = std::clamp(y, 0, image.height - 1);
+            if (c == 3 && !image.hasAlpha)
+                return 1.f;
+            return image.data[(static_cast<size_t>(y) * image.width + x) * channels + c] / 255.f;
+        };
+
+        m_overlay.resize(static_cast<size_t>(m_screenWidth) * m_screenHeight);
+        for (int y = 0; y < m_screenHeight; ++y) {
+            const float v = (y + 0.5f) / m_screenHeight * image.height - 0.5f;
+            const int v0 = static_cast<int>(std::floor(v));
+            const float fv = v - v0;
+            for (int x = 0; x < m_screenWidth; ++x) {
+                const float u = (x + 0.5f) / m_screenWidth * image.width - 0.5f;
+                const int u0 = static_cast<int>(std::floor(u));
+                const float fu = u - u0;
+                auto& texel = m_overlay[static_cast<size_t>(y) * m_screenWidth + x];
+                for (int c = 0; c < 4; ++c) {
+                    const float top = Texel(u0, v0, c) * (1 - fu) + Texel(u0 + 1, v0, c) * fu;
+                    const float bottom =
+                        Texel(u0, v0 + 1, c) * (1 - fu) + Texel(u0 + 1, v0 + 1, c) * fu;
+                    texel[c] = top * (1 - fv) + bottom * fv;
+                }
+            }
+        }
+    }
+
+    // See CombineVectorsAndGlow.frag, DrawTexture.frag and DrawScreen.frag
+    void Composite(const Image& vectors, const Image* glow) {
+        const float overlayAlpha = m_config.overlayAlpha;
+
+        ParallelRows(m_screenHeight, [&](int y) {
+            // Output is top row first, while images are bottom row first
+            uint8_t* out = &m_output[static_cast<size_t>(m_screenHeight - 1 - y) * m_screenWidth * 4];
+            const int crtY = m_screenToCrtY[y];
+            const float* vectorsRow = crtY >= 0 ? vectors.Row(crtY) : nullptr;
+            const float* glowRow = crtY >= 0 && glow ? glow->Row(crtY) : nullptr;
+            const std::array<float, 4>* overlayRow =
+                m_overlay.empty() ? nullptr : &m_overlay[static_cast<size_t>(y) * m_screenWidth];
+
+            for (int x = 0; x < m_screenWidth; ++x) {
+                float crt = 0.f;
+                const int crtX = m_screenToCrtX[x];
+                if (vectorsRow && crtX >= 0) {
+                    crt = vectorsRow[crtX];
+                    if (glowRow)
+                        crt = std::max(crt, glowRow[crtX]);
+                }
+
+                std::array<float, 3> color = {crt, crt, crt};
+                if (overlayRow) {
+                    const auto& overlay = overlayRow[x];
+                    const float ratio = std::max(0.f, overlay[3] - (1 - overlayAlpha));
+                    for (int c = 0; c < 3; ++c)
+                        color[c] += (overlay[c] - color[c]) * ratio;
+                }
+
+                for (int c = 0; c < 3; ++c) {
+                    out[x * 4 + c] = static_cast<uint8_t>(
+                        std::lround(std::clamp(color[c], 0.f, 1.f) * 255.f));
+                }
+                out[x * 4 + 3] = 255;
+            }
+        });
+    }
+
+    SoftwareRender::Config m_config;
+    std::unique_ptr<WorkerPool> m_workerPool;
+    int m_screenWidth{};
+    int m_screenHeight{};
+    float m_crtScaleX{};
+    float m_crtScaleY{};
+
+    LineVertices::VertexArray m_quadVA;
+    LineVertices::VertexArray m_glowQuadVA;
+    std::vector<LineRect> m_rects;
+    std::vector<LineRect> m_glowRects;
+
+    std::vector<Tile> m_tiles;
+    int m_numTilesX{};
+    std::vector<std::vector<uint32_t>> m_bins; // Per tile, indices of rects overlapping it
+    std::vector<std::vector<uint32_t>> m_glowBins;
+
+    int m_vectorsImage0Index{};
+    Image m_vectorsImage[2];
+    Image m_vectorsThickImage[2];
+    Image m_tempImage;
+    Image m_glowImage;
+    std::vector<int> m_screenToCrtX; // CRT column sampled by each screen column, or -1
+    std::vector<int> m_screenToCrtY;
+
+    std::unique_ptr<ImageUtil::PngImageData> m_overlayImage;
+    std::vector<std::array<float, 4>> m_overlay; // RGBA, resampled to screen size
+    std::vector<uint8_t> m_output;
+};
+
+int SoftwareRender::ScreenWidthForHeight(int screenHeight) {
+    return static_cast<int>(std::lround(screenHeight * OverlayAR));
+}
+
+SoftwareRender::SoftwareRender() = default;
+SoftwareRender::~SoftwareRender() = default;
+
+void SoftwareRender::Initialize(int screenWidth, int screenHeight, size_t numThreads) {
+    m_impl->Initialize(screenWidth, screenHeight, numThreads);
+}
+
+SoftwareRender::Config& SoftwareRender::GetConfig() {
+    return m_impl->GetConfig();
+}
+
+bool SoftwareRender::ResetOverlay(const char* file) {
+    return m_impl->ResetOverlay(file);
+}
+
+void SoftwareRender::RenderScene(double frameTime, const RenderContext& renderContext) {
+    m_impl->RenderScene(frameTime, renderContext);
+}
+
+int SoftwareRender::Width() const {
+    return m_impl->Width();
+}
+
+int SoftwareRender::Height() const {
+    return m_impl->Height();
+}
+
+int SoftwareRender::FramesToFade(double frameTime) const {
+    return m_impl->FramesToFade(frameTime);
+}
+
+void SoftwareRender::Clear() {
+    m_impl->Clear();
+}
+
+const uint8_t* SoftwareRender::Pixels() const {
+    return m_impl->Pixels();
+}
@@ -0,0 +1,277 @@
+#include "engine/VectorStream.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace {
+    enum class Op : uint8_t { Copy, Move, Add };
+
+    const float BrightnessScale = 128.f;
+    const float AudioScale = 32767.f;
+
+    // Moved lines must stay within int16 range once translated; lines further out than this are
+    // sent as new (clamped) lines instead
+    const int32_t MaxMovedCoord = 16383;
+
+    // Size of the message header up to the line data
+    const size_t HeaderSize = sizeof(uint32_t) * 3 + sizeof(uint8_t);
+    const size_t LineSize = sizeof(int16_t) * 4 + sizeof(uint8_t);
+
+    template <typename T>
+    void Append(std::vector<uint8_t>& buffer, const T& value) {
+        const auto bytes = reinterpret_cast<const uint8_t*>(&value);
+        buffer.insert(buffer.end(), bytes, bytes + sizeof(T));
+    }
+
+    template <typename T>
+    void Patch(std::vector<uint8_t>& buffer, size_t offset, const T& value) {
+        std::memcpy(buffer.data() + offset, &value, sizeof(T));
+    }
+
+    int16_t ClampToInt16(int32_t value) {
+        return static_cast<int16_t>(std::clamp<int32_t>(value, INT16_MIN, INT16_MAX));
+    }
+
+    void AppendLine(std::vector<uint8_t>& buffer, const DisplayListDiff::QuantizedLine& q) {
+        Append(buffer, ClampToInt16(q.x0));
+        Append(buffer, ClampToInt16(q.y0));
+        Append(buffer, ClampToInt16(q.x1));
+        Append(buffer, ClampToInt16(q.y1));
+        Append(buffer, static_cast<uint8_t>(std::clamp<int32_t>(q.brightness, 0, UINT8_MAX)));
+    }
+
+    bool CanMove(const DisplayListDiff::QuantizedLine& q) {
+        return std::max({std::abs(q.x0), std::abs(q.y0), std::abs(q.x1), std::abs(q.y1)}) <=
+               MaxMovedCoord;
+    }
+
+    // Bounds-checked reads from a payload
+    class Reader {
+    public:
+        Reader(const uint8_t* data, size_t size)
+            : m_curr(data)
+            , m_end(data + size) {}
+
+        template <typename T>
+        bool Read(T& value) {
+            if (static_cast<size_t>(m_end - m_curr) < sizeof(T))
+                return false;
+            std::memcpy(&value, m_curr, sizeof(T));
+            m_curr += sizeof(T);
+            return true;
+        }
+
+        // Checks that count items of itemSize remain, so that sizes can be validated before
+        // resizing buffers to them
+        bool HasRemaining(size_t count, size_t itemSize) const {
+            return count <= static_cast<size_t>(m_end - m_curr) / itemSize;
+        }
+
+        bool AtEnd() const { return m_curr == m_end; }
+
+    private:
+        const uint8_t* m_curr;
+        const uint8_t* m_end;
+    };
+} // namespace
+
+namespace VectorStream {
+    void Encoder::Encode(uint32_t frameIndex, const LineStrips& lines,
+                         const std::vector<float>& samples, bool keyframe,
+                         std::vector<uint8_t>& message) {
+        using LineState = DisplayListDiff::LineState;
+
+        m_diff.Update(lines);
+        const auto& quantized = m_diff.QuantizedLines();
+        const auto& deltas = m_diff.Deltas();
+
+        message.clear();
+        Append(message, uint32_t{0}); // Payload size
+        Append(message, Magic);
+        Append(message, keyframe ? MessageType::Keyframe : MessageType::Delta);
+        Append(message, frameIndex);
+
+        if (keyframe) {
+            Append(message, static_cast<uint32_t>(quantized.size()));
+            for (const auto& q : quantized)
+                AppendLine(message, q);
+        } else {
+            const size_t numOpsOffset = message.size();
+            Append(message, uint32_t{0});
+            uint32_t numOps = 0;
+
+            for (size_t i = 0; i < quantized.size();) {
+                const auto& delta = deltas[i];
+
+                // Moved lines are translated by whole cells in quantized space
+                auto IsMoved = [&](size_t index) {
+                    return deltas[index].state == LineState::Moved && CanMove(quantized[index]) &&
+                           CanMove(m_prevLines[deltas[index].prevIndex]);
+                };
+                auto MoveOffset = [&](size_t index) {
+                    const auto& prev = m_prevLines[deltas[index].prevIndex];
+                    return std::make_pair(quantized[index].x0 - prev.x0,
+                                          quantized[index].y0 - prev.y0);
+                };
+
+                // Extend runs over following lines that continue the same op
+                size_t end = i + 1;
+                if (delta.state == LineState::Unchanged) {
+                    while (end < quantized.size() && deltas[end].state == LineState::Unchanged &&
+                           deltas[end].prevIndex == delta.prevIndex + (end - i)) {
+                        ++end;
+                    }
+                    Append(message, Op::Copy);
+                    Append(message, delta.prevIndex);
+                    Append(message, static_cast<uint32_t>(end - i));
+                } else if (IsMoved(i)) {
+                    const auto offset = MoveOffset(i);
+                    while (end < quantized.size() && IsMoved(end) &&
+                           deltas[end].prevIndex == delta.prevIndex + (end - i) &&
+                           MoveOffset(end) == offset) {
+                        ++end;
+                    }
+                    Append(message, Op::Move);
+                    Append(message, delta.prevIndex);
+                    Append(message, static_cast<uint32_t>(end - i));
+                    Append(message, static_cast<int16_t>(offset.first));
+                    Append(message, static_cast<int16_t>(offset.second));
+                } else {
+                    while (end < quantized.size() && deltas[end].state != LineState::Unchanged &&
+                           !IsMoved(end)) {
+                        ++end;
+                    }
+                    Append(message, Op::Add);
+                    Append(message, static_cast<uint32_t>(end - i));
+                    for (size_t j = i; j < end; ++j)
+                        AppendLine(message, quantized[j]);
+                }
+                ++numOps;
+                i = end;
+            }
+            Patch(message, numOpsOffset, numOps);
+        }
+
+        Append(message, static_cast<uint32_t>(samples.size()));
+        for (float sample : samples) {
+            Append(message,
+                   static_cast<int16_t>(std::lround(std::clamp(sample, -1.f, 1.f) * AudioScale)));
+        }
+        Patch(message, 0, static_cast<uint32_t>(message.size() - sizeof(uint32_t)));
+
+        m_lastKeyframeSize = HeaderSize + sizeof(uint32_t) + quantized.size() * LineSize +
+                             sizeof(uint32_t) + samples.size() * sizeof(int16_t);
+        m_prevLines = quantized;
+    }
+
+    bool Decoder::Decode(const uint8_t* payload, size_t size, LineStrips& lines,
+                         std::vector<float>& samples) {
+        Reader reader(payload, size);
+
+        auto ReadLines = [&](uint32_t count) {
+            if (!reader.HasRemaining(count, LineSize))
+                return false;
+            for (uint32_t i = 0; i < count; ++i) {
+                StreamLine line{};
+                reader.Read(line.x0);
+                reader.Read(line.y0);
+                reader.Read(line.x1);
+                reader.Read(line.y1);
+                reader.Read(line.brightness);
+                m_lines.push_back(line);
+            }
+            return true;
+        };
+
+        uint32_t magic{};
+        MessageType type{};
+        uint32_t frameIndex{};
+        if (!reader.Read(magic) || magic != Magic || !reader.Read(type) ||
+            !reader.Read(frameIndex)) {
+            return false;
+        }
+
+        m_lines.clear();
+        if (type == MessageType::Keyframe) {
+            uint32_t numLines{};
+            if (!reader.Read(numLines) || !ReadLines(numLines))
+                return false;
+        } else if (type == MessageType::Delta) {
+            uint32_t numOps{};
+            if (!m_hasPrevLines || !reader.Read(numOps))
+                return false;
+
+            for (uint32_t i = 0; i < numOps; ++i) {
+                Op op{};
+                uint32_t first{}, count{};
+                if (!reader.Read(op))
+                    return false;
+
+                if (op == Op::Copy || op == Op::Move) {
+                    int16_t dx{}, dy{};
+                    if (!reader.Read(first) || !reader.Read(count) ||
+                        (op == Op::Move && (!reader.Read(dx) || !reader.Read(dy))) ||
+                        first > m_prevLines.size() || count > m_prevLines.size() - first) {
+                        return false;
+                    }
+                    for (uint32_t j = first; j < first + count; ++j) {
+                        auto line = m_prevLines[j];
+                        line.x0 = static_cast<int16_t>(line.x0 + dx);
+                        line.y0 = static_cast<int16_t>(line.y0 + dy);
+                        line.x1 = static_cast<int16_t>(line.x1 + dx);
+                        line.y1 = static_cast<int16_t>(line.y1 + dy);
+                        m_lines.push_back(line);
+                    }
+                } else if (op == Op::Add) {
+                    if (!reader.Read(count) || !ReadLines(count))
+                        return false;
+                } else {
+                    return false;
+                }
+            }
+        } else {
+            return false;
+        }
+
+        uint32_t numSamples{};
+        if (!reader.Read(numSamples) || !reader.HasRemaining(numSamples, sizeof(int16_t)))
+            return false;
+        samples.resize(numSamples);
+        for (auto& sample : samples) {
+            int16_t value{};
+            reader.Read(value);
+            sample = value / AudioScale;
+        }
+        if (!reader.AtEnd())
+            return false;
+
+        // Reconnect lines into strips where they share end points, as the stream doesn't preserve
+        // strips (and may have reversed lines)
+        lines.Clear();
+        for (const auto& line : m_lines) {
+            const Vector2 p0{line.x0 * CellSize, line.y0 * CellSize};
+            const Vector2 p1{line.x1 * CellSize, line.y1 * CellSize};
+            const float brightness = line.brightness / BrightnessScale;
+            const bool sameStrip = !lines.Empty() && lines.LastStripBrightness() == brightness &&
+                                   !(p0 == p1);
+            if (sameStrip && lines.LastPoint() == p0) {
+                lines.AddPoint(p1);
+            } else if (sameStrip && lines.LastPoint() == p1) {
+                lines.AddPoint(p0);
+            } else {
+                lines.AddLine(Line{p0, p1, brightness});
+            }
+        }
+
+        std::swap(m_lines, m_prevLines);
+        m_hasPrevLines = true;
+        m_frameIndex = frameIndex;
+        return true;
+    }
+
+    void Decoder::Reset() {
+        m_prevLines.clear();
+        m_hasPrevLines = false;
+        m_frameIndex = {};
+    }
+} // namespace VectorStream
@@ -0,0 +1,104 @@
+#include "engine/VectorStreamServer.h"
+#include "core/ConsoleOutput.h"
+#include "emulator/EngineTypes.h"
+#include <chrono>
+
+namespace {
+    // A few frames of slack for hitches; a viewer that falls further behind than this is dropping
+    // frames anyway
+    const size_t FrameQueueSize = 4;
+
+    // Sent frames between keyframes, which bound how long a decoding error lasts
+    const int KeyframeInterval = 120;
+
+    // How often to check for a viewer connecting while there is none
+    const auto AcceptPollInterval = std::chrono::milliseconds(50);
+} // namespace
+
+VectorStreamServer::VectorStreamServer()
+    : m_frames(FrameQueueSize) {}
+
+VectorStreamServer::~VectorStreamServer() {
+    Stop();
+}
+
+bool VectorStreamServer::Start(uint16_t port) {
+    if (!m_server.Open(port)) {
+        Errorf("Vector stream: failed to listen on port %d\n", port);
+        return false;
+    }
+    m_port = port;
+    m_started = true;
+    m_stopRequested = false;
+    m_thread = std::thread([this] { ThreadMain(); });
+    Printf("Vector stream: listening on port %d\n", port);
+    return true;
+}
+
+void VectorStreamServer::AddFrame(const RenderContext& renderContext,
+                                  const AudioContext& audioContext) {
+    const uint32_t frameIndex = m_numFramesAdded++;
+    if (!m_viewerConnected)
+        return;
+
+    if (!m_frames.TryPush({frameIndex, renderContext.lines, audioContext.samples}))
+        ++m_numFramesDropped;
+}
+
+void VectorStreamServer::Stop() {
+    if (!m_started)
+        return;
+    m_started = false;
+
+    m_stopRequested = true;
+    m_frames.Close();
+    m_thread.join();
+    m_server.Close();
+
+    if (m_numFramesSent > 0) {
+        Printf("Vector stream: sent %zu frame(s) (%zu dropped), %.1f KB, %.1f%% of keyframes\n",
+               m_numFramesSent, m_numFramesDropped.load(), m_numBytesSent / 1024.0,
+               m_numKeyframeBytes > 0 ? m_numBytesSent * 100.0 / m_numKeyframeBytes : 0.0);
+    }
+}
+
+void VectorStreamServer::ThreadMain() {
+    VectorStream::Encoder encoder;
+    std::vector<uint8_t> message;
+    int framesSinceKeyframe = 0;
+
+    while (!m_stopRequested) {
+        if (!m_viewerConnected) {
+            if (!m_server.TryAccept()) {
+                std::this_thread::sleep_for(AcceptPollInterval);
+                continue;
+            }
+            Printf("Vector stream: viewer connected on port %d\n", m_port);
+            // Start the new viewer with a keyframe
+            framesSinceKeyframe = KeyframeInterval;
+            m_viewerConnected = true;
+        }
+
+        auto frame = m_frames.Pop();
+        if (!frame)
+            break;
+
+        const bool keyframe = framesSinceKeyframe >= KeyframeInterval;
+        framesSinceKeyframe = keyframe ? 1 : framesSinceKeyframe + 1;
+        encoder.Encode(frame->index, frame->lines, frame->samples, keyframe, message);
+
+        const int size = static_cast<int>(message.size());
+        if (m_server.Send(message.data(), size) < size) {
+            Printf("Vector stream: viewer disconnected from port %d\n", m_port);
+            m_viewerConnected = false;
+            m_server.Disconnect();
+            continue;
+        }
+
+        ++m_numFramesSent;
+        m_numBytesSent += message.size();
+        m_numKeyframeBytes += encoder.LastKeyframeSize();
+    }
+
+    m_viewerConnected = false;
+}
@@ -6,5 +6,8 @@ public:
     void RegisterClient(IEngineClient& client);
 
     // Blocking call, returns when application is exited (window closed, etc.)
+    // Passing -frames=N runs a headless benchmark of N frames (after -warmup=N frames) and reports
+    // timing results. Passing -batch=<rom list file or dir> runs each rom in its own Emulator
+    // instance across all cores. See NullEngine.cpp for the full list of flags.
     bool Run(int argc, char** argv);
 };
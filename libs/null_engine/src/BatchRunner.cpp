@@ -0,0 +1,463 @@
+#include "BatchRunner.h"
+#include "GoldenFile.h"
+#include "InputScript.h"
+#include "core/ConsoleOutput.h"
+#include "core/ErrorHandler.h"
+#include "core/Stream.h"
+#include "core/StringUtil.h"
+#include "debugger/CoverageReport.h"
+#include "emulator/Emulator.h"
+#include "emulator/EngineTypes.h"
+#include "engine/VectorStreamServer.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <fstream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+
+namespace {
+    using Clock = std::chrono::steady_clock;
+
+    const double FrameTime = 1.0 / 60;
+    const float AudioSampleRate = 44100.0f;
+
+    // Fixed so that each rom's output is the same from run to run, as golden files require
+    const unsigned int RamSeed = 0;
+
+    struct RomResult {
+        bool success = false;
+        std::string error;
+        int framesRun = 0;
+        double wallTime = 0;
+        size_t linesLastFrame = 0;
+        int goldenFramesDiffering = 0;
+        std::string goldenDiff; // First difference found against golden file
+        std::unique_ptr<CodeCoverage> coverage;
+        std::vector<uint8_t> romData; // For the coverage report
+    };
+
+    fs::path GoldenFilePath(const fs::path& goldenDir, const fs::path& romFile) {
+        return goldenDir / (romFile.stem().string() + ".golden");
+    }
+
+    fs::path HeatMapPath(const fs::path& heatMapDir, const fs::path& romFile, HeatMap::Kind kind) {
+        return heatMapDir / (romFile.stem().string() + "." + HeatMap::KindName(kind) + ".bin");
+    }
+
+    fs::path InputScriptPath(const fs::path& goldenDir, const fs::path& romFile) {
+        return goldenDir / (romFile.stem().string() + ".input");
+    }
+
+    RomResult RunRom(const BatchRunner::Config& config, size_t romIndex, const fs::path& romFile,
+                     const fs::path& logFile) {
+        RomResult result;
+
+        // Redirect this thread's console output and error state to this rom's log
+        FileStream logStream;
+        ScopedOverridePrintStream scopedPrintStream;
+        ScopedOverrideErrorStream scopedErrorStream;
+        if (logStream.Open(logFile, "w")) {
+            scopedPrintStream.SetPrintStream(logStream.Get());
+            scopedErrorStream.SetErrorStream(logStream.Get());
+        }
+        ErrorHandler::SetPolicy(ErrorHandler::Policy::LogOnce);
+        ErrorHandler::Reset();
+
+        const bool useGolden = !config.goldenDir.empty();
+        const bool compareGolden = useGolden && !config.updateGolden;
+        InputScript inputScript;
+        std::vector<GoldenFile::Frame> goldenFrames;
+
+        if (useGolden) {
+            if (auto scriptFile = InputScriptPath(config.goldenDir, romFile);
+                fs::exists(scriptFile) && !inputScript.Load(scriptFile)) {
+                result.error = "Failed to load input script";
+                return result;
+            }
+
+            if (compareGolden) {
+                auto goldenFile = GoldenFilePath(config.goldenDir, romFile);
+                if (auto frames = GoldenFile::Read(goldenFile)) {
+                    goldenFrames = std::move(*frames);
+                } else {
+                    result.error = "Missing or invalid golden file: " + goldenFile.string();
+                    return result;
+                }
+            }
+        }
+
+        // Roms already run in parallel, so capture each on as few threads as possible
+        FrameCapture frameCapture;
+        if (!config.captureDir.empty()) {
+            FrameCapture::Config captureConfig;
+            captureConfig.dir = config.captureDir / romFile.stem();
+            captureConfig.format = config.captureFormat;
+            captureConfig.frameInterval = config.captureInterval;
+            captureConfig.screenHeight = config.captureHeight;
+            captureConfig.frameTime = FrameTime;
+            captureConfig.numRenderThreads = 1;
+            captureConfig.numEncodeThreads = 1;
+            if (!frameCapture.Start(captureConfig)) {
+                result.error = "Failed to start capture";
+                return result;
+            }
+        }
+
+        const auto startTime = Clock::now();
+
+        try {
+            VectorStreamServer streamServer;
+            if (config.streamPort != 0 &&
+                !streamServer.Start(static_cast<uint16_t>(config.streamPort + romIndex))) {
+                result.error = "Failed to start stream server";
+                return result;
+            }
+
+            // Heap allocate as Emulator is large
+            auto emulator = std::make_unique<Emulator>();
+            emulator->Init(config.biosRomFile.string().c_str());
+
+            if (!emulator->LoadRom(romFile.string().c_str())) {
+                result.error = "Failed to load rom";
+            } else if (!emulator->SetBiosHleMode(config.biosHle)) {
+                result.error = "BIOS HLE not supported for this BIOS";
+            } else {
+                emulator->SetIdleLoopSkipping(config.skipIdleLoops);
+                emulator->Reset(RamSeed);
+
+                std::unique_ptr<HeatMap> heatMap;
+                if (!config.heatMapDir.empty()) {
+                    heatMap = std::make_unique<HeatMap>();
+                    emulator->SetHeatMap(heatMap.get());
+                }
+
+                if (!config.coverageDir.empty()) {
+                    result.coverage = std::make_unique<CodeCoverage>();
+                    result.coverage->Init(emulator->GetCartridge());
+                    result.romData = emulator->GetCartridge().GetData();
+                    emulator->SetCodeCoverage(result.coverage.get());
+                }
+
+                Input input{};
+                RenderContext renderContext{};
+                AudioContext audioContext{static_cast<float>(Cpu::Hz / AudioSampleRate)};
+                double cpuCyclesLeft = 0;
+                const auto& idleStats = emulator->GetIdleLoopSkipper().GetStats();
+                uint64_t maxIdleCyclesSkipped = 0; // In one frame
+
+                for (; result.framesRun < config.framesPerRom; ++result.framesRun) {
+                    const int frameIndex = result.framesRun;
+                    inputScript.Apply(frameIndex, input);
+
+                    cpuCyclesLeft += Cpu::Hz * FrameTime;
+                    const uint64_t idleCyclesSkipped = idleStats.numCyclesSkipped;
+                    while (cpuCyclesLeft > 0) {
+                        // BIOS HLE and idle loop skipping stop where the instruction loop would
+                        // have stopped
+                        const auto maxCycles = static_cast<cycles_t>(std::ceil(cpuCyclesLeft));
+                        cpuCyclesLeft -= emulator->ExecuteInstruction(input, renderContext,
+                                                                      audioContext, maxCycles);
+                    }
+                    maxIdleCyclesSkipped = std::max(
+                        maxIdleCyclesSkipped, idleStats.numCyclesSkipped - idleCyclesSkipped);
+                    emulator->FrameUpdate(FrameTime);
+
+                    if (useGolden) {
+                        auto frame = GoldenFile::MakeFrame(renderContext, audioContext);
+                        if (!compareGolden) {
+                            goldenFrames.push_back(std::move(frame));
+                        } else if (frameIndex >= static_cast<int>(goldenFrames.size())) {
+                            if (result.goldenDiff.empty()) {
+                                result.goldenDiff =
+                                    FormattedString<>("frame %d: golden file only has %zu frames",
+                                                      frameIndex, goldenFrames.size());
+                            }
+                            ++result.goldenFramesDiffering;
+                        } else if (auto diff = GoldenFile::Compare(
+                                       frameIndex, goldenFrames[frameIndex], frame,
+                                       renderContext.lines)) {
+                            if (result.goldenDiff.empty())
+                                result.goldenDiff = *diff;
+                            ++result.goldenFramesDiffering;
+                        }
+                    }
+
+                    frameCapture.AddFrame(renderContext, audioContext);
+                    streamServer.AddFrame(renderContext, audioContext);
+                    result.linesLastFrame = renderContext.lines.NumLines();
+                    renderContext.lines.Clear();
+                    audioContext.samples.clear();
+                }
+                result.success = true;
+
+                const auto& hleStats = emulator->GetBiosHle().GetStats();
+                if (config.biosHle != BiosHle::Mode::Off) {
+                    Printf("BIOS HLE: %llu calls, %llu cycles, %llu mismatches\n",
+                           static_cast<unsigned long long>(hleStats.numCalls),
+                           static_cast<unsigned long long>(hleStats.numCycles),
+                           static_cast<unsigned long long>(hleStats.numMismatches));
+                }
+                if (config.skipIdleLoops && result.framesRun > 0) {
+                    Printf("Idle loops: %llu cycles skipped per frame on average, %llu at most, in "
+                           "%llu skips\n",
+                           static_cast<unsigned long long>(idleStats.numCyclesSkipped /
+                                                           result.framesRun),
+                           static_cast<unsigned long long>(maxIdleCyclesSkipped),
+                           static_cast<unsigned long long>(idleStats.numSkips));
+                }
+
+                bool heatMapSaved = true;
+                if (heatMap) {
+                    Printf("Hottest instructions:\n");
+                    for (auto& entry : heatMap->Hottest(HeatMap::Kind::Execute, 10))
+                        Printf("  $%04x %u\n", entry.address, entry.count);
+
+                    for (auto kind : {HeatMap::Kind::Execute, HeatMap::Kind::Read,
+                                      HeatMap::Kind::Write}) {
+                        if (!heatMap->Save(kind, HeatMapPath(config.heatMapDir, romFile, kind)))
+                            heatMapSaved = false;
+                    }
+                }
+
+                if (!frameCapture.Stop()) {
+                    result.success = false;
+                    result.error = "Failed to write capture";
+                } else if (!heatMapSaved) {
+                    result.success = false;
+                    result.error = "Failed to write heat map";
+                } else if (config.updateGolden &&
+                    !GoldenFile::Write(GoldenFilePath(config.goldenDir, romFile), goldenFrames)) {
+                    result.success = false;
+                    result.error = "Failed to write golden file";
+                } else if (result.goldenFramesDiffering > 0) {
+                    result.success = false;
+                    result.error = FormattedString<>("%d/%d frames differ from golden, first at %s",
+                                                     result.goldenFramesDiffering,
+                                                     result.framesRun, result.goldenDiff.c_str());
+                } else if (hleStats.numMismatches > 0) {
+                    result.success = false;
+                    result.error = FormattedString<>("%llu BIOS HLE calls differ from emulation",
+                                                     static_cast<unsigned long long>(
+                                                         hleStats.numMismatches));
+                }
+            }
+        } catch (const std::exception& ex) {
+            result.error = ex.what();
+        }
+
+        result.wallTime = std::chrono::duration<double>(Clock::now() - startTime).count();
+
+        if (!result.success)
+            Errorf("Failed after %d frames: %s\n", result.framesRun, result.error.c_str());
+
+        return result;
+    }
+
+    // Merges the coverage of roms with the same contents and writes a report for each, named after
+    // the first of them
+    bool WriteCoverage(const BatchRunner::Config& config, std::vector<RomResult>& results) {
+        Debugger::SymbolTable commonSymbols;
+        if (!config.symbolsFile.empty() &&
+            !Debugger::LoadSymbolsFile(config.symbolsFile, commonSymbols)) {
+            Errorf("Failed to load symbols from %s\n", config.symbolsFile.string().c_str());
+            return false;
+        }
+
+        std::map<uint64_t, std::vector<size_t>> romsByContent;
+        for (size_t i = 0; i < results.size(); ++i) {
+            if (results[i].coverage)
+                romsByContent[results[i].coverage->GetContentHash()].push_back(i);
+        }
+
+        bool success = true;
+        for (auto& [contentHash, romIndices] : romsByContent) {
+            auto& first = results[romIndices[0]];
+            for (size_t i = 1; i < romIndices.size(); ++i)
+                first.coverage->Merge(*results[romIndices[i]].coverage);
+
+            const auto& romFile = config.romFiles[romIndices[0]];
+            auto symbols = commonSymbols;
+            for (const char* ext : {".lst", ".map", ".asm", ".a09"}) {
+                auto symbolsFile = fs::path(romFile).replace_extension(ext);
+                if (fs::exists(symbolsFile))
+                    Debugger::LoadSymbolsFile(symbolsFile, symbols);
+            }
+
+            if (!CoverageReport::Write(config.coverageDir, romFile.stem().string(),
+                                       *first.coverage, first.romData, symbols,
+                                       romIndices.size())) {
+                Errorf("Failed to write coverage for %s\n", romFile.string().c_str());
+                success = false;
+            }
+        }
+        return success;
+    }
+
+    // Log file name unique to index so that roms with the same name in different dirs don't clash
+    fs::path MakeLogFile(const fs::path& logDir, const fs::path& romFile, size_t index) {
+        return logDir / FormattedString<>("%04zu_%s.log", index, romFile.stem().string().c_str())
+                            .Value();
+    }
+} // namespace
+
+namespace BatchRunner {
+    std::vector<fs::path> GatherRomFiles(const fs::path& listOrDir) {
+        std::vector<fs::path> romFiles;
+
+        if (fs::is_directory(listOrDir)) {
+            for (auto& entry : fs::recursive_directory_iterator(listOrDir)) {
+                if (!entry.is_regular_file())
+                    continue;
+                auto ext = StringUtil::ToLower(entry.path().extension().string());
+                if (ext == ".vec" || ext == ".bin")
+                    romFiles.push_back(entry.path());
+            }
+            std::sort(romFiles.begin(), romFiles.end());
+
+        } else {
+            std::ifstream listFile(listOrDir);
+            if (!listFile) {
+                Errorf("Failed to open rom list file: %s\n", listOrDir.string().c_str());
+                return {};
+            }
+
+            std::string line;
+            while (std::getline(listFile, line)) {
+                line = StringUtil::Trim(line, " \t\r");
+                if (line.empty() || line[0] == '#')
+                    continue;
+                fs::path romFile = line;
+                if (romFile.is_relative())
+                    romFile = listOrDir.parent_path() / romFile;
+                romFiles.push_back(romFile);
+            }
+        }
+
+        return romFiles;
+    }
+
+    bool Run(const Config& config) {
+        const size_t numRoms = config.romFiles.size();
+        if (numRoms == 0) {
+            Errorf("No roms to run\n");
+            return false;
+        }
+
+        if (!config.logDir.empty())
+            fs::create_directories(config.logDir);
+        if (!config.heatMapDir.empty())
+            fs::create_directories(config.heatMapDir);
+        if (!config.coverageDir.empty())
+            fs::create_directories(config.coverageDir);
+
+        if (!config.goldenDir.empty() || !config.captureDir.empty() ||
+            !config.heatMapDir.empty() || !config.coverageDir.empty()) {
+            // Golden files, capture dirs, heat maps and coverage reports are named after roms, so
+            // names must be unique
+            std::set<std::string> romNames;
+            for (auto& romFile : config.romFiles) {
+                if (!romNames.insert(romFile.stem().string()).second) {
+                    Errorf("Rom name used more than once, can't use golden files, capture, heat "
+                           "maps or coverage: %s\n",
+                           romFile.stem().string().c_str());
+                    return false;
+                }
+            }
+
+            if (config.updateGolden)
+                fs::create_directories(config.goldenDir);
+        }
+
+        if (config.streamPort != 0) {
+            if (config.streamPort + numRoms - 1 > UINT16_MAX) {
+                Errorf("Not enough ports above %d to stream %zu roms\n", config.streamPort,
+                       numRoms);
+                return false;
+            }
+            Printf("Streaming roms on ports %d-%zu\n", config.streamPort,
+                   config.streamPort + numRoms - 1);
+        }
+
+        size_t numThreads = config.numThreads > 0 ? config.numThreads
+                                                  : std::max(1u, std::thread::hardware_concurrency());
+        numThreads = std::min(numThreads, numRoms);
+
+        Printf("Running %zu roms for %d frames each on %zu threads\n", numRoms,
+               config.framesPerRom, numThreads);
+        if (config.biosHle != BiosHle::Mode::Off) {
+            Printf("BIOS HLE %s\n",
+                   config.biosHle == BiosHle::Mode::Validate ? "validating against emulation"
+                                                             : "on");
+        }
+        if (!config.goldenDir.empty()) {
+            Printf("%s golden files in: %s\n",
+                   config.updateGolden ? "Updating" : "Comparing against",
+                   config.goldenDir.string().c_str());
+        }
+
+        std::vector<RomResult> results(numRoms);
+        std::atomic<size_t> nextRomIndex = 0;
+        std::atomic<size_t> numRomsDone = 0;
+        std::mutex printMutex;
+
+        // Capture main thread's stdout as worker threads redirect their own print streams
+        FILE* const progressStream = GetStream(ConsoleStream::Output);
+
+        const auto startTime = Clock::now();
+
+        auto worker = [&] {
+            for (size_t i = nextRomIndex++; i < numRoms; i = nextRomIndex++) {
+                const auto& romFile = config.romFiles[i];
+                const auto logFile = config.logDir.empty()
+                                         ? fs::path{}
+                                         : MakeLogFile(config.logDir, romFile, i);
+
+                results[i] = RunRom(config, i, romFile, logFile);
+
+                std::lock_guard<std::mutex> lock(printMutex);
+                fprintf(progressStream, "[%zu/%zu] %s %s (%.2f s)\n", ++numRomsDone, numRoms,
+                        results[i].success ? "OK  " : "FAIL", romFile.string().c_str(),
+                        results[i].wallTime);
+                fflush(progressStream);
+            }
+        };
+
+        std::vector<std::thread> threads;
+        for (size_t i = 0; i < numThreads; ++i)
+            threads.emplace_back(worker);
+        for (auto& thread : threads)
+            thread.join();
+
+        const double wallTime = std::chrono::duration<double>(Clock::now() - startTime).count();
+
+        size_t numFailed = 0;
+        for (size_t i = 0; i < numRoms; ++i) {
+            if (!results[i].success) {
+                if (numFailed++ == 0)
+                    Printf("\nFailed roms:\n");
+                Printf("  %s: %s\n", config.romFiles[i].string().c_str(),
+                       results[i].error.c_str());
+            }
+        }
+
+        bool coverageWritten = true;
+        if (!config.coverageDir.empty())
+            coverageWritten = WriteCoverage(config, results);
+
+        Printf("\n%zu/%zu roms passed in %.2f s\n", numRoms - numFailed, numRoms, wallTime);
+        if (!config.logDir.empty())
+            Printf("Logs written to: %s\n", config.logDir.string().c_str());
+        if (!config.captureDir.empty())
+            Printf("Captures written to: %s\n", config.captureDir.string().c_str());
+        if (!config.coverageDir.empty() && coverageWritten)
+            Printf("Coverage written to: %s\n", config.coverageDir.string().c_str());
+
+        return numFailed == 0 && coverageWritten;
+    }
+} // namespace BatchRunner
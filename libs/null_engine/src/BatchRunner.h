@@ -0,0 +1,62 @@
+#pragma once
+
+#include "FrameCapture.h"
+#include "core/FileSystem.h"
+#include "emulator/BiosHle.h"
+#include <vector>
+
+// Runs a list of roms headlessly, each in its own Emulator instance, spread across a pool of worker
+// threads. Console output and errors from each instance are written to a separate log file.
+//
+// If a golden dir is set, each rom's per-frame video and audio output is compared against (or, when
+// updating, recorded to) <goldenDir>/<rom name>.golden, and scripted input is played back from
+// <goldenDir>/<rom name>.input if it exists (see InputScript.h).
+//
+// If a capture dir is set, each rom's video and audio are written to <captureDir>/<rom name>/ (see
+// FrameCapture.h).
+//
+// If a stream port is set, rom N's output is streamed to viewers on port + N (see
+// VectorStreamServer.h).
+//
+// If BIOS HLE is on, BIOS routines run natively (see BiosHle.h). In Validate mode, each call is
+// also emulated and compared, and a rom fails if any call differs.
+//
+// If idle loop skipping is on, loops that only poll the VIA are skipped (see IdleLoopSkipper.h), and
+// each rom's log reports how many cycles were skipped per frame.
+//
+// If a heat map dir is set, each rom's executions, reads and writes per address are written to
+// <heatMapDir>/<rom name>.{pc,reads,writes}.bin (see HeatMap.h), and its log lists its hottest
+// instructions.
+//
+// If a coverage dir is set, the instructions each rom executes are recorded (see CodeCoverage.h).
+// Coverage of roms with the same contents is merged, and written to <coverageDir>/<rom name>.*
+// (see CoverageReport.h), labeled with symbols from the symbols file if set, and from a .lst, .map,
+// .asm or .a09 file next to the rom with the same name.
+namespace BatchRunner {
+    struct Config {
+        fs::path biosRomFile;
+        std::vector<fs::path> romFiles;
+        int framesPerRom = 60 * 60;
+        int numThreads = 0; // If 0, uses one thread per hardware thread
+        fs::path logDir;
+        fs::path goldenDir;
+        bool updateGolden = false;
+        fs::path captureDir;
+        FrameCapture::Format captureFormat = FrameCapture::Format::Png;
+        int captureInterval = 1;
+        int captureHeight = 600;
+        uint16_t streamPort{}; // If 0, doesn't stream
+        BiosHle::Mode biosHle = BiosHle::Mode::Off;
+        bool skipIdleLoops = false;
+        fs::path heatMapDir;
+        fs::path coverageDir;
+        fs::path symbolsFile;
+    };
+
+    // Returns roms listed in a text file (one path per line, relative to the file's directory), or
+    // all .vec and .bin files found recursively if listOrDir is a directory.
+    std::vector<fs::path> GatherRomFiles(const fs::path& listOrDir);
+
+    // Blocking call, returns true if all roms ran without failing (and matched their golden files)
+    bool Run(const Config& config);
+} // namespace BatchRunner
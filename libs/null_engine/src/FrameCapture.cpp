@@ -0,0 +1,288 @@
+#include "FrameCapture.h"
+#include "core/ConsoleOutput.h"
+#include "core/ImageUtil.h"
+#include "core/StringUtil.h"
+#include "emulator/EngineTypes.h"
+#include <algorithm>
+#include <cmath>
+#include <system_error>
+
+namespace {
+    const uint32_t AudioSampleRate = 44100;
+    const float AudioScale = 32767.f;
+
+    // Enough to smooth out hitches without holding on to much memory: a queued frame to render is
+    // a few KB, but one to encode is a full screen of RGBA.
+    const size_t RenderQueueSize = 16;
+    const size_t EncodeQueueSize = 4;
+
+    // Canonical 44-byte PCM header. Sizes are written as 0 and patched once all samples are in.
+    void WriteWavHeader(FileStream& fs) {
+        const uint16_t numChannels = 1;
+        const uint16_t bitsPerSample = 16;
+        const uint16_t blockAlign = numChannels * bitsPerSample / 8;
+
+        fs.Write("RIFF", 4);
+        fs.WriteValue(uint32_t{0}); // 36 + data size
+        fs.Write("WAVE", 4);
+        fs.Write("fmt ", 4);
+        fs.WriteValue(uint32_t{16});
+        fs.WriteValue(uint16_t{1}); // PCM
+        fs.WriteValue(numChannels);
+        fs.WriteValue(AudioSampleRate);
+        fs.WriteValue(uint32_t{AudioSampleRate * blockAlign});
+        fs.WriteValue(blockAlign);
+        fs.WriteValue(bitsPerSample);
+        fs.Write("data", 4);
+        fs.WriteValue(uint32_t{0}); // Data size
+    }
+
+    // BT.601 limited range, as players assume for Y4M
+    uint8_t RgbToY(int r, int g, int b) {
+        return static_cast<uint8_t>(((66 * r + 129 * g + 25 * b + 128) >> 8) + 16);
+    }
+    uint8_t RgbToU(int r, int g, int b) {
+        return static_cast<uint8_t>(((-38 * r - 74 * g + 112 * b + 128) >> 8) + 128);
+    }
+    uint8_t RgbToV(int r, int g, int b) {
+        return static_cast<uint8_t>(((112 * r - 94 * g - 18 * b + 128) >> 8) + 128);
+    }
+
+    // Converts RGBA to planar 4:2:0 YUV, with chroma from the average of each 2x2 block.
+    // Width and height must be even.
+    void RgbaToYuv420(const uint8_t* rgba, int width, int height, std::vector<uint8_t>& yuv) {
+        const size_t lumaSize = static_cast<size_t>(width) * height;
+        yuv.resize(lumaSize + lumaSize / 2);
+        uint8_t* yPlane = yuv.data();
+        uint8_t* uPlane = yPlane + lumaSize;
+        uint8_t* vPlane = uPlane + lumaSize / 4;
+
+        for (int y = 0; y < height; ++y) {
+            const uint8_t* src = rgba + static_cast<size_t>(y) * width * 4;
+            uint8_t* dst = yPlane + static_cast<size_t>(y) * width;
+            for (int x = 0; x < width; ++x, src += 4)
+                dst[x] = RgbToY(src[0], src[1], src[2]);
+        }
+
+        const size_t stride = static_cast<size_t>(width) * 4;
+        for (int y = 0; y < height; y += 2) {
+            const uint8_t* row0 = rgba + y * stride;
+            const uint8_t* row1 = row0 + stride;
+            for (int x = 0; x < width; x += 2) {
+                const size_t i = x * 4;
+                const int r = (row0[i] + row0[i + 4] + row1[i] + row1[i + 4] + 2) / 4;
+                const int g = (row0[i + 1] + row0[i + 5] + row1[i + 1] + row1[i + 5] + 2) / 4;
+                const int b = (row0[i + 2] + row0[i + 6] + row1[i + 2] + row1[i + 6] + 2) / 4;
+                *uPlane++ = RgbToU(r, g, b);
+                *vPlane++ = RgbToV(r, g, b);
+            }
+        }
+    }
+} // namespace
+
+std::optional<FrameCapture::Format> FrameCapture::ParseFormat(const std::string& name) {
+    const auto lower = StringUtil::ToLower(name);
+    if (lower == "png")
+        return Format::Png;
+    if (lower == "y4m")
+        return Format::Y4m;
+    return {};
+}
+
+FrameCapture::FrameCapture()
+    : m_renderQueue(RenderQueueSize)
+    , m_encodeQueue(EncodeQueueSize) {}
+
+FrameCapture::~FrameCapture() {
+    Stop();
+}
+
+bool FrameCapture::Start(const Config& config) {
+    m_config = config;
+    m_config.frameInterval = std::max(m_config.frameInterval, 1);
+
+    std::error_code ec;
+    fs::create_directories(m_config.dir, ec);
+    if (ec) {
+        Errorf("Failed to create capture dir: %s\n", m_config.dir.string().c_str());
+        return false;
+    }
+
+    const auto audioFile = m_config.dir / "audio.wav";
+    if (!m_audioFile.Open(audioFile, "wb")) {
+        Errorf("Failed to open for writing: %s\n", audioFile.string().c_str());
+        return false;
+    }
+    WriteWavHeader(m_audioFile);
+
+    // Even dimensions, as 4:2:0 video requires (and most video encoders fed PNGs)
+    const int screenHeight = std::max(m_config.screenHeight & ~1, 2);
+    const int screenWidth = std::max(SoftwareRender::ScreenWidthForHeight(screenHeight) & ~1, 2);
+
+    if (m_config.format == Format::Y4m) {
+        const auto videoFile = m_config.dir / "video.y4m";
+        if (!m_videoFile.Open(videoFile, "wb")) {
+            Errorf("Failed to open for writing: %s\n", videoFile.string().c_str());
+            return false;
+        }
+        const auto fps = static_cast<int>(std::lround(1.0 / m_config.frameTime));
+        m_videoFile.Printf("YUV4MPEG2 W%d H%d F%d:%d Ip A1:1 C420jpeg\n", screenWidth,
+                           screenHeight, fps, m_config.frameInterval);
+    }
+
+    m_render.Initialize(screenWidth, screenHeight, m_config.numRenderThreads);
+    m_framesToFade = m_render.FramesToFade(m_config.frameTime);
+
+    size_t numEncodeThreads = 1;
+    if (m_config.format == Format::Png) {
+        numEncodeThreads = m_config.numEncodeThreads > 0
+                               ? m_config.numEncodeThreads
+                               : std::max(1u, std::thread::hardware_concurrency());
+    }
+
+    m_renderThread = std::thread([this] { RenderMain(); });
+    for (size_t i = 0; i < numEncodeThreads; ++i)
+        m_encodeThreads.emplace_back([this] { EncodeMain(); });
+
+    m_started = true;
+    Printf("Capturing every %d frame(s) at %dx%d to: %s\n", m_config.frameInterval, screenWidth,
+           screenHeight, m_config.dir.string().c_str());
+    return true;
+}
+
+void FrameCapture::AddFrame(const RenderContext& renderContext, const AudioContext& audioContext) {
+    if (!m_started)
+        return;
+
+    // Only frames within m_framesToFade of the next captured one are visible in it
+    const int frameIndex = m_numFramesAdded++;
+    const int framesToCapture =
+        (m_config.frameInterval - frameIndex % m_config.frameInterval) % m_config.frameInterval;
+
+    RenderJob job;
+    job.capture = framesToCapture == 0;
+    job.render = m_framesToFade == 0 || framesToCapture <= m_framesToFade;
+    if (job.render)
+        job.lines = renderContext.lines;
+    job.samples = audioContext.samples;
+    m_renderQueue.Push(std::move(job));
+}
+
+void FrameCapture::ResetOverlay(const char* file) {
+    if (!m_started)
+        return;
+
+    RenderJob job;
+    job.overlayFile = file ? file : "";
+    m_renderQueue.Push(std::move(job));
+}
+
+bool FrameCapture::Stop() {
+    if (!m_started)
+        return true;
+    m_started = false;
+
+    // The render thread closes the encode queue once it's drained the render queue
+    m_renderQueue.Close();
+    m_renderThread.join();
+    for (auto& thread : m_encodeThreads)
+        thread.join();
+    m_encodeThreads.clear();
+
+    // Patch sizes in the WAV header
+    const auto dataSize = checked_static_cast<uint32_t>(m_audioDataSize);
+    m_audioFile.SetPos(4);
+    m_audioFile.WriteValue(uint32_t{36 + dataSize});
+    m_audioFile.SetPos(40);
+    m_audioFile.WriteValue(dataSize);
+    m_audioFile.Close();
+    m_videoFile.Close();
+
+    Printf("Captured %d frame(s) and %.2f s of audio to: %s\n", m_numFramesCaptured,
+           m_audioDataSize / sizeof(int16_t) / static_cast<double>(AudioSampleRate),
+           m_config.dir.string().c_str());
+    return !m_failed;
+}
+
+void FrameCapture::RenderMain() {
+    RenderContext renderContext{};
+    bool skippedFrames = false;
+
+    while (auto job = m_renderQueue.Pop()) {
+        if (job->overlayFile) {
+            const char* file = job->overlayFile->empty() ? nullptr : job->overlayFile->c_str();
+            if (!m_render.ResetOverlay(file))
+                Errorf("Frame capture: Failed to load overlay: %s\n", file);
+            continue;
+        }
+
+        WriteAudio(job->samples);
+
+        if (!job->render) {
+            skippedFrames = true;
+            continue;
+        }
+
+        // Whatever was drawn before the skipped frames would have faded out by now
+        if (skippedFrames) {
+            m_render.Clear();
+            skippedFrames = false;
+        }
+
+        renderContext.lines = std::move(job->lines);
+        m_render.RenderScene(m_config.frameTime, renderContext);
+
+        if (job->capture) {
+            const uint8_t* pixels = m_render.Pixels();
+            const size_t size = static_cast<size_t>(m_render.Width()) * m_render.Height() * 4;
+            m_encodeQueue.Push(
+                {m_numFramesCaptured++, std::vector<uint8_t>(pixels, pixels + size)});
+        }
+    }
+
+    m_encodeQueue.Close();
+}
+
+void FrameCapture::EncodeMain() {
+    std::vector<uint8_t> yuv;
+
+    while (auto job = m_encodeQueue.Pop()) {
+        if (m_config.format == Format::Y4m) {
+            if (!WriteVideoFrame(*job, yuv))
+                ReportError("Failed to write", m_config.dir / "video.y4m");
+        } else {
+            const auto file =
+                m_config.dir / FormattedString<>("frame_%06d.png", job->index).Value();
+            if (!ImageUtil::writePngImage(file.string().c_str(), m_render.Width(),
+                                          m_render.Height(), 4, job->pixels.data())) {
+                ReportError("Failed to write", file);
+            }
+        }
+    }
+}
+
+void FrameCapture::WriteAudio(const std::vector<float>& samples) {
+    if (samples.empty())
+        return;
+
+    m_audioBuffer.resize(samples.size());
+    std::transform(samples.begin(), samples.end(), m_audioBuffer.begin(), [](float sample) {
+        return static_cast<int16_t>(std::lround(std::clamp(sample, -1.f, 1.f) * AudioScale));
+    });
+
+    if (m_audioFile.Write(m_audioBuffer.data(), m_audioBuffer.size()) != m_audioBuffer.size())
+        ReportError("Failed to write", m_config.dir / "audio.wav");
+    m_audioDataSize += m_audioBuffer.size() * sizeof(int16_t);
+}
+
+bool FrameCapture::WriteVideoFrame(const EncodeJob& job, std::vector<uint8_t>& yuv) {
+    RgbaToYuv420(job.pixels.data(), m_render.Width(), m_render.Height(), yuv);
+    return m_videoFile.Write("FRAME\n", 6) == 6 &&
+           m_videoFile.Write(yuv.data(), yuv.size()) == yuv.size();
+}
+
+void FrameCapture::ReportError(const char* what, const fs::path& file) {
+    // Only report the first error, as a full disk would fail every frame
+    if (!m_failed.exchange(true))
+        Errorf("Frame capture: %s: %s\n", what, file.string().c_str());
+}
@@ -0,0 +1,104 @@
+#pragma once
+
+#include "core/BlockingQueue.h"
+#include "core/FileSystem.h"
+#include "core/LineStrips.h"
+#include "core/Stream.h"
+#include "engine/SoftwareRender.h"
+#include <atomic>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <thread>
+#include <vector>
+
+struct RenderContext;
+struct AudioContext;
+
+// Writes the emulator's output to disk during headless runs, to make clips: every Nth frame is
+// rendered with SoftwareRender and written as a PNG image sequence or a Y4M video, and all audio is
+// written to a WAV file. Files written to the capture dir:
+//
+//   frame_000000.png, frame_000001.png, ... or video.y4m
+//   audio.wav
+//
+// Rendering, encoding and file I/O run on background threads fed by bounded queues. The emulation
+// thread only copies each frame's lines and samples, and only waits if the capture threads fall
+// behind. Frames too old to visibly affect a captured one (see SoftwareRender::FramesToFade) are
+// not rendered at all, so capturing every Nth frame costs less as N grows.
+class FrameCapture {
+public:
+    enum class Format { Png, Y4m };
+
+    struct Config {
+        fs::path dir;
+        Format format = Format::Png;
+        int frameInterval = 1;  // Capture every Nth frame
+        int screenHeight = 600; // Width is set to match the overlay aspect ratio
+        double frameTime = 1.0 / 60;
+        size_t numRenderThreads = 0; // See SoftwareRender::Initialize
+        // PNG only, 0 means one per hardware thread. Y4M frames are written in order by one thread.
+        size_t numEncodeThreads = 0;
+    };
+
+    // Parses "png" or "y4m"
+    static std::optional<Format> ParseFormat(const std::string& name);
+
+    FrameCapture();
+    ~FrameCapture();
+
+    FrameCapture(const FrameCapture&) = delete;
+    FrameCapture& operator=(const FrameCapture&) = delete;
+
+    // Creates the capture dir and output files, and starts the capture threads
+    bool Start(const Config& config);
+
+    // Queues the output of the next frame
+    void AddFrame(const RenderContext& renderContext, const AudioContext& audioContext);
+
+    // Loads the overlay drawn over captured frames from the next one added; pass nullptr to
+    // remove it
+    void ResetOverlay(const char* file);
+
+    // Waits for queued frames to be written, and closes the output files. Returns false if
+    // writing any of them failed.
+    bool Stop();
+
+private:
+    struct RenderJob {
+        bool render = false;  // If false, only the audio is written
+        bool capture = false; // Encode the rendered frame
+        LineStrips lines;
+        std::vector<float> samples;
+        std::optional<std::string> overlayFile; // If set, only resets the overlay
+    };
+
+    struct EncodeJob {
+        int index{};
+        std::vector<uint8_t> pixels;
+    };
+
+    void RenderMain();
+    void EncodeMain();
+    void WriteAudio(const std::vector<float>& samples);
+    bool WriteVideoFrame(const EncodeJob& job, std::vector<uint8_t>& yuv);
+    void ReportError(const char* what, const fs::path& file);
+
+    Config m_config;
+    bool m_started = false;
+    int m_framesToFade{};
+    int m_numFramesAdded{};    // Emulation thread
+    int m_numFramesCaptured{}; // Render thread
+
+    SoftwareRender m_render;
+    BlockingQueue<RenderJob> m_renderQueue;
+    BlockingQueue<EncodeJob> m_encodeQueue;
+    std::thread m_renderThread;
+    std::vector<std::thread> m_encodeThreads;
+
+    FileStream m_audioFile;
+    size_t m_audioDataSize{};
+    std::vector<int16_t> m_audioBuffer;
+    FileStream m_videoFile;
+    std::atomic<bool> m_failed = false;
+};
@@ -0,0 +1,125 @@
+#include "GoldenFile.h"
+#include "core/Encode.h"
+#include "core/Line.h"
+#include "core/LineStrips.h"
+#include "core/Stream.h"
+#include "core/StringUtil.h"
+#include "emulator/EngineTypes.h"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+    const uint32_t Magic = 0x44475856; // "VXGD"
+    // Version 2: lines are output as merged strips (see Screen::Update)
+    const uint32_t Version = 2;
+
+    // Screen positions are quantized to 1/32 of a unit, and brightness to the 128 levels the
+    // screen actually produces.
+    const float PositionScale = 32.f;
+    const float BrightnessScale = 128.f;
+    const float AudioScale = 32767.f;
+
+    int32_t Quantize(float value, float scale) {
+        return static_cast<int32_t>(std::lround(value * scale));
+    }
+} // namespace
+
+namespace GoldenFile {
+    uint32_t HashLine(const Line& line) {
+        const int32_t values[] = {
+            Quantize(line.p0.x, PositionScale), Quantize(line.p0.y, PositionScale),
+            Quantize(line.p1.x, PositionScale), Quantize(line.p1.y, PositionScale),
+            Quantize(line.brightness, BrightnessScale),
+        };
+        return Encode::Crc32(0, values, sizeof(values));
+    }
+
+    uint32_t HashAudio(const std::vector<float>& samples) {
+        uint32_t hash = 0;
+        for (float sample : samples) {
+            const auto value = static_cast<int16_t>(Quantize(sample, AudioScale));
+            hash = Encode::Crc32(hash, value);
+        }
+        return hash;
+    }
+
+    Frame MakeFrame(const RenderContext& renderContext, const AudioContext& audioContext) {
+        Frame frame;
+        frame.audioHash = HashAudio(audioContext.samples);
+        frame.lineHashes.reserve(renderContext.lines.NumLines());
+        renderContext.lines.ForEachLine(
+            [&frame](const Line& line) { frame.lineHashes.push_back(HashLine(line)); });
+        return frame;
+    }
+
+    bool Write(const fs::path& file, const std::vector<Frame>& frames) {
+        FileStream fs;
+        if (!fs.Open(file, "wb"))
+            return false;
+
+        fs.WriteValue(Magic);
+        fs.WriteValue(Version);
+        fs.WriteValue(checked_static_cast<uint32_t>(frames.size()));
+        for (auto& frame : frames) {
+            fs.WriteValue(frame.audioHash);
+            fs.WriteValue(checked_static_cast<uint32_t>(frame.lineHashes.size()));
+            fs.Write(frame.lineHashes.data(), frame.lineHashes.size());
+        }
+        return true;
+    }
+
+    std::optional<std::vector<Frame>> Read(const fs::path& file) {
+        FileStream fs;
+        if (!fs.Open(file, "rb"))
+            return {};
+
+        uint32_t magic{}, version{}, numFrames{};
+        if (!fs.ReadValue(magic) || magic != Magic || !fs.ReadValue(version) ||
+            version != Version || !fs.ReadValue(numFrames)) {
+            return {};
+        }
+
+        std::vector<Frame> frames(numFrames);
+        for (auto& frame : frames) {
+            uint32_t numLines{};
+            if (!fs.ReadValue(frame.audioHash) || !fs.ReadValue(numLines))
+                return {};
+            frame.lineHashes.resize(numLines);
+            if (numLines > 0 && !fs.Read(frame.lineHashes.data(), numLines))
+                return {};
+        }
+        return frames;
+    }
+
+    std::optional<std::string> Compare(int frameIndex, const Frame& expected, const Frame& actual,
+                                       const LineStrips& actualLines) {
+        const auto& e = expected.lineHashes;
+        const auto& a = actual.lineHashes;
+
+        auto [firstDiff, _] = std::mismatch(e.begin(), e.end(), a.begin(), a.end());
+        const auto lineIndex = static_cast<size_t>(firstDiff - e.begin());
+
+        if (lineIndex < e.size() && lineIndex < a.size()) {
+            std::vector<Line> lines;
+            actualLines.AppendLines(lines);
+            const Line& line = lines[lineIndex];
+            return FormattedString<>("frame %d: line %zu differs, got (%.3f, %.3f)-(%.3f, %.3f) "
+                                     "brightness %.3f",
+                                     frameIndex, lineIndex, line.p0.x, line.p0.y, line.p1.x,
+                                     line.p1.y, line.brightness)
+                .Value();
+        }
+
+        if (e.size() != a.size()) {
+            return FormattedString<>("frame %d: expected %zu lines, got %zu (first %zu match)",
+                                     frameIndex, e.size(), a.size(), lineIndex)
+                .Value();
+        }
+
+        if (expected.audioHash != actual.audioHash) {
+            return FormattedString<>("frame %d: audio samples differ", frameIndex).Value();
+        }
+
+        return {};
+    }
+} // namespace GoldenFile
@@ -0,0 +1,35 @@
+#pragma once
+
+#include "core/FileSystem.h"
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <vector>
+
+struct Line;
+class LineStrips;
+struct RenderContext;
+struct AudioContext;
+
+// Per-frame hashes of the emulator's video and audio output. A run's frames are recorded to a
+// "golden" file once, and later runs are compared against it to catch accuracy regressions.
+namespace GoldenFile {
+    struct Frame {
+        uint32_t audioHash{};
+        std::vector<uint32_t> lineHashes; // One per line, in draw order
+    };
+
+    // Values are quantized before hashing so that float noise doesn't show up as a difference
+    uint32_t HashLine(const Line& line);
+    uint32_t HashAudio(const std::vector<float>& samples);
+
+    Frame MakeFrame(const RenderContext& renderContext, const AudioContext& audioContext);
+
+    bool Write(const fs::path& file, const std::vector<Frame>& frames);
+    std::optional<std::vector<Frame>> Read(const fs::path& file);
+
+    // Returns a description of the first difference between expected and actual output for a
+    // frame, or nothing if they match. Lines are passed in to describe the differing line.
+    std::optional<std::string> Compare(int frameIndex, const Frame& expected, const Frame& actual,
+                                       const LineStrips& actualLines);
+} // namespace GoldenFile
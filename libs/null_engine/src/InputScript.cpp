@@ -0,0 +1,83 @@
+#include "InputScript.h"
+#include "core/ConsoleOutput.h"
+#include "core/StringUtil.h"
+#include <algorithm>
+#include <fstream>
+#include <iterator>
+#include <optional>
+#include <string>
+
+namespace {
+    std::optional<Input> ParseInput(const std::vector<std::string>& tokens) {
+        Input input{};
+
+        const std::string& buttons = tokens[1];
+        if (buttons.size() != 8)
+            return {};
+        for (uint8_t i = 0; i < 8; ++i) {
+            if (buttons[i] != '0' && buttons[i] != '1')
+                return {};
+            input.SetButton(i / 4, i % 4, buttons[i] == '1');
+        }
+
+        for (size_t i = 2; i < tokens.size(); ++i) {
+            const int value = std::stoi(tokens[i]);
+            if (value < -128 || value > 127)
+                return {};
+            const int joystickIndex = static_cast<int>(i - 2) / 2;
+            if ((i - 2) % 2 == 0)
+                input.SetAnalogAxisX(joystickIndex, static_cast<int8_t>(value));
+            else
+                input.SetAnalogAxisY(joystickIndex, static_cast<int8_t>(value));
+        }
+        return input;
+    }
+} // namespace
+
+bool InputScript::Load(const fs::path& file) {
+    m_entries.clear();
+
+    std::ifstream fin(file);
+    if (!fin) {
+        Errorf("Failed to open input script: %s\n", file.string().c_str());
+        return false;
+    }
+
+    std::string line;
+    for (int lineNumber = 1; std::getline(fin, line); ++lineNumber) {
+        line = line.substr(0, line.find('#'));
+        auto tokens = StringUtil::Split(line, " \t\r");
+        if (tokens.empty())
+            continue;
+
+        std::optional<Input> input;
+        int frame = -1;
+        if (tokens.size() >= 2 && tokens.size() <= 6) {
+            try {
+                frame = std::stoi(tokens[0]);
+                input = ParseInput(tokens);
+            } catch (...) {
+            }
+        }
+
+        if (frame < 0 || !input) {
+            Errorf("%s(%d): Invalid input script line: %s\n", file.string().c_str(), lineNumber,
+                   line.c_str());
+            return false;
+        }
+
+        m_entries.push_back({frame, *input});
+    }
+
+    std::stable_sort(m_entries.begin(), m_entries.end(),
+                     [](const Entry& lhs, const Entry& rhs) { return lhs.frame < rhs.frame; });
+    return true;
+}
+
+void InputScript::Apply(int frameIndex, Input& input) const {
+    auto iter = std::upper_bound(
+        m_entries.begin(), m_entries.end(), frameIndex,
+        [](int frameIndex, const Entry& entry) { return frameIndex < entry.frame; });
+
+    input = iter == m_entries.begin() ? Input{} : std::prev(iter)->input;
+}
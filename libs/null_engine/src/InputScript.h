@@ -0,0 +1,28 @@
+#pragma once
+
+#include "core/FileSystem.h"
+#include "emulator/EngineTypes.h"
+#include <vector>
+
+// Scripted input for headless runs. Each line of a script sets the input state from a given frame
+// onward:
+//
+//   <frame> <buttons> [<x1> <y1> [<x2> <y2>]]
+//
+// where buttons is 8 characters of '0' or '1' for joystick 1 buttons 1-4 followed by joystick 2
+// buttons 1-4 ('1' is pressed), and x/y are analog axis values in [-128, 127] (default 0).
+// Everything after a '#' is a comment.
+class InputScript {
+public:
+    bool Load(const fs::path& file);
+
+    // Sets input to the state scripted for frameIndex
+    void Apply(int frameIndex, Input& input) const;
+
+private:
+    struct Entry {
+        int frame{};
+        Input input{};
+    };
+    std::vector<Entry> m_entries; // Sorted by frame
+};
@@ -1,19 +1,442 @@
 #include "null_engine/NullEngine.h"
+#include "BatchRunner.h"
+#include "FrameCapture.h"
+#include "core/ConsoleOutput.h"
+#include "core/HostProfiler.h"
+#include "emulator/Cpu.h"
+#include "engine/DisplayListDiff.h"
 #include "engine/EngineUtil.h"
 #include "engine/Paths.h"
+#include "engine/RomLibrary.h"
+#include "engine/VectorStreamServer.h"
+#include <algorithm>
+#include <chrono>
+#include <optional>
+#include <string>
+#include <thread>
+#include <vector>
 
 namespace {
     IEngineClient* g_client = nullptr;
-}
+
+    using Clock = std::chrono::steady_clock;
+
+    const double FrameTime = 1.0 / 60;
+    const float AudioSampleRate = 44100.0f;
+
+    // Command-line flags for headless benchmark runs, e.g.:
+    // vectrexy -frames=3600 -warmup=60 -unthrottled -rom=roms/Scramble.vec -json=bench.json
+    // And for batch runs of many roms in parallel, e.g.:
+    // vectrexy -batch=roms/ -frames=3600 -threads=8 -logdir=logs/
+    // Batch runs may also compare each rom's output against golden files, e.g.:
+    // vectrexy -batch=roms/ -frames=600 -golden=golden/ [-update-golden]
+    // Batch runs can run BIOS routines natively (see BiosHle.h), or check that doing so matches
+    // emulation, and skip loops that only poll the VIA (see IdleLoopSkipper.h), e.g.:
+    // vectrexy -batch=roms/ -frames=3600 [-hle|-hle-validate] [-skip-idle]
+    // Batch runs can also write each rom's execution, read and write counts per address (see
+    // HeatMap.h), e.g.:
+    // vectrexy -batch=roms/ -frames=3600 -heatmap=heatmaps/
+    // And which code of each rom was executed (see CoverageReport.h), e.g.:
+    // vectrexy -batch=roms/ -frames=3600 -coverage=coverage/ [-symbols=bios.asm]
+    // Either kind of run can capture video and audio to disk (see FrameCapture.h), e.g.:
+    // vectrexy -rom=roms/Scramble.vec -frames=1800 -unthrottled -capture=clips/ -capture-every=2
+    //          [-capture-format=png|y4m] [-capture-height=600]
+    // Either kind of run can also stream its output to a viewer (vectrexy -watch=host:port), where
+    // batch runs stream rom N on port + N, e.g.:
+    // vectrexy -rom=roms/Scramble.vec -stream=9124
+    // Benchmark runs can also report how much each frame's lines change (see DisplayListDiff.h):
+    // vectrexy -rom=roms/Scramble.vec -frames=3600 -unthrottled -diff-stats
+    // And, when built with HOST_PROFILER, where each frame's time goes (see HostProfiler.h):
+    // vectrexy -rom=roms/Scramble.vec -frames=3600 -unthrottled -host-profile=profile.json
+    // Or a trace of the frames after warm-up, for chrome://tracing or Perfetto:
+    // vectrexy -rom=roms/Scramble.vec -frames=600 -warmup=60 -trace=trace.json [-trace-frames=120]
+    // And roms can be listed with their titles and content hashes (see RomLibrary.h), e.g.:
+    // vectrexy -scan-roms=roms/ [-threads=8]
+    struct CommandLineArgs {
+        std::optional<int> frames; // If not set, runs forever
+        int warmupFrames = 0;
+        bool unthrottled = false;
+        fs::path romFile;
+        fs::path biosRomFile;
+        fs::path jsonFile;
+        fs::path batchListOrDir; // Rom list file or directory
+        int numThreads = 0;
+        fs::path logDir;
+        fs::path goldenDir;
+        bool updateGolden = false;
+        BiosHle::Mode biosHle = BiosHle::Mode::Off;
+        bool skipIdleLoops = false;
+        fs::path heatMapDir;
+        fs::path coverageDir;
+        fs::path symbolsFile;
+        fs::path captureDir;
+        FrameCapture::Format captureFormat = FrameCapture::Format::Png;
+        int captureInterval = 1;
+        int captureHeight = 600;
+        bool diffStats = false;
+        fs::path hostProfileFile;
+        fs::path traceFile;
+        int traceFrames = 120;
+        uint16_t streamPort{}; // If 0, doesn't stream
+        fs::path romLibraryDir;
+    };
+
+    // Returns the value of "-name=value" if arg matches name
+    std::optional<std::string> GetArgValue(const std::string& arg, const char* name) {
+        const std::string prefix = std::string(name) + "=";
+        if (arg.compare(0, prefix.size(), prefix) == 0)
+            return arg.substr(prefix.size());
+        return {};
+    }
+
+    std::optional<CommandLineArgs> ParseArgs(int argc, char** argv) {
+        CommandLineArgs result;
+
+        auto parseInt = [](const std::string& value, const char* name) -> std::optional<int> {
+            try {
+                int i = std::stoi(value);
+                if (i >= 0)
+                    return i;
+            } catch (...) {
+            }
+            Errorf("Invalid value for %s: %s\n", name, value.c_str());
+            return {};
+        };
+
+        for (int i = 1; i < argc; ++i) {
+            std::string arg = argv[i];
+            if (auto value = GetArgValue(arg, "-frames")) {
+                if (!(result.frames = parseInt(*value, "-frames")))
+                    return {};
+            } else if (auto value = GetArgValue(arg, "-warmup")) {
+                auto warmupFrames = parseInt(*value, "-warmup");
+                if (!warmupFrames)
+                    return {};
+                result.warmupFrames = *warmupFrames;
+            } else if (arg == "-unthrottled") {
+                result.unthrottled = true;
+            } else if (auto value = GetArgValue(arg, "-rom")) {
+                result.romFile = fs::absolute(*value);
+            } else if (auto value = GetArgValue(arg, "-bios")) {
+                result.biosRomFile = fs::absolute(*value);
+            } else if (auto value = GetArgValue(arg, "-json")) {
+                result.jsonFile = fs::absolute(*value);
+            } else if (auto value = GetArgValue(arg, "-batch")) {
+                result.batchListOrDir = fs::absolute(*value);
+            } else if (auto value = GetArgValue(arg, "-threads")) {
+                auto numThreads = parseInt(*value, "-threads");
+                if (!numThreads)
+                    return {};
+                result.numThreads = *numThreads;
+            } else if (auto value = GetArgValue(arg, "-logdir")) {
+                result.logDir = fs::absolute(*value);
+            } else if (auto value = GetArgValue(arg, "-golden")) {
+                result.goldenDir = fs::absolute(*value);
+            } else if (arg == "-update-golden") {
+                result.updateGolden = true;
+            } else if (arg == "-hle") {
+                result.biosHle = BiosHle::Mode::On;
+            } else if (arg == "-hle-validate") {
+                result.biosHle = BiosHle::Mode::Validate;
+            } else if (arg == "-skip-idle") {
+                result.skipIdleLoops = true;
+            } else if (auto value = GetArgValue(arg, "-heatmap")) {
+                result.heatMapDir = fs::absolute(*value);
+            } else if (auto value = GetArgValue(arg, "-coverage")) {
+                result.coverageDir = fs::absolute(*value);
+            } else if (auto value = GetArgValue(arg, "-symbols")) {
+                result.symbolsFile = fs::absolute(*value);
+            } else if (auto value = GetArgValue(arg, "-capture")) {
+                result.captureDir = fs::absolute(*value);
+            } else if (auto value = GetArgValue(arg, "-capture-format")) {
+                auto format = FrameCapture::ParseFormat(*value);
+                if (!format) {
+                    Errorf("Invalid value for -capture-format: %s\n", value->c_str());
+                    return {};
+                }
+                result.captureFormat = *format;
+            } else if (auto value = GetArgValue(arg, "-capture-every")) {
+                auto interval = parseInt(*value, "-capture-every");
+                if (!interval)
+                    return {};
+                result.captureInterval = std::max(*interval, 1);
+            } else if (auto value = GetArgValue(arg, "-capture-height")) {
+                auto height = parseInt(*value, "-capture-height");
+                if (!height)
+                    return {};
+                result.captureHeight = std::max(*height, 2);
+            } else if (auto value = GetArgValue(arg, "-stream")) {
+                auto port = parseInt(*value, "-stream");
+                if (!port || *port == 0 || *port > UINT16_MAX) {
+                    Errorf("Invalid port for -stream: %s\n", value->c_str());
+                    return {};
+                }
+                result.streamPort = static_cast<uint16_t>(*port);
+            } else if (arg == "-diff-stats") {
+                result.diffStats = true;
+            } else if (auto value = GetArgValue(arg, "-host-profile")) {
+                if (!HostProfiler::CompiledIn) {
+                    Errorf("-host-profile requires building with HOST_PROFILER\n");
+                    return {};
+                }
+                result.hostProfileFile = fs::absolute(*value);
+            } else if (auto value = GetArgValue(arg, "-trace")) {
+                if (!HostProfiler::CompiledIn) {
+                    Errorf("-trace requires building with HOST_PROFILER\n");
+                    return {};
+                }
+                result.traceFile = fs::absolute(*value);
+            } else if (auto value = GetArgValue(arg, "-trace-frames")) {
+                auto traceFrames = parseInt(*value, "-trace-frames");
+                if (!traceFrames)
+                    return {};
+                if (*traceFrames == 0) {
+                    Errorf("Invalid value for -trace-frames: %s\n", value->c_str());
+                    return {};
+                }
+                result.traceFrames = *traceFrames;
+            } else if (auto value = GetArgValue(arg, "-scan-roms")) {
+                result.romLibraryDir = fs::absolute(*value);
+            }
+        }
+        return result;
+    }
+
+    // Lists the roms in dir, updating the rom library manifest
+    bool ScanRomLibrary(const fs::path& dir, int numThreads) {
+        std::error_code ec;
+        fs::create_directories(Paths::userDir, ec);
+
+        const auto startTime = Clock::now();
+        RomLibrary library;
+        const auto stats =
+            library.Scan(dir, Paths::romLibraryFile, static_cast<size_t>(std::max(numThreads, 0)));
+        const double elapsedMs =
+            std::chrono::duration<double, std::milli>(Clock::now() - startTime).count();
+
+        for (auto& entry : library.Entries()) {
+            Printf("%016llx %7llu %s %-40s %s\n",
+                   static_cast<unsigned long long>(entry.contentHash),
+                   static_cast<unsigned long long>(entry.size), entry.validHeader ? "   " : "BAD",
+                   entry.title.c_str(), entry.path.lexically_relative(dir).string().c_str());
+        }
+        Printf("%zu rom(s) in %.1f ms: %zu read, %zu from the manifest, %zu failed to read\n",
+               library.Entries().size(), elapsedMs, stats.numRead, stats.numCached,
+               stats.numFailed);
+        return stats.numFailed == 0;
+    }
+
+    struct BenchmarkResults {
+        int frames{};
+        int warmupFrames{};
+        bool unthrottled{};
+        double wallTime{};     // Seconds spent in measured frames, including throttling
+        double emulatedTime{}; // Seconds of emulated time
+        double cyclesPerSec{}; // Emulated cpu cycles per wall-clock second
+        double fps{};
+        // Per-frame cost in milliseconds, excluding time spent throttling
+        double frameCostMin{};
+        double frameCostMean{};
+        double frameCostP50{};
+        double frameCostP90{};
+        double frameCostP99{};
+        double frameCostMax{};
+        // Largest frame's vector buffer (see LineStrips)
+        LineStrips::HighWaterMark vectorsHighWaterMark;
+        // Display list diff totals over measured frames, if enabled with -diff-stats
+        bool diffStats{};
+        DisplayListDiff::Stats diffTotals;
+        double diffCostMean{}; // Milliseconds per frame, not included in frame cost
+    };
+
+    // Nearest-rank percentile of sorted values
+    double Percentile(const std::vector<double>& sortedValues, double percent) {
+        if (sortedValues.empty())
+            return 0.0;
+        auto rank = static_cast<size_t>(percent / 100.0 * (sortedValues.size() - 1) + 0.5);
+        return sortedValues[std::min(rank, sortedValues.size() - 1)];
+    }
+
+    BenchmarkResults ComputeResults(const CommandLineArgs& args, std::vector<double> frameCosts,
+                                    double wallTime, const RenderContext& renderContext,
+                                    const DisplayListDiff::Stats& diffTotals, double diffCost) {
+        BenchmarkResults r;
+        r.frames = static_cast<int>(frameCosts.size());
+        r.warmupFrames = args.warmupFrames;
+        r.unthrottled = args.unthrottled;
+        r.wallTime = wallTime;
+        r.emulatedTime = r.frames * FrameTime;
+        if (wallTime > 0) {
+            r.cyclesPerSec = r.emulatedTime * Cpu::Hz / wallTime;
+            r.fps = r.frames / wallTime;
+        }
+
+        std::sort(frameCosts.begin(), frameCosts.end());
+        if (!frameCosts.empty()) {
+            double sum = 0;
+            for (double cost : frameCosts)
+                sum += cost;
+            r.frameCostMin = frameCosts.front();
+            r.frameCostMax = frameCosts.back();
+            r.frameCostMean = sum / frameCosts.size();
+            r.frameCostP50 = Percentile(frameCosts, 50);
+            r.frameCostP90 = Percentile(frameCosts, 90);
+            r.frameCostP99 = Percentile(frameCosts, 99);
+        }
+        r.vectorsHighWaterMark = renderContext.lines.GetHighWaterMark();
+        r.diffStats = args.diffStats;
+        r.diffTotals = diffTotals;
+        r.diffCostMean = r.frames > 0 ? diffCost / r.frames : 0.0;
+        return r;
+    }
+
+    void PrintResults(const BenchmarkResults& r) {
+        Printf("Benchmark results:\n");
+        Printf("  Frames:        %d (+%d warm-up, %s)\n", r.frames, r.warmupFrames,
+               r.unthrottled ? "unthrottled" : "throttled");
+        Printf("  Wall time:     %.3f s\n", r.wallTime);
+        Printf("  Emulated time: %.3f s (%.2fx realtime)\n", r.emulatedTime,
+               r.wallTime > 0 ? r.emulatedTime / r.wallTime : 0.0);
+        Printf("  Emulated CPU:  %.3f MHz (%.0f cycles/s)\n", r.cyclesPerSec / 1'000'000.0,
+               r.cyclesPerSec);
+        Printf("  Frames/sec:    %.1f\n", r.fps);
+        Printf("  Frame cost:    min %.3f ms, mean %.3f ms, p50 %.3f ms, p90 %.3f ms, p99 %.3f "
+               "ms, max %.3f ms\n",
+               r.frameCostMin, r.frameCostMean, r.frameCostP50, r.frameCostP90, r.frameCostP99,
+               r.frameCostMax);
+        Printf("  Peak vectors:  %zu points in %zu strips (%.1f KB)\n",
+               r.vectorsHighWaterMark.numPoints, r.vectorsHighWaterMark.numStrips,
+               r.vectorsHighWaterMark.Bytes() / 1024.0);
+        if (r.diffStats) {
+            const auto& d = r.diffTotals;
+            const double numLines = std::max<size_t>(d.numUnchanged + d.numMoved + d.numNew, 1);
+            Printf("  Display diff:  %.1f%% unchanged, %.1f%% moved, %.1f%% new, %.1f removed per "
+                   "frame, %.3f ms per frame\n",
+                   d.numUnchanged * 100 / numLines, d.numMoved * 100 / numLines,
+                   d.numNew * 100 / numLines,
+                   r.frames > 0 ? static_cast<double>(d.numRemoved) / r.frames : 0.0,
+                   r.diffCostMean);
+        }
+    }
+
+    bool WriteResultsJson(const BenchmarkResults& r, const fs::path& jsonFile) {
+        FILE* file = fopen(jsonFile.string().c_str(), "w");
+        if (!file) {
+            Errorf("Failed to open benchmark json file for writing: %s\n",
+                   jsonFile.string().c_str());
+            return false;
+        }
+
+        fprintf(file, "{\n");
+        fprintf(file, "  \"frames\": %d,\n", r.frames);
+        fprintf(file, "  \"warmupFrames\": %d,\n", r.warmupFrames);
+        fprintf(file, "  \"unthrottled\": %s,\n", r.unthrottled ? "true" : "false");
+        fprintf(file, "  \"wallTimeSec\": %.6f,\n", r.wallTime);
+        fprintf(file, "  \"emulatedTimeSec\": %.6f,\n", r.emulatedTime);
+        fprintf(file, "  \"cyclesPerSec\": %.0f,\n", r.cyclesPerSec);
+        fprintf(file, "  \"emulatedMHz\": %.6f,\n", r.cyclesPerSec / 1'000'000.0);
+        fprintf(file, "  \"fps\": %.3f,\n", r.fps);
+        fprintf(file, "  \"frameCostMs\": {\n");
+        fprintf(file, "    \"min\": %.6f,\n", r.frameCostMin);
+        fprintf(file, "    \"mean\": %.6f,\n", r.frameCostMean);
+        fprintf(file, "    \"p50\": %.6f,\n", r.frameCostP50);
+        fprintf(file, "    \"p90\": %.6f,\n", r.frameCostP90);
+        fprintf(file, "    \"p99\": %.6f,\n", r.frameCostP99);
+        fprintf(file, "    \"max\": %.6f\n", r.frameCostMax);
+        fprintf(file, "  },\n");
+        fprintf(file, "  \"peakVectors\": {\n");
+        fprintf(file, "    \"points\": %zu,\n", r.vectorsHighWaterMark.numPoints);
+        fprintf(file, "    \"strips\": %zu,\n", r.vectorsHighWaterMark.numStrips);
+        fprintf(file, "    \"bytes\": %zu\n", r.vectorsHighWaterMark.Bytes());
+        fprintf(file, "  }%s\n", r.diffStats ? "," : "");
+        if (r.diffStats) {
+            fprintf(file, "  \"displayListDiff\": {\n");
+            fprintf(file, "    \"unchangedLines\": %zu,\n", r.diffTotals.numUnchanged);
+            fprintf(file, "    \"movedLines\": %zu,\n", r.diffTotals.numMoved);
+            fprintf(file, "    \"newLines\": %zu,\n", r.diffTotals.numNew);
+            fprintf(file, "    \"removedLines\": %zu,\n", r.diffTotals.numRemoved);
+            fprintf(file, "    \"costMs\": %.6f\n", r.diffCostMean);
+            fprintf(file, "  }\n");
+        }
+        fprintf(file, "}\n");
+        fclose(file);
+        return true;
+    }
+} // namespace
 
 void NullEngine::RegisterClient(IEngineClient& client) {
     g_client = &client;
 }
 
 bool NullEngine::Run(int argc, char** argv) {
+    // Parse before FindAndSetRootPath changes the current directory so that relative paths passed
+    // on the command line are resolved against the caller's directory.
+    auto args = ParseArgs(argc, argv);
+    if (!args)
+        return false;
+
     if (!EngineUtil::FindAndSetRootPath(fs::path(fs::absolute(argv[0]))))
         return false;
 
+    HOST_PROFILE_THREAD_NAME("Main");
+
+    const auto biosRomFile =
+        args->biosRomFile.empty() ? Paths::biosRomFile.string() : args->biosRomFile.string();
+
+    if (!args->romLibraryDir.empty())
+        return ScanRomLibrary(args->romLibraryDir, args->numThreads);
+
+    if (args->updateGolden && args->goldenDir.empty()) {
+        Errorf("-update-golden requires -golden\n");
+        return false;
+    }
+
+    // Golden, BIOS HLE, idle loop skipping, heat map and coverage runs always go through the batch
+    // runner, even for a single rom
+    if (!args->batchListOrDir.empty() || !args->goldenDir.empty() ||
+        args->biosHle != BiosHle::Mode::Off || args->skipIdleLoops || !args->heatMapDir.empty() ||
+        !args->coverageDir.empty()) {
+        BatchRunner::Config config;
+        config.biosRomFile = fs::absolute(biosRomFile);
+        if (!args->batchListOrDir.empty())
+            config.romFiles = BatchRunner::GatherRomFiles(args->batchListOrDir);
+        else if (!args->romFile.empty())
+            config.romFiles = {args->romFile};
+        if (args->frames)
+            config.framesPerRom = *args->frames;
+        config.numThreads = args->numThreads;
+        config.logDir = args->logDir;
+        config.goldenDir = args->goldenDir;
+        config.updateGolden = args->updateGolden;
+        config.biosHle = args->biosHle;
+        config.skipIdleLoops = args->skipIdleLoops;
+        config.heatMapDir = args->heatMapDir;
+        config.coverageDir = args->coverageDir;
+        config.symbolsFile = args->symbolsFile;
+        config.captureDir = args->captureDir;
+        config.captureFormat = args->captureFormat;
+        config.captureInterval = args->captureInterval;
+        config.captureHeight = args->captureHeight;
+        config.streamPort = args->streamPort;
+        return BatchRunner::Run(config);
+    }
+
+    FrameCapture frameCapture;
+    if (!args->captureDir.empty()) {
+        FrameCapture::Config config;
+        config.dir = args->captureDir;
+        config.format = args->captureFormat;
+        config.frameInterval = args->captureInterval;
+        config.screenHeight = args->captureHeight;
+        config.frameTime = FrameTime;
+        if (!frameCapture.Start(config))
+            return false;
+    }
+
+    VectorStreamServer streamServer;
+    if (args->streamPort != 0 && !streamServer.Start(args->streamPort))
+        return false;
+
     std::shared_ptr<IEngineService> engineService =
         std::make_shared<aggregate_adapter<IEngineService>>(
             // SetFocusMainWindow
@@ -21,26 +444,111 @@ bool NullEngine::Run(int argc, char** argv) {
             // SetFocusConsole
             [] {},
             // ResetOverlay
-            [](const char* /*file*/) {});
+            [&frameCapture](const char* file) { frameCapture.ResetOverlay(file); });
+
+    // The client picks up the rom as the first non-flag argument, so forward -rom that way
+    std::vector<std::string> clientArgs(argv, argv + argc);
+    if (!args->romFile.empty())
+        clientArgs.push_back(args->romFile.string());
+    std::vector<char*> clientArgv;
+    for (auto& arg : clientArgs)
+        clientArgv.push_back(arg.data());
 
-    if (!g_client->Init(engineService, Paths::biosRomFile.string(), argc, argv)) {
+    if (!g_client->Init(engineService, biosRomFile, static_cast<int>(clientArgv.size()),
+                        clientArgv.data())) {
         return false;
     }
 
+    EmuEvents emuEvents{};
+    Options options{};
+    Input input{};
+    RenderContext renderContext{};
+    AudioContext audioContext{static_cast<float>(Cpu::Hz / AudioSampleRate)};
+
+    const int totalFrames = args->frames ? args->warmupFrames + *args->frames : 0;
+    std::vector<double> frameCosts;
+    if (args->frames)
+        frameCosts.reserve(*args->frames);
+
+    DisplayListDiff displayListDiff;
+    DisplayListDiff::Stats diffTotals;
+    double diffCost = 0;
+
+    Clock::time_point startTime{};
+    auto nextFrameTime = Clock::now();
+
     bool quit = false;
-    while (!quit) {
-        double frameTime = 1.0 / 60;
-        EmuEvents emuEvents{};
-        Options options{};
-        Input input{};
-        RenderContext renderContext{};
-        AudioContext audioContext{0};
+    for (int frame = 0; !quit && (!args->frames || frame < totalFrames); ++frame) {
+        if (frame == args->warmupFrames) {
+            startTime = Clock::now();
+            HostProfiler::Reset();
+            if (!args->traceFile.empty())
+                HostProfiler::StartCapture(args->traceFrames, args->traceFile);
+        }
 
-        if (!g_client->FrameUpdate(frameTime, {std::ref(emuEvents), std::ref(options)}, input,
-                                   renderContext, audioContext)) {
-            quit = true;
+        const auto frameStart = Clock::now();
+        {
+            HOST_PROFILE_SCOPE(Emulate);
+            if (!g_client->FrameUpdate(FrameTime, {std::ref(emuEvents), std::ref(options)}, input,
+                                       renderContext, audioContext)) {
+                quit = true;
+            }
+        }
+        const auto frameEnd = Clock::now();
+        HOST_PROFILE_END_FRAME();
+
+        if (args->diffStats) {
+            displayListDiff.Update(renderContext.lines);
+            if (args->frames && frame >= args->warmupFrames) {
+                const auto& stats = displayListDiff.GetStats();
+                diffTotals.numUnchanged += stats.numUnchanged;
+                diffTotals.numMoved += stats.numMoved;
+                diffTotals.numNew += stats.numNew;
+                diffTotals.numRemoved += stats.numRemoved;
+                diffCost +=
+                    std::chrono::duration<double, std::milli>(Clock::now() - frameEnd).count();
+            }
+        }
+
+        frameCapture.AddFrame(renderContext, audioContext);
+        streamServer.AddFrame(renderContext, audioContext);
+        renderContext.lines.Clear();
+        audioContext.samples.clear();
+
+        if (args->frames && frame >= args->warmupFrames) {
+            frameCosts.push_back(
+                std::chrono::duration<double, std::milli>(frameEnd - frameStart).count());
+        }
+
+        if (!args->unthrottled) {
+            nextFrameTime += std::chrono::duration_cast<Clock::duration>(
+                std::chrono::duration<double>(FrameTime));
+            std::this_thread::sleep_until(nextFrameTime);
         }
     }
 
-    return false;
+    if (!frameCapture.Stop())
+        return false;
+
+    if (!args->frames)
+        return false;
+
+    const double wallTime =
+        frameCosts.empty() ? 0.0
+                           : std::chrono::duration<double>(Clock::now() - startTime).count();
+    auto results = ComputeResults(*args, std::move(frameCosts), wallTime, renderContext,
+                                  diffTotals, diffCost);
+    PrintResults(results);
+
+    if (!args->jsonFile.empty() && !WriteResultsJson(results, args->jsonFile))
+        return false;
+
+    if (!args->hostProfileFile.empty() && !HostProfiler::WriteJson(args->hostProfileFile))
+        return false;
+
+    // Writes what was captured if the run ended before all the trace's frames
+    if (HostProfiler::IsCapturing() && !HostProfiler::StopCapture())
+        return false;
+
+    return true;
 }
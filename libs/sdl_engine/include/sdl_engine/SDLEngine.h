@@ -14,5 +14,5 @@ public:
     bool Run(int argc, char** argv);
 
 private:
-    pimpl::Pimpl<class SDLEngineImpl, 4096> m_impl;
+    pimpl::Pimpl<class SDLEngineImpl, 8192> m_impl;
 };
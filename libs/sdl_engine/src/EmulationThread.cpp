@@ -0,0 +1,128 @@
+#include "EmulationThread.h"
+#include "SDLAudioDriver.h"
+#include "core/HostProfiler.h"
+#include "engine/EngineClient.h"
+#include <algorithm>
+#include <iterator>
+
+namespace {
+    // Upper bound on the time emulated in one go when merging frames the emulation thread didn't
+    // keep up with, so that falling behind doesn't snowball into ever longer frames.
+    const double MaxMergedFrameTime = 0.1;
+
+    // Whether handling these events makes the client read or save options
+    bool EventsUseOptions(const EmuEvents& emuEvents) {
+        return std::any_of(emuEvents.begin(), emuEvents.end(), [](const EmuEvent& event) {
+            return std::holds_alternative<EmuEvent::OpenRomFile>(event.type) ||
+                   std::holds_alternative<EmuEvent::OpenBiosRomFile>(event.type);
+        });
+    }
+} // namespace
+
+EmulationThread::~EmulationThread() {
+    Stop();
+}
+
+void EmulationThread::Start(IEngineClient& client, Options& options, std::mutex& optionsMutex,
+                            SDLAudioDriver& audioDriver, float cpuCyclesPerAudioSample) {
+    assert(!m_thread.joinable());
+    m_client = &client;
+    m_options = &options;
+    m_optionsMutex = &optionsMutex;
+    m_audioDriver = &audioDriver;
+    m_cpuCyclesPerAudioSample = cpuCyclesPerAudioSample;
+    m_stopRequested = false;
+    m_quitRequested = false;
+    m_thread = std::thread([this] { ThreadMain(); });
+}
+
+void EmulationThread::Stop() {
+    if (!m_thread.joinable())
+        return;
+
+    {
+        std::lock_guard<std::mutex> lock(m_wakeMutex);
+        m_stopRequested = true;
+    }
+    m_wakeCondition.notify_one();
+    m_thread.join();
+}
+
+void EmulationThread::PushFrame(double frameTime, int fastForwardSpeed, const Input& input,
+                                EmuEvents emuEvents) {
+    m_pendingFrame.frameTime = std::min(m_pendingFrame.frameTime + frameTime,
+                                        std::max(frameTime, MaxMergedFrameTime));
+    m_pendingFrame.fastForwardSpeed = fastForwardSpeed;
+    m_pendingFrame.input = input;
+    std::move(emuEvents.begin(), emuEvents.end(), std::back_inserter(m_pendingFrame.emuEvents));
+
+    if (!m_frames.TryPush(std::move(m_pendingFrame)))
+        return;
+
+    m_pendingFrame = {};
+
+    // Lock so that the wake up can't be missed between the emulation thread checking for frames
+    // and going to sleep.
+    { std::lock_guard<std::mutex> lock(m_wakeMutex); }
+    m_wakeCondition.notify_one();
+}
+
+RenderContext& EmulationThread::AcquireRenderContext() {
+    m_renderContexts.Acquire();
+    return m_renderContexts.Front();
+}
+
+void EmulationThread::ThreadMain() {
+    HOST_PROFILE_THREAD_NAME("Emulation");
+    AudioContext audioContext{m_cpuCyclesPerAudioSample};
+    FrameInput frame;
+
+    while (!m_quitRequested) {
+        {
+            std::unique_lock<std::mutex> lock(m_wakeMutex);
+            m_wakeCondition.wait(lock, [this] { return m_stopRequested || !m_frames.Empty(); });
+        }
+
+        if (m_stopRequested)
+            break;
+
+        while (!m_quitRequested && m_frames.TryPop(frame)) {
+            EmulateFrame(frame, audioContext);
+        }
+    }
+}
+
+void EmulationThread::EmulateFrame(FrameInput& frame, AudioContext& audioContext) {
+    RenderContext& renderContext = m_renderContexts.Back();
+
+    bool keepGoing = false;
+    {
+        // Only hold the options lock when needed: the debugger may block this thread on console
+        // input for an arbitrary amount of time, and the main thread shouldn't stall with it.
+        std::unique_lock<std::mutex> optionsLock(*m_optionsMutex, std::defer_lock);
+        if (EventsUseOptions(frame.emuEvents))
+            optionsLock.lock();
+
+        // Emulation overlaps with rendering, so when fast-forwarding unthrottled, it can use up
+        // the whole frame's time.
+        const double timeBudget = frame.frameTime;
+        keepGoing = m_fastForward.FrameUpdate(
+            *m_client, frame.frameTime, frame.fastForwardSpeed, timeBudget,
+            {std::ref(frame.emuEvents), std::ref(*m_options)}, frame.input, renderContext,
+            audioContext);
+    }
+
+    if (!keepGoing)
+        m_quitRequested = true;
+
+    {
+        HOST_PROFILE_SCOPE(Audio);
+        m_audioDriver->AddSamples(audioContext.samples.data(), audioContext.samples.size());
+        audioContext.samples.clear();
+    }
+
+    // Don't publish when paused so that the main thread keeps drawing the last frame's lines
+    if (frame.frameTime > 0) {
+        m_renderContexts.Publish().lines.Clear();
+    }
+}
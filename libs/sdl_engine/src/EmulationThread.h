@@ -0,0 +1,79 @@
+#pragma once
+
+#include "core/SpscQueue.h"
+#include "core/TripleBuffer.h"
+#include "emulator/EngineTypes.h"
+#include "engine/FastForward.h"
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+class IEngineClient;
+class Options;
+class SDLAudioDriver;
+
+// Runs IEngineClient::FrameUpdate on its own thread so that emulation overlaps with ImGui, GL
+// rendering and swapping buffers (which may block on vsync) on the main thread.
+//
+// Each frame, the main thread sends the frame time, input and events through a lock-free queue,
+// and picks up the lines of the most recently emulated frame from a triple buffer of
+// RenderContext. Audio samples are pushed straight into the audio driver's ring buffer from the
+// emulation thread.
+//
+// Note that ImGui windows enabled on the main thread (Gui::EnabledWindows) are not enabled on the
+// emulation thread, so the emulator's own debug UI is only available when emulating on the main
+// thread. For this reason, the emulation thread is opt-in (option "emulationThread", default
+// false).
+class EmulationThread {
+public:
+    ~EmulationThread();
+
+    // optionsMutex guards options, which the client may read and save while handling events
+    void Start(IEngineClient& client, Options& options, std::mutex& optionsMutex,
+               SDLAudioDriver& audioDriver, float cpuCyclesPerAudioSample);
+
+    // Waits for the current frame to complete. If the debugger is waiting for console input, this
+    // blocks until a command is entered.
+    void Stop();
+
+    // Main thread: queues a frame to emulate, which is made up of several emulated frames when
+    // fastForwardSpeed isn't 1 (see FastForward). Never blocks; if the emulation thread has fallen
+    // behind, frames are merged until there's room in the queue again.
+    void PushFrame(double frameTime, int fastForwardSpeed, const Input& input,
+                   EmuEvents emuEvents);
+
+    // Main thread: returns the lines of the most recently emulated frame
+    RenderContext& AcquireRenderContext();
+
+    // Returns true once the client has asked to quit (e.g. via the debugger's quit command)
+    bool QuitRequested() const { return m_quitRequested; }
+
+private:
+    struct FrameInput {
+        double frameTime{};
+        int fastForwardSpeed = 1;
+        Input input{};
+        EmuEvents emuEvents{};
+    };
+
+    void ThreadMain();
+    void EmulateFrame(FrameInput& frame, AudioContext& audioContext);
+
+    IEngineClient* m_client{};
+    Options* m_options{};
+    std::mutex* m_optionsMutex{};
+    SDLAudioDriver* m_audioDriver{};
+    float m_cpuCyclesPerAudioSample{};
+
+    SpscQueue<FrameInput, 4> m_frames;
+    FrameInput m_pendingFrame; // Frame that didn't fit in the queue, owned by main thread
+    TripleBuffer<RenderContext> m_renderContexts;
+    FastForward m_fastForward; // Owned by emulation thread
+
+    std::thread m_thread;
+    std::mutex m_wakeMutex;
+    std::condition_variable m_wakeCondition;
+    std::atomic<bool> m_stopRequested{false};
+    std::atomic<bool> m_quitRequested{false};
+};
@@ -1,18 +1,23 @@
 #include "GLRender.h"
 #include "GLUtil.h"
+#include "OverlayLoader.h"
 #include "core/ConsoleOutput.h"
 #include "core/Gui.h"
 #include "emulator/EngineTypes.h"
+#include "engine/LineVertices.h"
+#include "engine/Paths.h"
 
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
 #include <glm/mat4x4.hpp>
 
+#include <algorithm>
 #include <optional>
 #include <string>
 #include <vector>
 
 using namespace GLUtil;
+using namespace LineVertices;
 
 // Vectrex screen dimensions
 const int VECTREX_SCREEN_WIDTH = 256;
@@ -83,88 +88,6 @@ namespace {
         return {width, height};
     }
 
-    struct VertexData {
-        glm::vec2 v{};
-        float brightness{};
-    };
-
-    std::vector<VertexData> CreateQuadVertexArray(const std::vector<Line>& lines, float lineWidth,
-                                                  float scaleX, float scaleY) {
-        std::vector<VertexData> result;
-
-        const float MinPixelDist = 1.f;
-
-        // Make sure line width is at least one pixel wide to ensure it gets rendered
-        lineWidth = std::max(lineWidth, MinPixelDist);
-
-        float hlw = lineWidth / 2.0f;
-
-        for (auto& line : lines) {
-            // If end points are close, draw a dot instead of a line. We do this before applying any
-            // scale.
-            const bool isPoint = Magnitude(line.p0 - line.p1) <= 0.1f;
-
-            glm::vec2 p0{line.p0.x * scaleX, line.p0.y * scaleY};
-            glm::vec2 p1{line.p1.x * scaleX, line.p1.y * scaleY};
-
-            if (isPoint) {
-                auto a = VertexData{p0 + glm::vec2{hlw, hlw}, line.brightness};
-                auto b = VertexData{p0 + glm::vec2{hlw, -hlw}, line.brightness};
-                auto c = VertexData{p0 + glm::vec2{-hlw, -hlw}, line.brightness};
-                auto d = VertexData{p0 + glm::vec2{-hlw, hlw}, line.brightness};
-
-                result.insert(result.end(), {a, b, c, c, d, a});
-            } else {
-                auto v01 = p1 - p0;
-                glm::vec2 n = glm::normalize(v01);
-
-                // Make sure line gets at least one pixel coverage to ensure it gets rendered.
-                // Note that we extend p1, the end point, which means we may get some slight errors
-                // with attached lines. If we were to store "line strips" instead, we could correct
-                // the point in the strip, ensuring that strips don't get detached.
-                if (abs(v01.x) < MinPixelDist) {
-                    p1.x = p0.x + n.x * MinPixelDist;
-                }
-                if (abs(v01.y) < MinPixelDist) {
-                    p1.y = p0.y + n.y * MinPixelDist;
-                }
-
-                glm::vec2 bn(-n.y, n.x);
-
-                auto a = VertexData{p0 + bn * hlw, line.brightness};
-                auto b = VertexData{p0 - bn * hlw, line.brightness};
-                auto c = VertexData{p1 - bn * hlw, line.brightness};
-                auto d = VertexData{p1 + bn * hlw, line.brightness};
-
-                result.insert(result.end(), {a, b, c, c, d, a});
-            }
-        }
-        return result;
-    }
-
-    std::tuple<std::vector<VertexData>, std::vector<VertexData>>
-    CreateLineAndPointVertexArrays(const std::vector<Line>& lines, float scaleX, float scaleY) {
-        auto AlmostEqual = [](float a, float b, float epsilon = 0.01f) {
-            return abs(a - b) <= epsilon;
-        };
-
-        std::vector<VertexData> lineVA, pointVA;
-
-        for (auto& line : lines) {
-            glm::vec2 p0{line.p0.x * scaleX, line.p0.y * scaleY};
-            glm::vec2 p1{line.p1.x * scaleX, line.p1.y * scaleY};
-
-            if (AlmostEqual(p0.x, p1.x) && AlmostEqual(p0.y, p1.y)) {
-                pointVA.push_back({p0, line.brightness});
-            } else {
-                lineVA.push_back({p0, line.brightness});
-                lineVA.push_back({p1, line.brightness});
-            }
-        }
-
-        return {lineVA, pointVA};
-    }
-
     std::array<glm::vec3, 6> MakeClipSpaceQuad(float scaleX = 1.f, float scaleY = 1.f) {
         return {glm::vec3{-scaleX, -scaleY, 0.0f}, glm::vec3{scaleX, -scaleY, 0.0f},
                 glm::vec3{-scaleX, scaleY, 0.0f},  glm::vec3{-scaleX, scaleY, 0.0f},
@@ -242,6 +165,10 @@ namespace {
 #include "shaders/DrawVectors.frag"
             ;
 
+        const char* DrawLineInstances_vert =
+#include "shaders/DrawLineInstances.vert"
+            ;
+
         const char* DrawVectors_vert =
 #include "shaders/DrawVectors.vert"
             ;
@@ -274,10 +201,11 @@ namespace {
 
         void Init() {
             m_shader.LoadShaders(ShaderSource::DrawVectors_vert, ShaderSource::DrawVectors_frag);
+            m_vbo = MakeBufferResource();
         }
 
-        void Draw(const std::vector<VertexData>& VA1, GLenum mode1,
-                  const std::vector<VertexData>& VA2, GLenum mode2, const Texture& outputTexture) {
+        void Draw(const VertexArray& VA1, GLenum mode1, const VertexArray& VA2, GLenum mode2,
+                  const Texture& outputTexture) {
             ScopedDebugGroup sdg("DrawVectorsPass");
 
             SetFrameBufferTexture(*m_textureFB, outputTexture.Id());
@@ -291,15 +219,18 @@ namespace {
             const auto mvp = m_projectionMatrix * m_modelViewMatrix;
             SetUniformMatrix4v(m_shader.Id(), "MVP", &mvp[0][0]);
 
-            auto DrawVertices = [](auto& VA, GLenum mode) {
-                if (VA.size() == 0)
+            auto DrawVertices = [this](const VertexArray& VA, GLenum mode) {
+                if (VA.Empty())
                     return;
 
-                auto vbo = MakeBufferResource();
-
-                glBindBuffer(GL_ARRAY_BUFFER, *vbo);
-                glBufferData(GL_ARRAY_BUFFER, VA.size() * sizeof(VertexData), VA.data(),
-                             GL_DYNAMIC_DRAW);
+                // Reuse the same buffer every draw, only growing it when needed. Respecifying its
+                // storage before updating it orphans the previous contents, so we don't wait on the
+                // GPU to finish with them.
+                const auto size = static_cast<GLsizeiptr>(VA.Size() * sizeof(VertexData));
+                m_vboSize = std::max(m_vboSize, size);
+                glBindBuffer(GL_ARRAY_BUFFER, *m_vbo);
+                glBufferData(GL_ARRAY_BUFFER, m_vboSize, nullptr, GL_DYNAMIC_DRAW);
+                glBufferSubData(GL_ARRAY_BUFFER, 0, size, VA.Data());
 
                 glEnableVertexAttribArray(0);
                 glEnableVertexAttribArray(1);
@@ -322,7 +253,7 @@ namespace {
                                       (void*)offsetof(VertexData, brightness) // array buffer offset
                 );
 
-                glDrawArrays(mode, 0, checked_static_cast<GLsizei>(VA.size()));
+                glDrawArrays(mode, 0, checked_static_cast<GLsizei>(VA.Size()));
 
                 glDisableVertexAttribArray(1);
                 glDisableVertexAttribArray(0);
@@ -332,6 +263,68 @@ namespace {
             DrawVertices(VA2, mode2);
         }
 
+    private:
+        const glm::mat4x4& m_projectionMatrix;
+        const glm::mat4x4& m_modelViewMatrix;
+        BufferResource m_vbo;
+        GLsizeiptr m_vboSize{};
+    };
+
+    // Draws lines as quads from LineInstances, one instance per line
+    class DrawLineInstancesPass : public ShaderPass {
+    public:
+        DrawLineInstancesPass(FrameBufferResource& textureFB, const glm::mat4x4& projectionMatrix,
+                              const glm::mat4x4& modelViewMatrix)
+            : ShaderPass(textureFB)
+            , m_projectionMatrix(projectionMatrix)
+            , m_modelViewMatrix(modelViewMatrix) {}
+
+        void Init() {
+            m_shader.LoadShaders(ShaderSource::DrawLineInstances_vert,
+                                 ShaderSource::DrawVectors_frag);
+        }
+
+        void Draw(GLuint instanceBuffer, GLintptr instanceOffset, size_t numInstances,
+                  float lineWidth, float lineScaleX, float lineScaleY,
+                  const Texture& outputTexture) {
+            if (numInstances == 0)
+                return;
+
+            ScopedDebugGroup sdg("DrawLineInstancesPass");
+
+            SetFrameBufferTexture(*m_textureFB, outputTexture.Id());
+            SetViewportToTextureDims(outputTexture);
+
+            m_shader.Bind();
+
+            const auto mvp = m_projectionMatrix * m_modelViewMatrix;
+            SetUniformMatrix4v(m_shader.Id(), "MVP", &mvp[0][0]);
+            SetUniform(m_shader.Id(), "lineScale", lineScaleX, lineScaleY);
+            SetUniform(m_shader.Id(), "lineWidth", lineWidth);
+
+            glBindBuffer(GL_ARRAY_BUFFER, instanceBuffer);
+
+            auto SetInstanceAttribute = [instanceOffset](GLuint index, GLint size,
+                                                         size_t memberOffset) {
+                glEnableVertexAttribArray(index);
+                glVertexAttribPointer(index, size, GL_FLOAT, GL_FALSE, sizeof(LineInstance),
+                                      (void*)(instanceOffset + memberOffset));
+                glVertexAttribDivisor(index, 1);
+            };
+            SetInstanceAttribute(0, 2, offsetof(LineInstance, p0));
+            SetInstanceAttribute(1, 2, offsetof(LineInstance, p1));
+            SetInstanceAttribute(2, 1, offsetof(LineInstance, brightness));
+
+            // 6 vertices per instance, for the 2 triangles of the quad
+            glDrawArraysInstanced(GL_TRIANGLES, 0, 6, checked_static_cast<GLsizei>(numInstances));
+
+            // Other passes use these attributes per vertex
+            for (GLuint index : {2, 1, 0}) {
+                glVertexAttribDivisor(index, 0);
+                glDisableVertexAttribArray(index);
+            }
+        }
+
     private:
         const glm::mat4x4& m_projectionMatrix;
         const glm::mat4x4& m_modelViewMatrix;
@@ -505,6 +498,7 @@ class GLRenderImpl {
 public:
     GLRenderImpl()
         : m_drawVectorsPass(m_textureFB, m_projectionMatrix, m_modelViewMatrix)
+        , m_drawLineInstancesPass(m_textureFB, m_projectionMatrix, m_modelViewMatrix)
         , m_darkenTexturePass(m_textureFB)
         , m_glowPass(m_textureFB)
         , m_combineVectorsAndGlowPass(m_textureFB)
@@ -537,6 +531,7 @@ public:
 
         // Load shaders
         m_drawVectorsPass.Init();
+        m_drawLineInstancesPass.Init();
         m_darkenTexturePass.Init();
         m_glowPass.Init();
         m_combineVectorsAndGlowPass.Init();
@@ -559,23 +554,15 @@ public:
     }
 
     void ResetOverlay(const char* file = nullptr) {
-        auto CreateEmptyOverlayTexture = [this] {
-            std::vector<uint8_t> emptyTexture;
-            emptyTexture.resize(64 * 64 * 4);
-            m_overlayTexture.Allocate(64, 64, GL_RGBA, {},
-                                      PixelData{&emptyTexture[0], GL_RGBA, GL_UNSIGNED_BYTE});
-        };
-
-        if (!file) {
-            CreateEmptyOverlayTexture();
-        } else if (!m_overlayTexture.LoadPng(file, GL_LINEAR)) {
-            Errorf("Failed to load overlay: %s\n", file);
-
-            // If we fail, then allocate a min-sized transparent texture
-            CreateEmptyOverlayTexture();
+        // The new overlay is loaded in the background and swapped in by RenderScene once ready,
+        // showing none in the meantime
+        CreateEmptyOverlayTexture();
+        m_overlayFile = file ? file : "";
+        if (m_overlayFile.empty()) {
+            m_overlayLoader.Cancel();
+        } else {
+            m_overlayLoader.Load(m_overlayFile, m_screenTextureWidth, m_screenTextureHeight);
         }
-
-        m_overlayTexture.SetName("m_overlayTexture");
     }
 
     bool OnWindowResized(int windowWidth, int windowHeight) {
@@ -636,6 +623,15 @@ public:
         m_screenCrtTexture.Allocate(screenTextureWidth, screenTextureHeight, GL_RGB, GL_LINEAR);
         m_screenCrtTexture.SetName("m_screenCrtTexture");
 
+        // Reload the overlay scaled for the new size, keeping the current one until it's ready
+        if (screenTextureWidth != m_screenTextureWidth ||
+            screenTextureHeight != m_screenTextureHeight) {
+            m_screenTextureWidth = screenTextureWidth;
+            m_screenTextureHeight = screenTextureHeight;
+            if (!m_overlayFile.empty())
+                m_overlayLoader.Load(m_overlayFile, m_screenTextureWidth, m_screenTextureHeight);
+        }
+
         // Clear m_vectorsTexture[0] once
         SetFrameBufferTexture(*m_textureFB, m_vectorsTexture[0].Id());
         SetViewportToTextureDims(m_vectorsTexture[0]);
@@ -671,6 +667,9 @@ public:
             }
         }
 
+        if (auto overlay = m_overlayLoader.TakeLoaded())
+            SetOverlay(*overlay);
+
         if (frameTime > 0)
             m_vectorsTexture0Index = (m_vectorsTexture0Index + 1) % 2;
 
@@ -691,31 +690,48 @@ public:
             static_cast<float>(currVectorsTexture0.Height()) / VECTREX_SCREEN_HEIGHT;
         const float lineWidthScale = lineScaleX;
 
-        // Render normal lines and points, and darken
         IMGUI_CALL_IF(GLRenderImGui, Debug, ImGui::Checkbox("ThickBaseLines", &ThickBaseLines));
+        IMGUI_CALL_IF(GLRenderImGui && ThickBaseLines, Debug,
+                      ImGui::SliderFloat("LineWidthNormal", &LineWidthNormal, 0.1f, 3.0f));
+        IMGUI_CALL_IF(GLRenderImGui, Debug, ImGui::Checkbox("EnableBlur", &EnableBlur));
+        IMGUI_CALL_IF(GLRenderImGui && EnableBlur, Debug,
+                      ImGui::SliderFloat("LineWidthGlow", &LineWidthGlow, 0.1f, 2.0f));
+
+        // Quads are expanded from line instances on the GPU, so both normal and glow lines are
+        // drawn from the same upload of one record per line.
+        const float lineWidthNormal = LineWidthNormal * lineWidthScale;
+        const float lineWidthGlow = LineWidthGlow * lineWidthScale;
+        const size_t numLines = renderContext.lines.NumLines();
+        GLintptr lineInstancesOffset = 0;
+        m_lineInstances.BeginFrame();
+        if ((ThickBaseLines || EnableBlur) && numLines > 0) {
+            auto instances = static_cast<LineInstance*>(
+                m_lineInstances.BeginWrite(numLines * sizeof(LineInstance)));
+            PackLineInstances(renderContext.lines, instances);
+            lineInstancesOffset = m_lineInstances.EndWrite();
+        }
+
+        auto DrawLineInstances = [&](float lineWidth, const Texture& outputTexture) {
+            if (numLines == 0)
+                return;
+            m_drawLineInstancesPass.Draw(m_lineInstances.Id(), lineInstancesOffset, numLines,
+                                         lineWidth, lineScaleX, lineScaleY, outputTexture);
+        };
+
+        // Render normal lines and points, and darken
         if (!ThickBaseLines) {
-            std::tie(m_lineVA, m_pointVA) =
-                CreateLineAndPointVertexArrays(renderContext.lines, lineScaleX, lineScaleY);
+            CreateLineAndPointVertexArrays(renderContext.lines, lineScaleX, lineScaleY, m_lineVA,
+                                           m_pointVA);
             m_drawVectorsPass.Draw(m_lineVA, GL_LINES, m_pointVA, GL_POINTS, currVectorsTexture0);
         } else {
-            IMGUI_CALL_IF(GLRenderImGui, Debug,
-                          ImGui::SliderFloat("LineWidthNormal", &LineWidthNormal, 0.1f, 3.0f));
-            m_quadVA = CreateQuadVertexArray(renderContext.lines, LineWidthNormal * lineWidthScale,
-                                             lineScaleX, lineScaleY);
-            m_drawVectorsPass.Draw(m_quadVA, GL_TRIANGLES, {}, {}, currVectorsTexture0);
+            DrawLineInstances(lineWidthNormal, currVectorsTexture0);
         }
         m_darkenTexturePass.Draw(currVectorsTexture0, currVectorsTexture1,
                                  static_cast<float>(frameTime));
 
-        IMGUI_CALL_IF(GLRenderImGui, Debug, ImGui::Checkbox("EnableBlur", &EnableBlur));
         if (EnableBlur) {
-
             // Render thicker lines for blurring, darken, and apply glow
-            IMGUI_CALL_IF(GLRenderImGui, Debug,
-                          ImGui::SliderFloat("LineWidthGlow", &LineWidthGlow, 0.1f, 2.0f));
-            m_quadVA = CreateQuadVertexArray(renderContext.lines, LineWidthGlow * lineWidthScale,
-                                             lineScaleX, lineScaleY);
-            m_drawVectorsPass.Draw(m_quadVA, GL_TRIANGLES, {}, {}, currVectorsThickTexture0);
+            DrawLineInstances(lineWidthGlow, currVectorsThickTexture0);
             m_darkenTexturePass.Draw(currVectorsThickTexture0, currVectorsThickTexture1,
                                      static_cast<float>(frameTime));
             m_glowPass.Draw(currVectorsThickTexture0, m_tempTexture, m_glowTexture);
@@ -730,17 +746,44 @@ public:
 
         // Present
         m_renderToScreenPass.Draw(m_screenCrtTexture, m_overlayTexture);
+
+        m_lineInstances.EndFrame();
     }
 
 private:
+    void CreateEmptyOverlayTexture() {
+        std::vector<uint8_t> emptyTexture;
+        emptyTexture.resize(64 * 64 * 4);
+        m_overlayTexture.Allocate(64, 64, GL_RGBA, {},
+                                  PixelData{&emptyTexture[0], GL_RGBA, GL_UNSIGNED_BYTE});
+        m_overlayTexture.SetName("m_overlayTexture");
+    }
+
+    void SetOverlay(OverlayLoader::Overlay& overlay) {
+        if (!overlay.image) {
+            Errorf("Failed to load overlay: %s\n", overlay.file.c_str());
+
+            // If we fail, then allocate a min-sized transparent texture
+            CreateEmptyOverlayTexture();
+            return;
+        }
+
+        auto& image = *overlay.image;
+        m_overlayTexture.Allocate(image.width, image.height, GL_RGBA, GL_LINEAR,
+                                  PixelData{image.data.get(), GL_RGBA, GL_UNSIGNED_BYTE});
+        m_overlayTexture.SetName("m_overlayTexture");
+    }
+
     int m_windowWidth{};
     int m_windowHeight{};
+    int m_screenTextureWidth{};
+    int m_screenTextureHeight{};
 
     Viewport m_screenViewport{};
 
-    std::vector<VertexData> m_quadVA;
-    std::vector<VertexData> m_lineVA;
-    std::vector<VertexData> m_pointVA;
+    StreamBuffer m_lineInstances;
+    VertexArray m_lineVA;
+    VertexArray m_pointVA;
 
     glm::mat4x4 m_projectionMatrix{};
     glm::mat4x4 m_modelViewMatrix{};
@@ -753,8 +796,11 @@ private:
     Texture m_glowTexture;
     Texture m_screenCrtTexture;
     Texture m_overlayTexture;
+    std::string m_overlayFile; // Empty for no overlay
+    OverlayLoader m_overlayLoader{Paths::overlayCacheDir};
 
     DrawVectorsPass m_drawVectorsPass;
+    DrawLineInstancesPass m_drawLineInstancesPass;
     DarkenTexturePass m_darkenTexturePass;
     GlowPass m_glowPass;
     CombineVectorsAndGlowPass m_combineVectorsAndGlowPass;
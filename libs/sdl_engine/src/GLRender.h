@@ -18,5 +18,5 @@ public:
     void RenderScene(double frameTime, const RenderContext& renderContext);
 
 private:
-    pimpl::Pimpl<class GLRenderImpl, 1024> m_impl;
+    pimpl::Pimpl<class GLRenderImpl, 2048> m_impl;
 };
@@ -1,6 +1,7 @@
 #include "GLUtil.h"
 #include "core/ConsoleOutput.h"
 #include "core/ImageUtil.h"
+#include <algorithm>
 #include <fstream>
 #include <sstream>
 #include <vector>
@@ -83,6 +84,98 @@ void GLUtil::BindFrameBuffer(GLuint frameBufferId) {
     g_frameBufferId = frameBufferId;
 }
 
+GLUtil::StreamBuffer::~StreamBuffer() {
+    Release();
+}
+
+void GLUtil::StreamBuffer::BeginFrame() {
+    m_region = (m_region + 1) % NumRegions;
+    m_regionOffset = 0;
+
+    // Wait for the GPU to be done with the frame that last used this region. This rarely blocks,
+    // as that frame was submitted NumRegions - 1 frames ago.
+    if (GLsync fence = m_fences[m_region]) {
+        const GLuint64 timeout = 1'000'000'000; // ns
+        while (glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, timeout) == GL_TIMEOUT_EXPIRED) {
+        }
+        glDeleteSync(fence);
+        m_fences[m_region] = {};
+    }
+}
+
+void GLUtil::StreamBuffer::EndFrame() {
+    if (!m_persistent)
+        return;
+
+    if (m_fences[m_region])
+        glDeleteSync(m_fences[m_region]);
+    m_fences[m_region] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+}
+
+void* GLUtil::StreamBuffer::BeginWrite(size_t size) {
+    assert(size > 0);
+
+    // Keep writes aligned for vertex attributes
+    const size_t offset = (m_regionOffset + 15) & ~size_t{15};
+
+    if (offset + size > m_regionSize) {
+        // Grow to fit. Storage of the previous buffer is released once the GPU is done with it.
+        Allocate(std::max({m_regionSize * 2, size, MinRegionSize}));
+        return BeginWrite(size);
+    }
+
+    if (m_persistent) {
+        m_writeOffset = m_region * m_regionSize + offset;
+        m_regionOffset = offset + size;
+        return m_mapped + m_writeOffset;
+    }
+
+    // Orphan the buffer so that we don't have to wait for the GPU to be done with its contents
+    glBindBuffer(GL_ARRAY_BUFFER, *m_buffer);
+    glBufferData(GL_ARRAY_BUFFER, static_cast<GLsizeiptr>(m_regionSize), nullptr, GL_STREAM_DRAW);
+    m_writeOffset = 0;
+    return glMapBufferRange(GL_ARRAY_BUFFER, 0, static_cast<GLsizeiptr>(size),
+                            GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT);
+}
+
+GLintptr GLUtil::StreamBuffer::EndWrite() {
+    if (!m_persistent) {
+        glBindBuffer(GL_ARRAY_BUFFER, *m_buffer);
+        glUnmapBuffer(GL_ARRAY_BUFFER);
+    }
+    return static_cast<GLintptr>(m_writeOffset);
+}
+
+void GLUtil::StreamBuffer::Allocate(size_t regionSize) {
+    Release();
+
+    m_persistent = GLEW_ARB_buffer_storage;
+    m_regionSize = regionSize;
+    m_region = 0;
+    m_regionOffset = 0;
+    m_buffer = MakeBufferResource();
+
+    if (m_persistent) {
+        const GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+        const auto size = static_cast<GLsizeiptr>(m_regionSize * NumRegions);
+        glBindBuffer(GL_ARRAY_BUFFER, *m_buffer);
+        glBufferStorage(GL_ARRAY_BUFFER, size, nullptr, flags);
+        m_mapped = static_cast<uint8_t*>(glMapBufferRange(GL_ARRAY_BUFFER, 0, size, flags));
+    }
+}
+
+void GLUtil::StreamBuffer::Release() {
+    for (auto& fence : m_fences) {
+        if (fence) {
+            glDeleteSync(fence);
+            fence = {};
+        }
+    }
+    // Deleting the buffer also unmaps it
+    m_mapped = nullptr;
+    m_buffer = {};
+}
+
 void GLUtil::AllocateTexture(GLuint textureId, GLsizei width, GLsizei height, GLint internalFormat,
                              std::optional<GLint> filtering, std::optional<PixelData> pixelData) {
 
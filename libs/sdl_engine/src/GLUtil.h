@@ -176,6 +176,46 @@ namespace GLUtil {
         glBufferData(GL_ARRAY_BUFFER, N * sizeof(vertices[0]), &vertices[0], GL_DYNAMIC_DRAW);
     }
 
+    // Vertex buffer for data that's rewritten every frame, written to directly through a mapped
+    // pointer. With ARB_buffer_storage (core in GL 4.4), the buffer is mapped once and used as a
+    // ring with one region per frame in flight; fences make sure the GPU is done reading a region
+    // before it's rewritten. Otherwise, the buffer is orphaned and mapped on every write.
+    class StreamBuffer {
+    public:
+        ~StreamBuffer();
+
+        // Call once per frame, before the first write
+        void BeginFrame();
+
+        // Call once per frame, after the last draw that reads this frame's data
+        void EndFrame();
+
+        // Returns a pointer to size bytes to write to. Call EndWrite when done, before drawing.
+        void* BeginWrite(size_t size);
+
+        // Returns the offset in the buffer of the data written since BeginWrite. This is only
+        // valid until the next BeginWrite.
+        GLintptr EndWrite();
+
+        GLuint Id() const { return *m_buffer; }
+
+    private:
+        static constexpr int NumRegions = 3;
+        static constexpr size_t MinRegionSize = 64 * 1024;
+
+        void Allocate(size_t regionSize);
+        void Release();
+
+        BufferResource m_buffer;
+        bool m_persistent = false;
+        uint8_t* m_mapped{};
+        size_t m_regionSize{};
+        int m_region{};
+        size_t m_regionOffset{};
+        size_t m_writeOffset{};
+        std::array<GLsync, NumRegions> m_fences{};
+    };
+
     inline void CheckFramebufferStatus() {
         assert(glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE);
     }
@@ -0,0 +1,245 @@
+#include "OverlayLoader.h"
+#include "core/Base.h"
+#include "core/ConsoleOutput.h"
+#include "core/Hash.h"
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <vector>
+
+namespace {
+    const uint32_t CacheMagic = 0x43565856; // "VXVC"
+    const uint32_t CacheVersion = 1;
+
+    // Cache file header, followed by width * height RGBA pixels. The cached image is only used
+    // while the source file and requested size are the same.
+    struct CacheHeader {
+        uint32_t magic{};
+        uint32_t version{};
+        int64_t sourceLastWriteTime{};
+        uint64_t sourceSize{};
+        int32_t maxWidth{};
+        int32_t maxHeight{};
+        int32_t width{};
+        int32_t height{};
+    };
+
+    // Size that fits width x height within maxWidth x maxHeight keeping its aspect ratio, without
+    // scaling up
+    std::pair<int, int> FitSize(int width, int height, int maxWidth, int maxHeight) {
+        if (maxWidth <= 0 || maxHeight <= 0 || (width <= maxWidth && height <= maxHeight))
+            return {width, height};
+        const float scale = std::min(static_cast<float>(maxWidth) / width,
+                                     static_cast<float>(maxHeight) / height);
+        return {std::max(1, static_cast<int>(std::lround(width * scale))),
+                std::max(1, static_cast<int>(std::lround(height * scale)))};
+    }
+
+    void Premultiply(uint8_t* pixels, size_t numPixels) {
+        for (size_t i = 0; i < numPixels; ++i, pixels += 4) {
+            const unsigned int alpha = pixels[3];
+            for (int c = 0; c < 3; ++c)
+                pixels[c] = static_cast<uint8_t>((pixels[c] * alpha + 127) / 255);
+        }
+    }
+
+    // Source pixels that a destination pixel covers when scaling down, and how much of each
+    struct Coverage {
+        int first{};
+        std::vector<float> weights;
+    };
+
+    std::vector<Coverage> ComputeCoverage(int srcSize, int dstSize) {
+        std::vector<Coverage> result(dstSize);
+        const double scale = static_cast<double>(srcSize) / dstSize;
+        for (int i = 0; i < dstSize; ++i) {
+            const double begin = i * scale;
+            const double end = (i + 1) * scale;
+            auto& coverage = result[i];
+            coverage.first = static_cast<int>(begin);
+            const int last = std::min(srcSize, static_cast<int>(std::ceil(end)));
+            for (int j = coverage.first; j < last; ++j) {
+                const double covered =
+                    std::min(end, j + 1.0) - std::max(begin, static_cast<double>(j));
+                coverage.weights.push_back(static_cast<float>(covered / scale));
+            }
+        }
+        return result;
+    }
+
+    // Scales RGBA pixels down by averaging the source pixels that each destination pixel covers,
+    // which doesn't alias the way bilinear sampling does when shrinking by more than half. Pixels
+    // must be premultiplied, so that transparent pixels don't bleed their color into edges.
+    void ScaleDown(const uint8_t* src, int srcWidth, int srcHeight, uint8_t* dst, int dstWidth,
+                   int dstHeight) {
+        const auto columns = ComputeCoverage(srcWidth, dstWidth);
+        const auto rows = ComputeCoverage(srcHeight, dstHeight);
+
+        // Horizontal pass into srcHeight rows of dstWidth pixels
+        std::vector<float> temp(static_cast<size_t>(srcHeight) * dstWidth * 4);
+        for (int y = 0; y < srcHeight; ++y) {
+            const uint8_t* srcRow = src + static_cast<size_t>(y) * srcWidth * 4;
+            float* tempRow = &temp[static_cast<size_t>(y) * dstWidth * 4];
+            for (int x = 0; x < dstWidth; ++x) {
+                const auto& coverage = columns[x];
+                for (size_t k = 0; k < coverage.weights.size(); ++k) {
+                    const uint8_t* p = srcRow + (coverage.first + k) * 4;
+                    for (int c = 0; c < 4; ++c)
+                        tempRow[x * 4 + c] += p[c] * coverage.weights[k];
+                }
+            }
+        }
+
+        // Vertical pass
+        std::vector<float> sum(static_cast<size_t>(dstWidth) * 4);
+        for (int y = 0; y < dstHeight; ++y) {
+            const auto& coverage = rows[y];
+            std::fill(sum.begin(), sum.end(), 0.f);
+            for (size_t k = 0; k < coverage.weights.size(); ++k) {
+                const float* tempRow = &temp[(coverage.first + k) * dstWidth * 4];
+                for (size_t i = 0; i < sum.size(); ++i)
+                    sum[i] += tempRow[i] * coverage.weights[k];
+            }
+            uint8_t* dstRow = dst + static_cast<size_t>(y) * dstWidth * 4;
+            for (size_t i = 0; i < sum.size(); ++i)
+                dstRow[i] = static_cast<uint8_t>(std::clamp(std::lround(sum[i]), 0l, 255l));
+        }
+    }
+} // namespace
+
+OverlayLoader::OverlayLoader(fs::path cacheDir)
+    : m_cacheDir(std::move(cacheDir)) {
+    m_thread = std::thread([this] { ThreadMain(); });
+}
+
+OverlayLoader::~OverlayLoader() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stopRequested = true;
+    }
+    m_wakeCondition.notify_one();
+    m_thread.join();
+}
+
+void OverlayLoader::Load(const std::string& file, int maxWidth, int maxHeight) {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_pendingRequest = Request{file, maxWidth, maxHeight, ++m_lastRequestId};
+        m_loaded.reset();
+    }
+    m_wakeCondition.notify_one();
+}
+
+void OverlayLoader::Cancel() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    ++m_lastRequestId;
+    m_pendingRequest.reset();
+    m_loaded.reset();
+}
+
+std::optional<OverlayLoader::Overlay> OverlayLoader::TakeLoaded() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    std::optional<Overlay> result;
+    result.swap(m_loaded);
+    return result;
+}
+
+void OverlayLoader::ThreadMain() {
+    while (true) {
+        Request request;
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_wakeCondition.wait(lock, [this] { return m_stopRequested || m_pendingRequest; });
+            if (m_stopRequested)
+                return;
+            request = std::move(*m_pendingRequest);
+            m_pendingRequest.reset();
+        }
+
+        auto image = LoadImage(request);
+
+        // Drop the result if another request came in meanwhile
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (request.id == m_lastRequestId)
+            m_loaded = Overlay{std::move(request.file), std::move(image)};
+    }
+}
+
+std::optional<ImageUtil::PngImageData> OverlayLoader::LoadImage(const Request& request) {
+    std::error_code ec;
+    const auto sourceSize = fs::file_size(request.file, ec);
+    if (ec)
+        return {};
+    const auto sourceLastWriteTime = static_cast<int64_t>(
+        fs::last_write_time(request.file, ec).time_since_epoch().count());
+
+    const auto cacheFile = CacheFile(request.file);
+    if (std::ifstream fin(cacheFile, std::ios::binary); fin) {
+        CacheHeader header{};
+        fin.read(reinterpret_cast<char*>(&header), sizeof(header));
+        if (fin && header.magic == CacheMagic && header.version == CacheVersion &&
+            header.sourceLastWriteTime == sourceLastWriteTime &&
+            header.sourceSize == sourceSize && header.maxWidth == request.maxWidth &&
+            header.maxHeight == request.maxHeight && header.width > 0 && header.height > 0) {
+            const size_t size = static_cast<size_t>(header.width) * header.height * 4;
+            if (auto pixels = ImageUtil::allocatePixels(size)) {
+                fin.read(reinterpret_cast<char*>(pixels.get()), size);
+                if (fin)
+                    return ImageUtil::PngImageData{header.width, header.height, true,
+                                                   std::move(pixels)};
+            }
+        }
+    }
+
+    // Decode straight to RGBA, premultiply in place, and only copy if scaling down
+    auto image = ImageUtil::loadPngImage(request.file.c_str(), 4);
+    if (!image)
+        return {};
+    Premultiply(image->data.get(), static_cast<size_t>(image->width) * image->height);
+
+    const auto [width, height] =
+        FitSize(image->width, image->height, request.maxWidth, request.maxHeight);
+    if (width != image->width || height != image->height) {
+        auto pixels = ImageUtil::allocatePixels(static_cast<size_t>(width) * height * 4);
+        if (!pixels)
+            return {};
+        ScaleDown(image->data.get(), image->width, image->height, pixels.get(), width, height);
+        image = ImageUtil::PngImageData{width, height, true, std::move(pixels)};
+    }
+
+    // Write to a temporary file first so that an interrupted write never leaves a bad cache file
+    CacheHeader header{};
+    header.magic = CacheMagic;
+    header.version = CacheVersion;
+    header.sourceLastWriteTime = sourceLastWriteTime;
+    header.sourceSize = sourceSize;
+    header.maxWidth = request.maxWidth;
+    header.maxHeight = request.maxHeight;
+    header.width = image->width;
+    header.height = image->height;
+
+    fs::create_directories(m_cacheDir, ec);
+    auto tempFile = cacheFile;
+    tempFile += ".tmp";
+    std::ofstream fout(tempFile, std::ios::binary);
+    fout.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    fout.write(reinterpret_cast<const char*>(image->data.get()),
+               static_cast<std::streamsize>(image->width) * image->height * 4);
+    fout.close();
+    if (fout) {
+        fs::rename(tempFile, cacheFile, ec);
+    } else {
+        Errorf("Failed to write overlay cache: %s\n", cacheFile.string().c_str());
+        fs::remove(tempFile, ec);
+    }
+
+    return image;
+}
+
+fs::path OverlayLoader::CacheFile(const fs::path& file) const {
+    // One cache file per overlay, named after its full path
+    const auto hash = Hash::Fnv1a(fs::absolute(file).generic_string());
+    return m_cacheDir / FormattedString<>("%s_%016llx.rgba", file.stem().string().c_str(),
+                                          static_cast<unsigned long long>(hash))
+                            .Value();
+}
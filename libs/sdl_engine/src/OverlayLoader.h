@@ -0,0 +1,58 @@
+#pragma once
+
+#include "core/FileSystem.h"
+#include "core/ImageUtil.h"
+#include <condition_variable>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+
+// Loads overlay images on a background thread, so that switching roms doesn't stall the frame
+// loop on decoding a PNG. Images are premultiplied by alpha and scaled down to fit the size they
+// are drawn at, and the result is cached in cacheDir: later loads of the same overlay at the same
+// size read the cache straight into the final buffer instead of decoding.
+//
+// Only the most recent request matters: a request made while another is loading replaces it, and
+// its result is dropped.
+class OverlayLoader {
+public:
+    struct Overlay {
+        std::string file;
+        // Empty if loading failed. RGBA premultiplied by alpha, bottom row first.
+        std::optional<ImageUtil::PngImageData> image;
+    };
+
+    explicit OverlayLoader(fs::path cacheDir);
+    ~OverlayLoader();
+
+    // Starts loading file, scaled down to fit within maxWidth x maxHeight (if not 0)
+    void Load(const std::string& file, int maxWidth, int maxHeight);
+
+    // Forgets any request in progress
+    void Cancel();
+
+    // Returns the overlay for the most recent request once it has loaded, and only once
+    std::optional<Overlay> TakeLoaded();
+
+private:
+    struct Request {
+        std::string file;
+        int maxWidth{};
+        int maxHeight{};
+        uint32_t id{};
+    };
+
+    void ThreadMain();
+    std::optional<ImageUtil::PngImageData> LoadImage(const Request& request);
+    fs::path CacheFile(const fs::path& file) const;
+
+    const fs::path m_cacheDir;
+    std::thread m_thread;
+    std::mutex m_mutex;
+    std::condition_variable m_wakeCondition;
+    bool m_stopRequested = false;
+    uint32_t m_lastRequestId{};
+    std::optional<Request> m_pendingRequest;
+    std::optional<Overlay> m_loaded;
+};
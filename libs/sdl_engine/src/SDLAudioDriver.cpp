@@ -1,11 +1,13 @@
 #include "SDLAudioDriver.h"
 #include "core/CircularBuffer.h"
 #include "core/Gui.h"
+#include "core/HostProfiler.h"
 #include "core/Stream.h"
 #include "engine/Paths.h"
 #include <SDL.h>
 #include <SDL_audio.h>
 #include <array>
+#include <atomic>
 
 namespace OutputRawAudioFileStream {
     constexpr bool Enabled = true;
@@ -162,7 +164,10 @@ public:
     size_t GetSampleRate() const { return m_audioSpec.freq; }
 
     float GetBufferUsageRatio() const {
-        return static_cast<float>(m_samples.UsedSize()) / m_samples.TotalSize();
+        SDL_LockAudioDevice(m_audioDeviceID);
+        const auto usedSize = m_samples.UsedSize();
+        SDL_UnlockAudioDevice(m_audioDeviceID);
+        return static_cast<float>(usedSize) / m_samples.TotalSize();
     }
 
     void SetPaused(bool paused) {
@@ -183,30 +188,36 @@ public:
         }
     }
 
-    void AddSample(float sample) {
-        assert(sample >= -1.0f && sample <= 1.0f);
-
-        sample *= m_volume;
+    // Samples may be added from any single thread (e.g. the emulation thread), concurrently with
+    // the audio callback and Update() on the main thread.
+    void AddSample(float sample) { AddSamples(&sample, 1); }
 
-        auto targetSample = CurrAudioFormat::Remap(sample);
+    void AddSamples(const float* samples, size_t size) {
+        const float volume = m_volume.load(std::memory_order_relaxed);
+
+        m_targetSamples.clear();
+        for (size_t i = 0; i < size; ++i) {
+            float sample = samples[i];
+            assert(sample >= -1.0f && sample <= 1.0f);
+            sample *= volume;
+            m_targetSamples.push_back(CurrAudioFormat::Remap(sample));
+
+            if constexpr (OutputRawAudioFileStream::Enabled &&
+                          OutputRawAudioFileStream::SourceSamples) {
+                m_rawAudioOutputFS.WriteValue(sample);
+            }
+        }
 
+        // Lock once for the whole batch rather than per sample
         SDL_LockAudioDevice(m_audioDeviceID);
-        m_samples.PushBack(targetSample);
+        m_samples.PushBack(m_targetSamples.data(), m_targetSamples.size());
         SDL_UnlockAudioDevice(m_audioDeviceID);
-
-        if constexpr (OutputRawAudioFileStream::Enabled &&
-                      OutputRawAudioFileStream::SourceSamples) {
-            m_rawAudioOutputFS.WriteValue(sample);
-        }
-    }
-
-    void AddSamples(const float* samples, size_t size) {
-        for (size_t i = 0; i < size; ++i)
-            AddSample(samples[i]);
     }
 
 private:
     static void AudioCallback(void* userData, Uint8* byteStream, int byteStreamLength) {
+        HOST_PROFILE_THREAD_NAME("Audio");
+        HOST_PROFILE_SCOPE(AudioCallback);
         auto audioDriver = reinterpret_cast<SDLAudioDriverImpl*>(userData);
         auto stream = reinterpret_cast<SampleFormatType*>(byteStream);
 
@@ -233,9 +244,10 @@ private:
     SDL_AudioDeviceID m_audioDeviceID{0};
     SDL_AudioSpec m_audioSpec;
     CircularBuffer<SampleFormatType> m_samples;
+    std::vector<SampleFormatType> m_targetSamples; // Scratch buffer for AddSamples
     FileStream m_rawAudioOutputFS;
     bool m_paused;
-    float m_volume{1.f};
+    std::atomic<float> m_volume{1.f};
 };
 
 SDLAudioDriver::SDLAudioDriver() = default;
@@ -1,27 +1,35 @@
 #include "sdl_engine/SDLEngine.h"
 
+#include "EmulationThread.h"
 #include "GLRender.h"
 #include "GLUtil.h"
 #include "InputManager.h"
 #include "SDLAudioDriver.h"
 #include "SDLGameController.h"
 #include "SDLKeyboard.h"
+#include "StreamViewer.h"
 #include "core/ConsoleOutput.h"
 #include "core/FileSystem.h"
 #include "core/FrameTimer.h"
 #include "core/Gui.h"
+#include "core/HostProfiler.h"
 #include "core/Platform.h"
 #include "core/StringUtil.h"
 #include "engine/EngineClient.h"
 #include "engine/EngineUtil.h"
+#include "engine/FastForward.h"
 #include "engine/Options.h"
 #include "engine/Paths.h"
 #include "imgui_impl/imgui_impl_sdl_gl3.h"
 #include <SDL.h>
 #include <SDL_net.h>
 #include <algorithm>
+#include <atomic>
+#include <cstring>
 #include <fstream>
 #include <iostream>
+#include <mutex>
+#include <optional>
 
 // Include SDL_syswm.h for SDL_GetWindowWMInfo
 // This includes windows.h on Windows platforms, we have to do the usual dance of disabling certain
@@ -85,6 +93,7 @@ public:
 
     bool Run(int argc, char** argv) {
         Platform::Init();
+        HOST_PROFILE_THREAD_NAME("Main");
 
         if (!EngineUtil::FindAndSetRootPath(fs::path(fs::absolute(argv[0]))))
             return false;
@@ -98,11 +107,14 @@ public:
         std::shared_ptr<IEngineService> engineService =
             std::make_shared<aggregate_adapter<IEngineService>>(
                 // SetFocusMainWindow
-                [this] { Platform::SetFocus(GetMainWindowHandle()); },
+                [this] { m_pendingSetFocusMainWindow = true; },
                 // SetFocusConsole
                 [] { Platform::SetConsoleFocus(); },
                 // ResetOverlay
-                [this](const char* file) { m_glRender.ResetOverlay(file); });
+                [this](const char* file) {
+                    std::lock_guard<std::mutex> lock(m_pendingOverlayMutex);
+                    m_pendingOverlayFile = file ? file : "";
+                });
 
         if (SDL_Init(SDL_INIT_VIDEO | SDL_INIT_AUDIO | SDL_INIT_GAMECONTROLLER) < 0) {
             std::cout << "SDL cannot init with error " << SDL_GetError() << std::endl;
@@ -128,10 +140,18 @@ public:
         m_options.Add<float>("imguiFontScale", GetDefaultImguiFontScale());
         m_options.Add<std::string>("lastOpenedFile", {});
         m_options.Add<float>("volume", 0.5f);
+        // Off by default, as the emulator's debug windows only work on the main thread
+        m_options.Add<bool>("emulationThread", false);
+        m_options.Add<int>("fastForwardSpeed", FastForward::MaxSpeed);
         m_inputManager.AddOptions(m_options);
         m_options.SetFilePath(Paths::optionsFile);
         m_options.Load();
 
+        // Keep a hand-edited fast-forward speed within the supported range
+        m_options.Set("fastForwardSpeed",
+                      std::clamp(m_options.Get<int>("fastForwardSpeed"), FastForward::Unthrottled,
+                                 FastForward::MaxSpeed));
+
         // Init input mapping and device for each player from options
         m_inputManager.ReadOptions(m_options);
 
@@ -209,6 +229,20 @@ public:
         m_audioDriver.Initialize();
         m_audioDriver.SetVolume(m_options.Get<float>("volume"));
 
+        // -watch=[host:]port shows a headless instance's -stream output instead of emulating
+        for (int i = 1; i < argc; ++i) {
+            std::string arg = argv[i];
+            if (arg.rfind("-watch=", 0) == 0) {
+                auto address = StreamViewer::ParseAddress(arg.substr(std::strlen("-watch=")));
+                if (!address) {
+                    Errorf("Invalid stream address: %s\n", arg.c_str());
+                    return false;
+                }
+                m_streamViewer = std::make_unique<StreamViewer>(*address);
+                m_client = m_streamViewer.get();
+            }
+        }
+
         if (!m_client->Init(engineService, m_options.Get<std::string>("biosRomFile"), argc, argv)) {
             return false;
         }
@@ -221,12 +255,22 @@ public:
         float CpuCyclesPerAudioSample = CpuCyclesPerSec / m_audioDriver.GetSampleRate();
         AudioContext audioContext{CpuCyclesPerAudioSample};
 
+        const bool useEmulationThread = m_options.Get<bool>("emulationThread");
+        if (useEmulationThread) {
+            m_emulationThread.Start(*m_client, m_options, m_optionsMutex, m_audioDriver,
+                                    CpuCyclesPerAudioSample);
+        }
+
         bool quit = false;
         while (!quit) {
+            // The emulation thread may use options while handling events
+            std::unique_lock<std::mutex> optionsLock(m_optionsMutex);
+
             PollEvents(quit);
             UpdatePauseState(m_paused[PauseSource::Game]);
             auto input = UpdateInput();
             const auto frameTime = UpdateFrameTime();
+            const int fastForwardSpeed = GetFastForwardSpeed();
 
             auto emuEvents = EmuEvents{};
             if (m_keyboard.GetKeyState(SDL_SCANCODE_LCTRL).down &&
@@ -251,41 +295,84 @@ public:
                 emuEvents.push_back({EmuEvent::OpenRomFile{}});
             }
 
-            ImGui_ImplSdlGL3_NewFrame(m_window);
+            {
+                HOST_PROFILE_SCOPE(Gui);
+                ImGui_ImplSdlGL3_NewFrame(m_window);
+
+                UpdateMenu(quit, emuEvents);
 
-            UpdateMenu(quit, emuEvents);
+#ifdef HOST_PROFILER_ENABLED
+                IMGUI_CALL(Profiler,
+                           HostProfiler::DrawImGui(Paths::devDir / "host_trace.json"));
+#endif
+            }
 
             HACK_Simulate3dImager(frameTime, input);
 
-            if (!m_client->FrameUpdate(frameTime, {std::ref(emuEvents), std::ref(m_options)}, input,
-                                       renderContext, audioContext)) {
-                quit = true;
+            if (useEmulationThread) {
+                ResolveOpenRomFileDialogs(emuEvents);
+                optionsLock.unlock();
+
+                m_emulationThread.PushFrame(frameTime, fastForwardSpeed, input,
+                                            std::move(emuEvents));
+                if (m_emulationThread.QuitRequested()) {
+                    quit = true;
+                }
+
+            } else {
+                optionsLock.unlock();
+
+                // Leave some of the frame's time for rendering when fast-forwarding unthrottled
+                const double timeBudget = frameTime / 2;
+                if (!m_fastForward.FrameUpdate(*m_client, frameTime, fastForwardSpeed, timeBudget,
+                                               {std::ref(emuEvents), std::ref(m_options)}, input,
+                                               renderContext, audioContext)) {
+                    quit = true;
+                }
+
+                HOST_PROFILE_SCOPE(Audio);
+                m_audioDriver.AddSamples(audioContext.samples.data(), audioContext.samples.size());
+                audioContext.samples.clear();
             }
 
             // Audio update
-            m_audioDriver.AddSamples(audioContext.samples.data(), audioContext.samples.size());
-            audioContext.samples.clear();
-            m_audioDriver.Update(frameTime);
+            {
+                HOST_PROFILE_SCOPE(Audio);
+                m_audioDriver.Update(frameTime);
+            }
+
+            // Apply engine service requests that must be made on this thread
+            ApplyPendingEngineServiceRequests();
 
             // Render update
-            const size_t MaxLinesInTurboMode = 1'000;
-            if (IsTurboMode() && renderContext.lines.size() > MaxLinesInTurboMode) {
-                renderContext.lines.resize(MaxLinesInTurboMode);
-            }
+            const RenderContext& frameRenderContext =
+                useEmulationThread ? m_emulationThread.AcquireRenderContext() : renderContext;
 
-            m_glRender.RenderScene(frameTime, renderContext);
-            ImGui_Render();
-            SDL_GL_SwapWindow(m_window);
+            {
+                HOST_PROFILE_SCOPE(Render);
+                m_glRender.RenderScene(frameTime, frameRenderContext);
+            }
+            {
+                HOST_PROFILE_SCOPE(Gui);
+                ImGui_Render();
+            }
+            {
+                HOST_PROFILE_SCOPE(Swap);
+                SDL_GL_SwapWindow(m_window);
+            }
 
             // Don't clear lines when paused
-            if (frameTime > 0) {
-                renderContext.lines.clear();
+            if (!useEmulationThread && frameTime > 0) {
+                renderContext.lines.Clear();
             }
 
             m_keyboard.PostFrameUpdateKeyStates();
             m_controllerDriver.PostFrameUpdateKeyStates();
+
+            HOST_PROFILE_END_FRAME();
         }
 
+        m_emulationThread.Stop();
         m_client->Shutdown();
 
         m_audioDriver.Shutdown();
@@ -405,10 +492,7 @@ private:
         if (IsPaused())
             frameTime = 0.0;
 
-        // Scale up if turbo
         UpdateTurboMode();
-        if (IsTurboMode())
-            frameTime *= 10;
 
         return frameTime;
     }
@@ -449,6 +533,21 @@ private:
                     emuEvents.push_back({EmuEvent::Reset{}});
 
                 ImGui::MenuItem("Pause", "P", &m_paused[PauseSource::Game]);
+
+                // Fast-forward speed, used while holding the turbo key (`)
+                {
+                    static const std::array<const char*, 5> items{"2x", "3x", "5x", "10x",
+                                                                  "Unthrottled"};
+                    static const std::array<int, 5> speeds{2, 3, 5, FastForward::MaxSpeed,
+                                                           FastForward::Unthrottled};
+
+                    auto currSpeed = m_options.Get<int>("fastForwardSpeed");
+                    int index = find_index_of(speeds, currSpeed, 3);
+                    if (ImGui::Combo("Fast-forward", &index, items.data(), (int)items.size())) {
+                        m_options.Set("fastForwardSpeed", speeds[index]);
+                        m_options.Save();
+                    }
+                }
                 ImGui::EndMenu();
             }
 
@@ -492,6 +591,9 @@ private:
 
 #ifdef DEBUG_UI_ENABLED
                 ImGui::MenuItem("Debug window", "", &Gui::EnabledWindows[Gui::Window::Debug]);
+#ifdef HOST_PROFILER_ENABLED
+                ImGui::MenuItem("Host profiler", "", &Gui::EnabledWindows[Gui::Window::Profiler]);
+#endif
 #endif
 
                 if (ImGui::MenuItem("Break into Debugger", "Ctrl+C"))
@@ -690,6 +792,45 @@ private:
         return SDL_GL_CreateContext(window);
     }
 
+    // The open file dialog must be shown from the main thread on some platforms, so when emulating
+    // on another thread, ask for the rom path here and send the client the chosen file instead.
+    void ResolveOpenRomFileDialogs(EmuEvents& emuEvents) {
+        for (auto iter = emuEvents.begin(); iter != emuEvents.end();) {
+            auto openRomFile = std::get_if<EmuEvent::OpenRomFile>(&iter->type);
+            if (openRomFile && openRomFile->path.empty()) {
+                fs::path lastOpenedFile = m_options.Get<std::string>("lastOpenedFile");
+
+                auto result = Platform::OpenFileDialog(
+                    "Open Vectrex rom", "Vectrex Rom", "*.vec;*.bin",
+                    lastOpenedFile.empty() ? Paths::romsDir : lastOpenedFile);
+
+                if (!result) {
+                    iter = emuEvents.erase(iter);
+                    continue;
+                }
+                openRomFile->path = *result;
+            }
+            ++iter;
+        }
+    }
+
+    // Engine service functions may be called by the client from the emulation thread, so those
+    // that touch the window or GL context are deferred to here.
+    void ApplyPendingEngineServiceRequests() {
+        if (m_pendingSetFocusMainWindow.exchange(false)) {
+            Platform::SetFocus(GetMainWindowHandle());
+        }
+
+        std::optional<std::string> overlayFile;
+        {
+            std::lock_guard<std::mutex> lock(m_pendingOverlayMutex);
+            overlayFile.swap(m_pendingOverlayFile);
+        }
+        if (overlayFile) {
+            m_glRender.ResetOverlay(overlayFile->empty() ? nullptr : overlayFile->c_str());
+        }
+    }
+
     Input UpdateInput() { return m_inputManager.Poll(); }
 
     void UpdatePauseState(bool& paused) {
@@ -733,7 +874,13 @@ private:
 
     bool IsTurboMode() { return m_turbo; }
 
+    // Number of frames to emulate per presented frame, or FastForward::Unthrottled
+    int GetFastForwardSpeed() {
+        return IsTurboMode() ? m_options.Get<int>("fastForwardSpeed") : 1;
+    }
+
     IEngineClient* m_client = nullptr;
+    std::unique_ptr<StreamViewer> m_streamViewer; // Replaces the registered client with -watch
     SDL_Window* m_window = nullptr;
     SDL_GLContext m_glContext{};
     GLRender m_glRender;
@@ -742,7 +889,13 @@ private:
     SDLAudioDriver m_audioDriver;
     InputManager m_inputManager;
     Options m_options;
+    std::mutex m_optionsMutex;
+    EmulationThread m_emulationThread;
+    std::atomic<bool> m_pendingSetFocusMainWindow{false};
+    std::mutex m_pendingOverlayMutex;
+    std::optional<std::string> m_pendingOverlayFile; // Empty string for no overlay
     FrameTimer m_frameTimer;
+    FastForward m_fastForward;
     bool m_paused[PauseSource::Size]{};
     bool m_turbo = false;
 };
@@ -0,0 +1,131 @@
+#include "StreamViewer.h"
+#include "core/ConsoleOutput.h"
+#include <algorithm>
+#include <chrono>
+
+namespace {
+    // Short enough that shutting down doesn't wait noticeably on an idle connection
+    const int ReceiveTimeoutMs = 100;
+    const auto ReconnectInterval = std::chrono::seconds(1);
+
+    // About a second at the stream's sample rate. Older samples are dropped if the server runs
+    // faster than realtime.
+    const size_t MaxBufferedSamples = 44100;
+} // namespace
+
+std::optional<StreamViewer::Address> StreamViewer::ParseAddress(const std::string& address) {
+    const auto colon = address.rfind(':');
+    Address result;
+    result.host = colon == std::string::npos ? "127.0.0.1" : address.substr(0, colon);
+    const auto portString = colon == std::string::npos ? address : address.substr(colon + 1);
+    try {
+        const int port = std::stoi(portString);
+        if (port <= 0 || port > UINT16_MAX || result.host.empty())
+            return {};
+        result.port = static_cast<uint16_t>(port);
+    } catch (...) {
+        return {};
+    }
+    return result;
+}
+
+StreamViewer::StreamViewer(Address address)
+    : m_address(std::move(address)) {}
+
+StreamViewer::~StreamViewer() {
+    Shutdown();
+}
+
+bool StreamViewer::Init(std::shared_ptr<IEngineService>& /*engineService*/,
+                        std::string_view /*biosRomFile*/, int /*argc*/, char** /*argv*/) {
+    Printf("Watching stream at %s:%d\n", m_address.host.c_str(), m_address.port);
+    m_stopRequested = false;
+    m_thread = std::thread([this] { ReceiveMain(); });
+    return true;
+}
+
+bool StreamViewer::FrameUpdate(double /*frameTime*/, const EmuContext& /*emuContext*/,
+                               const Input& /*input*/, RenderContext& renderContext,
+                               AudioContext& audioContext) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    renderContext.lines = m_lines;
+    audioContext.samples.insert(audioContext.samples.end(), m_samples.begin(), m_samples.end());
+    m_samples.clear();
+    return true;
+}
+
+void StreamViewer::Shutdown() {
+    if (m_thread.joinable()) {
+        m_stopRequested = true;
+        m_thread.join();
+    }
+}
+
+bool StreamViewer::ReceiveAll(void* data, size_t size) {
+    auto bytes = static_cast<uint8_t*>(data);
+    size_t received = 0;
+    while (received < size) {
+        if (m_stopRequested)
+            return false;
+        if (!m_client.WaitForData(ReceiveTimeoutMs))
+            continue;
+        const int result = m_client.Receive(bytes + received, static_cast<int>(size - received));
+        if (result <= 0)
+            return false;
+        received += result;
+    }
+    return true;
+}
+
+void StreamViewer::ReceiveMain() {
+    VectorStream::Decoder decoder;
+    std::vector<uint8_t> payload;
+    LineStrips lines;
+    std::vector<float> samples;
+    bool connected = false;
+
+    while (!m_stopRequested) {
+        if (!connected) {
+            if (!m_client.Open(m_address.host.c_str(), m_address.port)) {
+                const auto retryTime = std::chrono::steady_clock::now() + ReconnectInterval;
+                while (!m_stopRequested && std::chrono::steady_clock::now() < retryTime)
+                    std::this_thread::sleep_for(std::chrono::milliseconds(ReceiveTimeoutMs));
+                continue;
+            }
+            Printf("Stream viewer: connected to %s:%d\n", m_address.host.c_str(),
+                   m_address.port);
+            decoder.Reset();
+            connected = true;
+        }
+
+        uint32_t size{};
+        bool received = ReceiveAll(&size, sizeof(size)) && size <= VectorStream::MaxPayloadSize;
+        if (received) {
+            payload.resize(size);
+            received = ReceiveAll(payload.data(), size);
+        }
+        if (!received) {
+            if (!m_stopRequested)
+                Printf("Stream viewer: disconnected, reconnecting...\n");
+            m_client.Close();
+            connected = false;
+            continue;
+        }
+
+        // After a bad message, deltas are rejected until the next keyframe
+        if (!decoder.Decode(payload.data(), payload.size(), lines, samples)) {
+            decoder.Reset();
+            continue;
+        }
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        std::swap(m_lines, lines);
+        m_samples.insert(m_samples.end(), samples.begin(), samples.end());
+        if (m_samples.size() > MaxBufferedSamples) {
+            m_samples.erase(m_samples.begin(),
+                            m_samples.end() - static_cast<ptrdiff_t>(MaxBufferedSamples));
+        }
+    }
+
+    m_client.Close();
+}
@@ -0,0 +1,49 @@
+#pragma once
+
+#include "core/LineStrips.h"
+#include "core/Tcp.h"
+#include "engine/EngineClient.h"
+#include "engine/VectorStream.h"
+#include <atomic>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Engine client that shows the output streamed by a headless instance's VectorStreamServer instead
+// of emulating, e.g. vectrexy -watch=localhost:9124. Messages are received and decoded on a
+// background thread, which keeps only the most recent frame: each FrameUpdate presents it, along
+// with the audio received since the previous update. Reconnects if the connection drops.
+class StreamViewer final : public IEngineClient {
+public:
+    struct Address {
+        std::string host;
+        uint16_t port{};
+    };
+
+    // Parses "host:port", or "port" for a local server
+    static std::optional<Address> ParseAddress(const std::string& address);
+
+    explicit StreamViewer(Address address);
+    ~StreamViewer();
+
+private:
+    bool Init(std::shared_ptr<IEngineService>& engineService, std::string_view biosRomFile,
+              int argc, char** argv) override;
+    bool FrameUpdate(double frameTime, const EmuContext& emuContext, const Input& input,
+                     RenderContext& renderContext, AudioContext& audioContext) override;
+    void Shutdown() override;
+
+    void ReceiveMain();
+    bool ReceiveAll(void* data, size_t size);
+
+    const Address m_address;
+    TcpClient m_client;
+    std::thread m_thread;
+    std::atomic<bool> m_stopRequested{false};
+
+    std::mutex m_mutex;           // Guards members below
+    LineStrips m_lines;           // Most recent frame
+    std::vector<float> m_samples; // Received since the last FrameUpdate
+};
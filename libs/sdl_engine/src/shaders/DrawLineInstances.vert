@@ -0,0 +1,59 @@
+R"ShaderSource(
+#version 330 core
+
+// Draws one instance per line (LineVertices::LineInstance), expanding it into a quad of 2
+// triangles. This matches LineVertices::CreateQuadVertexArray on the CPU.
+
+layout(location = 0) in vec2 lineP0;
+layout(location = 1) in vec2 lineP1;
+layout(location = 2) in float lineBrightness;
+
+out float vertexBrightness;
+
+uniform mat4 MVP;
+uniform vec2 lineScale; // Vectrex space to CRT texture space
+uniform float lineWidth;
+
+const float MinPixelDist = 1.0;
+const float MaxPointLength = 0.1;
+
+void main() {
+    vec2 p0 = lineP0 * lineScale;
+    vec2 p1 = lineP1 * lineScale;
+
+    // The quad's corners are p0 + u, p0 + w, p1 - u and p1 - w
+    vec2 u;
+    vec2 w;
+
+    // If end points are close, draw a dot instead of a line. We do this before applying any scale.
+    if (length(lineP0 - lineP1) <= MaxPointLength) {
+        p1 = p0;
+        u = vec2(1.0, 1.0);
+        w = vec2(1.0, -1.0);
+    } else {
+        vec2 v01 = p1 - p0;
+        vec2 n = normalize(v01);
+
+        // Make sure line gets at least one pixel coverage to ensure it gets rendered
+        if (abs(v01.x) < MinPixelDist) {
+            p1.x = p0.x + n.x * MinPixelDist;
+        }
+        if (abs(v01.y) < MinPixelDist) {
+            p1.y = p0.y + n.y * MinPixelDist;
+        }
+
+        u = vec2(-n.y, n.x);
+        w = -u;
+    }
+
+    // Make sure line width is at least one pixel wide to ensure it gets rendered
+    float hlw = max(lineWidth, MinPixelDist) / 2.0;
+    u *= hlw;
+    w *= hlw;
+
+    vec2 corners[6] = vec2[6](p0 + u, p0 + w, p1 - u, p1 - u, p1 - w, p0 + u);
+    gl_Position = MVP * vec4(corners[gl_VertexID], 0.0, 1.0);
+
+    vertexBrightness = lineBrightness;
+}
+)ShaderSource"
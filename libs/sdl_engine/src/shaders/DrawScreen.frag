@@ -10,8 +10,10 @@ uniform float overlayAlpha;
 
 void main() {
     vec3 c1 = texture( crtTexture, UV ).rgb;
+    // Overlay is premultiplied by alpha
     vec4 c2 = texture( overlayTexture, UV ).rgba;
     float ratio = max(0, c2.a - (1 - overlayAlpha));
-    color = mix(c1, vec3(c2), ratio);
+    // Same as mix(c1, c2.rgb / c2.a, ratio), without dividing by 0 where fully transparent
+    color = c1 * (1 - ratio) + c2.rgb * (c2.a > 0.0 ? ratio / c2.a : 0.0);
 }
 )ShaderSource"
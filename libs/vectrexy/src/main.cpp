@@ -23,7 +23,7 @@ private:
               int argc, char** argv) override {
         m_engineService = engineService;
 
-        m_overlays.LoadOverlays(Paths::overlaysDir);
+        m_overlays.LoadOverlays(Paths::overlaysDir, Paths::overlayIndexFile);
 
         //@TODO: Clean this up
         std::string rom = "";